@@ -7,8 +7,14 @@
 /** \addtogroup BUZZER Buzzer
  ** @{ */
 
-/** @brief 
+/** @brief Buzzer driver
  *
+ * Tones and melodies are played in background by a sequencer driven by a soft timer 
+ * (see timer_mcu.h): none of the play functions block the calling task. 
+ * 
+ * A melody is an array of buzzer_note_t events (frequency and duration). RTTTL strings are 
+ * compiled to that format with BuzzerRtttlCompile(), so parsing is done once and not while 
+ * playing. Note arrays passed to BuzzerPlay() and BuzzerQueue() must remain valid while played.
  *
  * @author Albano Peñalva
  * 
@@ -17,11 +23,13 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 08/04/2024 | Document creation		                         |
+ * | 19/10/2026 | RTTTL compiler and non-blocking sequencer      |
  *
  */
 
 /*==================[inclusions]=============================================*/
 #include <stdint.h>
+#include <stdbool.h>
 #include <gpio_mcu.h>
 /*==================[macros]=================================================*/
 /* Note frequency (in Hz) */
@@ -114,7 +122,17 @@
 #define NOTE_CS8 4435
 #define NOTE_D8  4699
 #define NOTE_DS8 4978
+
+#define BUZZER_QUEUE_LEN		4		/*!< Melodies that can wait in BuzzerQueue() */
+#define BUZZER_RTTTL_MAX_NOTES	128		/*!< Notes of a melody played with BuzzerPlayRtttl() */
 /*==================[typedef]================================================*/
+/**
+ * @brief Melody event
+ */
+typedef struct {
+	uint16_t freq;			/*!< Tone frequency (in Hz), 0 for a silence */
+	uint16_t duration;		/*!< Duration (in ms) */
+} buzzer_note_t;
 
 /*==================[external data declaration]==============================*/
 
@@ -149,6 +167,8 @@ void BuzzerSetFrec(uint16_t freq);
 /**
  * @brief Plays a single tone for a duration of time.
  * 
+ * @note Returns immediately, it replaces whatever was playing.
+ * 
  * @param freq Tone frequency (in Hz).
  * @param duration Tone duration (in ms).
  */
@@ -157,10 +177,56 @@ void BuzzerPlayTone(uint16_t freq, uint16_t duration);
 /**
  * @brief Plays a melody stored in format RTTTL (Ring Tone Text Transfer Language).
  * 
+ * @note The melody is compiled to an internal buffer (up to BUZZER_RTTTL_MAX_NOTES notes)
+ * and played in background, it replaces whatever was playing.
+ * 
  * @param rtttl_melody String containing text with a RTTTL melody.
  */
 void BuzzerPlayRtttl(const char * rtttl_melody);
 
+/**
+ * @brief Compiles a RTTTL melody to an array of notes.
+ * 
+ * @note Default duration (d=) must be 1 to 32, octaves are limited to 4 to 7.
+ * 
+ * @param rtttl_melody String containing text with a RTTTL melody.
+ * @param notes Array where notes are stored.
+ * @param max_notes Size of notes array.
+ * @return int16_t Number of notes stored, -1 if the melody is malformed or does not fit.
+ */
+int16_t BuzzerRtttlCompile(const char * rtttl_melody, buzzer_note_t *notes, uint16_t max_notes);
+
+/**
+ * @brief Plays a melody, replacing whatever was playing and clearing the queue.
+ * 
+ * @param notes Array of notes.
+ * @param qty Number of notes.
+ * @param loop true: start again at the end (until BuzzerStop(), BuzzerPlay() or a queued melody).
+ * @return true if the melody started.
+ */
+bool BuzzerPlay(const buzzer_note_t *notes, uint16_t qty, bool loop);
+
+/**
+ * @brief Plays a melody after the current one (and the ones already queued).
+ * 
+ * @param notes Array of notes.
+ * @param qty Number of notes.
+ * @return false if the queue is full.
+ */
+bool BuzzerQueue(const buzzer_note_t *notes, uint16_t qty);
+
+/**
+ * @brief Stops the current melody and clears the queue.
+ */
+void BuzzerStop(void);
+
+/**
+ * @brief Check if a melody is playing.
+ * 
+ * @return true while a melody (or the queue) is being played.
+ */
+bool BuzzerIsPlaying(void);
+
 /**
  * @brief Buzzer de-initialization.
  */
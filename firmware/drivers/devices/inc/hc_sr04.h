@@ -14,6 +14,13 @@
  * 
  * @note When disconnected return 0.
  * 
+ * The echo pulse is measured with edge interruptions timestamped with the 
+ * CPU cycle counter, so the calling task sleeps while the echo is in flight.
+ * Up to HC_SR04_MAX_SENSORS modules can be registered. A ranging task fires 
+ * them one at a time, leaving a guard time after every echo so a sensor 
+ * never hears the burst of another one (cross-talk). Results are delivered
+ * through a callback and/or a result queue.
+ * 
  * @note When ussing dedicated connector in ESP-EDU:
  * |   HC_SR04      |   EDU-CIAA	|
  * |:--------------:|:-------------:|
@@ -29,6 +36,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/10/2023 | Document creation		                         						|
+ * | 19/10/2026 | Interrupt based echo capture, async API and several sensors			|
  * 
  **/
 
@@ -37,21 +45,98 @@
 #include <stdint.h>
 #include "gpio_mcu.h"
 /*==================[macros]=================================================*/
-
+#define HC_SR04_MAX_SENSORS		4	/*!< Maximun number of sensors */
+#define HC_SR04_GUARD_MS		20	/*!< Default quiet time between shots of different sensors */
 /*==================[typedef]================================================*/
+/**
+ * @brief Result of one measurement
+ */
+typedef struct {
+	uint8_t sensor;			/*!< Sensor index (as returned by HcSr04AddSensor) */
+	bool valid;				/*!< false when no echo was received (sensor disconnected) */
+	bool out_of_range;		/*!< true when the echo was longer than the maximun distance */
+	uint32_t echo_us;		/*!< Echo pulse width in us */
+	uint32_t distance_um;	/*!< Measured distance in micrometers */
+	int64_t timestamp;		/*!< Trigger instant (us since boot) */
+} hc_sr04_result_t;
 
+/**
+ * @brief Ranging task configuration
+ */
+typedef struct {
+	uint16_t period_ms;		/*!< Period to range the whole set of sensors (0: only on HcSr04Trigger()) */
+	uint16_t guard_ms;		/*!< Quiet time after each shot (0: HC_SR04_GUARD_MS) */
+	void *func_p;			/*!< Pointer to callback function void f(hc_sr04_result_t *result, void *param) (NULL: none) */
+	void *param_p;			/*!< Pointer to callback function parameters */
+} hc_sr04_config_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
 /**
  * @brief HC_SR04 initialization.
  * 
+ * Registers the module as sensor 0, used by the blocking read functions.
+ * 
  * @param echo GPIO number wher echo pin is connected
  * @param trigger GPIO number wher trigger pin is connected
  * @return true 
  */
 bool HcSr04Init(gpio_t echo, gpio_t trigger);
 
+/**
+ * @brief Register an additional sensor.
+ * 
+ * @param echo GPIO number wher echo pin is connected
+ * @param trigger GPIO number wher trigger pin is connected
+ * @return int8_t sensor index, -1 if there is no room for it
+ */
+int8_t HcSr04AddSensor(gpio_t echo, gpio_t trigger);
+
+/**
+ * @brief Start the ranging task.
+ * 
+ * With period_ms != 0 the registered sensors are fired round-robin, spreading
+ * the shots evenly along the period (never closer than the echo time plus 
+ * the guard time).
+ * 
+ * @param config pointer to ranging configuration
+ */
+void HcSr04Start(hc_sr04_config_t *config);
+
+/**
+ * @brief Stop the periodic scan (requests made with HcSr04Trigger() are still served).
+ */
+void HcSr04Stop(void);
+
+/**
+ * @brief Request one measurement of a sensor without blocking.
+ * 
+ * The result is delivered by the ranging task (HcSr04Start() must have been called).
+ * 
+ * @param sensor sensor index
+ * @return true if the request was queued
+ */
+bool HcSr04Trigger(uint8_t sensor);
+
+/**
+ * @brief Get the oldest pending result.
+ * 
+ * When the result queue is full the oldest result is discarded.
+ * 
+ * @param result pointer where the result is copied
+ * @param timeout_ms maximun time to wait for a result
+ * @return true if a result was copied
+ */
+bool HcSr04GetResult(hc_sr04_result_t *result, uint32_t timeout_ms);
+
+/**
+ * @brief Measure a sensor, blocking the calling task (not the CPU) until the echo ends.
+ * 
+ * @param sensor sensor index
+ * @param result pointer where the result is stored
+ */
+void HcSr04Measure(uint8_t sensor, hc_sr04_result_t *result);
+
 /**
  * @brief Read distance
  * 
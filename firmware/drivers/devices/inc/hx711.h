@@ -10,6 +10,13 @@
 /** \brief The HX711 amplifier is a breakout board that allows you to easily read load cells to measure weight. It communicates with the EDU-ESP
  * board via I2C.
  * 
+ * Besides the blocking reads, the driver can acquire continuously: a falling
+ * edge on DOUT (conversion ready) wakes a high priority task that clocks the 
+ * sample out with cycle counted timing. Samples are pushed to a lock-free ring 
+ * buffer and run through an outlier rejection, median and moving average 
+ * filter chain. Filtered, tared values can then be read at any time without 
+ * blocking. Continuous samples are signed 24 bit counts.
+ * 
  * @author Juan Ignacio Cerrudo
  *
  * @section changelog
@@ -17,14 +24,37 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 30/01/2024 | Document creation		                         						|
+ * | 19/10/2026 | Interrupt driven continuous acquisition, ring buffer and filters		|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include <gpio_mcu.h>
 /*==================[macros]=================================================*/
-
+#define HX711_RING_LEN		64		/*!< Raw samples ring buffer length (power of 2) */
+#define HX711_MEDIAN_MAX	5		/*!< Maximun median filter length */
+#define HX711_AVERAGE_MAX	32		/*!< Maximun moving average length */
 /*==================[typedef]================================================*/
+/**
+ * @brief Continuous acquisition filter configuration
+ */
+typedef struct {
+	uint8_t median;				/*!< Median filter length: 1 (off), 3 or 5 */
+	uint8_t average;			/*!< Moving average length: 1 (off) to HX711_AVERAGE_MAX */
+	uint32_t outlier_th;		/*!< Samples farther than this (counts) from the average are rejected (0: off) */
+	uint8_t outlier_max;		/*!< Consecutive outliers accepted as a real step change */
+	void *func_p;				/*!< Pointer to function called from the acquisition task on each sample void f(int32_t filtered, void *param) (NULL: none) */
+	void *param_p;				/*!< Pointer to callback function parameters */
+} hx711_filter_config_t;
+
+/**
+ * @brief Continuous acquisition counters
+ */
+typedef struct {
+	uint32_t samples;			/*!< Samples acquired */
+	uint32_t outliers;			/*!< Samples rejected as outliers */
+	uint32_t overruns;			/*!< Raw samples lost because the ring was full */
+} hx711_stats_t;
 
 /*==================[external data declaration]==============================*/
 
@@ -120,6 +150,55 @@ void HX711_powerDown(void);
  */
 void HX711_powerUp(void);
 
+/** @fn HX711_startContinuous(hx711_filter_config_t *config)
+ * @brief Starts interrupt driven continuous acquisition
+ * @note Blocking reads must not be used while continuous acquisition is running
+ * @param[in] config Filter configuration
+ */
+void HX711_startContinuous(hx711_filter_config_t *config);
+
+/** @fn HX711_stopContinuous(void)
+ * @brief Stops continuous acquisition
+ */
+void HX711_stopContinuous(void);
+
+/** @fn HX711_readRaw(int32_t *raw)
+ * @brief Pops the oldest unfiltered sample from the ring buffer, without blocking
+ * @param[out] raw Sample in counts
+ * @return true if a sample was available
+ */
+bool HX711_readRaw(int32_t *raw);
+
+/** @fn HX711_getFiltered(void)
+ * @brief Returns the latest filtered sample minus the tare, without blocking
+ * @return Filtered value in counts
+ */
+int32_t HX711_getFiltered(void);
+
+/** @fn HX711_getFilteredUnits(void)
+ * @brief Returns HX711_getFiltered() divided by SCALE
+ * @return Filtered value in units
+ */
+float HX711_getFilteredUnits(void);
+
+/** @fn HX711_tareContinuous(uint8_t times)
+ * @brief Starts a tare over the next filtered samples; returns immediately
+ * @param[in] times How many filtered samples to average
+ */
+void HX711_tareContinuous(uint8_t times);
+
+/** @fn HX711_tareDone(void)
+ * @brief Check if the tare started with HX711_tareContinuous() is complete
+ * @return true when done
+ */
+bool HX711_tareDone(void);
+
+/** @fn HX711_getStats(hx711_stats_t *stats)
+ * @brief Get continuous acquisition counters
+ * @param[out] stats Counters
+ */
+void HX711_getStats(hx711_stats_t *stats);
+
 /*==================[internal functions declaration]=========================*/
 // Sends/receives data. 
 uint8_t shiftIn(void);
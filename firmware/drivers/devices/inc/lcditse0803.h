@@ -23,6 +23,10 @@
  * | 	SEL3	 	| 	GPIO_9		|
  * | 	Gnd 	    | 	GND     	|
  * 
+ * @note Writes are skipped when the value is the one already shown. With LcdItsE0803StartRefresh()
+ * the display is updated in background from the timer service ISR: LcdItsE0803Write() and
+ * LcdItsE0803Off() only store the value, and the latest one is shown on the next refresh.
+ * 
  * @author Albano Peñalva
  *
  * @section changelog
@@ -30,6 +34,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/10/2023 | Document creation		                         						|
+ * | 19/10/2026 | Digit mask table, change cache and background refresh					|
  * 
  **/
 
@@ -79,6 +84,18 @@ uint16_t LcdItsE0803Read(void);
  */
 void LcdItsE0803Off(void);
 
+/**
+ * @brief Start updating the display in background.
+ * 
+ * @param period_ms Refresh period in ms (latency between a write and the display).
+ * @return true if started
+ */
+bool LcdItsE0803StartRefresh(uint16_t period_ms);
+/**
+ * @brief Stop background refresh, the last value written is shown and writes are direct again.
+ * 
+ */
+void LcdItsE0803StopRefresh(void);
 /**
  * @brief ESP-EDU LCD Module initialization.
  * 
@@ -10,6 +10,13 @@
 /** \brief MPU6050 sensor module is a 6-axis Motion Tracking Device. It combines 3-axis Accelerometer and 3-axis Gyroscope. It communicates with the EDU-ESP
  * board via I2C.
  * 
+ * Streaming mode: MPU6050_streamStart() sets the sample rate divider and DLPF,
+ * enables accel + gyro into the FIFO and the data ready interrupt on the INT
+ * pin. Every `watermark` samples a task burst-reads the FIFO, unpacks the 
+ * frames into a ring buffer of mpu6050_sample_t and stamps them with times 
+ * reconstructed from the output data rate. FIFO overflows are detected and 
+ * the FIFO is reset.
+ * 
  * @author Juan Ignacio Cerrudo
  *
  * @section changelog
@@ -17,6 +24,8 @@
  * |   Date	| Description                                    			|
  * |:----------:|:----------------------------------------------------------------------|
  * | 30/01/2024 | Document creation		                         		|
+ * | 19/10/2026 | FIFO burst streaming with data ready interrupt		|
+ * | 19/10/2026 | Configuration registers shadowed in the I2C layer		|
  * 
  **/
 
@@ -409,7 +418,41 @@
 #define MPU6050_DMP_MEMORY_CHUNK_SIZE   16
 // note: DMP code memory blocks defined at end of header file
 
+#define MPU6050_STREAM_RING_LEN     128     /*!< Samples stored by the streaming mode (power of 2) */
+#define MPU6050_STREAM_WATERMARK_MAX 20     /*!< Max streaming watermark: those samples and one more fit in a burst read */
+
 /*==================[typedef]================================================*/
+/** Streamed sample (raw register values)
+ */
+typedef struct {
+    int16_t ax;             /*!< Accelerometer X */
+    int16_t ay;             /*!< Accelerometer Y */
+    int16_t az;             /*!< Accelerometer Z */
+    int16_t gx;             /*!< Gyroscope X */
+    int16_t gy;             /*!< Gyroscope Y */
+    int16_t gz;             /*!< Gyroscope Z */
+    int64_t timestamp;      /*!< Sampling instant (us since boot) */
+} mpu6050_sample_t;
+
+/** Streaming configuration
+ */
+typedef struct {
+    uint16_t rate_hz;       /*!< Output data rate in Hz (up to 1000) */
+    uint8_t dlpf;           /*!< Digital low pass filter, MPU6050_DLPF_BW_xxx */
+    gpio_t int_pin;         /*!< GPIO where the INT pin is connected */
+    uint8_t watermark;      /*!< Samples accumulated in the FIFO before each burst read (1 to MPU6050_STREAM_WATERMARK_MAX) */
+    void *func_p;           /*!< Pointer to function called after each burst void f(void *param) (NULL: none) */
+    void *param_p;          /*!< Pointer to callback function parameters */
+} mpu6050_stream_config_t;
+
+/** Streaming counters
+ */
+typedef struct {
+    uint32_t samples;       /*!< Samples read from the FIFO */
+    uint32_t bursts;        /*!< Burst reads */
+    uint32_t fifo_overflows;/*!< FIFO overflows (FIFO was reset, samples lost) */
+    uint32_t ring_overruns; /*!< Samples lost because the ring was full */
+} mpu6050_stream_stats_t;
 
 /*==================[external data declaration]==============================*/
 
@@ -2669,6 +2712,35 @@ uint8_t MPU6050_getDeviceID();
  */
 void MPU6050_setDeviceID(uint8_t id);
 
+/** Start FIFO streaming.
+ * The rate is rounded to the ones the sample rate divider can give (base rate
+ * of 8kHz with the DLPF disabled, 1kHz otherwise, divided by 1 to 256): slower
+ * rates run at base / 256. The rate applied is kept in the streaming state.
+ * @param config Streaming configuration
+ * @return true if the configuration was accepted
+ */
+bool MPU6050_streamStart(mpu6050_stream_config_t *config);
+
+/** Stop FIFO streaming (disables the data ready interrupt and the FIFO).
+ */
+void MPU6050_streamStop(void);
+
+/** Get the oldest streamed sample, without blocking.
+ * @param sample Container for the sample
+ * @return true if a sample was available
+ */
+bool MPU6050_streamRead(mpu6050_sample_t *sample);
+
+/** Number of streamed samples waiting in the ring.
+ * @return Samples available
+ */
+uint16_t MPU6050_streamAvailable(void);
+
+/** Get streaming counters.
+ * @param stats Container for the counters
+ */
+void MPU6050_streamStats(mpu6050_stream_stats_t *stats);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
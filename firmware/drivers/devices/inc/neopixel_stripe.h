@@ -14,6 +14,13 @@
  * 
  * @note ESP-EDU have one individual NeoPixel connected to GPIO_8, that can be used with this driver.
  * 
+ * @note Frames are transmitted by the RMT peripheral, so every function returns
+ * without waiting for the stripe to be updated.
+ * 
+ * @note Setters only modify the color array and mark the frame as dirty. A render
+ * task sends at most one frame every 1/fps seconds (see NeoPixelFrameRate()), so
+ * several setter calls between two frames cost a single transmission.
+ * 
  * @author Albano Peñalva
  *
  * @section changelog
@@ -21,6 +28,8 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/10/2023 | Document creation		                         						|
+ * | 19/10/2026 | Non-blocking frames using RMT backend	                         		|
+ * | 19/10/2026 | Render task, gamma/brightness LUT and effects	                 		|
  * 
  **/
 
@@ -33,6 +42,8 @@
 #define BUILT_IN_RGB_LED_PIN          GPIO_8        /*> ESP32-C6-DevKitC-1 NeoPixel it's connected at GPIO_8 */
 #define BUILT_IN_RGB_LED_LENGTH       1             /*> ESP32-C6-DevKitC-1 NeoPixel has one pixel */
 
+#define NEOPIXEL_DEFAULT_FPS          50            /*> Default render task frame rate */
+
 #define NEOPIXEL_COLOR_WHITE          0x00FFFFFF  /*> Color white */
 #define NEOPIXEL_COLOR_RED            0x00FF0000  /*> Color red */
 #define NEOPIXEL_COLOR_ORANGE         0x00FF7D00  /*> Color orange */
@@ -82,6 +93,15 @@ typedef uint32_t neopixel_color_t;
  */
 void NeoPixelInit(gpio_t pin, uint16_t len, neopixel_color_t *color_array);
 
+/**
+ * @brief Change the render task frame rate.
+ * 
+ * @note The real frame rate is limited by the FreeRTOS tick rate. Effects
+ * speed is kept regardless of the frame rate.
+ * @param fps Frames per second (0: NEOPIXEL_DEFAULT_FPS)
+ */
+void NeoPixelFrameRate(uint8_t fps);
+
 /**
  * @brief Turn off all NeoPixels.
  * 
@@ -157,6 +177,43 @@ neopixel_color_t NeoPixelHSV2Color(uint16_t hue, uint8_t sat, uint8_t val);
  */
 void NeoPixelRainbow(uint16_t first_hue, uint8_t sat, uint8_t val, uint8_t reps);
 
+/**
+ * @brief Start a rotating rainbow effect (see NeoPixelRainbow()).
+ * 
+ * @note Any color setter stops the running effect, NeoPixelBrightness() does not.
+ * @param sat Color saturation of all the NeoPixels (HSV color model)
+ * @param val Color value or brightness of all the NeoPixels (HSV color model)
+ * @param reps number of repeticion of the color pattern
+ * @param cycle_ms Time to rotate the whole color wheel, in ms
+ */
+void NeoPixelEffectRainbow(uint8_t sat, uint8_t val, uint8_t reps, uint16_t cycle_ms);
+
+/**
+ * @brief Start a fade of every NeoPixel from its current color to a target color.
+ * 
+ * @note Each channel changes linearly. The effect stops once the target
+ * color is reached.
+ * @param color 24 bits target color
+ * @param duration_ms Fade duration, in ms
+ */
+void NeoPixelEffectFade(neopixel_color_t color, uint16_t duration_ms);
+
+/**
+ * @brief Start a chase effect: one NeoPixel running along the stripe followed
+ * by a fading tail.
+ * 
+ * @param color 24 bits color of the head
+ * @param tail Number of NeoPixels in the tail
+ * @param speed Head speed, in NeoPixels per second
+ */
+void NeoPixelEffectChase(neopixel_color_t color, uint8_t tail, uint16_t speed);
+
+/**
+ * @brief Stop the running effect, keeping the last frame.
+ * 
+ */
+void NeoPixelEffectStop(void);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -18,6 +18,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/01/2024 | Document creation		                         						|
+ * | 19/10/2026 | Q16 duty cycle, one degree resolution          						|
  * 
  **/
 
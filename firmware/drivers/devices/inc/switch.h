@@ -12,6 +12,11 @@
  * @note ESP-EDU have 2 switches connected to GPIO_4 and GPIO_15. 
  * The latter is also routed to J2 connector.
  *
+ * @note SwitchServiceInit() starts the switch service: edge interrupts only timestamp and
+ * enqueue, and a task runs the debouncing state machine of each switch (see "switch_fsm.h").
+ * Tasks get press, release, click, double click and long press events with SwitchWaitEvent(),
+ * or through a callback. Do not use SwitchActivInt() on a switch handled by the service.
+ *
  * @author Albano Peñalva
  *
  * @section changelog
@@ -19,19 +24,45 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/10/2023 | Document creation		                         						|
+ * | 19/10/2026 | Switch service with debouncing and gesture events						|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include <stdbool.h>
 #include <stdint.h>
+#include "switch_fsm.h"
 /*==================[macros]=================================================*/
+#define SWITCH_DEBOUNCE_MS		20		/*!< Default debounce time */
+#define SWITCH_DOUBLE_CLICK_MS	250		/*!< Default max time between clicks of a double click */
+#define SWITCH_LONG_PRESS_MS	800		/*!< Default long press duration */
+#define SWITCH_EVENT_QUEUE_LEN	16		/*!< Events kept for SwitchWaitEvent(), the oldest are dropped */
 
 /*==================[typedef]================================================*/
 typedef enum switches {
     SWITCH_1 = (1 << 0),  /**< Routed to GPIO_4 */
     SWITCH_2 = (1 << 1),  /**< Routed to GPIO_15 */
 } switch_t;
+
+/**
+ * @brief Switch event
+ */
+typedef struct {
+	switch_t sw;				/*!< Switch */
+	switch_event_type_t type;	/*!< Event */
+	uint32_t time_ms;			/*!< Time of the event (ms since boot, see "switch_fsm.h") */
+} switch_event_t;
+
+/**
+ * @brief Switch service configuration
+ */
+typedef struct {
+	uint16_t debounce_ms;		/*!< Time the level must be stable */
+	uint16_t double_click_ms;	/*!< Max time from a release to the second press (0: no double click, clicks are not delayed) */
+	uint16_t long_press_ms;		/*!< Press duration of a long press (0: no long press) */
+	void *func_p;				/*!< Pointer to function called for each event from the service task: void f(switch_event_t *event, void *param) (can be NULL) */
+	void *param_p;				/*!< Pointer to callback function parameter */
+} switch_service_config_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -58,6 +89,25 @@ int8_t SwitchesRead(void);
  */
 void SwitchActivInt(switch_t tec, void *ptrIntFunc, void *args);
 
+/**
+ * @brief Starts the switch service for both switches
+ * 
+ * @note Call SwitchesInit() first.
+ * 
+ * @param config Pointer to service configuration (NULL: default timing, no callback)
+ * @return int8_t 0 if ok
+ */
+int8_t SwitchServiceInit(switch_service_config_t *config);
+
+/**
+ * @brief Waits for the next switch event
+ * 
+ * @param event Pointer to struct where the event is stored
+ * @param timeout_ms Max time to wait (portMAX_DELAY: forever)
+ * @return true if an event was received
+ */
+bool SwitchWaitEvent(switch_event_t *event, uint32_t timeout_ms);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -0,0 +1,122 @@
+#ifndef SWITCH_FSM_H
+#define SWITCH_FSM_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Devices Drivers devices
+ ** @{ */
+/** \addtogroup Switch_FSM Switch_FSM
+ ** @{ */
+
+/** \brief Debouncing and gesture state machine of a switch: core of the switch service (see "switch.h").
+ *
+ * Raw edges are fed with SwitchFsmEdge(). SwitchFsmUpdate() accepts a new level once it has
+ * been stable for debounce_ms, and turns the debounced presses and releases into events:
+ * - SWITCH_EVENT_PRESS and SWITCH_EVENT_RELEASE on every debounced change.
+ * - SWITCH_EVENT_CLICK: short press not followed by another press within double_click_ms.
+ * - SWITCH_EVENT_DOUBLE_CLICK: second short press within double_click_ms (no click is emitted).
+ * - SWITCH_EVENT_LONG_PRESS: press held for long_press_ms (no click is emitted on release).
+ *
+ * Press and release times are the time of the first edge of the bounce burst. Clicks carry
+ * the time of their (last) release, and long presses the time the threshold was reached.
+ *
+ * @note Hardware independent: time is given by the caller in ms (wrapping), so it can be
+ * driven by edge interrupts or by synthetic edge traces on a host. Not thread safe:
+ * callers must serialize access.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 19/10/2026 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define SWITCH_FSM_NO_DEADLINE	UINT32_MAX	/*!< SwitchFsmUpdate(): nothing to wait for */
+/*==================[typedef]================================================*/
+/**
+ * @brief Switch events
+ */
+typedef enum switch_event_type {
+	SWITCH_EVENT_PRESS,			/*!< Debounced press */
+	SWITCH_EVENT_RELEASE,		/*!< Debounced release */
+	SWITCH_EVENT_CLICK,			/*!< Single short press */
+	SWITCH_EVENT_DOUBLE_CLICK,	/*!< Two short presses */
+	SWITCH_EVENT_LONG_PRESS,	/*!< Press held for long_press_ms */
+} switch_event_type_t;
+
+/**
+ * @brief Switch state machine timing
+ */
+typedef struct {
+	uint16_t debounce_ms;		/*!< Time the level must be stable */
+	uint16_t double_click_ms;	/*!< Max time from a release to the second press (0: no double click) */
+	uint16_t long_press_ms;		/*!< Press duration of a long press (0: no long press) */
+} switch_fsm_config_t;
+
+/**
+ * @brief Switch state machine (fields are private)
+ */
+typedef struct {
+	switch_fsm_config_t config;	/*!<  */
+	uint8_t state;				/*!< Gesture state */
+	bool level;					/*!< Debounced level (true: pressed) */
+	bool raw_level;				/*!< Level of the last edge */
+	bool bouncing;				/*!< Edges seen since the level was last accepted */
+	uint32_t edge_time;			/*!< First edge of the burst */
+	uint32_t raw_time;			/*!< Last edge */
+	uint32_t press_time;		/*!< Last debounced press */
+	uint32_t release_time;		/*!< Last debounced release */
+} switch_fsm_t;
+
+/**
+ * @brief Prototype of the function called for each event
+ *
+ * @param type Event
+ * @param time_ms Time of the event
+ * @param param Pointer given to SwitchFsmUpdate()
+ */
+typedef void (*switch_fsm_emit_t)(switch_event_type_t type, uint32_t time_ms, void *param);
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Initialize a state machine
+ *
+ * @param fsm State machine
+ * @param config Timing
+ * @param pressed Current level of the switch
+ */
+void SwitchFsmInit(switch_fsm_t *fsm, const switch_fsm_config_t *config, bool pressed);
+
+/**
+ * @brief Feed a raw edge
+ *
+ * @param fsm State machine
+ * @param pressed Level after the edge
+ * @param time_ms Time of the edge
+ */
+void SwitchFsmEdge(switch_fsm_t *fsm, bool pressed, uint32_t time_ms);
+
+/**
+ * @brief Run the state machine up to a given time
+ *
+ * @param fsm State machine
+ * @param time_ms Current time (not earlier than the last edge)
+ * @param emit Function called for each event (in order)
+ * @param param Pointer passed to emit
+ * @return uint32_t ms until the next timeout, SWITCH_FSM_NO_DEADLINE if only an edge can change the state
+ */
+uint32_t SwitchFsmUpdate(switch_fsm_t *fsm, uint32_t time_ms, switch_fsm_emit_t emit, void *param);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
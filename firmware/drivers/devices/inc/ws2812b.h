@@ -11,6 +11,10 @@
 /** \brief Driver for handling WS2812B RGB leds.
  *
  * @note For handling NeoPixels arrays use "neopixel_stripe.h".
+ *
+ * @note Two backends are available: ws2812bInit()/ws2812bSend() bit-bang each LED
+ * with the CPU (blocking), while ws2812bFrameInit()/ws2812bFrameSend() encode
+ * a whole frame with the RMT peripheral and return immediately.
  * 
  * @author Albano Peñalva
  *
@@ -19,6 +23,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/10/2023 | Document creation		                         						|
+ * | 19/10/2026 | RMT frame backend with completion callback							|
  * 
  **/
 
@@ -40,6 +45,13 @@ typedef struct rgb_led{
 	 uint8_t blue;  		// Blue
 } rgb_led_t;
 
+/**
+ * @brief Prototype of the callback called (from ISR) when a frame has been sent
+ * 
+ * @param param Pointer to callback function parameter
+ */
+typedef void (*ws2812b_done_t)(void *param);
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -63,6 +75,50 @@ void ws2812bSend(rgb_led_t led_color);
  */
 void ws2812bSendRet(void);
 
+/**
+ * @brief Gamma correction of a single color component.
+ * 
+ * @param component Linear color level (0 to 255)
+ * @return uint8_t Corrected color level
+ */
+uint8_t ws2812bGammaCorrection(uint8_t component);
+
+/**
+ * @brief NeoPixel initialization using the RMT peripheral (frame backend).
+ * 
+ * @note Two frame buffers are allocated, so a new frame can be filled while the
+ * previous one is being transmitted.
+ * 
+ * @param pin GPIO number where NeoPixel data pin (DIN) will be connected
+ * @param len Number of NeoPixels in the stripe
+ */
+void ws2812bFrameInit(gpio_t pin, uint16_t len);
+
+/**
+ * @brief Get the frame buffer to be filled before calling ws2812bFrameSend().
+ * 
+ * @note Blocks only if both frame buffers are still being transmitted.
+ * 
+ * @return uint8_t* Array of (len * 3) bytes, in G, R, B order (no gamma correction is applied)
+ */
+uint8_t * ws2812bFrameBuffer(void);
+
+/**
+ * @brief Start the transmission of the frame buffer and return immediately.
+ * 
+ * @note The ret command is appended by the encoder.
+ * 
+ * @param func_p Callback called (from ISR) when the frame has been sent (NULL if not required)
+ * @param param_p Pointer to callback function parameter
+ */
+void ws2812bFrameSend(ws2812b_done_t func_p, void *param_p);
+
+/**
+ * @brief Wait until all the frames queued have been sent.
+ * 
+ */
+void ws2812bFrameWait(void);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -0,0 +1,101 @@
+#ifndef WS2812B_PARALLEL_H
+#define WS2812B_PARALLEL_H
+
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Devices Drivers devices
+ ** @{ */
+/** \addtogroup WS2812B_Parallel WS2812B_Parallel
+ ** @{ */
+
+/** \brief Driver for handling up to 8 WS2812B stripes at the same time.
+ *
+ * Each stripe (lane) has its own GRB frame buffer. On ws2812bParallelSend()
+ * frames are bit-transposed (one byte per bit slot, bit n for lane n) and clocked
+ * out together on a dedicated GPIO bundle (see "gpio_fast_out_mcu.h"), so the
+ * frame time for N stripes is the same as for one.
+ *
+ * @note All the stripes must have the same number of LEDs (shorter stripes can
+ * simply ignore the extra data).
+ * 
+ * @note Bits are timed with the CPU cycle counter inside a critical section:
+ * interrupts are disabled for 30us per LED while sending (e.g. 3ms for 100 LEDs).
+ * 
+ * @note The dedicated GPIO bundle is shared with ws2812bInit(), only one of them
+ * can be used at a time.
+ * 
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 19/10/2026 | Document creation		                         						|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include "gpio_mcu.h"
+/*==================[macros]=================================================*/
+#define WS2812B_MAX_LANES   8   /*!< Max number of stripes driven at the same time */
+
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Parallel WS2812B initialization.
+ * 
+ * @param pin_list  Array of GPIOs, one for each stripe DIN
+ * @param lane_qty  Number of stripes (up to WS2812B_MAX_LANES)
+ * @param len       Number of LEDs in each stripe
+ */
+void ws2812bParallelInit(gpio_t *pin_list, uint8_t lane_qty, uint16_t len);
+
+/**
+ * @brief Get the frame buffer of one stripe.
+ * 
+ * @param lane Stripe number (position in pin_list)
+ * @return uint8_t* Buffer of 3 * len bytes, in G, R, B order for each LED
+ */
+uint8_t * ws2812bParallelBuffer(uint8_t lane);
+
+/**
+ * @brief Set the color of one LED in the frame buffer of one stripe (gamma corrected).
+ * 
+ * @param lane  Stripe number (position in pin_list)
+ * @param led   LED number in the stripe
+ * @param red   Red level
+ * @param green Green level
+ * @param blue  Blue level
+ */
+void ws2812bParallelSetLed(uint8_t lane, uint16_t led, uint8_t red, uint8_t green, uint8_t blue);
+
+/**
+ * @brief Send the frame buffers of all the stripes (blocking).
+ * 
+ */
+void ws2812bParallelSend(void);
+
+/**
+ * @brief Bit-transpose lane frames into bit slots.
+ * 
+ * Output byte (8 * k + b) holds bit (7 - b) of byte k of every lane: bit n
+ * corresponds to lanes[n]. Missing lanes (lane_qty < 8) are sent as 0.
+ * 
+ * @note Pure function, it doesn't access any hardware.
+ * @param lanes     Array of lane_qty pointers to the frame of each lane
+ * @param lane_qty  Number of lanes (up to WS2812B_MAX_LANES)
+ * @param len       Bytes in each lane frame
+ * @param slots     Output buffer of 8 * len bytes
+ */
+void ws2812bParallelTranspose(const uint8_t *const *lanes, uint8_t lane_qty, uint16_t len, uint8_t *slots);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
@@ -11,39 +11,106 @@
 
 /*==================[inclusions]=============================================*/
 #include "buzzer.h"
-#include "delay_mcu.h"
 #include "pwm_mcu.h"
+#include "timer_mcu.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 /*==================[macros and definitions]=================================*/
 #define PWM_BUZZER      PWM_3
 #define PWM_DC          50
-#define OCTAVE_OFFSET   0
 /*==================[internal data declaration]==============================*/
-
+/**
+ * @brief Melody waiting in the queue
+ */
+typedef struct {
+    const buzzer_note_t *notes;
+    uint16_t qty;
+} melody_t;
 /*==================[internal functions declaration]=========================*/
-
+static void BuzzerNextNote(void);
+static void BuzzerSeqTimer(void *param);
 /*==================[internal data definition]===============================*/
-uint16_t notes[] = {
-    0,
-    NOTE_C4, NOTE_CS4, NOTE_D4, NOTE_DS4, NOTE_E4, NOTE_F4, NOTE_FS4, NOTE_G4, NOTE_GS4, NOTE_A4, NOTE_AS4, NOTE_B4,
-    NOTE_C5, NOTE_CS5, NOTE_D5, NOTE_DS5, NOTE_E5, NOTE_F5, NOTE_FS5, NOTE_G5, NOTE_GS5, NOTE_A5, NOTE_AS5, NOTE_B5,
-    NOTE_C6, NOTE_CS6, NOTE_D6, NOTE_DS6, NOTE_E6, NOTE_F6, NOTE_FS6, NOTE_G6, NOTE_GS6, NOTE_A6, NOTE_AS6, NOTE_B6,
-    NOTE_C7, NOTE_CS7, NOTE_D7, NOTE_DS7, NOTE_E7, NOTE_F7, NOTE_FS7, NOTE_G7, NOTE_GS7, NOTE_A7, NOTE_AS7, NOTE_B7
-};
+static soft_timer_t seq_timer;                              /*!< One-shot, re-armed with the duration of each note */
+static SemaphoreHandle_t seq_mutex = NULL;                  /*!< Sequencer state, taken by the API and the timer callback */
+static const buzzer_note_t *seq_notes = NULL;               /*!< Melody playing */
+static uint16_t seq_qty = 0;                                /*!<  */
+static uint16_t seq_pos = 0;                                /*!< Next note to play */
+static bool seq_loop = false;                               /*!<  */
+static bool seq_playing = false;                            /*!<  */
+static melody_t seq_queue[BUZZER_QUEUE_LEN];                /*!<  */
+static uint8_t queue_head = 0, queue_count = 0;             /*!<  */
+static buzzer_note_t rtttl_notes[BUZZER_RTTTL_MAX_NOTES];   /*!< Melody compiled by BuzzerPlayRtttl() */
+static buzzer_note_t tone_note;                             /*!< Note played by BuzzerPlayTone() */
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
-bool isDigit(char c){
-    if((c >= '0') && (c <= '9')){
-        return true;
-    }else{
-        return false;
+/**
+ * @brief Starts the next note of the sequence (seq_mutex must be taken)
+ */
+static void BuzzerNextNote(void){
+    const buzzer_note_t *note = NULL;
+    uint16_t skipped = 0;
+    while(note == NULL){
+        if(seq_pos >= seq_qty){
+            if(queue_count){
+                seq_notes = seq_queue[queue_head].notes;
+                seq_qty = seq_queue[queue_head].qty;
+                queue_head = (queue_head + 1) % BUZZER_QUEUE_LEN;
+                queue_count--;
+                seq_loop = false;
+            } else if(!seq_loop || (skipped >= seq_qty)){
+                /* end of the melody, or a loop with nothing to play */
+                seq_playing = false;
+                PWMOff(PWM_BUZZER);
+                return;
+            }
+            seq_pos = 0;
+            skipped = 0;
+            continue;
+        }
+        note = &seq_notes[seq_pos++];
+        if(note->duration == 0){
+            note = NULL;
+            skipped++;
+        }
+    }
+    if(note->freq){
+        PWMSetFreq(PWM_BUZZER, note->freq);
+        PWMOn(PWM_BUZZER);
+    } else{
+        PWMOff(PWM_BUZZER);
     }
+    SoftTimerSetPeriod(&seq_timer, (uint32_t)note->duration * 1000);
+    SoftTimerStart(&seq_timer);
+}
+
+/**
+ * @brief End of the current note, called from the timer service task
+ */
+static void BuzzerSeqTimer(void *param){
+    xSemaphoreTake(seq_mutex, portMAX_DELAY);
+    /* Skip stale expirations: stopped, or restarted by BuzzerPlay() before this ran */
+    if(seq_playing && !SoftTimerIsActive(&seq_timer)){
+        BuzzerNextNote();
+    }
+    xSemaphoreGive(seq_mutex);
 }
 /*==================[external functions definition]==========================*/
 void BuzzerInit(gpio_t pin){
     PWMInit(PWM_BUZZER, pin, NOTE_C4);
     PWMSetDutyCycle(PWM_BUZZER, PWM_DC);
     PWMOff(PWM_BUZZER);
+    if(seq_mutex == NULL){
+        seq_mutex = xSemaphoreCreateMutex();
+        soft_timer_config_t seq_cfg = {
+            .period = 1000,
+            .periodic = false,
+            .dispatch = TIMER_DISPATCH_TASK,
+            .func_p = BuzzerSeqTimer,
+            .param_p = NULL,
+        };
+        SoftTimerInit(&seq_timer, &seq_cfg);
+    }
 }
 
 void BuzzerOn(void){
@@ -59,136 +126,80 @@ void BuzzerSetFrec(uint16_t freq){
 }
 
 void BuzzerPlayTone(uint16_t freq, uint16_t duration){
-	PWMSetFreq(PWM_BUZZER, freq);
-	PWMOn(PWM_BUZZER);
-	DelayMs(duration);
-	PWMOff(PWM_BUZZER);
+    BuzzerStop();
+    tone_note.freq = freq;
+    tone_note.duration = duration;
+    BuzzerPlay(&tone_note, 1, false);
 }
 
 void BuzzerPlayRtttl(const char * rtttl_melody){
-    uint8_t default_dur = 4;
-    uint8_t default_oct = 6;
-    int bpm = 63;
-    int num;
-    long wholenote;
-    long duration;
-    uint8_t note;
-    uint8_t scale;
-
-    /* find the start (skip name, etc) */
-    while(*rtttl_melody != ':') rtttl_melody++; // ignore name
-    rtttl_melody++;                             // skip ':'
-
-    /* get default duration */
-    if(*rtttl_melody == 'd'){
-        rtttl_melody++; 
-        rtttl_melody++;     // skip "d="
-        num = 0;
-        while(isDigit(*rtttl_melody)){
-        num = (num * 10) + (*rtttl_melody++ - '0');
-        }
-        if(num > 0) default_dur = num;
-        rtttl_melody++;     // skip comma
+    int16_t qty;
+    /* stop first: rtttl_notes may be playing */
+    BuzzerStop();
+    qty = BuzzerRtttlCompile(rtttl_melody, rtttl_notes, BUZZER_RTTTL_MAX_NOTES);
+    if(qty > 0){
+        BuzzerPlay(rtttl_notes, qty, false);
     }
+}
 
-    /* get default octave */
-    if(*rtttl_melody == 'o'){
-        rtttl_melody++; 
-        rtttl_melody++;     // skip "o="
-        num = *rtttl_melody++ - '0';
-        if(num >= 3 && num <=7) default_oct = num;
-        rtttl_melody++;     // skip comma
+bool BuzzerPlay(const buzzer_note_t *notes_in, uint16_t qty, bool loop){
+    if((seq_mutex == NULL) || (notes_in == NULL) || (qty == 0)){
+        return false;
     }
+    xSemaphoreTake(seq_mutex, portMAX_DELAY);
+    SoftTimerStop(&seq_timer);
+    queue_count = 0;
+    seq_notes = notes_in;
+    seq_qty = qty;
+    seq_pos = 0;
+    seq_loop = loop;
+    seq_playing = true;
+    BuzzerNextNote();
+    xSemaphoreGive(seq_mutex);
+    return true;
+}
 
-    /* get BPM */
-    if(*rtttl_melody == 'b'){
-        rtttl_melody++; 
-        rtttl_melody++;     // skip "b="
-        num = 0;
-        while(isDigit(*rtttl_melody)){
-        num = (num * 10) + (*rtttl_melody++ - '0');
-        }
-        bpm = num;
-        rtttl_melody++;     // skip colon
+bool BuzzerQueue(const buzzer_note_t *notes_in, uint16_t qty){
+    bool ret = true;
+    if((seq_mutex == NULL) || (notes_in == NULL) || (qty == 0)){
+        return false;
     }
+    xSemaphoreTake(seq_mutex, portMAX_DELAY);
+    if(!seq_playing){
+        seq_notes = notes_in;
+        seq_qty = qty;
+        seq_pos = 0;
+        seq_loop = false;
+        seq_playing = true;
+        BuzzerNextNote();
+    } else if(queue_count < BUZZER_QUEUE_LEN){
+        seq_queue[(queue_head + queue_count) % BUZZER_QUEUE_LEN].notes = notes_in;
+        seq_queue[(queue_head + queue_count) % BUZZER_QUEUE_LEN].qty = qty;
+        queue_count++;
+    } else{
+        ret = false;
+    }
+    xSemaphoreGive(seq_mutex);
+    return ret;
+}
 
-    /* BPM usually expresses the number of quarter notes per minute */
-    wholenote = (60 * 1000L / bpm) * 4;  // this is the time for whole note (in milliseconds)
-
-    /* now begin note loop */
-    while(*rtttl_melody){
-        /* first, get note duration, if available */
-        num = 0;
-        while(isDigit(*rtttl_melody)){
-            num = (num * 10) + (*rtttl_melody++ - '0');
-        }
-        if(num){
-            duration = wholenote / num;
-        }else{
-            duration = wholenote / default_dur;  // we will need to check if we are a dotted note after
-        } 
-        /* now get the note */
-        note = 0;
-        switch(*rtttl_melody){
-        case 'c':
-            note = 1;
-            break;
-        case 'd':
-            note = 3;
-            break;
-        case 'e':
-            note = 5;
-            break;
-        case 'f':
-            note = 6;
-            break;
-        case 'g':
-            note = 8;
-            break;
-        case 'a':
-            note = 10;
-            break;
-        case 'b':
-            note = 12;
-            break;
-        case 'p':
-        default:
-            note = 0;
-        }
-        rtttl_melody++;
-        /* now, get optional '#' sharp */
-        if(*rtttl_melody == '#'){
-            note++;
-            rtttl_melody++;
-        }
-        /* now, get optional '.' dotted note */
-        if(*rtttl_melody == '.'){
-            duration += duration/2;
-            rtttl_melody++;
-        }
-        /* now, get scale */
-        if(isDigit(*rtttl_melody)){
-            scale = *rtttl_melody - '0';
-            rtttl_melody++;
-        }else{
-            scale = default_oct;
-        }
-        scale += OCTAVE_OFFSET;
-
-        if(*rtttl_melody == ','){
-            rtttl_melody++; // skip comma for next note (or we may be at the end)
-        }
-        /* now play the note */
-        if(note){
-            BuzzerPlayTone(notes[(scale - 4) * 12 + note], duration);
-        }
-        else{
-            DelayMs(duration);
-        }
+void BuzzerStop(void){
+    if(seq_mutex == NULL){
+        return;
     }
+    xSemaphoreTake(seq_mutex, portMAX_DELAY);
+    SoftTimerStop(&seq_timer);
+    queue_count = 0;
+    seq_playing = false;
+    PWMOff(PWM_BUZZER);
+    xSemaphoreGive(seq_mutex);
+}
+
+bool BuzzerIsPlaying(void){
+    return seq_playing;
 }
 
 void BuzzerDeinit(void){
-    
+    BuzzerStop();
 }
 /*==================[end of file]============================================*/
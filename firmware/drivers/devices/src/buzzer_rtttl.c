@@ -0,0 +1,207 @@
+/**
+ * @file buzzer_rtttl.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief RTTTL compiler of the buzzer driver, hardware independent (see buzzer.h)
+ * @version 0.1
+ * @date 2026-10-19
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "buzzer.h"
+/*==================[macros and definitions]=================================*/
+#define OCTAVE_OFFSET   0
+#define OCTAVE_MIN      4       /*!< First octave of notes[] */
+#define OCTAVE_MAX      7       /*!< Last octave of notes[] */
+#define DURATION_MIN    1       /*!< Whole note */
+#define DURATION_MAX    32      /*!< Thirty-second note */
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+static const uint16_t notes[] = {
+    0,
+    NOTE_C4, NOTE_CS4, NOTE_D4, NOTE_DS4, NOTE_E4, NOTE_F4, NOTE_FS4, NOTE_G4, NOTE_GS4, NOTE_A4, NOTE_AS4, NOTE_B4,
+    NOTE_C5, NOTE_CS5, NOTE_D5, NOTE_DS5, NOTE_E5, NOTE_F5, NOTE_FS5, NOTE_G5, NOTE_GS5, NOTE_A5, NOTE_AS5, NOTE_B5,
+    NOTE_C6, NOTE_CS6, NOTE_D6, NOTE_DS6, NOTE_E6, NOTE_F6, NOTE_FS6, NOTE_G6, NOTE_GS6, NOTE_A6, NOTE_AS6, NOTE_B6,
+    NOTE_C7, NOTE_CS7, NOTE_D7, NOTE_DS7, NOTE_E7, NOTE_F7, NOTE_FS7, NOTE_G7, NOTE_GS7, NOTE_A7, NOTE_AS7, NOTE_B7
+};
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+bool isDigit(char c){
+    if((c >= '0') && (c <= '9')){
+        return true;
+    }else{
+        return false;
+    }
+}
+
+static const char * skipSpaces(const char * p){
+    while(*p == ' '){
+        p++;
+    }
+    return p;
+}
+
+static uint16_t parseNum(const char ** p){
+    uint16_t num = 0;
+    while(isDigit(**p)){
+        num = (num * 10) + (*(*p)++ - '0');
+    }
+    return num;
+}
+
+/*==================[external functions definition]==========================*/
+int16_t BuzzerRtttlCompile(const char * rtttl_melody, buzzer_note_t *notes_out, uint16_t max_notes){
+    uint16_t default_dur = 4;
+    uint8_t default_oct = 6;
+    uint16_t bpm = 63;
+    uint16_t num;
+    uint32_t wholenote;
+    uint32_t duration;
+    uint8_t note;
+    uint8_t scale;
+    uint16_t qty = 0;
+    char c;
+
+    /* find the start (skip name, etc) */
+    while(*rtttl_melody != ':'){
+        if(*rtttl_melody == '\0'){
+            return -1;
+        }
+        rtttl_melody++;                         // ignore name
+    }
+    rtttl_melody++;                             // skip ':'
+
+    /* get defaults, in any order */
+    rtttl_melody = skipSpaces(rtttl_melody);
+    while((*rtttl_melody != ':') && (*rtttl_melody != '\0')){
+        c = *rtttl_melody | 0x20;               // lower case
+        rtttl_melody = skipSpaces(rtttl_melody + 1);
+        if(*rtttl_melody != '='){
+            return -1;
+        }
+        rtttl_melody = skipSpaces(rtttl_melody + 1);
+        num = parseNum(&rtttl_melody);
+        switch(c){
+        case 'd':
+            /* also keeps wholenote / default_dur from dividing by zero */
+            if((num < DURATION_MIN) || (num > DURATION_MAX)){
+                return -1;
+            }
+            default_dur = num;
+            break;
+        case 'o':
+            if(num >= OCTAVE_MIN && num <= OCTAVE_MAX) default_oct = num;
+            break;
+        case 'b':
+            if(num > 0) bpm = num;
+            break;
+        default:
+            return -1;
+        }
+        rtttl_melody = skipSpaces(rtttl_melody);
+        if(*rtttl_melody == ','){
+            rtttl_melody = skipSpaces(rtttl_melody + 1);
+        }
+    }
+    if(*rtttl_melody != ':'){
+        return -1;
+    }
+    rtttl_melody++;                             // skip colon
+
+    /* BPM usually expresses the number of quarter notes per minute */
+    wholenote = (60 * 1000UL / bpm) * 4;        // this is the time for whole note (in milliseconds)
+
+    /* now begin note loop */
+    while(*(rtttl_melody = skipSpaces(rtttl_melody))){
+        /* first, get note duration, if available */
+        num = parseNum(&rtttl_melody);
+        if(num){
+            duration = wholenote / num;
+        }else{
+            duration = wholenote / default_dur; // we will need to check if we are a dotted note after
+        } 
+        /* now get the note */
+        switch(*rtttl_melody | 0x20){
+        case 'c':
+            note = 1;
+            break;
+        case 'd':
+            note = 3;
+            break;
+        case 'e':
+            note = 5;
+            break;
+        case 'f':
+            note = 6;
+            break;
+        case 'g':
+            note = 8;
+            break;
+        case 'a':
+            note = 10;
+            break;
+        case 'b':
+        case 'h':
+            note = 12;
+            break;
+        case 'p':
+            note = 0;
+            break;
+        default:
+            return -1;
+        }
+        rtttl_melody++;
+        /* now, get optional '#' sharp */
+        if(*rtttl_melody == '#'){
+            note++;
+            rtttl_melody++;
+        }
+        /* now, get optional '.' dotted note */
+        if(*rtttl_melody == '.'){
+            duration += duration/2;
+            rtttl_melody++;
+        }
+        /* now, get scale */
+        if(isDigit(*rtttl_melody)){
+            scale = *rtttl_melody - '0';
+            rtttl_melody++;
+        }else{
+            scale = default_oct;
+        }
+        scale += OCTAVE_OFFSET;
+        if(scale < OCTAVE_MIN){
+            scale = OCTAVE_MIN;
+        } else if(scale > OCTAVE_MAX){
+            scale = OCTAVE_MAX;
+        }
+        /* some melodies put the dot after the scale */
+        if(*rtttl_melody == '.'){
+            duration += duration/2;
+            rtttl_melody++;
+        }
+        rtttl_melody = skipSpaces(rtttl_melody);
+        if(*rtttl_melody == ','){
+            rtttl_melody++; // skip comma for next note (or we may be at the end)
+        }
+        /* now store the note (b# wraps to the next octave) */
+        if(qty >= max_notes){
+            return -1;
+        }
+        if(note > 12){
+            note -= 12;
+            scale = (scale < OCTAVE_MAX) ? scale + 1 : scale;
+        }
+        notes_out[qty].freq = note ? notes[(scale - OCTAVE_MIN) * 12 + note] : 0;
+        notes_out[qty].duration = (duration > UINT16_MAX) ? UINT16_MAX : duration;
+        qty++;
+    }
+    return qty;
+}
+
+/*==================[end of file]============================================*/
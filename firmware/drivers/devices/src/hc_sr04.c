@@ -12,81 +12,254 @@
 /*==================[inclusions]=============================================*/
 #include "hc_sr04.h"
 #include "delay_mcu.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_attr.h"
+#include "sdkconfig.h"
 /*==================[macros and definitions]=================================*/
 #define MAX_US		17700	/* maximun distance time in us (300cm or 118inch) */
 #define MAX_CM		300		/* maximun distance time in cm */
 #define MAX_INCH	118		/* maximun distance time in inch */
 #define US2CM		59		/* scale factor to conver pulse width to cm */
 #define US2INCH		150		/* scale factor to conver pulse width to inch */
-#define WAIT_MAX	5900	/* maximun time to wait for echo signal */
+#define TRIGGER_US	10		/* trigger pulse width */
+#define ECHO_TIMEOUT_MS		50	/* the module holds echo high ~38ms when nothing is in range */
+#define SOUND_SPEED			343	/* speed of sound in um/us (m/s) */
+#define CYCLES_PER_US		CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ	/* CPU cycles in 1usec */
+#define RESULT_QUEUE_LEN	8
+#define REQUEST_QUEUE_LEN	8
+#define SCAN_WAKE			0xFF	/* request used only to wake up the ranging task */
+#define RANGING_TASK_STACK	2048
+#define RANGING_TASK_PRIO	5
 /*==================[internal data declaration]==============================*/
-static gpio_t echo_st, trigger_st; /**<  Stores the pin inicilization*/
-/*==================[internal functions declaration]=========================*/
+/**
+ * @brief Echo capture state
+ */
+typedef enum {
+	ECHO_IDLE = 0,
+	ECHO_ARMED,
+	ECHO_HIGH,
+	ECHO_DONE,
+} echo_state_t;
 
+/**
+ * @brief Sensor data
+ */
+typedef struct {
+	gpio_t echo;				/*!< Echo GPIO */
+	gpio_t trigger;				/*!< Trigger GPIO */
+	volatile echo_state_t state;/*!< Echo capture state */
+	volatile uint32_t rise;		/*!< Cycle count at echo rising edge */
+	volatile uint32_t fall;		/*!< Cycle count at echo falling edge */
+} hc_sr04_sensor_t;
+/*==================[internal functions declaration]=========================*/
+static void HcSr04EchoIsr(void *arg);
+static void HcSr04Deliver(hc_sr04_result_t *result);
+static void HcSr04RangingTask(void *param);
 /*==================[internal data definition]===============================*/
-
+static hc_sr04_sensor_t sensors[HC_SR04_MAX_SENSORS];
+static uint8_t sensor_qty = 0;
+static SemaphoreHandle_t measure_mutex = NULL;	/**< One sensor fired at a time */
+static SemaphoreHandle_t echo_done = NULL;		/**< Given from ISR on echo falling edge */
+static QueueHandle_t request_queue = NULL;
+static QueueHandle_t result_queue = NULL;
+static TaskHandle_t ranging_task = NULL;
+static hc_sr04_config_t ranging_config;
+static volatile bool scanning = false;
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static void IRAM_ATTR HcSr04EchoIsr(void *arg){
+	hc_sr04_sensor_t *sensor = (hc_sr04_sensor_t *)arg;
+	uint32_t now = esp_cpu_get_cycle_count();
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+	if(GPIORead(sensor->echo)){
+		if(sensor->state == ECHO_ARMED){
+			sensor->rise = now;
+			sensor->state = ECHO_HIGH;
+		}
+	} else if(sensor->state == ECHO_HIGH){
+		sensor->fall = now;
+		sensor->state = ECHO_DONE;
+		xSemaphoreGiveFromISR(echo_done, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+	}
+}
+
+static void HcSr04Deliver(hc_sr04_result_t *result){
+	hc_sr04_result_t discard;
+
+	if(ranging_config.func_p != NULL){
+		((void (*)(hc_sr04_result_t *, void *))ranging_config.func_p)(result, ranging_config.param_p);
+	}
+	if(xQueueSend(result_queue, result, 0) != pdTRUE){
+		/* keep the freshest results */
+		xQueueReceive(result_queue, &discard, 0);
+		xQueueSend(result_queue, result, 0);
+	}
+}
+
+static void HcSr04RangingTask(void *param){
+	hc_sr04_result_t result;
+	uint8_t request, next = 0;
+	TickType_t guard, step, last_wake = xTaskGetTickCount();
+
+	while(true){
+		guard = pdMS_TO_TICKS(ranging_config.guard_ms ? ranging_config.guard_ms : HC_SR04_GUARD_MS);
+		/* requests made with HcSr04Trigger() */
+		while(xQueueReceive(request_queue, &request, scanning ? 0 : portMAX_DELAY) == pdTRUE){
+			if(request < sensor_qty){
+				HcSr04Measure(request, &result);
+				HcSr04Deliver(&result);
+				vTaskDelay(guard);
+			}
+			if(!scanning){
+				last_wake = xTaskGetTickCount();
+			}
+		}
+		/* periodic round-robin scan */
+		if(scanning && sensor_qty){
+			HcSr04Measure(next, &result);
+			HcSr04Deliver(&result);
+			next = (next + 1) % sensor_qty;
+			step = pdMS_TO_TICKS(ranging_config.period_ms) / sensor_qty;
+			if(step < pdMS_TO_TICKS(ECHO_TIMEOUT_MS) + guard){
+				step = pdMS_TO_TICKS(ECHO_TIMEOUT_MS) + guard;
+			}
+			vTaskDelayUntil(&last_wake, step);
+		}
+	}
+}
 /*==================[external functions definition]==========================*/
 
 bool HcSr04Init(gpio_t echo, gpio_t trigger){
-	echo_st = echo;
-	trigger_st = trigger;
+	sensor_qty = 0;
+	HcSr04AddSensor(echo, trigger);
+
+	return true;
+}
+
+int8_t HcSr04AddSensor(gpio_t echo, gpio_t trigger){
+	hc_sr04_sensor_t *sensor;
+
+	if(sensor_qty >= HC_SR04_MAX_SENSORS){
+		return -1;
+	}
+	if(measure_mutex == NULL){
+		measure_mutex = xSemaphoreCreateMutex();
+		echo_done = xSemaphoreCreateBinary();
+	}
+	sensor = &sensors[sensor_qty];
+	sensor->echo = echo;
+	sensor->trigger = trigger;
+	sensor->state = ECHO_IDLE;
 
 	/** Configuration of the GPIO pins*/
 	GPIOInit(echo, GPIO_INPUT);
 	GPIOInit(trigger, GPIO_OUTPUT);
+	GPIOOff(trigger);
+	GPIOActivIntAnyEdge(echo, HcSr04EchoIsr, sensor);
 
-	return true;
+	return sensor_qty++;
+}
+
+void HcSr04Start(hc_sr04_config_t *config){
+	ranging_config = *config;
+	if(ranging_task == NULL){
+		request_queue = xQueueCreate(REQUEST_QUEUE_LEN, sizeof(uint8_t));
+		result_queue = xQueueCreate(RESULT_QUEUE_LEN, sizeof(hc_sr04_result_t));
+		xTaskCreate(HcSr04RangingTask, "hc_sr04", RANGING_TASK_STACK, NULL, RANGING_TASK_PRIO, &ranging_task);
+	}
+	scanning = (config->period_ms != 0);
+	if(scanning){
+		uint8_t wake = SCAN_WAKE;
+		xQueueSend(request_queue, &wake, 0);
+	}
+}
+
+void HcSr04Stop(void){
+	scanning = false;
+}
+
+bool HcSr04Trigger(uint8_t sensor){
+	if((request_queue == NULL) || (sensor >= sensor_qty)){
+		return false;
+	}
+	return (xQueueSend(request_queue, &sensor, 0) == pdTRUE);
+}
+
+bool HcSr04GetResult(hc_sr04_result_t *result, uint32_t timeout_ms){
+	if(result_queue == NULL){
+		return false;
+	}
+	return (xQueueReceive(result_queue, result, pdMS_TO_TICKS(timeout_ms)) == pdTRUE);
+}
+
+void HcSr04Measure(uint8_t sensor, hc_sr04_result_t *result){
+	hc_sr04_sensor_t *s = &sensors[sensor];
+	uint32_t cycles;
+
+	xSemaphoreTake(measure_mutex, portMAX_DELAY);
+	/* drop a give left by an echo that ended after a previous timeout */
+	xSemaphoreTake(echo_done, 0);
+	s->state = ECHO_ARMED;
+	result->sensor = sensor;
+	result->timestamp = esp_timer_get_time();
+	GPIOOn(s->trigger);
+	DelayUs(TRIGGER_US);
+	GPIOOff(s->trigger);
+
+	if(xSemaphoreTake(echo_done, pdMS_TO_TICKS(ECHO_TIMEOUT_MS)) == pdTRUE){
+		cycles = s->fall - s->rise;
+		result->valid = true;
+		result->echo_us = cycles / CYCLES_PER_US;
+		result->distance_um = (uint32_t)(((uint64_t)cycles * SOUND_SPEED) / (2 * CYCLES_PER_US));
+		result->out_of_range = (result->echo_us > MAX_US);
+	} else{
+		/* echo never rose: disconnected; echo still high: nothing in range */
+		result->valid = (s->state == ECHO_HIGH);
+		result->out_of_range = result->valid;
+		result->echo_us = 0;
+		result->distance_um = 0;
+	}
+	s->state = ECHO_IDLE;
+	xSemaphoreGive(measure_mutex);
 }
 
 uint16_t HcSr04ReadDistanceInCentimeters(void){
-	uint16_t distance = 0, waiting = 0;
-	GPIOOn(trigger_st);
-	DelayUs(10);
-	GPIOOff(trigger_st);
-	while(!GPIORead(echo_st)){
-		DelayUs(10);
-		waiting += 10;
-		if(waiting > WAIT_MAX){
-			return 0;
-		}
+	hc_sr04_result_t result;
+
+	HcSr04Measure(0, &result);
+	if(!result.valid){
+		return 0;
 	}
-	do{
-		DelayUs(10);
-		distance += 10;
-		if(distance > MAX_US)
-			return MAX_CM;
+	if(result.out_of_range){
+		return MAX_CM;
 	}
-	while(GPIORead(echo_st));
-	return (distance/US2CM);
+	return (result.echo_us/US2CM);
 }
 
 uint16_t HcSr04ReadDistanceInInches(void){
-	uint16_t distance = 0, waiting = 0;
-	GPIOOn(trigger_st);
-	DelayUs(10);
-	GPIOOff(trigger_st);
-	while(!GPIORead(echo_st)){
-		DelayUs(10);
-		waiting += 10;
-		if(waiting > WAIT_MAX){
-			return 0;
-		}
+	hc_sr04_result_t result;
+
+	HcSr04Measure(0, &result);
+	if(!result.valid){
+		return 0;
 	}
-	do{
-		DelayUs(10);
-		distance += 10;
-		if(distance > MAX_US)
-			return MAX_INCH;
+	if(result.out_of_range){
+		return MAX_INCH;
 	}
-	while(GPIORead(echo_st));
-	return (distance/US2INCH);
+	return (result.echo_us/US2INCH);
 }
 
 bool HcSr04Deinit(void){
+	scanning = false;
+	sensor_qty = 0;
 	GPIODeinit();
 	return true;
 }
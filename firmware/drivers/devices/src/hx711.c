@@ -8,12 +8,23 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "hx711.h"
 
 #include <delay_mcu.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_attr.h"
+#include "sdkconfig.h"
 
 /*==================[macros and definitions]=================================*/
+#define CLK_CYCLES		CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ	/*!< PD_SCK half period: 1us (must stay under 50us high) */
+#define HX711_TASK_STACK	2048
+#define HX711_TASK_PRIO		10
+#define RING_MASK		(HX711_RING_LEN - 1)
 
 /*==================[internal data declaration]==============================*/
 uint8_t GAIN;		             /*!<  Amplification factor */
@@ -24,7 +35,39 @@ float SCALE;	                 /*!<  Used to return weight in grams, kg, ounces,
 gpio_t internal_pd_sck;
 gpio_t internal_dout;
 
+static portMUX_TYPE hx711_spinlock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t hx711_task_handle = NULL;
+static volatile bool continuous = false;    /*!< Continuous acquisition running */
+static volatile bool shifting = false;      /*!< DOUT edges are data, not conversion ready */
+static bool isr_installed = false;
+
+/* raw samples ring, written by the acquisition task only */
+static int32_t ring[HX711_RING_LEN];
+static uint32_t ring_head = 0;
+static uint32_t ring_tail = 0;
+
+/* filter chain, owned by the acquisition task */
+static hx711_filter_config_t filter;
+static int32_t median_buf[HX711_MEDIAN_MAX];
+static uint8_t median_idx, median_count;
+static int32_t average_buf[HX711_AVERAGE_MAX];
+static uint8_t average_idx, average_count;
+static int64_t average_sum;
+static uint8_t outlier_run;
+static volatile int32_t filtered = 0;       /*!<  Latest filtered value */
+static volatile int32_t tare_counts = 0;    /*!<  Tare of the continuous acquisition */
+static volatile uint8_t tare_remaining = 0;
+static uint8_t tare_times;
+static int64_t tare_sum;
+static hx711_stats_t stats;
+
 /*==================[internal functions declaration]=========================*/
+static inline void HX711_wait(uint32_t cycles);
+static uint32_t HX711_shift(void);
+static void HX711_resetFilters(void);
+static void HX711_filter(int32_t raw);
+static void HX711_task(void *param);
+static void HX711_doutIsr(void *arg);
 
 uint8_t shiftIn(void)
 {
@@ -42,6 +85,162 @@ uint8_t shiftIn(void)
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static inline void HX711_wait(uint32_t cycles)
+{
+	uint32_t start = esp_cpu_get_cycle_count();
+	while((esp_cpu_get_cycle_count() - start) < cycles);
+}
+
+/* Clocks out the 24 data bits plus the gain/channel pulses. Runs with 
+ * interrupts masked: a PD_SCK high time over 50us powers the chip down. */
+static uint32_t HX711_shift(void)
+{
+	uint32_t count = 0;
+
+	shifting = true;
+	taskENTER_CRITICAL(&hx711_spinlock);
+	for(uint8_t i = 0; i < 24; i++)
+	{
+		GPIOOn(internal_pd_sck);//PD_SCK_SET_HIGH;
+		HX711_wait(CLK_CYCLES);
+		count = (count << 1) | GPIORead(internal_dout);
+		GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
+		HX711_wait(CLK_CYCLES);
+	}
+	for(uint8_t i = 0; i < GAIN; i++)
+	{
+		GPIOOn(internal_pd_sck);//PD_SCK_SET_HIGH;
+		HX711_wait(CLK_CYCLES);
+		GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
+		HX711_wait(CLK_CYCLES);
+	}
+	taskEXIT_CRITICAL(&hx711_spinlock);
+	/* DOUT edges caused by the shift have already been served (and ignored) here */
+	shifting = false;
+	return count;
+}
+
+static void HX711_resetFilters(void)
+{
+	median_idx = median_count = 0;
+	average_idx = average_count = 0;
+	average_sum = 0;
+	outlier_run = 0;
+}
+
+static void HX711_filter(int32_t raw)
+{
+	int32_t sorted[HX711_MEDIAN_MAX], value, ref;
+	uint8_t i, j, n;
+
+	/* outlier rejection against the current average; a run of outliers is a real step */
+	if(filter.outlier_th && average_count)
+	{
+		ref = average_sum / average_count;
+		if((uint32_t)abs(raw - ref) > filter.outlier_th)
+		{
+			if(++outlier_run <= filter.outlier_max)
+			{
+				stats.outliers++;
+				return;
+			}
+			HX711_resetFilters();
+		}
+		else
+		{
+			outlier_run = 0;
+		}
+	}
+
+	/* running median */
+	median_buf[median_idx] = raw;
+	median_idx = (median_idx + 1) % filter.median;
+	if(median_count < filter.median)
+	{
+		median_count++;
+	}
+	n = median_count;
+	for(i = 0; i < n; i++)
+	{
+		value = median_buf[i];
+		for(j = i; j > 0 && sorted[j - 1] > value; j--)
+		{
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = value;
+	}
+	value = sorted[n / 2];
+
+	/* moving average, running sum */
+	if(average_count == filter.average)
+	{
+		average_sum -= average_buf[average_idx];
+	}
+	else
+	{
+		average_count++;
+	}
+	average_buf[average_idx] = value;
+	average_sum += value;
+	average_idx = (average_idx + 1) % filter.average;
+	value = average_sum / average_count;
+
+	/* incremental tare */
+	if(tare_remaining)
+	{
+		tare_sum += value;
+		if(--tare_remaining == 0)
+		{
+			tare_counts = tare_sum / tare_times;
+		}
+	}
+	filtered = value;
+	if(filter.func_p != NULL)
+	{
+		((void (*)(int32_t, void *))filter.func_p)(value - tare_counts, filter.param_p);
+	}
+}
+
+static void HX711_task(void *param)
+{
+	uint32_t head, count;
+	int32_t raw;
+
+	while(true)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		if(!continuous || !HX711_isReady())
+		{
+			continue;
+		}
+		count = HX711_shift();
+		/* 24 bit two's complement */
+		raw = ((int32_t)(count << 8)) >> 8;
+		stats.samples++;
+		head = ring_head;
+		if((head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE)) < HX711_RING_LEN)
+		{
+			ring[head & RING_MASK] = raw;
+			__atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+		}
+		else
+		{
+			stats.overruns++;
+		}
+		HX711_filter(raw);
+	}
+}
+
+static void IRAM_ATTR HX711_doutIsr(void *arg)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	if(continuous && !shifting)
+	{
+		vTaskNotifyGiveFromISR(hx711_task_handle, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+	}
+}
 
 /*==================[external functions definition]==========================*/
 void HX711_Init(uint8_t gain, gpio_t pd_sck, gpio_t dout)
@@ -75,43 +274,27 @@ void HX711_setGain(uint8_t gain)
 	}
 
 	GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
-	HX711_read();
+	// while acquiring continuously the new gain is applied by the next shift
+	if(!continuous)
+	{
+		HX711_read();
+	}
 }
 
 uint32_t HX711_read(void)
 {
-	// wait for the chip to become ready
-	while (!HX711_isReady());
-
-    unsigned long count;
-    unsigned char i;
-
-    GPIOOn(internal_dout);//DOUT_SET_HIGH;
+	uint32_t count;
 
-    DelayUs(1);
-
-    GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
-    DelayUs(1);
+	// wait for the chip to become ready, letting other tasks run
+	while (!HX711_isReady())
+	{
+		vTaskDelay(1);
+	}
 
-    count=0;
-    while(GPIORead(internal_dout));
-    for(i=0;i<24;i++)
-    {
-    	 GPIOOn(internal_pd_sck);//PD_SCK_SET_HIGH;
-    	 DelayUs(1);
-        count=count<<1;
-        GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
-        DelayUs(1);
-        if(GPIORead(internal_dout))
-            count++;
-    }
-    count = count>>6;
-    GPIOOn(internal_pd_sck);//PD_SCK_SET_HIGH;
-    DelayUs(1);
-    GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
-    DelayUs(1);
-    count ^= 0x800000;
-    return(count);
+	count = HX711_shift();
+	count = count>>6;
+	count ^= 0x800000;
+	return(count);
 }
 
 uint32_t HX711_readAverage(uint8_t times)
@@ -125,12 +308,12 @@ uint32_t HX711_readAverage(uint8_t times)
 	return sum / times;
 }
 
-double HX711_getValue(uint8_t times)
+double HX711_get_value(uint8_t times)
 {
 	return HX711_readAverage(times) - OFFSET;
 }
 
-float HX711_getUnits(uint8_t times)
+float HX711_get_units(uint8_t times)
 {
 	return HX711_get_value(times) / SCALE;
 }
@@ -173,4 +356,85 @@ void HX711_powerUp(void)
 	GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
 }
 
+void HX711_startContinuous(hx711_filter_config_t *config)
+{
+	filter = *config;
+	if(filter.median == 0 || filter.median > HX711_MEDIAN_MAX)
+	{
+		filter.median = 1;
+	}
+	if(filter.average == 0 || filter.average > HX711_AVERAGE_MAX)
+	{
+		filter.average = 1;
+	}
+	HX711_resetFilters();
+	memset(&stats, 0, sizeof(stats));
+	if(hx711_task_handle == NULL)
+	{
+		xTaskCreate(HX711_task, "hx711", HX711_TASK_STACK, NULL, HX711_TASK_PRIO, &hx711_task_handle);
+	}
+	if(!isr_installed)
+	{
+		GPIOActivInt(internal_dout, HX711_doutIsr, false, NULL);
+		isr_installed = true;
+	}
+	continuous = true;
+	/* a conversion may already be waiting: no falling edge will come for it */
+	if(HX711_isReady())
+	{
+		xTaskNotifyGive(hx711_task_handle);
+	}
+}
+
+void HX711_stopContinuous(void)
+{
+	continuous = false;
+}
+
+bool HX711_readRaw(int32_t *raw)
+{
+	uint32_t tail = ring_tail;
+
+	if(tail == __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE))
+	{
+		return false;
+	}
+	*raw = ring[tail & RING_MASK];
+	__atomic_store_n(&ring_tail, tail + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+int32_t HX711_getFiltered(void)
+{
+	return filtered - tare_counts;
+}
+
+float HX711_getFilteredUnits(void)
+{
+	return HX711_getFiltered() / SCALE;
+}
+
+void HX711_tareContinuous(uint8_t times)
+{
+	if(times == 0)
+	{
+		times = 1;
+	}
+	taskENTER_CRITICAL(&hx711_spinlock);
+	tare_sum = 0;
+	tare_times = times;
+	tare_remaining = times;
+	taskEXIT_CRITICAL(&hx711_spinlock);
+}
+
+bool HX711_tareDone(void)
+{
+	return tare_remaining == 0;
+}
+
+void HX711_getStats(hx711_stats_t *stats_p)
+{
+	*stats_p = stats;
+}
+
 
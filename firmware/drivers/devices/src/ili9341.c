@@ -15,6 +15,7 @@
 #include "spi_mcu.h"
 #include "gpio_mcu.h"
 #include "delay_mcu.h"
+#include "trace_mcu.h"
 /*==================[macros and definitions]=================================*/
 #define NULL 0
 
@@ -194,6 +195,7 @@ static orientation_properties_t lcd_orientation = {
 /*==================[internal functions definition]==========================*/
 
 void WriteLCD(lcd_cmd_t * data){
+	TRACE_BEGIN(TRACE_ID_LCD_WRITE);
 	SpiInit(&spi_conf);
 	/* If command is NULL don't send command */
 	if (data->cmd != NULL){
@@ -207,6 +209,7 @@ void WriteLCD(lcd_cmd_t * data){
 		GPIOOn(ili9341_dc);
 		SpiWrite(ili9341_spi, data->data, data->databytes);
 	}
+	TRACE_END(TRACE_ID_LCD_WRITE);
 }
 
 void SetCursorPosition(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1){
@@ -12,6 +12,9 @@
 /*==================[inclusions]=============================================*/
 #include "lcditse0803.h"
 #include "gpio_mcu.h"
+#include "timer_mcu.h"
+#include "esp_attr.h"
+#include "esp_rom_sys.h"
 /*==================[macros and definitions]=================================*/
 #define GPIO_BCD_1	GPIO_20
 #define GPIO_BCD_2	GPIO_21
@@ -20,19 +23,75 @@
 #define GPIO_SEL_1	GPIO_19
 #define GPIO_SEL_2	GPIO_18
 #define GPIO_SEL_3	GPIO_9
+#define BCD_MASK	(GPIO_MASK(GPIO_BCD_1) | GPIO_MASK(GPIO_BCD_2) | GPIO_MASK(GPIO_BCD_3) | GPIO_MASK(GPIO_BCD_4))
+#define DIGIT_MASK(d)	((((d) & 1) ? GPIO_MASK(GPIO_BCD_1) : 0) | (((d) & 2) ? GPIO_MASK(GPIO_BCD_2) : 0) | \
+						 (((d) & 4) ? GPIO_MASK(GPIO_BCD_3) : 0) | (((d) & 8) ? GPIO_MASK(GPIO_BCD_4) : 0))
+#define DIGITS			3
+#define DIGIT_BLANK		0x0F		/*!< BCD code out of range: the decoder blanks the digit */
+#define LCD_VALUE_OFF	0xFFFF		/*!< Display blanked */
+#define LCD_VALUE_NONE	0xFFFE		/*!< Nothing written yet */
+#define LCD_STROBE_US	1			/*!< Latch enable pulse width */
 /*==================[internal data definition]===============================*/
 static uint16_t actual_value = 0; /*variable that saves the value to be shown in the display LCD*/
+/** @brief BCD lines set for each digit (the rest are cleared) */
+static const DRAM_ATTR uint32_t digit_mask[16] = {
+	DIGIT_MASK(0), DIGIT_MASK(1), DIGIT_MASK(2), DIGIT_MASK(3), DIGIT_MASK(4), DIGIT_MASK(5), DIGIT_MASK(6), DIGIT_MASK(7),
+	DIGIT_MASK(8), DIGIT_MASK(9), DIGIT_MASK(10), DIGIT_MASK(11), DIGIT_MASK(12), DIGIT_MASK(13), DIGIT_MASK(14), DIGIT_MASK(15),
+};
+/** @brief Latch enable of each digit, hundreds first */
+static const DRAM_ATTR uint32_t sel_mask[DIGITS] = {GPIO_MASK(GPIO_SEL_1), GPIO_MASK(GPIO_SEL_2), GPIO_MASK(GPIO_SEL_3)};
+static volatile uint16_t back_value = LCD_VALUE_NONE;	/*!< Value requested by the application */
+static uint16_t front_value = LCD_VALUE_NONE;			/*!< Value latched in the display */
+static bool refresh_on = false;							/*!< Background refresh running */
+static soft_timer_t refresh_timer;						/*!<  */
 /*==================[internal functions declaration]=========================*/
 /** @brief Aux function to load a digit to the LCD Display
  *
+ * The four BCD lines are written with two port stores (ones, then zeros): the
+ * display takes them on the latch enable pulse, after both.
  */
 bool LcdItsE0803BCDtoPin(uint8_t value){
-	GPIOState(GPIO_BCD_1, (value & (1<<0))>>0);
-	GPIOState(GPIO_BCD_2, (value & (1<<1))>>1);
-	GPIOState(GPIO_BCD_3, (value & (1<<2))>>2);
-	GPIOState(GPIO_BCD_4, (value & (1<<3))>>3);
+	uint32_t set = digit_mask[value & 0x0F];
+	GPIOWriteMask(set, BCD_MASK & ~set);
 	return true;
 }
+
+/** @brief Loads a digit and pulses its latch enable
+ */
+static void IRAM_ATTR LcdItsE0803Latch(uint8_t digit, uint32_t sel){
+	uint32_t set = digit_mask[digit & 0x0F];
+	GPIOWriteMask(set, BCD_MASK & ~set);
+	GPIOWriteMask(sel, 0);
+	esp_rom_delay_us(LCD_STROBE_US);
+	GPIOWriteMask(0, sel);
+}
+
+/** @brief Writes a value (or LCD_VALUE_OFF) to the three digits if it is not the one shown
+ */
+static void IRAM_ATTR LcdItsE0803Show(uint16_t value){
+	uint8_t digits[DIGITS] = {DIGIT_BLANK, DIGIT_BLANK, DIGIT_BLANK};
+	uint16_t rest;
+	if(value == front_value){
+		return;
+	}
+	if(value != LCD_VALUE_OFF){
+		/* value / 100 and rest / 10 without divisions, exact for value < 1000 */
+		digits[0] = (value * 41) >> 12;
+		rest = value - digits[0] * 100;
+		digits[1] = (rest * 103) >> 10;
+		digits[2] = rest - digits[1] * 10;
+	}
+	for(uint8_t i = 0; i < DIGITS; i++){
+		LcdItsE0803Latch(digits[i], sel_mask[i]);
+	}
+	front_value = value;
+}
+
+/** @brief Background refresh, called from the timer service ISR
+ */
+static void IRAM_ATTR LcdItsE0803Refresh(void *param){
+	LcdItsE0803Show(back_value);
+}
 /*==================[external functions definition]==========================*/
 bool LcdItsE0803Init(void){
 	/* Configuration of pins of data*/
@@ -47,33 +106,19 @@ bool LcdItsE0803Init(void){
 	GPIOInit(GPIO_SEL_3, GPIO_OUTPUT);
 
 	actual_value=0;
+	front_value = LCD_VALUE_NONE;
 	LcdItsE0803Write(actual_value);
 	return true;
 };
 
 bool LcdItsE0803Write(uint16_t value) {
-	uint8_t units, tens, hundreds;
 	if(value<1000)	 {
 		actual_value = value;
-
-		hundreds = value/100;
-		tens = (value-(hundreds*100))/10;
-		units = (value-(hundreds*100)-(tens*10));
-
-		/* Write hundreds */
-		LcdItsE0803BCDtoPin(hundreds);
-		GPIOOn(GPIO_SEL_1);
-		GPIOOff(GPIO_SEL_1);
-
-		/* Write tens */
-		LcdItsE0803BCDtoPin(tens);
-		GPIOOn(GPIO_SEL_2);
-		GPIOOff(GPIO_SEL_2);
-
-		/* Write units */
-		LcdItsE0803BCDtoPin(units);
-		GPIOOn(GPIO_SEL_3);
-		GPIOOff(GPIO_SEL_3);
+		if(refresh_on){
+			back_value = value;		/* shown on the next refresh */
+		} else {
+			LcdItsE0803Show(value);
+		}
 		return true; /* return 1 for values lower than 999 */
 	}
 	else
@@ -85,20 +130,42 @@ uint16_t LcdItsE0803Read(void){
 }
 
 void LcdItsE0803Off(void){
-	LcdItsE0803BCDtoPin(0x0F);
-	GPIOOn(GPIO_SEL_1);
-	GPIOOff(GPIO_SEL_1);
+	if(refresh_on){
+		back_value = LCD_VALUE_OFF;
+	} else {
+		LcdItsE0803Show(LCD_VALUE_OFF);
+	}
+}
 
-	LcdItsE0803BCDtoPin(0x0F);
-	GPIOOn(GPIO_SEL_2);
-	GPIOOff(GPIO_SEL_2);
+bool LcdItsE0803StartRefresh(uint16_t period_ms){
+	soft_timer_config_t refresh_cfg = {
+		.period = (uint32_t)period_ms * 1000,
+		.periodic = true,
+		.dispatch = TIMER_DISPATCH_ISR,
+		.func_p = LcdItsE0803Refresh,
+		.param_p = NULL,
+	};
+	if((period_ms == 0) || refresh_on){
+		return false;
+	}
+	back_value = front_value;
+	SoftTimerInit(&refresh_timer, &refresh_cfg);
+	refresh_on = true;
+	SoftTimerStart(&refresh_timer);
+	return true;
+}
 
-	LcdItsE0803BCDtoPin(0x0F);
-	GPIOOn(GPIO_SEL_3);
-	GPIOOff(GPIO_SEL_3);
+void LcdItsE0803StopRefresh(void){
+	if(refresh_on){
+		SoftTimerStop(&refresh_timer);
+		refresh_on = false;
+		/* flush the last requested value */
+		LcdItsE0803Show(back_value);
+	}
 }
 
 bool LcdItsE0803DeInit(void){
+	LcdItsE0803StopRefresh();
 	GPIODeinit();
 	return true;
 }
@@ -13,32 +13,43 @@
 #include "mpu6050.h"
 #include "math.h"
 #include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 /*==================[macros and definitions]=================================*/
 #define I2C_NUM I2C_NUM_0
 
+#define FIFO_SIZE           1024    /* MPU6050 FIFO bytes */
+#define FRAME_SIZE          12      /* accel xyz + gyro xyz, 16 bit big endian */
+#define BURST_FRAMES        21      /* frames per I2C transaction (length is 8 bit) */
+#define STREAM_TASK_STACK   3072
+#define STREAM_TASK_PRIO    10
+#define RING_MASK           (MPU6050_STREAM_RING_LEN - 1)
+#define RATE_DIV_MAX        255     /* SMPLRT_DIV is 8 bit */
+
 /*==================[internal data definition]===============================*/
 uint8_t devAddr;
 uint8_t buffer[14];
+
+static mpu6050_stream_config_t stream_config;
+static int32_t stream_period_us;        /* sample period, exact (rate_hz is rounded) */
+static TaskHandle_t stream_task = NULL;
+static volatile bool streaming = false;
+static portMUX_TYPE stream_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t drdy_count;    /* data ready interrupts since the FIFO reset */
+static volatile int64_t drdy_time;      /* instant of the last data ready interrupt */
+static mpu6050_sample_t ring[MPU6050_STREAM_RING_LEN];
+static uint32_t ring_head = 0;
+static uint32_t ring_tail = 0;
+static mpu6050_stream_stats_t stream_stats;
 /*==================[internal functions declaration]=========================*/
+static void MPU6050_intIsr(void *arg);
+static void MPU6050_streamTask(void *param);
 
 /*==================[external functions definition]==========================*/
 void MPU6050_ReadRegister(uint8_t reg, uint8_t *data, uint8_t len){
-	uint8_t dev = 0x68;
-	i2c_cmd_handle_t cmd;
-	I2C_SelectRegister(dev, reg);
-
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (dev << 1) | I2C_MASTER_READ, 1));
-
-	if(len>1)
-		ESP_ERROR_CHECK(i2c_master_read(cmd, data, len, I2C_MASTER_ACK));
-
-	ESP_ERROR_CHECK(i2c_master_read_byte(cmd, data+len-1, I2C_MASTER_NACK));
-
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	ESP_ERROR_CHECK(i2c_master_cmd_begin(I2C_NUM, cmd, 1000));
-	i2c_cmd_link_delete(cmd);
+	I2C_readBytes(MPU6050_DEFAULT_ADDRESS, reg, len, data, I2C_MASTER_TIMEOUT_MS);
 }
 
 void MPU6050_Address(uint8_t address) {
@@ -47,6 +58,15 @@ void MPU6050_Address(uint8_t address) {
 
 void MPU6050_initialize() {
 	devAddr = MPU6050_DEFAULT_ADDRESS;
+    /* configuration registers are shadowed: bit setters skip the bus read */
+    I2C_shadowAttach(devAddr);
+    /* changed by the chip: I2C_SLV4_EN and the reset bits clear themselves, the rest is status/data */
+    I2C_shadowSetVolatile(devAddr, MPU6050_RA_I2C_SLV4_CTRL, MPU6050_RA_I2C_MST_STATUS - MPU6050_RA_I2C_SLV4_CTRL + 1);
+    I2C_shadowSetVolatile(devAddr, MPU6050_RA_DMP_INT_STATUS, MPU6050_RA_MOT_DETECT_STATUS - MPU6050_RA_DMP_INT_STATUS + 1);
+    I2C_shadowSetVolatile(devAddr, MPU6050_RA_SIGNAL_PATH_RESET, 1);
+    I2C_shadowSetVolatile(devAddr, MPU6050_RA_USER_CTRL, 1);
+    I2C_shadowSetVolatile(devAddr, MPU6050_RA_BANK_SEL, MPU6050_RA_MEM_R_W - MPU6050_RA_BANK_SEL + 1);
+    I2C_shadowSetVolatile(devAddr, MPU6050_RA_FIFO_COUNTH, MPU6050_RA_FIFO_R_W - MPU6050_RA_FIFO_COUNTH + 1);
     MPU6050_setClockSource(MPU6050_CLOCK_PLL_XGYRO);
     MPU6050_setFullScaleGyroRange(MPU6050_GYRO_FS_250);
     MPU6050_setFullScaleAccelRange(MPU6050_ACCEL_FS_2);
@@ -2409,6 +2429,9 @@ void MPU6050_resetSensors() {
  */
 void MPU6050_reset() {
     I2C_writeBit(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_DEVICE_RESET_BIT, true);
+    I2C_shadowFlush(devAddr);
+    /* every register is back to its reset value */
+    I2C_shadowInvalidate(devAddr, 0, I2C_SHADOW_REGS);
 }
 /** Get sleep mode status.
  * Setting the SLEEP bit in the register puts the device into very low power
@@ -2766,4 +2789,184 @@ void MPU6050_setDeviceID(uint8_t id) {
     I2C_writeBits(devAddr, MPU6050_RA_WHO_AM_I, MPU6050_WHO_AM_I_BIT, MPU6050_WHO_AM_I_LENGTH, id);
 }
 
+// FIFO streaming
+
+static void IRAM_ATTR MPU6050_intIsr(void *arg) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if(!streaming){
+        return;
+    }
+    drdy_time = esp_timer_get_time();
+    if((++drdy_count % stream_config.watermark) == 0){
+        vTaskNotifyGiveFromISR(stream_task, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+static void MPU6050_streamTask(void *param) {
+    uint8_t fifo[BURST_FRAMES * FRAME_SIZE];
+    uint8_t *f;
+    uint16_t count, frames, burst;
+    uint32_t head, sample_idx = 0, anchor_idx = 0, last_idx, drdy;
+    int64_t anchor_time = 0, predicted, now;
+    bool anchored = false;
+    int32_t period;
+    mpu6050_sample_t *s;
+
+    while(true){
+        /* timeout: recover if a data ready pulse was missed */
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        if(!streaming){
+            continue;
+        }
+        period = stream_period_us;
+        count = MPU6050_getFIFOCount();
+        if((count > FIFO_SIZE - FRAME_SIZE) || (count % FRAME_SIZE)){
+            /* overflow: FIFO content is misaligned, start over */
+            streaming = false;
+            MPU6050_resetFIFO();
+            drdy_count = 0;
+            streaming = true;
+            sample_idx = 0;
+            anchored = false;
+            stream_stats.fifo_overflows++;
+            continue;
+        }
+        frames = count / FRAME_SIZE;
+        if(frames == 0){
+            continue;
+        }
+
+        /* the sample written together with the last data ready pulse anchors the time base */
+        taskENTER_CRITICAL(&stream_lock);
+        drdy = drdy_count;
+        now = drdy_time;
+        taskEXIT_CRITICAL(&stream_lock);
+        if(drdy == 0){
+            /* samples written before counting resumed */
+            drdy = sample_idx + frames;
+            now = esp_timer_get_time();
+        }
+        last_idx = drdy - 1;
+        if(!anchored){
+            anchor_time = now;
+            anchored = true;
+        } else{
+            /* low pass the interrupt latency out, follow the sensor clock drift */
+            predicted = anchor_time + (int64_t)(int32_t)(last_idx - anchor_idx) * period;
+            anchor_time = predicted + (now - predicted) / 8;
+        }
+        anchor_idx = last_idx;
+
+        while(frames){
+            burst = (frames > BURST_FRAMES) ? BURST_FRAMES : frames;
+            MPU6050_getFIFOBytes(fifo, burst * FRAME_SIZE);
+            for(uint16_t i = 0; i < burst; i++){
+                head = ring_head;
+                if((head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE)) >= MPU6050_STREAM_RING_LEN){
+                    stream_stats.ring_overruns++;
+                    sample_idx++;
+                    continue;
+                }
+                f = &fifo[i * FRAME_SIZE];
+                s = &ring[head & RING_MASK];
+                s->ax = (((int16_t)f[0]) << 8) | f[1];
+                s->ay = (((int16_t)f[2]) << 8) | f[3];
+                s->az = (((int16_t)f[4]) << 8) | f[5];
+                s->gx = (((int16_t)f[6]) << 8) | f[7];
+                s->gy = (((int16_t)f[8]) << 8) | f[9];
+                s->gz = (((int16_t)f[10]) << 8) | f[11];
+                s->timestamp = anchor_time + ((int64_t)sample_idx - (int64_t)anchor_idx) * period;
+                __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+                sample_idx++;
+            }
+            frames -= burst;
+            stream_stats.samples += burst;
+        }
+        stream_stats.bursts++;
+        if(stream_config.func_p != NULL){
+            ((void (*)(void *))stream_config.func_p)(stream_config.param_p);
+        }
+    }
+}
+
+bool MPU6050_streamStart(mpu6050_stream_config_t *config) {
+    static bool isr_installed = false;
+    uint16_t base, div;
+
+    if((config->rate_hz == 0) || (config->rate_hz > 1000) || (config->watermark == 0)
+        || (config->watermark > MPU6050_STREAM_WATERMARK_MAX)){
+        return false;
+    }
+    streaming = false;
+    stream_config = *config;
+
+    MPU6050_setFIFOEnabled(false);
+    /* gather the configuration and write it in a few bursts */
+    I2C_shadowDefer(devAddr, true);
+    /* gyro output rate is 8kHz with the DLPF disabled, 1kHz otherwise */
+    base = ((config->dlpf == MPU6050_DLPF_BW_256) || (config->dlpf > MPU6050_DLPF_BW_5)) ? 8000 : 1000;
+    MPU6050_setDLPFMode(config->dlpf);
+    /* slowest rate: base / 256 (31.25Hz with the DLPF disabled) */
+    div = base / config->rate_hz - 1;
+    if(div > RATE_DIV_MAX){
+        div = RATE_DIV_MAX;
+    }
+    MPU6050_setRate(div);
+    stream_config.rate_hz = base / (div + 1);
+    stream_period_us = 1000000 / base * (div + 1);
+
+    I2C_writeByte(devAddr, MPU6050_RA_FIFO_EN, (1 << MPU6050_XG_FIFO_EN_BIT) | (1 << MPU6050_YG_FIFO_EN_BIT) |
+        (1 << MPU6050_ZG_FIFO_EN_BIT) | (1 << MPU6050_ACCEL_FIFO_EN_BIT));
+    MPU6050_setInterruptMode(MPU6050_INTMODE_ACTIVEHIGH);
+    MPU6050_setInterruptDrive(MPU6050_INTDRV_PUSHPULL);
+    MPU6050_setInterruptLatch(MPU6050_INTLATCH_50USPULSE);
+    MPU6050_setIntEnabled(1 << MPU6050_INTERRUPT_DATA_RDY_BIT);
+    I2C_shadowFlush(devAddr);
+    I2C_shadowDefer(devAddr, false);
+
+    ring_tail = ring_head;
+    memset(&stream_stats, 0, sizeof(stream_stats));
+    if(stream_task == NULL){
+        xTaskCreate(MPU6050_streamTask, "mpu6050_stream", STREAM_TASK_STACK, NULL, STREAM_TASK_PRIO, &stream_task);
+    }
+    if(!isr_installed){
+        GPIOInit(config->int_pin, GPIO_INPUT);
+        GPIOActivInt(config->int_pin, MPU6050_intIsr, true, NULL);
+        isr_installed = true;
+    }
+
+    MPU6050_resetFIFO();
+    drdy_count = 0;
+    MPU6050_setFIFOEnabled(true);
+    streaming = true;
+    return true;
+}
+
+void MPU6050_streamStop(void) {
+    streaming = false;
+    MPU6050_setIntEnabled(0);
+    MPU6050_setFIFOEnabled(false);
+}
+
+bool MPU6050_streamRead(mpu6050_sample_t *sample) {
+    uint32_t tail = ring_tail;
+
+    if(tail == __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE)){
+        return false;
+    }
+    *sample = ring[tail & RING_MASK];
+    __atomic_store_n(&ring_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint16_t MPU6050_streamAvailable(void) {
+    return __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE) - ring_tail;
+}
+
+void MPU6050_streamStats(mpu6050_stream_stats_t *stats) {
+    *stats = stream_stats;
+}
+
 /*==================[end of file]============================================*/
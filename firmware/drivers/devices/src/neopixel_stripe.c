@@ -10,8 +10,12 @@
  */
 
 /*==================[inclusions]=============================================*/
+#include <stdlib.h>
 #include "neopixel_stripe.h"
 #include "ws2812b.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 /*==================[macros and definitions]=================================*/
 #define RED_MSK         0x00FF0000
 #define GREEN_MSK       0x0000FF00
@@ -21,73 +25,256 @@
 #define BLUE_OFFSET     0
 #define MAX_BRIGHT  	255
 #define BRIGHT_OFFSET   8
+#define GREEN_BYTE      0   /* WS2812B expects G, R, B order */
+#define RED_BYTE        1
+#define BLUE_BYTE       2
+#define BYTES_PER_LED   3
+#define LUT_SIZE        256
+#define Q8_SHIFT        8   /* fixed point Q8: 256 = 1.0 */
+#define Q16_SHIFT       16  /* fixed point Q16: 65536 = 1.0 */
+#define HUE_CYCLE       65536
+#define RENDER_TASK_STACK   2048
+#define RENDER_TASK_PRIO    5
 /*==================[internal data declaration]==============================*/
+/**
+ * @brief Effects computed by the render task on each frame.
+ */
+typedef enum {
+	EFFECT_NONE = 0,
+	EFFECT_RAINBOW,
+	EFFECT_FADE,
+	EFFECT_CHASE,
+} neopixel_effect_type_t;
+
+/**
+ * @brief Effect state, every field in fixed point.
+ */
+typedef struct {
+	neopixel_effect_type_t type;	/*!< Running effect */
+	neopixel_color_t color;			/*!< Fade target or chase color */
+	uint32_t pos_q16;				/*!< Rainbow first hue (Q16.16) */
+	uint32_t pos_q8;				/*!< Chase head position (pixels, Q8) */
+	uint32_t rate;					/*!< Rainbow cycle in ms or chase speed in pixels/s */
+	uint32_t frames;				/*!< Fade length in frames */
+	uint32_t elapsed;				/*!< Fade frames done */
+	uint8_t sat;					/*!< Rainbow saturation */
+	uint8_t val;					/*!< Rainbow value */
+	uint8_t reps;					/*!< Rainbow repetitions */
+	uint8_t tail;					/*!< Chase tail length */
+} neopixel_effect_t;
+
 uint16_t stripe_length;
 uint8_t stripe_bright = MAX_BRIGHT;
 neopixel_color_t *stripe_colors; 
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
-
+static uint8_t bright_lut[LUT_SIZE];		/* gamma(level * bright) */
+static volatile bool stripe_dirty = false;
+static bool stripe_off = false;
+static uint8_t stripe_fps = NEOPIXEL_DEFAULT_FPS;
+static TickType_t frame_period;
+static SemaphoreHandle_t stripe_mutex = NULL;
+static neopixel_effect_t effect = {.type = EFFECT_NONE};
+static neopixel_color_t *fade_from = NULL;	/* colors at the fade start */
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/**
+ * @brief Rebuild the combined gamma x brightness table. Only needed when
+ * brightness changes, so rendering a pixel costs three table lookups.
+ */
+static void NeoPixelBuildLut(void){
+	for (uint16_t i = 0; i < LUT_SIZE; i++){
+		bright_lut[i] = ws2812bGammaCorrection((i * stripe_bright) >> BRIGHT_OFFSET);
+	}
+}
+
+/**
+ * @brief Encode stripe_colors into the next free WS2812B frame buffer.
+ */
+static void NeoPixelRender(void){
+	uint8_t *frame = ws2812bFrameBuffer();
+	neopixel_color_t color;
+	for (uint16_t i = 0; i < stripe_length; i++){
+		color = stripe_off ? 0 : stripe_colors[i];
+		frame[GREEN_BYTE] = bright_lut[(color & GREEN_MSK) >> GREEN_OFFSET];
+		frame[RED_BYTE] = bright_lut[(color & RED_MSK) >> RED_OFFSET];
+		frame[BLUE_BYTE] = bright_lut[(color & BLUE_MSK) >> BLUE_OFFSET];
+		frame += BYTES_PER_LED;
+	}
+}
+
+static void NeoPixelRainbowFill(uint32_t first_hue_q16, uint8_t sat, uint8_t val, uint8_t reps){
+	/* hue step between pixels in Q16.16, wraps around the color wheel */
+	uint32_t step = (uint32_t)((((uint64_t)reps) << (2 * Q16_SHIFT)) / stripe_length);
+	uint32_t hue = first_hue_q16;
+	for (uint16_t i = 0; i < stripe_length; i++){
+		stripe_colors[i] = NeoPixelHSV2Color(hue >> Q16_SHIFT, sat, val);
+		hue += step;
+	}
+}
+
+/**
+ * @brief Linear interpolation between two levels, rounded.
+ *
+ * @param progress_q16 Position between from (0) and to (1 << Q16_SHIFT)
+ */
+static uint8_t NeoPixelFadeLevel(uint8_t from, uint8_t to, uint32_t progress_q16){
+	return (from * ((1UL << Q16_SHIFT) - progress_q16) + to * progress_q16 + (1UL << (Q16_SHIFT - 1))) >> Q16_SHIFT;
+}
+
+/**
+ * @brief Advance the running effect one frame. Called with stripe_mutex taken.
+ */
+static void NeoPixelEffectStep(void){
+	neopixel_color_t color;
+	uint32_t span_q8, dist_q8, inv, level, progress_q16;
+
+	switch(effect.type){
+	case EFFECT_RAINBOW:
+		/* one full hue cycle every effect.rate ms */
+		effect.pos_q16 += (uint32_t)(((uint64_t)HUE_CYCLE << Q16_SHIFT) * 1000 / ((uint64_t)effect.rate * stripe_fps));
+		NeoPixelRainbowFill(effect.pos_q16, effect.sat, effect.val, effect.reps);
+		stripe_dirty = true;
+	break;
+	case EFFECT_FADE:
+		/* every channel on a straight line from its start level, lands exactly on target at the last frame */
+		effect.elapsed++;
+		progress_q16 = (effect.elapsed << Q16_SHIFT) / effect.frames;
+		for (uint16_t i = 0; i < stripe_length; i++){
+			color = (fade_from != NULL) ? fade_from[i] : effect.color;
+			stripe_colors[i] = NeoPixelRgb2Color(
+				NeoPixelFadeLevel((color & RED_MSK) >> RED_OFFSET, (effect.color & RED_MSK) >> RED_OFFSET, progress_q16),
+				NeoPixelFadeLevel((color & GREEN_MSK) >> GREEN_OFFSET, (effect.color & GREEN_MSK) >> GREEN_OFFSET, progress_q16),
+				NeoPixelFadeLevel((color & BLUE_MSK) >> BLUE_OFFSET, (effect.color & BLUE_MSK) >> BLUE_OFFSET, progress_q16));
+		}
+		if(effect.elapsed == effect.frames){
+			effect.type = EFFECT_NONE;
+		}
+		stripe_dirty = true;
+	break;
+	case EFFECT_CHASE:
+		span_q8 = (uint32_t)stripe_length << Q8_SHIFT;
+		effect.pos_q8 = (effect.pos_q8 + (effect.rate << Q8_SHIFT) / stripe_fps) % span_q8;
+		inv = (1 << Q16_SHIFT) / (effect.tail + 1);
+		for (uint16_t i = 0; i < stripe_length; i++){
+			/* distance behind the head, in pixels Q8 */
+			dist_q8 = (effect.pos_q8 + span_q8 - ((uint32_t)i << Q8_SHIFT)) % span_q8;
+			if(dist_q8 >= ((uint32_t)(effect.tail + 1) << Q8_SHIFT)){
+				stripe_colors[i] = 0;
+			}else{
+				level = (1 << Q8_SHIFT) - ((dist_q8 * inv) >> Q16_SHIFT);
+				stripe_colors[i] = NeoPixelRgb2Color(
+					(((effect.color & RED_MSK) >> RED_OFFSET) * level) >> Q8_SHIFT,
+					(((effect.color & GREEN_MSK) >> GREEN_OFFSET) * level) >> Q8_SHIFT,
+					(((effect.color & BLUE_MSK) >> BLUE_OFFSET) * level) >> Q8_SHIFT);
+			}
+		}
+		stripe_dirty = true;
+	break;
+	default:
+	break;
+	}
+}
 
+/**
+ * @brief Render task: pushes at most one frame per tick, no matter how many
+ * setters were called in between.
+ */
+static void NeoPixelRenderTask(void *param){
+	TickType_t last_wake = xTaskGetTickCount();
+	while(true){
+		vTaskDelayUntil(&last_wake, frame_period);
+		xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+		NeoPixelEffectStep();
+		if(stripe_dirty){
+			stripe_dirty = false;
+			NeoPixelRender();
+			ws2812bFrameSend(NULL, NULL);
+		}
+		xSemaphoreGive(stripe_mutex);
+	}
+}
 /*==================[external functions definition]==========================*/
 
 void NeoPixelInit(gpio_t pin, uint16_t len, neopixel_color_t *color_array){
     stripe_length = len;
 	stripe_colors = color_array;
-    ws2812bInit(pin);
+    ws2812bFrameInit(pin, len);
+	NeoPixelBuildLut();
+	free(fade_from);
+	fade_from = calloc(len, sizeof(neopixel_color_t));
+	if(stripe_mutex == NULL){
+		stripe_mutex = xSemaphoreCreateMutex();
+		NeoPixelFrameRate(stripe_fps);
+		xTaskCreate(&NeoPixelRenderTask, "NeoPixel", RENDER_TASK_STACK, NULL, RENDER_TASK_PRIO, NULL);
+	}
 }
 
-void NeoPixelAllOff(void){
-    rgb_led_t led;
-	ws2812bSendRet();
-	ws2812bSendRet();
-	ws2812bSendRet();
-	for (uint16_t i = 0; i < stripe_length; i++){
-		led.red = 0;
-		led.green = 0;
-		led.blue = 0;
-		ws2812bSend(led);
+void NeoPixelFrameRate(uint8_t fps){
+	TickType_t period;
+
+	if(fps == 0){
+		fps = NEOPIXEL_DEFAULT_FPS;
 	}
-	ws2812bSendRet();
+	period = pdMS_TO_TICKS(1000 / fps);
+	if(period == 0){
+		period = 1;
+	}
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	frame_period = period;
+	/* effects advance with the real frame rate, limited by the tick rate */
+	stripe_fps = configTICK_RATE_HZ / period;
+	xSemaphoreGive(stripe_mutex);
+}
+
+void NeoPixelAllOff(void){
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_NONE;
+	stripe_off = true;
+	stripe_dirty = true;
+	xSemaphoreGive(stripe_mutex);
 }
 
 void NeoPixelAllColor(neopixel_color_t color){
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_NONE;
 	for (uint16_t i = 0; i < stripe_length; i++){
 		stripe_colors[i] = color;
 	}
-	NeoPixelSetArray(stripe_colors);
+	stripe_off = false;
+	stripe_dirty = true;
+	xSemaphoreGive(stripe_mutex);
 }
 
 void NeoPixelSetPixel(uint16_t pixel, neopixel_color_t color){
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_NONE;
 	stripe_colors[pixel] = color;
-	NeoPixelSetArray(stripe_colors);
+	stripe_off = false;
+	stripe_dirty = true;
+	xSemaphoreGive(stripe_mutex);
 }
 
 void NeoPixelSetArray(neopixel_color_t *color_array){
-    rgb_led_t led;
-	uint16_t red, green, blue;
-	ws2812bSendRet();
-	ws2812bSendRet();
-	ws2812bSendRet();
-	for (uint16_t i = 0; i < stripe_length; i++){
-		red = ((color_array[i] & RED_MSK) >> RED_OFFSET) * stripe_bright;
-		green = ((color_array[i] & GREEN_MSK) >> GREEN_OFFSET) * stripe_bright;
-		blue = ((color_array[i] & BLUE_MSK) >> BLUE_OFFSET) * stripe_bright;
-		led.red = red >> BRIGHT_OFFSET;
-		led.green = green >> BRIGHT_OFFSET;
-		led.blue = blue >> BRIGHT_OFFSET;
-		ws2812bSend(led);
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_NONE;
+	if(color_array != stripe_colors){
+		for (uint16_t i = 0; i < stripe_length; i++){
+			stripe_colors[i] = color_array[i];
+		}
 	}
-	ws2812bSendRet();
+	stripe_off = false;
+	stripe_dirty = true;
+	xSemaphoreGive(stripe_mutex);
 }
 
 void NeoPixelShift(bool upwards){
 	neopixel_color_t carry;
 
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_NONE;
 	if(upwards){
 		carry = stripe_colors[stripe_length-1];
 		for (uint16_t i = 0; i < stripe_length-1; i++){
@@ -101,21 +288,76 @@ void NeoPixelShift(bool upwards){
 		}
 		stripe_colors[stripe_length-1] = carry;
 	}
-	NeoPixelSetArray(stripe_colors);
+	stripe_off = false;
+	stripe_dirty = true;
+	xSemaphoreGive(stripe_mutex);
 }
 
 void NeoPixelBrightness(uint8_t bright){
-	stripe_bright = bright;
-	NeoPixelSetArray(stripe_colors);
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	if(bright != stripe_bright){
+		stripe_bright = bright;
+		NeoPixelBuildLut();
+	}
+	stripe_off = false;
+	stripe_dirty = true;
+	xSemaphoreGive(stripe_mutex);
 }
 
 void NeoPixelRainbow(uint16_t first_hue, uint8_t sat, uint8_t val, uint8_t reps){
-	for (uint16_t i=0; i<stripe_length; i++) {
-		uint16_t hue = first_hue + (i * reps * 65536) / stripe_length;
-		neopixel_color_t color = NeoPixelHSV2Color(hue, sat, val);
-		stripe_colors[i] = color;
-  	}
-	NeoPixelSetArray(stripe_colors);
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_NONE;
+	NeoPixelRainbowFill((uint32_t)first_hue << Q16_SHIFT, sat, val, reps);
+	stripe_off = false;
+	stripe_dirty = true;
+	xSemaphoreGive(stripe_mutex);
+}
+
+void NeoPixelEffectRainbow(uint8_t sat, uint8_t val, uint8_t reps, uint16_t cycle_ms){
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_RAINBOW;
+	effect.pos_q16 = 0;
+	effect.rate = cycle_ms ? cycle_ms : 1;
+	effect.sat = sat;
+	effect.val = val;
+	effect.reps = reps;
+	stripe_off = false;
+	xSemaphoreGive(stripe_mutex);
+}
+
+void NeoPixelEffectFade(neopixel_color_t color, uint16_t duration_ms){
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_FADE;
+	effect.color = color;
+	effect.frames = ((uint32_t)duration_ms * stripe_fps) / 1000;
+	effect.elapsed = 0;
+	if((effect.frames == 0) || (fade_from == NULL)){
+		/* too short (or no memory for the start colors): straight to the target */
+		effect.frames = 1;
+	}else{
+		for (uint16_t i = 0; i < stripe_length; i++){
+			fade_from[i] = stripe_off ? 0 : stripe_colors[i];
+		}
+	}
+	stripe_off = false;
+	xSemaphoreGive(stripe_mutex);
+}
+
+void NeoPixelEffectChase(neopixel_color_t color, uint8_t tail, uint16_t speed){
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_CHASE;
+	effect.color = color;
+	effect.pos_q8 = 0;
+	effect.rate = speed;
+	effect.tail = tail;
+	stripe_off = false;
+	xSemaphoreGive(stripe_mutex);
+}
+
+void NeoPixelEffectStop(void){
+	xSemaphoreTake(stripe_mutex, portMAX_DELAY);
+	effect.type = EFFECT_NONE;
+	xSemaphoreGive(stripe_mutex);
 }
 
 neopixel_color_t NeoPixelRgb2Color(uint8_t red, uint8_t green, uint8_t blue){
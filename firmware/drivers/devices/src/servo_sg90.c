@@ -6,10 +6,9 @@
 #define SERVO_FREQ 	50
 #define MIN_ANG		-90
 #define MAX_ANG		90
-#define ANG_RANGE	180.0
-#define PERIOD_MS   20.0
-#define PULSEW_MS   1.0
-#define PERCENT   	100.0
+#define ANG_RANGE	180
+#define PERIOD_US   20000
+#define PULSEW_US   1000
 /*==================[internal data declaration]==============================*/
 
 /*==================[internal functions declaration]=========================*/
@@ -19,14 +18,15 @@
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
-uint8_t Angle2DutyCicle(int8_t angle){
-	static float h_time;
-	static float duty_cicle;
-	static int16_t deg;
-	deg = 2 * angle + MAX_ANG;	// NOTE: adjusted (angle x 2) for the available servos
-	h_time = (float)(deg/ANG_RANGE) + PULSEW_MS;
-	duty_cicle = (float)(h_time/PERIOD_MS) * PERCENT;
-	return (uint8_t) duty_cicle;
+/**
+ * @brief Duty cycle for an angle, as a Q16 fraction of the period
+ * 
+ * @note At 50 Hz the PWM runs with 20 bits, so every degree maps to a different pulse width.
+ */
+uint32_t Angle2DutyCicle(int8_t angle){
+	int32_t deg = 2 * angle + MAX_ANG;	// NOTE: adjusted (angle x 2) for the available servos
+	int32_t h_time = (deg * PULSEW_US) / ANG_RANGE + PULSEW_US;
+	return (uint32_t)(((uint64_t)h_time * PWM_Q16_ONE) / PERIOD_US);
 }
 /*==================[external functions definition]==========================*/
 
@@ -49,7 +49,7 @@ uint8_t ServoInit(servo_out_t servo, gpio_t gpio){
 }
 
 void ServoMove(servo_out_t servo, int8_t ang){
-	static uint8_t dc;
+	uint32_t dc;
 	if(ang < MIN_ANG){
 		ang = MIN_ANG;
 	} else if(ang > MAX_ANG){
@@ -58,16 +58,16 @@ void ServoMove(servo_out_t servo, int8_t ang){
 	dc = Angle2DutyCicle(ang);
 	switch(servo){
 		case SERVO_0:
-			PWMSetDutyCycle(PWM_0, dc);
+			PWMSetDutyQ16(PWM_0, dc);
 			break;
 		case SERVO_1:
-			PWMSetDutyCycle(PWM_1, dc);
+			PWMSetDutyQ16(PWM_1, dc);
 			break;
 		case SERVO_2:
-			PWMSetDutyCycle(PWM_2, dc);
+			PWMSetDutyQ16(PWM_2, dc);
 			break;
 		case SERVO_3:
-			PWMSetDutyCycle(PWM_3, dc);
+			PWMSetDutyQ16(PWM_3, dc);
 			break;
 	}
 }
@@ -12,18 +12,114 @@
 /*==================[inclusions]=============================================*/
 #include "switch.h"
 #include "gpio_mcu.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_attr.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "host_board.h"
+#else
+#include "esp_timer.h"
+#endif
 /*==================[macros and definitions]=================================*/
+#if CONFIG_IDF_TARGET_LINUX
+#define SWITCH_CLOCK_MS()	((uint32_t)(HostClockUs() / 1000))			/*!< Virtual board clock */
+#else
+#define SWITCH_CLOCK_MS()	((uint32_t)(esp_timer_get_time() / 1000))	/*!<  */
+#endif
 #define GPIO_SWITCH1 GPIO_4
 #define GPIO_SWITCH2 GPIO_15
+#define SWITCH_QTY			2
+#define EDGE_QUEUE_LEN		32		/*!< Raw edges, a bouncing contact gives a few per press */
+#define SWITCH_TASK_STACK	2048
+#define SWITCH_TASK_PRIO	10
 /*==================[internal data declaration]==============================*/
-
+/**
+ * @brief Raw edge captured by the ISR
+ */
+typedef struct {
+	uint8_t index;		/*!< Switch index */
+	bool pressed;		/*!< Level after the edge */
+	uint32_t time_ms;	/*!< Time of the edge */
+} switch_edge_t;
 /*==================[internal functions declaration]=========================*/
-
+static void SwitchEdgeIsr(void *param);
+static void SwitchEmit(switch_event_type_t type, uint32_t time_ms, void *param);
+static void SwitchServiceTask(void *param);
 /*==================[internal data definition]===============================*/
-
+static const gpio_t switch_gpio[SWITCH_QTY] = {GPIO_SWITCH1, GPIO_SWITCH2};
+static switch_fsm_t switch_fsm[SWITCH_QTY];
+static QueueHandle_t edge_queue = NULL;
+static QueueHandle_t event_queue = NULL;
+static volatile bool edges_lost = false;	/*!< Edge queue overflowed, levels must be re-read */
+static void (*event_func_p)(switch_event_t *, void *) = NULL;
+static void *event_param_p = NULL;
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static void IRAM_ATTR SwitchEdgeIsr(void *param){
+	BaseType_t woken = pdFALSE;
+	switch_edge_t edge = {
+		.index = (uint8_t)(uintptr_t)param,
+		.time_ms = SWITCH_CLOCK_MS(),
+	};
+	/* switches are active low */
+	edge.pressed = !(GPIOReadMask() & GPIO_MASK(switch_gpio[edge.index]));
+	if(xQueueSendFromISR(edge_queue, &edge, &woken) != pdTRUE){
+		edges_lost = true;
+	}
+	if(woken){
+		portYIELD_FROM_ISR();
+	}
+}
+
+/**
+ * @brief Called by the state machines (in the service task) for each event
+ */
+static void SwitchEmit(switch_event_type_t type, uint32_t time_ms, void *param){
+	switch_event_t event = {
+		.sw = (switch_t)(1 << (uintptr_t)param),
+		.type = type,
+		.time_ms = time_ms,
+	};
+	switch_event_t dropped;
+	if(event_func_p != NULL){
+		event_func_p(&event, event_param_p);
+	}
+	if(xQueueSend(event_queue, &event, 0) != pdTRUE){
+		/* keep the newest events */
+		xQueueReceive(event_queue, &dropped, 0);
+		xQueueSend(event_queue, &event, 0);
+	}
+}
+
+static void SwitchServiceTask(void *param){
+	switch_edge_t edge;
+	TickType_t wait = portMAX_DELAY;
+	uint32_t now, next, remaining;
+	while(1){
+		if(xQueueReceive(edge_queue, &edge, wait) == pdTRUE){
+			do{
+				SwitchFsmEdge(&switch_fsm[edge.index], edge.pressed, edge.time_ms);
+			} while(xQueueReceive(edge_queue, &edge, 0) == pdTRUE);
+		}
+		now = SWITCH_CLOCK_MS();
+		if(edges_lost){
+			/* resync with the current levels, the debounce time covers the gap */
+			edges_lost = false;
+			for(uint8_t i = 0; i < SWITCH_QTY; i++){
+				SwitchFsmEdge(&switch_fsm[i], !(GPIOReadMask() & GPIO_MASK(switch_gpio[i])), now);
+			}
+		}
+		next = SWITCH_FSM_NO_DEADLINE;
+		for(uint8_t i = 0; i < SWITCH_QTY; i++){
+			remaining = SwitchFsmUpdate(&switch_fsm[i], now, SwitchEmit, (void *)(uintptr_t)i);
+			next = (remaining < next) ? remaining : next;
+		}
+		/* one extra tick so the deadline has passed when the task wakes up */
+		wait = (next == SWITCH_FSM_NO_DEADLINE) ? portMAX_DELAY : pdMS_TO_TICKS(next) + 1;
+	}
+}
 
 /*==================[external functions definition]==========================*/
 int8_t SwitchesInit(void){
@@ -44,6 +140,41 @@ int8_t SwitchesRead(void){
 	return mask;
 }
 
+int8_t SwitchServiceInit(switch_service_config_t *config){
+	switch_fsm_config_t timing = {
+		.debounce_ms = SWITCH_DEBOUNCE_MS,
+		.double_click_ms = SWITCH_DOUBLE_CLICK_MS,
+		.long_press_ms = SWITCH_LONG_PRESS_MS,
+	};
+	if(edge_queue != NULL){
+		return -1;
+	}
+	if(config != NULL){
+		timing.debounce_ms = config->debounce_ms;
+		timing.double_click_ms = config->double_click_ms;
+		timing.long_press_ms = config->long_press_ms;
+		event_func_p = config->func_p;
+		event_param_p = config->param_p;
+	}
+	edge_queue = xQueueCreate(EDGE_QUEUE_LEN, sizeof(switch_edge_t));
+	event_queue = xQueueCreate(SWITCH_EVENT_QUEUE_LEN, sizeof(switch_event_t));
+	for(uint8_t i = 0; i < SWITCH_QTY; i++){
+		SwitchFsmInit(&switch_fsm[i], &timing, !(GPIOReadMask() & GPIO_MASK(switch_gpio[i])));
+	}
+	xTaskCreate(SwitchServiceTask, "switch_service", SWITCH_TASK_STACK, NULL, SWITCH_TASK_PRIO, NULL);
+	for(uint8_t i = 0; i < SWITCH_QTY; i++){
+		GPIOActivIntAnyEdge(switch_gpio[i], SwitchEdgeIsr, (void *)(uintptr_t)i);
+	}
+	return 0;
+}
+
+bool SwitchWaitEvent(switch_event_t *event, uint32_t timeout_ms){
+	if(event_queue == NULL){
+		return false;
+	}
+	return xQueueReceive(event_queue, event, (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
 void SwitchActivInt(switch_t sw, void *ptr_int_func, void *args){
 	switch(sw){
 		case SWITCH_1:
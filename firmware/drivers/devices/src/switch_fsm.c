@@ -0,0 +1,162 @@
+/**
+ * @file switch_fsm.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "switch_fsm.h"
+#include <stddef.h>
+/*==================[macros and definitions]=================================*/
+/**
+ * @brief Gesture states
+ */
+enum {
+	FSM_IDLE,				/*!< Released, no gesture in progress */
+	FSM_PRESSED,			/*!< First press, may become click, double click or long press */
+	FSM_LONG,				/*!< Long press reported, waiting release */
+	FSM_WAIT_SECOND,		/*!< Released after a short press, waiting a second one */
+	FSM_SECOND_PRESSED,		/*!< Second press */
+};
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Process the gesture timeouts expired at a given time
+ */
+static void SwitchFsmTimeouts(switch_fsm_t *fsm, uint32_t time_ms, switch_fsm_emit_t emit, void *param){
+	switch(fsm->state){
+		case FSM_PRESSED:
+		case FSM_SECOND_PRESSED:
+			if(fsm->config.long_press_ms && ((time_ms - fsm->press_time) >= fsm->config.long_press_ms)){
+				if(fsm->state == FSM_SECOND_PRESSED){
+					/* the first press was a click after all */
+					emit(SWITCH_EVENT_CLICK, fsm->release_time, param);
+				}
+				emit(SWITCH_EVENT_LONG_PRESS, fsm->press_time + fsm->config.long_press_ms, param);
+				fsm->state = FSM_LONG;
+			}
+		break;
+		case FSM_WAIT_SECOND:
+			if((time_ms - fsm->release_time) >= fsm->config.double_click_ms){
+				emit(SWITCH_EVENT_CLICK, fsm->release_time, param);
+				fsm->state = FSM_IDLE;
+			}
+		break;
+		default:
+		break;
+	}
+}
+
+static void SwitchFsmPressed(switch_fsm_t *fsm, uint32_t time_ms, switch_fsm_emit_t emit, void *param){
+	emit(SWITCH_EVENT_PRESS, time_ms, param);
+	fsm->press_time = time_ms;
+	fsm->state = (fsm->state == FSM_WAIT_SECOND) ? FSM_SECOND_PRESSED : FSM_PRESSED;
+}
+
+static void SwitchFsmReleased(switch_fsm_t *fsm, uint32_t time_ms, switch_fsm_emit_t emit, void *param){
+	emit(SWITCH_EVENT_RELEASE, time_ms, param);
+	fsm->release_time = time_ms;
+	switch(fsm->state){
+		case FSM_PRESSED:
+			if(fsm->config.double_click_ms){
+				fsm->state = FSM_WAIT_SECOND;
+			} else {
+				emit(SWITCH_EVENT_CLICK, time_ms, param);
+				fsm->state = FSM_IDLE;
+			}
+		break;
+		case FSM_SECOND_PRESSED:
+			emit(SWITCH_EVENT_DOUBLE_CLICK, time_ms, param);
+			fsm->state = FSM_IDLE;
+		break;
+		default:
+			fsm->state = FSM_IDLE;
+		break;
+	}
+}
+
+static uint32_t SwitchFsmRemaining(uint32_t start, uint32_t timeout, uint32_t time_ms){
+	uint32_t elapsed = time_ms - start;
+	return (elapsed >= timeout) ? 0 : (timeout - elapsed);
+}
+/*==================[external functions definition]==========================*/
+void SwitchFsmInit(switch_fsm_t *fsm, const switch_fsm_config_t *config, bool pressed){
+	fsm->config = *config;
+	/* a switch held at start up does not make a press */
+	fsm->state = pressed ? FSM_LONG : FSM_IDLE;
+	fsm->level = pressed;
+	fsm->raw_level = pressed;
+	fsm->bouncing = false;
+	fsm->edge_time = 0;
+	fsm->raw_time = 0;
+	fsm->press_time = 0;
+	fsm->release_time = 0;
+}
+
+void SwitchFsmEdge(switch_fsm_t *fsm, bool pressed, uint32_t time_ms){
+	if(!fsm->bouncing){
+		fsm->bouncing = true;
+		fsm->edge_time = time_ms;
+	}
+	fsm->raw_level = pressed;
+	fsm->raw_time = time_ms;
+}
+
+uint32_t SwitchFsmUpdate(switch_fsm_t *fsm, uint32_t time_ms, switch_fsm_emit_t emit, void *param){
+	uint32_t next = SWITCH_FSM_NO_DEADLINE;
+	uint32_t remaining;
+
+	if(fsm->bouncing){
+		remaining = SwitchFsmRemaining(fsm->raw_time, fsm->config.debounce_ms, time_ms);
+		if(remaining == 0){
+			fsm->bouncing = false;
+			if(fsm->raw_level != fsm->level){
+				/* timeouts that expired before the burst go first */
+				SwitchFsmTimeouts(fsm, fsm->edge_time, emit, param);
+				fsm->level = fsm->raw_level;
+				if(fsm->level){
+					SwitchFsmPressed(fsm, fsm->edge_time, emit, param);
+				} else {
+					SwitchFsmReleased(fsm, fsm->edge_time, emit, param);
+				}
+			}
+		} else {
+			next = remaining;
+		}
+	}
+	if(fsm->bouncing){
+		/* a press in the burst may still turn a click into a double click: wait for it */
+		SwitchFsmTimeouts(fsm, fsm->edge_time, emit, param);
+		return next;
+	}
+	SwitchFsmTimeouts(fsm, time_ms, emit, param);
+
+	switch(fsm->state){
+		case FSM_PRESSED:
+		case FSM_SECOND_PRESSED:
+			if(fsm->config.long_press_ms){
+				next = SwitchFsmRemaining(fsm->press_time, fsm->config.long_press_ms, time_ms);
+			}
+		break;
+		case FSM_WAIT_SECOND:
+			next = SwitchFsmRemaining(fsm->release_time, fsm->config.double_click_ms, time_ms);
+		break;
+		default:
+		break;
+	}
+	return next;
+}
+
+/*==================[end of file]============================================*/
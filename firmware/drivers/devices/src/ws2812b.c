@@ -14,14 +14,55 @@
 #include "gpio_mcu.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "gpio_fast_out_mcu.h"
 #include "delay_mcu.h"
+#include "driver/rmt_tx.h"
+#include "esp_heap_caps.h"
+#include <stdlib.h>
 /*==================[macros and definitions]=================================*/
 #define RET_CMD (50)    // ret command 50us low
 #define BIT_0   (1)     // bit 0
 #define BIT_7   (1<<7)  // bit 0
+
+#define RMT_RESOLUTION_HZ   10000000    /*!< 10MHz RMT tick (0.1us) */
+#define T0H_TICKS           3           /*!< bit 0: 0.3us high */
+#define T0L_TICKS           9           /*!< bit 0: 0.9us low */
+#define T1H_TICKS           9           /*!< bit 1: 0.9us high */
+#define T1L_TICKS           3           /*!< bit 1: 0.3us low */
+#define RET_TICKS           ((RMT_RESOLUTION_HZ / 1000000) * RET_CMD / 2)   /*!< ret command split in two halves */
+#define RMT_MEM_SYMBOLS     (2 * SOC_RMT_MEM_WORDS_PER_CHANNEL)   /*!< ping-pong memory, 2 LEDs per half */
+#define RMT_QUEUE_DEPTH     2           /*!< frames queued in the RMT driver */
+#define FRAME_BUFFERS       2           /*!< double buffer: one in flight, one being filled */
+#define BYTES_PER_LED       3
 /*==================[internal data declaration]==============================*/
 gpio_t pin_number;
+/**
+ * @brief Frame buffer used by the RMT backend
+ */
+typedef struct {
+    uint8_t *data;                  /*!< GRB bytes, already gamma corrected */
+    volatile bool busy;             /*!< Frame queued or being transmitted */
+    ws2812b_done_t func_p;          /*!< Completion callback for this frame */
+    void *param_p;                  /*!< Completion callback parameter */
+} ws2812b_frame_t;
+/**
+ * @brief RMT encoder: GRB bytes followed by the ret command
+ */
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_t *bytes_encoder;
+    rmt_encoder_t *copy_encoder;
+    uint8_t state;
+    rmt_symbol_word_t ret_symbol;
+} ws2812b_encoder_t;
+static rmt_channel_handle_t rmt_channel = NULL;
+static rmt_encoder_handle_t rmt_encoder = NULL;
+static ws2812b_frame_t frames[FRAME_BUFFERS];
+static uint8_t frame_fill = 0;      /*!< Buffer returned by ws2812bFrameBuffer */
+static uint8_t frame_done = 0;      /*!< Oldest buffer in flight */
+static uint16_t frame_length = 0;   /*!< Frame length in bytes */
+static SemaphoreHandle_t frame_free = NULL;
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -326,6 +367,87 @@ void IRAM_ATTR ws2812bSendLow(gpio_t pin){
     __asm__ __volatile__ ("nop");   // 94
 }
 
+static size_t IRAM_ATTR ws2812bEncode(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                                      const void *data, size_t data_size, rmt_encode_state_t *ret_state){
+    ws2812b_encoder_t *ws_encoder = __containerof(encoder, ws2812b_encoder_t, base);
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+    switch(ws_encoder->state){
+        case 0:     // GRB data
+            encoded_symbols += ws_encoder->bytes_encoder->encode(ws_encoder->bytes_encoder, channel, data, data_size, &session_state);
+            if(session_state & RMT_ENCODING_COMPLETE){
+                ws_encoder->state = 1;
+            }
+            if(session_state & RMT_ENCODING_MEM_FULL){
+                state |= RMT_ENCODING_MEM_FULL;
+                break;  // wait for the next ping-pong half
+            }
+            // fall-through
+        case 1:     // ret command
+            encoded_symbols += ws_encoder->copy_encoder->encode(ws_encoder->copy_encoder, channel, &ws_encoder->ret_symbol,
+                                                                sizeof(ws_encoder->ret_symbol), &session_state);
+            if(session_state & RMT_ENCODING_COMPLETE){
+                ws_encoder->state = 0;
+                state |= RMT_ENCODING_COMPLETE;
+            }
+            if(session_state & RMT_ENCODING_MEM_FULL){
+                state |= RMT_ENCODING_MEM_FULL;
+            }
+            break;
+    }
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+static esp_err_t ws2812bEncoderReset(rmt_encoder_t *encoder){
+    ws2812b_encoder_t *ws_encoder = __containerof(encoder, ws2812b_encoder_t, base);
+    rmt_encoder_reset(ws_encoder->bytes_encoder);
+    rmt_encoder_reset(ws_encoder->copy_encoder);
+    ws_encoder->state = 0;
+    return ESP_OK;
+}
+
+static esp_err_t ws2812bEncoderDel(rmt_encoder_t *encoder){
+    ws2812b_encoder_t *ws_encoder = __containerof(encoder, ws2812b_encoder_t, base);
+    rmt_del_encoder(ws_encoder->bytes_encoder);
+    rmt_del_encoder(ws_encoder->copy_encoder);
+    free(ws_encoder);
+    return ESP_OK;
+}
+
+static void ws2812bNewEncoder(rmt_encoder_handle_t *ret_encoder){
+    ws2812b_encoder_t *ws_encoder = calloc(1, sizeof(ws2812b_encoder_t));
+    ws_encoder->base.encode = ws2812bEncode;
+    ws_encoder->base.reset = ws2812bEncoderReset;
+    ws_encoder->base.del = ws2812bEncoderDel;
+    rmt_bytes_encoder_config_t bytes_config = {
+        .bit0 = {.level0 = 1, .duration0 = T0H_TICKS, .level1 = 0, .duration1 = T0L_TICKS},
+        .bit1 = {.level0 = 1, .duration0 = T1H_TICKS, .level1 = 0, .duration1 = T1L_TICKS},
+        .flags.msb_first = 1,
+    };
+    ESP_ERROR_CHECK(rmt_new_bytes_encoder(&bytes_config, &ws_encoder->bytes_encoder));
+    rmt_copy_encoder_config_t copy_config = {};
+    ESP_ERROR_CHECK(rmt_new_copy_encoder(&copy_config, &ws_encoder->copy_encoder));
+    ws_encoder->ret_symbol = (rmt_symbol_word_t){
+        .level0 = 0, .duration0 = RET_TICKS,
+        .level1 = 0, .duration1 = RET_TICKS,
+    };
+    *ret_encoder = &ws_encoder->base;
+}
+
+static bool IRAM_ATTR ws2812bTransDone(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata, void *user_ctx){
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    ws2812b_frame_t *frame = &frames[frame_done];
+    frame_done = (frame_done + 1) % FRAME_BUFFERS;
+    frame->busy = false;
+    if(frame->func_p != NULL){
+        frame->func_p(frame->param_p);
+    }
+    xSemaphoreGiveFromISR(frame_free, &xHigherPriorityTaskWoken);
+    return (xHigherPriorityTaskWoken == pdTRUE);
+}
+
 uint8_t ws2812bGammaCorrection(uint8_t component){
     return gamma_table[component];
 }
@@ -373,4 +495,56 @@ void ws2812bSendRet(void){
     DelayUs(RET_CMD);
 }
 
+void ws2812bFrameInit(gpio_t pin, uint16_t len){
+    pin_number = pin;
+    frame_length = len * BYTES_PER_LED;
+    for(uint8_t i = 0; i < FRAME_BUFFERS; i++){
+        frames[i].data = heap_caps_calloc(frame_length, sizeof(uint8_t), MALLOC_CAP_INTERNAL);
+        frames[i].busy = false;
+    }
+    frame_fill = 0;
+    frame_done = 0;
+    frame_free = xSemaphoreCreateBinary();
+    rmt_tx_channel_config_t tx_config = {
+        .gpio_num = pin,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = RMT_RESOLUTION_HZ,
+        .mem_block_symbols = RMT_MEM_SYMBOLS,
+        .trans_queue_depth = RMT_QUEUE_DEPTH,
+#if SOC_RMT_SUPPORT_DMA
+        .flags.with_dma = true,
+#endif
+    };
+    ESP_ERROR_CHECK(rmt_new_tx_channel(&tx_config, &rmt_channel));
+    ws2812bNewEncoder(&rmt_encoder);
+    rmt_tx_event_callbacks_t tx_callbacks = {
+        .on_trans_done = ws2812bTransDone,
+    };
+    rmt_tx_register_event_callbacks(rmt_channel, &tx_callbacks, NULL);
+    ESP_ERROR_CHECK(rmt_enable(rmt_channel));
+}
+
+uint8_t * ws2812bFrameBuffer(void){
+    while(frames[frame_fill].busy){
+        xSemaphoreTake(frame_free, portMAX_DELAY);
+    }
+    return frames[frame_fill].data;
+}
+
+void ws2812bFrameSend(ws2812b_done_t func_p, void *param_p){
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+    };
+    ws2812b_frame_t *frame = &frames[frame_fill];
+    frame->func_p = func_p;
+    frame->param_p = param_p;
+    frame->busy = true;
+    frame_fill = (frame_fill + 1) % FRAME_BUFFERS;
+    rmt_transmit(rmt_channel, rmt_encoder, frame->data, frame_length, &tx_config);
+}
+
+void ws2812bFrameWait(void){
+    rmt_tx_wait_all_done(rmt_channel, portMAX_DELAY);
+}
+
 /*==================[end of file]============================================*/
@@ -0,0 +1,98 @@
+/**
+ * @file ws2812b_parallel.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-19
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "ws2812b_parallel.h"
+#include "ws2812b.h"
+#include "sdkconfig.h"
+#include "gpio_fast_out_mcu.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include <stdlib.h>
+/*==================[macros and definitions]=================================*/
+#define BYTES_PER_LED   3
+#define GREEN_BYTE      0
+#define RED_BYTE        1
+#define BLUE_BYTE       2
+#define NS2CYCLES(ns)   ((CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * (ns)) / 1000)
+#define T0H_CYCLES      NS2CYCLES(350)      /*!< bit 0: high time */
+#define T1H_CYCLES      NS2CYCLES(800)      /*!< bit 1: high time */
+#define TBIT_CYCLES     NS2CYCLES(1250)     /*!< bit period */
+#define RET_US          300                 /*!< ret command (low), newer WS2812B need > 280us */
+/*==================[internal data declaration]==============================*/
+static uint8_t lane_count = 0;
+static uint16_t lane_bytes = 0;
+static uint8_t *lane_frames[WS2812B_MAX_LANES];
+static uint8_t *bit_slots = NULL;
+static uint16_t lanes_mask = 0;
+static portMUX_TYPE ws2812b_spinlock = portMUX_INITIALIZER_UNLOCKED;
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Clock out the bit slots on the bundle. Every slot starts with all lanes
+ * high, lanes sending a 0 go low at T0H and the rest at T1H.
+ */
+static void IRAM_ATTR ws2812bParallelClockOut(const uint8_t *slots, uint32_t slot_qty){
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (uint32_t i = 0; i < slot_qty; i++){
+        uint16_t ones = slots[i];
+        while((esp_cpu_get_cycle_count() - start) < TBIT_CYCLES);
+        start = esp_cpu_get_cycle_count();
+        GPIOFastWriteMask(lanes_mask, lanes_mask);
+        while((esp_cpu_get_cycle_count() - start) < T0H_CYCLES);
+        GPIOFastWriteMask(lanes_mask & ~ones, 0);
+        while((esp_cpu_get_cycle_count() - start) < T1H_CYCLES);
+        GPIOFastWriteMask(lanes_mask, 0);
+    }
+}
+/*==================[external functions definition]==========================*/
+void ws2812bParallelInit(gpio_t *pin_list, uint8_t lane_qty, uint16_t len){
+    if(lane_qty > WS2812B_MAX_LANES){
+        lane_qty = WS2812B_MAX_LANES;
+    }
+    lane_count = lane_qty;
+    lane_bytes = len * BYTES_PER_LED;
+    lanes_mask = (1 << lane_qty) - 1;
+    for (uint8_t n = 0; n < lane_qty; n++){
+        lane_frames[n] = calloc(lane_bytes, sizeof(uint8_t));
+    }
+    bit_slots = malloc(8 * lane_bytes);
+    GPIOFastInit(pin_list, lane_qty);
+    GPIOFastWrite(0);
+}
+
+uint8_t * ws2812bParallelBuffer(uint8_t lane){
+    return lane_frames[lane];
+}
+
+void ws2812bParallelSetLed(uint8_t lane, uint16_t led, uint8_t red, uint8_t green, uint8_t blue){
+    uint8_t *frame = lane_frames[lane] + led * BYTES_PER_LED;
+    frame[GREEN_BYTE] = ws2812bGammaCorrection(green);
+    frame[RED_BYTE] = ws2812bGammaCorrection(red);
+    frame[BLUE_BYTE] = ws2812bGammaCorrection(blue);
+}
+
+void ws2812bParallelSend(void){
+    ws2812bParallelTranspose((const uint8_t *const *)lane_frames, lane_count, lane_bytes, bit_slots);
+    portENTER_CRITICAL(&ws2812b_spinlock);
+    ws2812bParallelClockOut(bit_slots, 8 * lane_bytes);
+    portEXIT_CRITICAL(&ws2812b_spinlock);
+    esp_rom_delay_us(RET_US);
+}
+
+/*==================[end of file]============================================*/
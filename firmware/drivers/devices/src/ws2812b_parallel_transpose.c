@@ -0,0 +1,53 @@
+/**
+ * @file ws2812b_parallel_transpose.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Bit transpose of the parallel WS2812B driver, hardware independent (see ws2812b_parallel.h)
+ * @version 0.1
+ * @date 2026-10-19
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "ws2812b_parallel.h"
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+void ws2812bParallelTranspose(const uint8_t *const *lanes, uint8_t lane_qty, uint16_t len, uint8_t *slots){
+    uint64_t block, t;
+
+    if(lane_qty > WS2812B_MAX_LANES){
+        lane_qty = WS2812B_MAX_LANES;
+    }
+    for (uint16_t k = 0; k < len; k++){
+        /* byte k of lane n in row n of an 8x8 bit matrix */
+        block = 0;
+        for (uint8_t n = 0; n < lane_qty; n++){
+            block |= (uint64_t)lanes[n][k] << (8 * n);
+        }
+        /* 8x8 bit matrix transpose (Hacker's Delight, transpose8) */
+        t = (block ^ (block >> 7)) & 0x00AA00AA00AA00AAULL;
+        block = block ^ t ^ (t << 7);
+        t = (block ^ (block >> 14)) & 0x0000CCCC0000CCCCULL;
+        block = block ^ t ^ (t << 14);
+        t = (block ^ (block >> 28)) & 0x00000000F0F0F0F0ULL;
+        block = block ^ t ^ (t << 28);
+        /* row b now holds bit b of every lane, send MSB first */
+        for (uint8_t b = 0; b < 8; b++){
+            slots[8 * k + b] = (block >> (8 * (7 - b))) & 0xFF;
+        }
+    }
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,243 @@
+#ifndef HOST_BOARD_H
+#define HOST_BOARD_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Host_Board Host_Board
+ ** @{ */
+
+/** \brief Virtual ESP-EDU board: Linux backend of the microcontroller drivers.
+ *
+ * When the project is built for the linux target (idf.py --preview set-target linux) the
+ * drivers in microcontroller/src are replaced by the ones in microcontroller/host/src, which
+ * run on the FreeRTOS POSIX port and are driven by this module:
+ * - A simulated clock, running time_scale times faster than real time. Timers, soft timers,
+ * delays, ADC frames and the waveform generator follow it.
+ * - Signal sources for the ADC inputs and scripts for the GPIO inputs (the registered
+ * interrupt callbacks are called on every edge).
+ * - UART and BLE output captured to files, and data injection for their inputs.
+ *
+ * The simulated hardware is updated by a board task every FreeRTOS tick, so "interrupt"
+ * callbacks are called from that task, late by up to one tick (times time_scale) and
+ * in bursts to catch up. vTaskDelay() is not scaled: applications paced by timers,
+ * delays or ADC frames keep their timing, the ones paced by vTaskDelay() don't.
+ *
+ * Besides the microcontroller drivers, led, switch, servo_sg90 and buzzer are available,
+ * so P2_4_Osciloscopio, examen and Proyecto_integrador build as Linux executables:
+ * @code
+ * cd firmware/projects/examen
+ * idf.py --preview set-target linux
+ * idf.py build
+ * ./build/Control_irrigacion_planta.elf
+ * @endcode
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 19/10/2026 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio_mcu.h"
+#include "uart_mcu.h"
+#include "analog_io_mcu.h"
+#include "pwm_mcu.h"
+/*==================[macros]=================================================*/
+#define HOST_ADC_FULL_SCALE_MV	3300	/*!< Input voltage of the maximum raw value */
+#define HOST_ADC_MAX_RAW		4095	/*!< 12 bit conversions */
+/*==================[typedef]================================================*/
+/**
+ * @brief Virtual board configuration struct
+ */
+typedef struct {
+	uint32_t time_scale;		/*!< Simulated time per real time (0 or 1: real time) */
+	const char *uart_pc_file;	/*!< Capture file of UART_PC output (NULL: stdout) */
+	const char *uart_conn_file;	/*!< Capture file of UART_CONNECTOR output (NULL: discarded) */
+	const char *ble_file;		/*!< Capture file of BLE output (NULL: discarded) */
+	const char *dac_file;		/*!< Capture of the analog output as "time_us,value" lines (NULL: not captured) */
+} host_board_config_t;
+
+/**
+ * @brief Signal source waveforms
+ */
+typedef enum host_signal_type {
+	HOST_SIGNAL_CONST,			/*!< offset_mv */
+	HOST_SIGNAL_SINE,			/*!< offset_mv + amplitude_mv * sin(2 pi freq t) */
+	HOST_SIGNAL_SQUARE,			/*!< offset_mv +/- amplitude_mv, 50 % duty */
+	HOST_SIGNAL_RAMP,			/*!< offset_mv - amplitude_mv to offset_mv + amplitude_mv, then restart */
+	HOST_SIGNAL_TABLE,			/*!< table samples (mV) played at table_rate, in loop */
+} host_signal_type_t;
+
+/**
+ * @brief Signal source of an ADC input
+ */
+typedef struct {
+	host_signal_type_t type;	/*!< Waveform */
+	uint16_t offset_mv;			/*!< Mean value */
+	uint16_t amplitude_mv;		/*!< Peak value around offset_mv */
+	float freq;					/*!< Frequency (Hz) */
+	uint16_t noise_mv;			/*!< Peak of the uniform noise added (0: none) */
+	const uint16_t *table;		/*!< Samples in mV (HOST_SIGNAL_TABLE only) */
+	uint32_t length;			/*!< Number of samples in table */
+	uint32_t table_rate;		/*!< Samples per second of table */
+} host_signal_t;
+
+/**
+ * @brief Step of a GPIO input script
+ */
+typedef struct {
+	uint32_t time_ms;			/*!< Simulated time of the change, from HostGpioScript() */
+	gpio_t pin;					/*!< GPIO */
+	bool level;					/*!< New input level */
+} host_gpio_step_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Virtual board initialization (call it before any driver)
+ * @param config Configuration struct (NULL: real time, UART_PC to stdout, nothing else captured)
+ */
+void HostBoardInit(const host_board_config_t *config);
+
+/**
+ * @brief Simulated time
+ * @return int64_t us since HostBoardInit()
+ */
+int64_t HostClockUs(void);
+
+/**
+ * @brief Block the calling task for a simulated time
+ * @param us Time to wait (us)
+ */
+void HostClockWaitUs(uint64_t us);
+
+/**
+ * @brief Set the signal source of an ADC input (all of them start at 0 mV)
+ * @param channel ADC input
+ * @param signal Signal source (copied, a table must remain valid)
+ */
+void HostAdcSetSignal(adc_ch_t channel, const host_signal_t *signal);
+
+/**
+ * @brief Raw conversion of an ADC input at a given time
+ * @param channel ADC input
+ * @param time_us Simulated time
+ * @return uint16_t Raw value (0 to HOST_ADC_MAX_RAW)
+ */
+uint16_t HostAdcSample(adc_ch_t channel, int64_t time_us);
+
+/**
+ * @brief Change the level of a GPIO input now
+ * @note Inputs start high (pull-up), so switches are pressed with false.
+ * @param pin GPIO
+ * @param level New level
+ */
+void HostGpioSetInput(gpio_t pin, bool level);
+
+/**
+ * @brief Play a script of GPIO input changes
+ * @note Steps must be sorted by time. The script replaces the one being played.
+ * @param steps Array of steps (must remain valid while played)
+ * @param qty Number of steps
+ */
+void HostGpioScript(const host_gpio_step_t *steps, uint16_t qty);
+
+/**
+ * @brief Check if a GPIO script is being played
+ * @return true if steps are pending
+ */
+bool HostGpioScriptRunning(void);
+
+/**
+ * @brief Feed bytes to the input of a serial port
+ * @note The port callback (if any) is called from the calling task.
+ * @param port Serial port
+ * @param data Bytes received
+ * @param length Number of bytes
+ * @return uint16_t Number of bytes accepted
+ */
+uint16_t HostUartInject(uart_mcu_port_t port, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief Simulate the connection of a BLE client
+ * @param connected New state (true after BleInit() by default)
+ */
+void HostBleConnect(bool connected);
+
+/**
+ * @brief Feed data received from the BLE client
+ * @note The read callback (if any) is called from the calling task.
+ * @param data Bytes received
+ * @param length Number of bytes
+ */
+void HostBleInject(const uint8_t *data, uint8_t length);
+
+/**
+ * @brief Current state of an PWM output
+ * @param out PWM output
+ * @param freq Where the frequency (Hz) is stored (NULL if not required)
+ * @return uint32_t Duty cycle (0 to PWM_Q16_ONE, 0 when paused)
+ */
+uint32_t HostPwmDutyQ16(pwm_out_t out, uint32_t *freq);
+
+/**
+ * @brief Last value written to the analog output (AnalogOutputWrite() or waveform generator)
+ * @return uint8_t Output value (0 to 255)
+ */
+uint8_t HostDacValue(void);
+
+/* Backend interface: used by the host drivers only */
+/**
+ * @brief Serialize access to the simulated hardware (recursive)
+ */
+void HostBoardLock(void);
+
+/**
+ * @brief Release the lock taken with HostBoardLock()
+ */
+void HostBoardUnlock(void);
+
+/**
+ * @brief Scale factor of the simulated clock
+ * @return uint32_t Simulated time per real time
+ */
+uint32_t HostBoardTimeScale(void);
+
+/**
+ * @brief Capture file of a board output
+ * @param port 0: UART_PC, 1: UART_CONNECTOR, 2: BLE, 3: analog output
+ * @return void* FILE pointer (NULL: not captured)
+ */
+void *HostBoardCapture(uint8_t port);
+
+/**
+ * @brief Play the GPIO script up to now (called by the board task, lock taken)
+ * @param now_us Simulated time
+ */
+void HostGpioStep(int64_t now_us);
+
+/**
+ * @brief Expire timers and soft timers up to now (called by the board task, lock taken)
+ * @param now_us Simulated time
+ */
+void HostTimerStep(int64_t now_us);
+
+/**
+ * @brief Produce ADC frames and waveform updates up to now (called by the board task, lock taken)
+ * @param now_us Simulated time
+ */
+void HostAnalogStep(int64_t now_us);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,376 @@
+/**
+ * @file analog_io_mcu_host.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Analog inputs and output driver of the virtual board (see host_board.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "analog_io_mcu.h"
+#include "host_board.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+/*==================[macros and definitions]=================================*/
+#define ADC_CHANNELS		4							// CH0 to CH3
+#define ADC_TASK_STACK		2048
+#define ADC_TASK_PRIO		13							// same as the target driver
+#define ADC_FREQ_MIN		611							// SOC_ADC_SAMPLE_FREQ_THRES_LOW
+#define ADC_FREQ_MAX		83333						// SOC_ADC_SAMPLE_FREQ_THRES_HIGH
+#define WAVE_MAX_RATE		100000						// max output updates per second
+#define Q16_SHIFT			16
+#define CAPTURE_DAC			3							// HostBoardCapture() port
+#define US_PER_SEC			1000000LL
+/*==================[internal data declaration]==============================*/
+/**
+ * @brief Waveform generator state (updated by the board task)
+ */
+typedef struct {
+	const uint8_t *buffer;				/*!< Buffer being played */
+	uint16_t length;					/*!< Length of buffer being played */
+	const uint8_t * volatile next;		/*!< Buffer queued (stream mode) */
+	volatile uint16_t next_length;		/*!< Length of queued buffer */
+	analog_wave_mode_t mode;			/*!< One-shot, loop or stream */
+	uint32_t phase;						/*!< Position in buffer (samples, Q16.16) */
+	uint32_t step;						/*!< Phase increment per output update (Q16.16) */
+	uint32_t update_rate;				/*!< Output updates per second */
+	int64_t start;						/*!< Simulated time of the first update */
+	uint64_t updates;					/*!< Updates done since start */
+	volatile bool running;				/*!<  */
+	volatile uint32_t underruns;		/*!< Updates with no buffer queued (stream mode) */
+	void (*func_p)(void *param);		/*!< Called at the end of each buffer */
+	void *param_p;						/*!<  */
+} analog_wave_t;
+static analog_wave_t wave = {0};
+static bool dac_ready = false;
+static uint8_t dac_value = 0;
+/* continuous mode */
+static uint8_t cont_channels = 0;					/* bit n: CHn in the scan pattern */
+static uint32_t cont_sample_freq = 0;				/* conversions per second (all channels) */
+static analog_frame_func_t frame_func_p = NULL;		/* per frame callback */
+static void *frame_param_p = NULL;
+static TaskHandle_t adc_task_handle = NULL;
+static SemaphoreHandle_t frames_ready = NULL;		/* counts frames waiting in the ring */
+static analog_frame_t frame_ring[ANALOG_FRAME_RING];
+static volatile uint32_t frame_head = 0;			/* next frame to be filled (ADC task) */
+static volatile uint32_t frame_tail = 0;			/* next frame to be read (user) */
+static analog_frame_t *last_frame = NULL;			/* last complete frame, guarded by the board lock */
+static uint32_t frame_seq = 0;
+static uint32_t frame_overruns = 0;
+static bool cont_running = false;
+static int64_t cont_start = 0;						/* simulated time of the first conversion */
+static uint64_t cont_conversions = 0;				/* conversions handed to the ADC task */
+static volatile uint32_t frames_due = 0;			/* complete frames, by the board clock */
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void HostDacSet(uint8_t value, int64_t time_us){
+	FILE *capture = HostBoardCapture(CAPTURE_DAC);
+	if(value != dac_value && capture != NULL){
+		fprintf(capture, "%lld,%u\n", (long long)time_us, value);
+	}
+	dac_value = value;
+}
+
+/**
+ * @brief One output update, same interpolation as the target timer ISR.
+ */
+static void AnalogWaveUpdate(int64_t time_us){
+	uint32_t idx = wave.phase >> Q16_SHIFT;
+	int32_t frac = wave.phase & ((1 << Q16_SHIFT) - 1);
+	int32_t a, b;
+
+	a = wave.buffer[idx];
+	if(idx + 1 < wave.length){
+		b = wave.buffer[idx + 1];
+	}else if(wave.mode == ANALOG_WAVE_LOOP){
+		b = wave.buffer[0];
+	}else if(wave.mode == ANALOG_WAVE_STREAM && wave.next != NULL){
+		b = wave.next[0];
+	}else{
+		b = a;
+	}
+	HostDacSet(a + (((b - a) * frac) >> Q16_SHIFT), time_us);
+
+	wave.phase += wave.step;
+	if((wave.phase >> Q16_SHIFT) >= wave.length){
+		switch(wave.mode){
+			case ANALOG_WAVE_LOOP:
+				wave.phase -= (uint32_t)wave.length << Q16_SHIFT;
+			break;
+			case ANALOG_WAVE_ONESHOT:
+				wave.phase = (uint32_t)(wave.length - 1) << Q16_SHIFT;
+				wave.running = false;
+			break;
+			case ANALOG_WAVE_STREAM:
+				if(wave.next != NULL){
+					wave.phase -= (uint32_t)wave.length << Q16_SHIFT;
+					wave.length = wave.next_length;
+					wave.buffer = wave.next;
+					wave.next = NULL;
+				}else{
+					wave.phase = (uint32_t)(wave.length - 1) << Q16_SHIFT;
+					wave.underruns++;
+					return;
+				}
+			break;
+		}
+		if(wave.func_p != NULL){
+			wave.func_p(wave.param_p);
+		}
+	}
+}
+
+/**
+ * @brief Fill a frame with the scan pattern, sampling the signal sources at the
+ * time of each conversion.
+ */
+static void AdcFillFrame(analog_frame_t *frame, uint64_t first){
+	uint8_t pattern[ADC_CHANNELS];
+	uint8_t qty = 0;
+	uint16_t per_channel, offset = 0;
+	uint64_t conv;
+	uint8_t ch;
+
+	for(ch = 0; ch < ADC_CHANNELS; ch++){
+		frame->length[ch] = 0;
+		frame->samples[ch] = NULL;
+		if(cont_channels & (1 << ch)){
+			pattern[qty++] = ch;
+		}
+	}
+	per_channel = ANALOG_FRAME_CONVERSIONS / qty;
+	for(uint8_t i = 0; i < qty; i++){
+		frame->samples[pattern[i]] = &frame->data[offset];
+		offset += per_channel;
+	}
+	for(uint16_t i = 0; i < per_channel * qty; i++){
+		conv = first + i;
+		ch = pattern[conv % qty];
+		frame->samples[ch][frame->length[ch]++] = HostAdcSample(ch, cont_start + (int64_t)(conv * US_PER_SEC / cont_sample_freq));
+	}
+	frame->timestamp = cont_start + (int64_t)((first + ANALOG_FRAME_CONVERSIONS) * US_PER_SEC / cont_sample_freq);
+}
+
+static void AdcContinuousTask(void *param){
+	analog_frame_t *frame;
+	uint64_t first;
+	while(1){
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		while(cont_conversions / ANALOG_FRAME_CONVERSIONS < frames_due){
+			first = cont_conversions;
+			cont_conversions += ANALOG_FRAME_CONVERSIONS;
+			if(frame_func_p == NULL && (frame_head - frame_tail) >= ANALOG_FRAME_RING){
+				frame_overruns++;
+				continue;
+			}
+			frame = &frame_ring[frame_head % ANALOG_FRAME_RING];
+			/* a slow AnalogInputReadContinuous() could be copying this frame */
+			HostBoardLock();
+			AdcFillFrame(frame, first);
+			frame->seq = frame_seq++;
+			last_frame = frame;
+			HostBoardUnlock();
+			if(frame_func_p != NULL){
+				frame_func_p(frame, frame_param_p);
+				frame_head++;
+				frame_tail = frame_head;
+			}else{
+				frame_head++;
+				xSemaphoreGive(frames_ready);
+			}
+		}
+	}
+}
+/*==================[external functions definition]==========================*/
+
+void AnalogInputInit(analog_input_config_t *config){
+	HostBoardInit(NULL);
+	if(config->mode == ADC_CONTINUOUS){
+		cont_channels |= (1 << config->input);
+		if(config->sample_frec != 0){
+			cont_sample_freq = config->sample_frec;
+		}
+		if(cont_sample_freq < ADC_FREQ_MIN){
+			cont_sample_freq = ADC_FREQ_MIN;
+		}else if(cont_sample_freq > ADC_FREQ_MAX){
+			cont_sample_freq = ADC_FREQ_MAX;
+		}
+		if(config->func_p != NULL){
+			frame_func_p = (analog_frame_func_t)config->func_p;
+			frame_param_p = config->param_p;
+		}
+	}
+}
+
+void AnalogOutputInit(void){
+	HostBoardInit(NULL);
+	dac_ready = true;
+}
+
+void AnalogInputReadSingle(adc_ch_t channel, uint16_t *value){
+	*value = HostAdcSample(channel, HostClockUs());
+}
+
+void AnalogStartContinuous(adc_ch_t channel){
+	if(cont_channels == 0 || cont_running){
+		return;
+	}
+	if(adc_task_handle == NULL){
+		frames_ready = xSemaphoreCreateCounting(ANALOG_FRAME_RING, 0);
+		xTaskCreate(AdcContinuousTask, "adc_cont_task", ADC_TASK_STACK, NULL, ADC_TASK_PRIO, &adc_task_handle);
+	}
+	HostBoardLock();
+	cont_start = HostClockUs();
+	cont_conversions = 0;
+	frames_due = 0;
+	cont_running = true;
+	HostBoardUnlock();
+}
+
+void AnalogStopContinuous(adc_ch_t channel){
+	HostBoardLock();
+	cont_running = false;
+	HostBoardUnlock();
+}
+
+uint16_t AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values){
+	uint16_t length = 0;
+
+	/* the ADC task can't refill the frame while it is copied */
+	HostBoardLock();
+	if(last_frame != NULL && last_frame->samples[channel] != NULL){
+		length = last_frame->length[channel];
+		memcpy(values, last_frame->samples[channel], length * sizeof(uint16_t));
+	}
+	HostBoardUnlock();
+	return length;
+}
+
+const analog_frame_t * AnalogFrameWait(uint32_t timeout_ms){
+	if(frames_ready == NULL || xSemaphoreTake(frames_ready, pdMS_TO_TICKS(timeout_ms)) != pdTRUE){
+		return NULL;
+	}
+	return &frame_ring[frame_tail % ANALOG_FRAME_RING];
+}
+
+void AnalogFrameRelease(void){
+	if(frame_tail != frame_head){
+		frame_tail++;
+	}
+}
+
+uint32_t AnalogFrameOverruns(void){
+	return frame_overruns;
+}
+
+uint16_t AnalogRaw2mV(uint16_t value){
+	/* ideal converter: the signal sources are given in mV */
+	return (uint32_t)value * HOST_ADC_FULL_SCALE_MV / HOST_ADC_MAX_RAW;
+}
+
+void AnalogRaw2mVBlock(const uint16_t *raw, uint16_t *mv, uint16_t len){
+	for(uint16_t i = 0; i < len; i++){
+		mv[i] = AnalogRaw2mV(raw[i]);
+	}
+}
+
+void AnalogRaw2VoltBlock(const uint16_t *raw, float *volts, uint16_t len){
+	for(uint16_t i = 0; i < len; i++){
+		volts[i] = AnalogRaw2mV(raw[i]) * 0.001f;
+	}
+}
+
+bool AnalogWaveStart(analog_wave_config_t *config){
+	uint32_t update_rate = config->update_rate;
+
+	if(!dac_ready || config->buffer == NULL || config->length == 0 || config->sample_rate == 0){
+		return false;
+	}
+	if(update_rate < config->sample_rate){
+		update_rate = config->sample_rate;
+	}
+	if(update_rate > WAVE_MAX_RATE){
+		update_rate = WAVE_MAX_RATE;
+	}
+	HostBoardLock();
+	wave.buffer = config->buffer;
+	wave.length = config->length;
+	wave.next = NULL;
+	wave.mode = config->mode;
+	wave.phase = 0;
+	wave.step = ((uint64_t)config->sample_rate << Q16_SHIFT) / update_rate;
+	wave.update_rate = update_rate;
+	wave.start = HostClockUs();
+	wave.updates = 0;
+	wave.underruns = 0;
+	wave.func_p = config->func_p;
+	wave.param_p = config->param_p;
+	wave.running = true;
+	HostBoardUnlock();
+	return true;
+}
+
+bool AnalogWaveQueue(const uint8_t *buffer, uint16_t length){
+	if(wave.next != NULL || buffer == NULL || length == 0){
+		return false;
+	}
+	wave.next_length = length;
+	wave.next = buffer;
+	return true;
+}
+
+void AnalogWaveStop(void){
+	HostBoardLock();
+	wave.running = false;
+	HostBoardUnlock();
+}
+
+bool AnalogWaveRunning(void){
+	return wave.running;
+}
+
+uint32_t AnalogWaveUnderruns(void){
+	return wave.underruns;
+}
+
+void AnalogOutputWrite(uint8_t value){
+	HostBoardLock();
+	HostDacSet(value, HostClockUs());
+	HostBoardUnlock();
+}
+
+uint8_t HostDacValue(void){
+	return dac_value;
+}
+
+void HostAnalogStep(int64_t now_us){
+	uint64_t due;
+
+	if(cont_running && now_us > cont_start){
+		due = (uint64_t)(now_us - cont_start) * cont_sample_freq / US_PER_SEC / ANALOG_FRAME_CONVERSIONS;
+		if(due != frames_due){
+			frames_due = due;
+			xTaskNotifyGive(adc_task_handle);
+		}
+	}
+	if(wave.running && now_us > wave.start){
+		due = (uint64_t)(now_us - wave.start) * wave.update_rate / US_PER_SEC;
+		while(wave.running && wave.updates < due){
+			wave.updates++;
+			AnalogWaveUpdate(wave.start + (int64_t)(wave.updates * US_PER_SEC / wave.update_rate));
+		}
+	}
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,149 @@
+/**
+ * @file ble_mcu_host.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief BLE driver of the virtual board (see host_board.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "ble_mcu.h"
+#include "host_board.h"
+#include "trace_mcu.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+/*==================[macros and definitions]=================================*/
+#define CAPTURE_BLE		2		/*!< HostBoardCapture() port */
+#define HOST_MTU		247		/*!< Simulated client: largest MTU of the target stack */
+#define ATT_HEADER		3		/*!< Notification overhead */
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+static ble_status_t status = BLE_OFF;
+static read_func ble_read_isr_p = BLE_NO_INT;
+static ble_stats_t stats;						/* Throughput and queue counters */
+static int64_t stats_start;						/* Time of the last counters reset */
+static uint8_t tx_buffer[BLE_TX_RING_SIZE];		/* Region handed out by BleTxReserve() */
+static SemaphoreHandle_t tx_mutex = NULL;		/* One producer at a time */
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+void BleInit(ble_config_t * ble_device){
+	HostBoardInit(NULL);
+	ble_read_isr_p = ble_device->func_p;
+	if(tx_mutex == NULL){
+		tx_mutex = xSemaphoreCreateMutex();
+	}
+	BleStatsReset();
+	/* the simulated client connects right away */
+	status = BLE_CONNECTED;
+}
+
+ble_status_t BleStatus(void){
+	return status;
+}
+
+uint16_t BleMtu(void){
+	return HOST_MTU;
+}
+
+void BleStats(ble_stats_t *ble_stats){
+	int64_t elapsed = HostClockUs() - stats_start;
+
+	*ble_stats = stats;
+	ble_stats->mtu = HOST_MTU;
+	ble_stats->throughput = (elapsed > 0) ? (uint32_t)((stats.bytes_sent * 1000000ULL) / elapsed) : 0;
+}
+
+void BleStatsReset(void){
+	memset(&stats, 0, sizeof(stats));
+	stats_start = HostClockUs();
+}
+
+void BleSetTxPolicy(ble_tx_policy_t policy){
+	/* output is never congested: every policy behaves the same */
+}
+
+uint16_t BleTxReserve(uint8_t **buffer, uint16_t length){
+	if((status != BLE_CONNECTED) || (length == 0)){
+		return 0;
+	}
+	if(length > BLE_TX_RING_SIZE){
+		length = BLE_TX_RING_SIZE;
+	}
+	xSemaphoreTake(tx_mutex, portMAX_DELAY);
+	*buffer = tx_buffer;
+	return length;
+}
+
+void BleTxCommit(uint16_t length){
+	FILE *capture = HostBoardCapture(CAPTURE_BLE);
+
+	if(capture != NULL){
+		fwrite(tx_buffer, 1, length, capture);
+	}
+	stats.bytes_sent += length;
+	stats.notifications += (length + HOST_MTU - ATT_HEADER - 1) / (HOST_MTU - ATT_HEADER);
+	if(length > stats.ring_max){
+		stats.ring_max = length;
+	}
+	xSemaphoreGive(tx_mutex);
+}
+
+uint16_t BleWrite(const uint8_t *data, uint16_t length){
+	uint8_t *buffer;
+	uint16_t written = 0, n;
+
+	TRACE_BEGIN(TRACE_ID_BLE_WRITE);
+	while(written < length){
+		n = BleTxReserve(&buffer, length - written);
+		if(n == 0){
+			break;
+		}
+		memcpy(buffer, &data[written], n);
+		BleTxCommit(n);
+		written += n;
+	}
+	if(written){
+		stats.messages++;
+	}else if(length){
+		stats.bytes_dropped += length;
+	}
+	TRACE_END(TRACE_ID_BLE_WRITE);
+	return written;
+}
+
+void BleSendByte(const char *data){
+	BleWrite((const uint8_t *)data, 1);
+}
+
+void BleSendString(const char *msg){
+	BleWrite((const uint8_t *)msg, strlen(msg));
+}
+
+void BleSendBuffer(const char *data, uint8_t nbytes){
+	BleWrite((const uint8_t *)data, nbytes);
+}
+
+void HostBleConnect(bool connected){
+	if(status != BLE_OFF){
+		status = connected ? BLE_CONNECTED : BLE_DISCONNECTED;
+	}
+}
+
+void HostBleInject(const uint8_t *data, uint8_t length){
+	if(status == BLE_CONNECTED && ble_read_isr_p != BLE_NO_INT){
+		ble_read_isr_p((uint8_t *)data, length);
+	}
+}
+
+/*==================[end of file]============================================*/
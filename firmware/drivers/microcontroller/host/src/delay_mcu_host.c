@@ -0,0 +1,42 @@
+/**
+ * @file delay_mcu_host.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Delay driver of the virtual board (see host_board.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "delay_mcu.h"
+#include "host_board.h"
+/*==================[macros and definitions]=================================*/
+#define MSEC				1000	/*!< 1msec = 1000usec */
+#define SEC					1000000	/*!< 1sec = 1000msec */
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+/* delays are in simulated time, so they shrink with the board time scale */
+void DelaySec(uint16_t sec){
+	HostClockWaitUs((uint64_t)sec * SEC);
+}
+
+void DelayMs(uint16_t msec){
+	HostClockWaitUs((uint64_t)msec * MSEC);
+}
+
+void DelayUs(uint16_t usec){
+	HostClockWaitUs(usec);
+}
+
+/*==================[end of file]============================================*/
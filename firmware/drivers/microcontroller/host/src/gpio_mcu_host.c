@@ -0,0 +1,143 @@
+/**
+ * @file gpio_mcu_host.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief GPIO driver of the virtual board (see host_board.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "gpio_mcu.h"
+#include "host_board.h"
+#include <stddef.h>
+/*==================[macros and definitions]=================================*/
+#define GPIO_QTY 	24
+#define GPIO_ALL	((1UL << GPIO_QTY) - 1)
+#define EDGE_POS	(1 << 0)		/*!< Interrupt on positive edges */
+#define EDGE_NEG	(1 << 1)		/*!< Interrupt on negative edges */
+/*==================[internal data declaration]==============================*/
+/**
+ * @brief Interrupt registered on an input
+ */
+typedef struct {
+	void (*isr_p)(void *);	/*!<  */
+	void *args;				/*!<  */
+	uint8_t edges;			/*!< EDGE_POS and/or EDGE_NEG */
+} gpio_host_int_t;
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+static gpio_host_int_t gpio_ints[GPIO_QTY] = {0};
+static const host_gpio_step_t *script = NULL;
+static uint16_t script_qty = 0;
+static uint16_t script_next = 0;
+static int64_t script_start = 0;
+/*==================[external data definition]===============================*/
+/* inputs idle high, as with the pull-ups of the target */
+gpio_host_port_t gpio_host_port = {.out = 0, .in = GPIO_ALL, .writes = 0, .reads = 0};
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Change an input level and call its interrupt, as the GPIO ISR service would
+ */
+static void HostGpioDrive(gpio_t pin, bool level){
+	uint32_t mask = GPIO_MASK(pin);
+	gpio_host_int_t *gpio_int = &gpio_ints[pin];
+
+	if(((gpio_host_port.in & mask) != 0) == level){
+		return;
+	}
+	gpio_host_port.in ^= mask;
+	if(gpio_int->isr_p != NULL && (gpio_int->edges & (level ? EDGE_POS : EDGE_NEG))){
+		gpio_int->isr_p(gpio_int->args);
+	}
+}
+/*==================[external functions definition]==========================*/
+void GPIOInit(gpio_t pin, io_t io){
+	if((pin == GPIO_14) || (pin > GPIO_23)){
+		return;
+	}
+	HostBoardLock();
+	if(io == GPIO_OUTPUT){
+		gpio_host_port.out &= ~GPIO_MASK(pin);
+	}
+	HostBoardUnlock();
+}
+
+void GPIOOn(gpio_t pin){
+	GPIOWriteMask(GPIO_MASK(pin), 0);
+}
+
+void GPIOOff(gpio_t pin){
+	GPIOWriteMask(0, GPIO_MASK(pin));
+}
+
+void GPIOState(gpio_t pin, bool state){
+	if(state){
+		GPIOWriteMask(GPIO_MASK(pin), 0);
+	} else{
+		GPIOWriteMask(0, GPIO_MASK(pin));
+	}
+}
+
+void GPIOToggle(gpio_t pin){
+	GPIOState(pin, !(GPIOReadOutputMask() & GPIO_MASK(pin)));
+}
+
+bool GPIORead(gpio_t pin){
+	return (GPIOReadMask() >> pin) & 1;
+}
+
+void GPIOActivInt(gpio_t pin, void *ptr_int_func, bool edge, void *args){
+	HostBoardLock();
+	gpio_ints[pin].isr_p = ptr_int_func;
+	gpio_ints[pin].args = args;
+	gpio_ints[pin].edges = edge ? EDGE_POS : EDGE_NEG;
+	HostBoardUnlock();
+}
+
+void GPIOActivIntAnyEdge(gpio_t pin, void *ptr_int_func, void *args){
+	HostBoardLock();
+	gpio_ints[pin].isr_p = ptr_int_func;
+	gpio_ints[pin].args = args;
+	gpio_ints[pin].edges = EDGE_POS | EDGE_NEG;
+	HostBoardUnlock();
+}
+
+void GPIOInputFilter(gpio_t pin){
+	/* simulated inputs have no glitches */
+}
+
+void GPIODeinit(void){
+
+}
+
+void HostGpioSetInput(gpio_t pin, bool level){
+	HostBoardLock();
+	HostGpioDrive(pin, level);
+	HostBoardUnlock();
+}
+
+void HostGpioScript(const host_gpio_step_t *steps, uint16_t qty){
+	HostBoardLock();
+	script = steps;
+	script_qty = qty;
+	script_next = 0;
+	script_start = HostClockUs();
+	HostBoardUnlock();
+}
+
+bool HostGpioScriptRunning(void){
+	return script_next < script_qty;
+}
+
+void HostGpioStep(int64_t now_us){
+	while(script_next < script_qty && (script_start + (int64_t)script[script_next].time_ms * 1000) <= now_us){
+		HostGpioDrive(script[script_next].pin, script[script_next].level);
+		script_next++;
+	}
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,186 @@
+/**
+ * @file host_board.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "host_board.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+/*==================[macros and definitions]=================================*/
+#define BOARD_TASK_STACK	4096
+#define BOARD_TASK_PRIO		(configMAX_PRIORITIES - 1)	/*!< Simulated interrupts preempt every task */
+#define ADC_CHANNELS		4							/*!< CH0 to CH3 */
+#define CAPTURES			4							/*!< UART_PC, UART_CONNECTOR, BLE, DAC */
+#define TWO_PI				6.283185307179586
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+static SemaphoreHandle_t board_lock = NULL;
+static uint32_t time_scale = 1;
+static struct timespec start_time;
+static FILE *captures[CAPTURES] = {NULL};
+static host_signal_t adc_signals[ADC_CHANNELS] = {0};
+static uint32_t noise_seed = 1;
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static FILE *HostOpenCapture(const char *path){
+	FILE *file;
+	if(path == NULL){
+		return NULL;
+	}
+	file = fopen(path, "w");
+	if(file == NULL){
+		perror(path);
+	}
+	return file;
+}
+
+/**
+ * @brief Updates the simulated hardware once per tick: inputs first, so timer
+ * callbacks see the levels of the same instant.
+ */
+static void HostBoardTask(void *param){
+	int64_t now;
+	while(1){
+		vTaskDelay(1);
+		now = HostClockUs();
+		HostBoardLock();
+		HostGpioStep(now);
+		HostAnalogStep(now);
+		HostTimerStep(now);
+		HostBoardUnlock();
+		for(uint8_t i = 0; i < CAPTURES; i++){
+			if(captures[i] != NULL){
+				fflush(captures[i]);
+			}
+		}
+	}
+}
+/*==================[external functions definition]==========================*/
+void HostBoardInit(const host_board_config_t *config){
+	if(board_lock != NULL){
+		return;
+	}
+	board_lock = xSemaphoreCreateRecursiveMutex();
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	captures[0] = stdout;
+	if(config != NULL){
+		time_scale = (config->time_scale > 1) ? config->time_scale : 1;
+		if(config->uart_pc_file != NULL){
+			captures[0] = HostOpenCapture(config->uart_pc_file);
+		}
+		captures[1] = HostOpenCapture(config->uart_conn_file);
+		captures[2] = HostOpenCapture(config->ble_file);
+		captures[3] = HostOpenCapture(config->dac_file);
+	}
+	xTaskCreate(HostBoardTask, "host_board", BOARD_TASK_STACK, NULL, BOARD_TASK_PRIO, NULL);
+}
+
+int64_t HostClockUs(void){
+	struct timespec now;
+	int64_t elapsed;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsed = (int64_t)(now.tv_sec - start_time.tv_sec) * 1000000 + (now.tv_nsec - start_time.tv_nsec) / 1000;
+	return elapsed * time_scale;
+}
+
+void HostClockWaitUs(uint64_t us){
+	uint64_t real_us = us / time_scale;
+	TickType_t ticks = pdMS_TO_TICKS(real_us / 1000);
+	struct timespec wait;
+
+	if(ticks > 0){
+		vTaskDelay(ticks);
+		real_us -= (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+	}
+	if(real_us > 0){
+		/* below one tick: sleep the thread, as a busy wait would on the target */
+		wait.tv_sec = 0;
+		wait.tv_nsec = real_us * 1000;
+		nanosleep(&wait, NULL);
+	}
+}
+
+void HostAdcSetSignal(adc_ch_t channel, const host_signal_t *signal){
+	HostBoardLock();
+	adc_signals[channel] = *signal;
+	HostBoardUnlock();
+}
+
+uint16_t HostAdcSample(adc_ch_t channel, int64_t time_us){
+	const host_signal_t *signal = &adc_signals[channel];
+	double t = time_us * 1e-6;
+	double phase = signal->freq * t - floor(signal->freq * t);
+	double mv = signal->offset_mv;
+	int32_t raw;
+
+	switch(signal->type){
+		case HOST_SIGNAL_CONST:
+		break;
+		case HOST_SIGNAL_SINE:
+			mv += signal->amplitude_mv * sin(TWO_PI * phase);
+		break;
+		case HOST_SIGNAL_SQUARE:
+			mv += (phase < 0.5) ? signal->amplitude_mv : -signal->amplitude_mv;
+		break;
+		case HOST_SIGNAL_RAMP:
+			mv += signal->amplitude_mv * (2.0 * phase - 1.0);
+		break;
+		case HOST_SIGNAL_TABLE:
+			if(signal->table != NULL && signal->length){
+				mv = signal->table[(uint64_t)time_us * signal->table_rate / 1000000 % signal->length];
+			}
+		break;
+	}
+	if(signal->noise_mv){
+		/* xorshift: same noise on every run */
+		noise_seed ^= noise_seed << 13;
+		noise_seed ^= noise_seed >> 17;
+		noise_seed ^= noise_seed << 5;
+		mv += (int32_t)(noise_seed % (2 * signal->noise_mv + 1)) - signal->noise_mv;
+	}
+	raw = (int32_t)(mv * HOST_ADC_MAX_RAW / HOST_ADC_FULL_SCALE_MV + 0.5);
+	if(raw < 0){
+		raw = 0;
+	}else if(raw > HOST_ADC_MAX_RAW){
+		raw = HOST_ADC_MAX_RAW;
+	}
+	return raw;
+}
+
+void HostBoardLock(void){
+	if(board_lock == NULL){
+		/* a driver used before HostBoardInit(): default board */
+		HostBoardInit(NULL);
+	}
+	xSemaphoreTakeRecursive(board_lock, portMAX_DELAY);
+}
+
+void HostBoardUnlock(void){
+	xSemaphoreGiveRecursive(board_lock);
+}
+
+uint32_t HostBoardTimeScale(void){
+	return time_scale;
+}
+
+void *HostBoardCapture(uint8_t port){
+	return (port < CAPTURES) ? captures[port] : NULL;
+}
+
+/*==================[end of file]============================================*/
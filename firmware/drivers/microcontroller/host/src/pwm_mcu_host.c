@@ -0,0 +1,267 @@
+/**
+ * @file pwm_mcu_host.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief PWM driver of the virtual board (see host_board.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "pwm_mcu.h"
+#include "host_board.h"
+#include <stddef.h>
+/*==================[macros and definitions]=================================*/
+#define PWM_QTY         4
+#define PWM_SRC_CLK_HZ  80000000UL                  /*!< Same source clock as the target */
+#define PWM_MIN_BITS    1
+#define PWM_MAX_BITS    20                          /*!< SOC_LEDC_TIMER_BIT_WIDTH of the ESP32-C6 */
+
+/**
+ * @brief State of a simulated LEDC timer
+ */
+typedef struct {
+    uint32_t freq;      /*!< Frequency in Hz */
+    uint8_t bits;       /*!< Duty resolution */
+    uint8_t users;      /*!< Outputs attached */
+} pwm_timer_t;
+
+/**
+ * @brief State of a simulated PWM output
+ */
+typedef struct {
+    uint8_t timer;      /*!< Timer the output is attached to */
+    uint32_t duty_q16;  /*!< Last duty, used to rescale on resolution changes */
+    uint32_t ticks;     /*!< Duty applied (end of the fade, if any) */
+    uint32_t fade_from; /*!< Duty at the start of the fade (ticks) */
+    int64_t fade_start; /*!< Fade start (simulated us) */
+    int64_t fade_end;   /*!< Fade end (simulated us), 0: no fade */
+    bool running;       /*!< Not paused */
+    bool init;          /*!< Output initialized */
+} pwm_channel_t;
+/*==================[internal data declaration]==============================*/
+static pwm_timer_t pwm_timers[PWM_QTY];
+static pwm_channel_t pwm_channels[PWM_QTY];
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Largest duty resolution the source clock allows at a given frequency
+ */
+static uint8_t PWMBestResolution(uint32_t freq){
+    uint8_t bits = PWM_MIN_BITS;
+    if(freq == 0){
+        return PWM_MAX_BITS;
+    }
+    while((bits < PWM_MAX_BITS) && (((uint64_t)freq << (bits + 1)) <= PWM_SRC_CLK_HZ)){
+        bits++;
+    }
+    return bits;
+}
+
+static uint8_t PWMTimerConfig(uint8_t timer, uint32_t freq){
+    if(freq == 0){
+        return 1;
+    }
+    pwm_timers[timer].freq = freq;
+    pwm_timers[timer].bits = PWMBestResolution(freq);
+    return 0;
+}
+
+static uint8_t PWMAttach(pwm_out_t out, uint8_t timer){
+    if(pwm_channels[out].init){
+        pwm_timers[pwm_channels[out].timer].users--;
+    }
+    pwm_channels[out].timer = timer;
+    pwm_channels[out].duty_q16 = 0;
+    pwm_channels[out].ticks = 0;
+    pwm_channels[out].fade_end = 0;
+    pwm_channels[out].running = true;
+    pwm_channels[out].init = true;
+    pwm_timers[timer].users++;
+    return 0;
+}
+
+static uint32_t PWMQ16ToTicks(pwm_out_t out, uint32_t duty_q16){
+    if(duty_q16 > PWM_Q16_ONE){
+        duty_q16 = PWM_Q16_ONE;
+    }
+    return (uint32_t)(((uint64_t)duty_q16 << pwm_timers[pwm_channels[out].timer].bits) >> 16);
+}
+
+/**
+ * @brief Duty in ticks at a given time, following the fade in progress
+ */
+static uint32_t PWMTicksAt(pwm_channel_t *channel, int64_t now){
+    int64_t span;
+    if(channel->fade_end == 0 || now >= channel->fade_end){
+        return channel->ticks;
+    }
+    span = channel->fade_end - channel->fade_start;
+    return channel->fade_from + (int64_t)((int64_t)channel->ticks - channel->fade_from) * (now - channel->fade_start) / span;
+}
+
+static void PWMApply(pwm_out_t out, uint32_t ticks){
+    pwm_channels[out].ticks = ticks;
+    pwm_channels[out].fade_end = 0;
+}
+/*==================[external functions definition]==========================*/
+uint8_t PWMInit(pwm_out_t out, gpio_t gpio, uint16_t freq){
+    uint8_t ret;
+    if(out >= PWM_QTY){
+        return 1;
+    }
+    HostBoardLock();
+    ret = PWMTimerConfig(out, freq) || PWMAttach(out, out);
+    HostBoardUnlock();
+    return ret;
+}
+
+uint8_t PWMGroupInit(const pwm_out_t *outs, const gpio_t *gpios, uint8_t qty, uint32_t freq){
+    uint8_t ret = 0;
+    if((qty == 0) || (outs[0] >= PWM_QTY)){
+        return 1;
+    }
+    HostBoardLock();
+    if(PWMTimerConfig(outs[0], freq)){
+        HostBoardUnlock();
+        return 1;
+    }
+    for(uint8_t i = 0; i < qty; i++){
+        if(outs[i] >= PWM_QTY){
+            ret = 1;
+            break;
+        }
+        ret |= PWMAttach(outs[i], outs[0]);
+    }
+    HostBoardUnlock();
+    return ret;
+}
+
+void PWMOn(pwm_out_t out){
+    pwm_channels[out].running = true;
+}
+
+void PWMOff(pwm_out_t out){
+    pwm_channels[out].running = false;
+}
+
+void PWMSetDutyCycle(pwm_out_t out, uint8_t duty_cycle){
+    if(duty_cycle > 100){
+        duty_cycle = 100;
+    }
+    PWMSetDutyQ16(out, PWM_Q16_PERCENT(duty_cycle));
+}
+
+uint8_t PWMGetResolution(pwm_out_t out){
+    return pwm_timers[pwm_channels[out].timer].bits;
+}
+
+uint32_t PWMGetMaxTicks(pwm_out_t out){
+    return 1UL << pwm_timers[pwm_channels[out].timer].bits;
+}
+
+void PWMSetDutyTicks(pwm_out_t out, uint32_t ticks){
+    uint8_t bits = pwm_timers[pwm_channels[out].timer].bits;
+    if(ticks > (1UL << bits)){
+        ticks = 1UL << bits;
+    }
+    HostBoardLock();
+    pwm_channels[out].duty_q16 = (uint32_t)(((uint64_t)ticks << 16) >> bits);
+    PWMApply(out, ticks);
+    HostBoardUnlock();
+}
+
+void PWMSetDutyQ16(pwm_out_t out, uint32_t duty_q16){
+    if(duty_q16 > PWM_Q16_ONE){
+        duty_q16 = PWM_Q16_ONE;
+    }
+    HostBoardLock();
+    pwm_channels[out].duty_q16 = duty_q16;
+    PWMApply(out, PWMQ16ToTicks(out, duty_q16));
+    HostBoardUnlock();
+}
+
+void PWMGroupSetDutyQ16(const pwm_out_t *outs, const uint32_t *duty_q16, uint8_t qty){
+    /* the lock keeps the board task from seeing half of the group updated */
+    HostBoardLock();
+    for(uint8_t i = 0; i < qty; i++){
+        pwm_channels[outs[i]].duty_q16 = (duty_q16[i] > PWM_Q16_ONE) ? PWM_Q16_ONE : duty_q16[i];
+        PWMApply(outs[i], PWMQ16ToTicks(outs[i], duty_q16[i]));
+    }
+    HostBoardUnlock();
+}
+
+uint8_t PWMFadeQ16(pwm_out_t out, uint32_t duty_q16, uint32_t time_ms, bool wait){
+    pwm_channel_t *channel = &pwm_channels[out];
+    int64_t now;
+
+    if(duty_q16 > PWM_Q16_ONE){
+        duty_q16 = PWM_Q16_ONE;
+    }
+    HostBoardLock();
+    now = HostClockUs();
+    channel->fade_from = PWMTicksAt(channel, now);
+    channel->duty_q16 = duty_q16;
+    channel->ticks = PWMQ16ToTicks(out, duty_q16);
+    channel->fade_start = now;
+    channel->fade_end = time_ms ? (now + (int64_t)time_ms * 1000) : 0;
+    HostBoardUnlock();
+    if(wait){
+        HostClockWaitUs((uint64_t)time_ms * 1000);
+    }
+    return 0;
+}
+
+uint8_t PWMSetFreq(pwm_out_t out, uint32_t freq){
+    uint8_t timer = pwm_channels[out].timer;
+    HostBoardLock();
+    if(PWMTimerConfig(timer, freq)){
+        HostBoardUnlock();
+        return 1;
+    }
+    /* rescale every output attached to the timer, as the target does on resolution changes */
+    for(uint8_t i = 0; i < PWM_QTY; i++){
+        if(pwm_channels[i].init && (pwm_channels[i].timer == timer)){
+            PWMApply(i, PWMQ16ToTicks(i, pwm_channels[i].duty_q16));
+        }
+    }
+    HostBoardUnlock();
+    return 0;
+}
+
+uint8_t PWMDeinit(pwm_out_t out){
+    if(out >= PWM_QTY){
+        return 1;
+    }
+    HostBoardLock();
+    if(pwm_channels[out].init){
+        pwm_timers[pwm_channels[out].timer].users--;
+        pwm_channels[out].init = false;
+    }
+    HostBoardUnlock();
+    return 0;
+}
+
+uint32_t HostPwmDutyQ16(pwm_out_t out, uint32_t *freq){
+    pwm_channel_t *channel = &pwm_channels[out];
+    uint32_t duty = 0;
+
+    HostBoardLock();
+    if(freq != NULL){
+        *freq = channel->init ? pwm_timers[channel->timer].freq : 0;
+    }
+    if(channel->init && channel->running){
+        duty = (uint32_t)(((uint64_t)PWMTicksAt(channel, HostClockUs()) << 16) >> pwm_timers[channel->timer].bits);
+    }
+    HostBoardUnlock();
+    return duty;
+}
+
+/*==================[end of file]============================================*/
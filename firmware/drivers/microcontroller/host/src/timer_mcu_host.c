@@ -0,0 +1,250 @@
+/**
+ * @file timer_mcu_host.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Timer driver of the virtual board (see host_board.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "timer_mcu.h"
+#include "timer_wheel.h"
+#include "trace_mcu.h"
+#include "host_board.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+/*==================[macros and definitions]=================================*/
+#define HW_TIMERS			3		/*!< TIMER_A, TIMER_B, TIMER_C */
+#define SERVICE_QUEUE_SIZE	32		/*!< Expired timers waiting for the service task */
+#define SERVICE_TASK_STACK	3072	/*!<  */
+#define SERVICE_TASK_PRIO	(configMAX_PRIORITIES - 2)	/*!< Deferred callbacks run above application tasks */
+/*==================[internal data declaration]==============================*/
+/**
+ * @brief Hardware timer (TIMER_A, TIMER_B, TIMER_C) state, in simulated time
+ */
+typedef struct {
+	void (*isr_p)(void*);		/*!<  */
+	void *user_data;			/*!<  */
+	uint32_t period;			/*!< Alarm period (us) */
+	uint32_t count;				/*!< Count when stopped (us) */
+	int64_t alarm;				/*!< Time of next alarm when running */
+	bool running;				/*!<  */
+} hw_timer_t;
+static hw_timer_t hw_timers[HW_TIMERS] = {0};	/*!<  */
+/* timer service */
+static bool service_ready = false;
+static tw_wheel_t service_wheel;					/*!<  */
+static int64_t service_now = 0;						/*!< Time of the board step being processed */
+static QueueHandle_t service_queue = NULL;			/*!< Deferred dispatch */
+static uint32_t service_queue_overruns = 0;			/*!<  */
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static uint32_t ServiceTick(int64_t time_us){
+	return (uint32_t)(time_us / TIMER_SERVICE_TICK_US);
+}
+
+/**
+ * @brief Run the user function of a soft timer and update its statistics
+ */
+static void SoftTimerRun(soft_timer_t *timer, int64_t now){
+	uint32_t jitter;
+
+	if(timer->stats.runs && timer->wheel.period){
+		int64_t interval = now - timer->last_run;
+		jitter = (interval > timer->period_us) ? (interval - timer->period_us) : (timer->period_us - interval);
+		if(jitter > timer->stats.max_jitter_us){
+			timer->stats.max_jitter_us = jitter;
+		}
+		timer->stats.sum_jitter_us += jitter;
+	}
+	timer->last_run = now;
+	timer->stats.runs++;
+	TRACE_BEGIN(TRACE_ID_SOFT_TIMER);
+	timer->func_p(timer->param_p);
+	TRACE_END(TRACE_ID_SOFT_TIMER);
+}
+
+/**
+ * @brief Called by the timer wheel (in the board task) for each expired soft timer
+ */
+static void SoftTimerExpired(tw_timer_t *entry, void *param){
+	soft_timer_t *timer = (soft_timer_t *)entry->owner;
+	/* a step covers several ticks: stats use the tick the timer expired on */
+	uint32_t late = ServiceTick(service_now) - (service_wheel.now - 1);
+
+	switch(timer->dispatch){
+		case TIMER_DISPATCH_ISR:
+			SoftTimerRun(timer, service_now - (int64_t)late * TIMER_SERVICE_TICK_US);
+		break;
+		case TIMER_DISPATCH_TASK:
+			if(xQueueSend(service_queue, &timer, 0) != pdTRUE){
+				service_queue_overruns++;
+				timer->stats.missed++;
+			}
+		break;
+		case TIMER_DISPATCH_NOTIFY:
+			timer->stats.runs++;
+			xTaskNotifyGive((TaskHandle_t)timer->param_p);
+		break;
+	}
+}
+
+static void service_task(void *param){
+	soft_timer_t *timer;
+	while(1){
+		if(xQueueReceive(service_queue, &timer, portMAX_DELAY) == pdTRUE){
+			SoftTimerRun(timer, HostClockUs());
+		}
+	}
+}
+
+static uint32_t SoftTimerTicks(uint32_t period_us){
+	uint32_t ticks = (period_us + TIMER_SERVICE_TICK_US - 1) / TIMER_SERVICE_TICK_US;
+	return (ticks == 0) ? 1 : ticks;
+}
+/*==================[external functions definition]==========================*/
+void TimerInit(timer_config_t *timer_ini){
+	hw_timer_t *hw = &hw_timers[timer_ini->timer];
+	HostBoardLock();
+	hw->isr_p = timer_ini->func_p;
+	hw->user_data = timer_ini->param_p;
+	hw->period = timer_ini->period;
+	hw->count = 0;
+	hw->running = false;
+	HostBoardUnlock();
+}
+
+void TimerStart(timer_mcu_t timer){
+	hw_timer_t *hw = &hw_timers[timer];
+	HostBoardLock();
+	if(!hw->running && hw->period){
+		hw->alarm = HostClockUs() + (hw->period - hw->count);
+		hw->running = true;
+	}
+	HostBoardUnlock();
+}
+
+void TimerStop(timer_mcu_t timer){
+	hw_timer_t *hw = &hw_timers[timer];
+	int64_t left;
+	HostBoardLock();
+	if(hw->running){
+		left = hw->alarm - HostClockUs();
+		hw->count = (left > 0 && left < hw->period) ? (hw->period - left) : 0;
+		hw->running = false;
+	}
+	HostBoardUnlock();
+}
+
+void TimerReset(timer_mcu_t timer){
+	hw_timer_t *hw = &hw_timers[timer];
+	HostBoardLock();
+	hw->count = 0;
+	if(hw->running){
+		hw->alarm = HostClockUs() + hw->period;
+	}
+	HostBoardUnlock();
+}
+
+void TimerServiceInit(void){
+	HostBoardLock();
+	if(!service_ready){
+		TimerWheelInit(&service_wheel, ServiceTick(HostClockUs()));
+		service_queue = xQueueCreate(SERVICE_QUEUE_SIZE, sizeof(soft_timer_t *));
+		xTaskCreate(service_task, "timer_service", SERVICE_TASK_STACK, NULL, SERVICE_TASK_PRIO, NULL);
+		service_ready = true;
+	}
+	HostBoardUnlock();
+}
+
+void SoftTimerInit(soft_timer_t *timer, soft_timer_config_t *config){
+	TimerServiceInit();
+	TimerWheelTimerInit(&timer->wheel);
+	timer->wheel.owner = timer;
+	timer->period_us = config->period;
+	timer->periodic = config->periodic;
+	timer->dispatch = config->dispatch;
+	timer->func_p = config->func_p;
+	timer->param_p = config->param_p;
+	if(timer->dispatch == TIMER_DISPATCH_NOTIFY && timer->param_p == NULL){
+		timer->param_p = xTaskGetCurrentTaskHandle();
+	}
+	SoftTimerStatsReset(timer);
+}
+
+void SoftTimerStart(soft_timer_t *timer){
+	uint32_t ticks = SoftTimerTicks(timer->period_us);
+	HostBoardLock();
+	TimerWheelAdd(&service_wheel, &timer->wheel, ticks, timer->periodic ? ticks : 0);
+	timer->stats.runs = 0;
+	HostBoardUnlock();
+}
+
+void SoftTimerSetPeriod(soft_timer_t *timer, uint32_t period){
+	HostBoardLock();
+	timer->period_us = period;
+	HostBoardUnlock();
+}
+
+void SoftTimerStop(soft_timer_t *timer){
+	HostBoardLock();
+	TimerWheelCancel(&timer->wheel);
+	HostBoardUnlock();
+}
+
+bool SoftTimerIsActive(soft_timer_t *timer){
+	return TimerWheelPending(&timer->wheel);
+}
+
+void SoftTimerStats(soft_timer_t *timer, soft_timer_stats_t *stats){
+	HostBoardLock();
+	*stats = timer->stats;
+	HostBoardUnlock();
+}
+
+void SoftTimerStatsReset(soft_timer_t *timer){
+	HostBoardLock();
+	timer->stats.runs = 0;
+	timer->stats.missed = 0;
+	timer->stats.max_jitter_us = 0;
+	timer->stats.sum_jitter_us = 0;
+	HostBoardUnlock();
+}
+
+uint32_t TimerServiceOverruns(void){
+	return service_queue_overruns;
+}
+
+void HostTimerStep(int64_t now_us){
+	hw_timer_t *hw;
+
+	for(uint8_t i = 0; i < HW_TIMERS; i++){
+		hw = &hw_timers[i];
+		/* one call per period elapsed, as the alarm interrupt would */
+		while(hw->running && hw->alarm <= now_us){
+			hw->alarm += hw->period;
+			if(hw->isr_p != NULL){
+				TRACE_BEGIN(TRACE_ID_TIMER_ISR);
+				hw->isr_p(hw->user_data);
+				TRACE_END(TRACE_ID_TIMER_ISR);
+			}
+		}
+	}
+	if(service_ready){
+		service_now = now_us;
+		TRACE_BEGIN(TRACE_ID_TIMER_SERVICE);
+		TimerWheelAdvance(&service_wheel, ServiceTick(now_us), SoftTimerExpired, NULL);
+		TRACE_END(TRACE_ID_TIMER_SERVICE);
+	}
+}
+
+/*==================[end of file]============================================*/
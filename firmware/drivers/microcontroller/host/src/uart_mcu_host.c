@@ -0,0 +1,161 @@
+/**
+ * @file uart_mcu_host.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief UART driver of the virtual board (see host_board.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "uart_mcu.h"
+#include "host_board.h"
+#include "trace_mcu.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+/*==================[macros and definitions]=================================*/
+#define RX_BUFFER_SIZE      256             /*!<  */
+#define READ_TIMEOUT        100             /*!<  */
+#define UART_PORTS          2               /*!< UART_PC and UART_CONNECTOR */
+#define PRINTF_BUFFER_SIZE  128             /*!< Max length of a UartPrintf() line */
+/*==================[internal data declaration]==============================*/
+/**
+ * @brief Simulated port: output goes straight to the capture file
+ */
+typedef struct {
+    QueueHandle_t rx;                       /*!< Injected bytes */
+    void (*isr_p)(void*);                   /*!< Reception callback */
+    void *user_data;                        /*!<  */
+    uart_tx_policy_t policy;                /*!< Kept for UartSetTxPolicy(), output never blocks */
+    uart_tx_stats_t stats;                  /*!< Counters */
+    SemaphoreHandle_t write_mutex;          /*!< Serializes writers */
+} uart_host_t;
+static uart_host_t uart_ports[UART_PORTS];  /*!<  */
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static uint16_t UartTxPush(uart_mcu_port_t port, const uint8_t *data, uint16_t nbytes){
+    uart_host_t *uart = &uart_ports[port];
+    FILE *capture = HostBoardCapture(port);
+
+    if(uart->write_mutex == NULL || nbytes == 0){
+        return 0;
+    }
+    TRACE_BEGIN(TRACE_ID_UART_SEND);
+    xSemaphoreTake(uart->write_mutex, portMAX_DELAY);
+    if(capture != NULL){
+        fwrite(data, 1, nbytes, capture);
+    }
+    uart->stats.bytes_queued += nbytes;
+    uart->stats.bytes_sent += nbytes;
+    if(nbytes > uart->stats.max_used){
+        uart->stats.max_used = nbytes;
+    }
+    xSemaphoreGive(uart->write_mutex);
+    TRACE_END(TRACE_ID_UART_SEND);
+    return nbytes;
+}
+/*==================[external functions definition]==========================*/
+
+void UartInit(serial_config_t *port_config){
+    uart_host_t *uart = &uart_ports[port_config->port];
+    HostBoardInit(NULL);
+    if(uart->write_mutex == NULL){
+        uart->rx = xQueueCreate(RX_BUFFER_SIZE, sizeof(uint8_t));
+        uart->write_mutex = xSemaphoreCreateMutex();
+    }
+    uart->isr_p = port_config->func_p;
+    uart->user_data = port_config->param_p;
+    uart->policy = port_config->tx_policy;
+}
+
+uint8_t UartReadByte(uart_mcu_port_t port, uint8_t* data){
+    if(uart_ports[port].rx == NULL){
+        return false;
+    }
+    return (xQueueReceive(uart_ports[port].rx, data, READ_TIMEOUT) == pdTRUE);
+}
+
+uint8_t UartReadBuffer(uart_mcu_port_t port, uint8_t* data, uint16_t nbytes){
+    uint16_t length = 0;
+    if(uart_ports[port].rx == NULL){
+        return false;
+    }
+    while(length < nbytes && xQueueReceive(uart_ports[port].rx, &data[length], length ? 0 : READ_TIMEOUT) == pdTRUE){
+        length++;
+    }
+    return (length > 0);
+}
+
+void UartSendByte(uart_mcu_port_t port, const char *data){
+    UartTxPush(port, (const uint8_t *)data, 1);
+}
+
+void UartSendString(uart_mcu_port_t port, const char *msg){
+    UartTxPush(port, (const uint8_t *)msg, strlen(msg));
+}
+
+void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes){
+    UartTxPush(port, (const uint8_t *)data, nbytes);
+}
+
+uint16_t UartWrite(uart_mcu_port_t port, const void *data, uint16_t nbytes){
+    return UartTxPush(port, (const uint8_t *)data, nbytes);
+}
+
+void UartSetTxPolicy(uart_mcu_port_t port, uart_tx_policy_t policy){
+    uart_ports[port].policy = policy;
+}
+
+void UartTxStats(uart_mcu_port_t port, uart_tx_stats_t *stats){
+    *stats = uart_ports[port].stats;
+}
+
+void UartTxStatsReset(uart_mcu_port_t port){
+    memset(&uart_ports[port].stats, 0, sizeof(uart_tx_stats_t));
+}
+
+bool UartTxFlush(uart_mcu_port_t port, uint32_t timeout_ms){
+    FILE *capture = HostBoardCapture(port);
+    if(capture != NULL){
+        fflush(capture);
+    }
+    return true;
+}
+
+uint16_t UartPrintf(uart_mcu_port_t port, const char *fmt, ...){
+    char line[PRINTF_BUFFER_SIZE];
+    va_list args;
+    uint16_t len;
+    va_start(args, fmt);
+    len = UartVsprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    return UartTxPush(port, (const uint8_t *)line, len);
+}
+
+uint16_t HostUartInject(uart_mcu_port_t port, const uint8_t *data, uint16_t length){
+    uart_host_t *uart = &uart_ports[port];
+    uint16_t accepted = 0;
+
+    if(uart->rx == NULL){
+        return 0;
+    }
+    while(accepted < length && xQueueSend(uart->rx, &data[accepted], 0) == pdTRUE){
+        accepted++;
+    }
+    if(accepted && uart->isr_p != NULL){
+        uart->isr_p(uart->user_data);
+    }
+    return accepted;
+}
+
+/*==================[end of file]============================================*/
@@ -14,6 +14,17 @@
  * @note The ESP-EDU have 4 analog inputs and 1 analog output, but the designated pin for 
  * the latter is shared with analog output 0 (CH0).
  *
+ * @note In continuous mode every channel initialized with ADC_CONTINUOUS is added to one
+ * scan pattern, sampled by DMA. Samples are delivered in frames of ANALOG_FRAME_CONVERSIONS
+ * conversions (split among the channels), either to a callback or through AnalogFrameWait().
+ * Single and continuous modes can't be used at the same time (both use ADC1).
+ *
+ * @note The analog output can play a buffer of samples at a fixed rate directly from a
+ * timer ISR (AnalogWaveStart()), with linear interpolation when the output update rate is
+ * higher than the buffer sample rate. The ISR runs from IRAM: the project needs
+ * CONFIG_SDM_CTRL_FUNC_IN_IRAM and CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM (set in every project
+ * sdkconfig, the build fails without them).
+ *
  * @author Albano Peñalva
  *
  * @section changelog
@@ -21,12 +32,19 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 24/02/2024 | Document creation		                         						|
+ * | 19/10/2026 | DMA continuous mode with frame ring		                         	|
+ * | 19/10/2026 | Calibration table and block conversions		                        |
+ * | 19/10/2026 | Waveform generator for analog output		                         	|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include <stdbool.h>
 /*==================[macros]=================================================*/
+#define ANALOG_FRAME_CONVERSIONS	256		/*!< Conversions per frame (all channels) */
+#define ANALOG_FRAME_RING			4		/*!< Frames buffered in continuous mode */
+
 typedef enum adc_ch {
 	CH0 = 0,				/*!< Channel 0 */
 	CH1,					/*!< Channel 1 */
@@ -48,11 +66,55 @@ typedef enum adc_mode {
 typedef struct {			
 	adc_ch_t input;			/*!< Inputs: CH0, CH1, CH2, CH3 */
 	adc_mode_t mode;		/*!< Mode: single read or continuous read */
-	void *func_p;			/*!< Pointer to callback function for convertion end (only for continuous mode) */
+	void *func_p;			/*!< Pointer to callback function for frame end, see analog_frame_func_t (only for continuous mode, NULL to use AnalogFrameWait()) */
 	void *param_p;			/*!< Pointer to callback function parameters (only for continuous mode) */
-	uint16_t sample_frec;	/*!< Sample frequency min: 20kHz - max: 2MHz (only for continuous mode)  */
+	uint32_t sample_frec;	/*!< Conversions per second, shared by all channels, min: 611Hz - max: 83333Hz (only for continuous mode)  */
 } analog_input_config_t;	
 
+/**
+ * @brief Block of samples acquired in continuous mode
+ * 
+ */
+typedef struct {
+	uint16_t *samples[4];	/*!< Raw samples of each channel (NULL if the channel is not sampled) */
+	uint16_t length[4];		/*!< Number of samples of each channel */
+	uint32_t seq;			/*!< Frame sequence number */
+	int64_t timestamp;		/*!< Time of frame end (us, esp_timer) */
+	uint16_t data[ANALOG_FRAME_CONVERSIONS];	/*!< Storage for samples */
+} analog_frame_t;
+
+/**
+ * @brief Prototype of the callback called (from the ADC driver task) for each frame
+ * 
+ * @note Samples are not copied: the frame is only valid until the callback returns.
+ * @param frame Pointer to frame
+ * @param param Pointer to callback function parameters
+ */
+typedef void (*analog_frame_func_t)(const analog_frame_t *frame, void *param);
+
+/**
+ * @brief Waveform generator playback modes
+ * 
+ */
+typedef enum analog_wave_mode {
+	ANALOG_WAVE_ONESHOT,	/*!< Play the buffer once, then hold the last sample */
+	ANALOG_WAVE_LOOP,		/*!< Play the buffer continuously */
+	ANALOG_WAVE_STREAM,		/*!< Play the buffers queued with AnalogWaveQueue() one after another */
+} analog_wave_mode_t;
+
+/**
+ * @brief Waveform generator config structure
+ * 
+ */
+typedef struct {
+	const uint8_t *buffer;	/*!< Samples to play (0 to 255, as in AnalogOutputWrite()) */
+	uint16_t length;		/*!< Number of samples in buffer */
+	analog_wave_mode_t mode;/*!< Playback mode */
+	uint32_t sample_rate;	/*!< Buffer samples per second */
+	uint32_t update_rate;	/*!< Output updates per second (>= sample_rate, max 100kHz), intermediate values are interpolated */
+	void *func_p;			/*!< Pointer to function called (from ISR) at the end of each buffer (NULL if not required) */
+	void *param_p;			/*!< Pointer to callback function parameters */
+} analog_wave_config_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -83,6 +145,8 @@ void AnalogInputReadSingle(adc_ch_t channel, uint16_t *value);
 /**
  * @brief Start convertion for ADC module in continuous mode
  * 
+ * @note All channels initialized in continuous mode are started (the scan
+ * pattern is fixed on the first start).
  * @param channel Channel selected
  */
 void AnalogStartContinuous(adc_ch_t channel);
@@ -95,21 +159,106 @@ void AnalogStartContinuous(adc_ch_t channel);
 void AnalogStopContinuous(adc_ch_t channel);
 
 /**
- * @brief 
+ * @brief Copy the samples of one channel from the last complete frame
  * 
  * @param channel Channel selected.
- * @param values Read variable array
+ * @param values Read variable array (at least ANALOG_FRAME_CONVERSIONS values)
+ * @return uint16_t Number of samples copied
+ */
+uint16_t AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
+
+/**
+ * @brief Wait for the oldest frame not read yet (only when no callback is used)
+ * 
+ * @note Samples are not copied: call AnalogFrameRelease() once the frame has been processed.
+ * @param timeout_ms Max waiting time
+ * @return const analog_frame_t* Frame, NULL on timeout
+ */
+const analog_frame_t * AnalogFrameWait(uint32_t timeout_ms);
+
+/**
+ * @brief Return the frame obtained with AnalogFrameWait() to the ring
+ * 
+ */
+void AnalogFrameRelease(void);
+
+/**
+ * @brief Number of frames dropped because the ring was full
+ * 
+ * @return uint32_t Dropped frames
  */
-void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
+uint32_t AnalogFrameOverruns(void);
 
 /**
  * @brief Convert raw value from ADC to mV, using a calibration curve.
  * 
+ * @note The calibration curve is expanded (on AnalogInputInit()) in a table with
+ * one entry per raw value, so conversion is a single table read. Before the ADC is
+ * initialized a linear table is used, replaced once calibration is available.
  * @param value Raw value from ADC.
  * @return uint16_t Calibrated value from ADC in mV.
  */
 uint16_t AnalogRaw2mV(uint16_t value);
 
+/**
+ * @brief Convert an array of raw values from ADC to mV, using a calibration curve.
+ * 
+ * @note raw and mv can be the same array.
+ * @param raw Raw values from ADC.
+ * @param mv Array to store calibrated values in mV.
+ * @param len Number of values.
+ */
+void AnalogRaw2mVBlock(const uint16_t *raw, uint16_t *mv, uint16_t len);
+
+/**
+ * @brief Convert an array of raw values from ADC to V, using a calibration curve.
+ * 
+ * @param raw Raw values from ADC.
+ * @param volts Array to store calibrated values in V.
+ * @param len Number of values.
+ */
+void AnalogRaw2VoltBlock(const uint16_t *raw, float *volts, uint16_t len);
+
+/**
+ * @brief Start playing a waveform on the analog output (AnalogOutputInit() must be called first).
+ * 
+ * @param config Waveform generator config structure
+ * @return true if playback started
+ */
+bool AnalogWaveStart(analog_wave_config_t *config);
+
+/**
+ * @brief Queue the next buffer in stream mode (double buffering).
+ * 
+ * @note Only one buffer can be waiting: queue the next one from the end of buffer
+ * callback (or after it). If no buffer is queued when the current one ends, the
+ * last sample is held and underruns are counted.
+ * @param buffer Samples to play
+ * @param length Number of samples
+ * @return true if queued, false if a buffer is already waiting
+ */
+bool AnalogWaveQueue(const uint8_t *buffer, uint16_t length);
+
+/**
+ * @brief Stop waveform playback (output keeps the last value).
+ * 
+ */
+void AnalogWaveStop(void);
+
+/**
+ * @brief Check if a waveform is being played.
+ * 
+ * @return true if playing
+ */
+bool AnalogWaveRunning(void);
+
+/**
+ * @brief Number of output updates without a buffer queued (stream mode).
+ * 
+ * @return uint32_t Underruns since AnalogWaveStart()
+ */
+uint32_t AnalogWaveUnderruns(void);
+
 /**
  * @brief Digital-to-Analog convert.
  * 
@@ -0,0 +1,86 @@
+#ifndef ANALOG_LUT_H
+#define ANALOG_LUT_H
+
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Analog_LUT Analog_LUT
+ ** @{ */
+
+/** \brief Raw to mV table of the ADC (see "analog_io_mcu.h").
+ *
+ * The calibration curve is expanded in a table with one entry per raw value, so
+ * converting a sample costs a single memory read. Raw values the calibration
+ * can't convert (or all of them, without calibration) take a linear full scale.
+ *
+ * @note Hardware independent: the calibration is reached through a function
+ * given by the caller.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 19/10/2026 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define ANALOG_LUT_BITS			12							/*!< ADC resolution */
+#define ANALOG_LUT_SIZE			(1 << ANALOG_LUT_BITS)		/*!< One entry per raw value */
+#define ANALOG_LUT_FULL_SCALE_MV	3300					/*!< Linear fallback full scale */
+/*==================[typedef]================================================*/
+/**
+ * @brief Calibration function
+ *
+ * @param cal Calibration handle
+ * @param raw Raw value
+ * @param mv Where the voltage is returned
+ * @return true if converted
+ */
+typedef bool (*analog_lut_cal_t)(void *cal, int raw, int *mv);
+
+/**
+ * @brief Raw to mV table
+ */
+typedef struct {
+	uint16_t mv[ANALOG_LUT_SIZE];		/*!< Voltage of each raw value */
+	void *cal;							/*!< Calibration the table was built with (NULL: linear) */
+	bool ready;							/*!< Table built */
+} analog_lut_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Build the table, unless it is already built with the same calibration
+ *
+ * @note Call it again once calibration is available: a table built without it
+ * is replaced.
+ * @param lut Table
+ * @param func Calibration function (not called if cal is NULL)
+ * @param cal Calibration handle, NULL if not available
+ */
+void AnalogLutBuild(analog_lut_t *lut, analog_lut_cal_t func, void *cal);
+
+/**
+ * @brief Convert a raw value (higher bits are ignored)
+ *
+ * @param lut Table
+ * @param raw Raw value
+ * @return uint16_t Voltage in mV
+ */
+static inline uint16_t AnalogLutRaw2mV(const analog_lut_t *lut, uint16_t raw){
+	return lut->mv[raw & (ANALOG_LUT_SIZE - 1)];
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* ANALOG_LUT_H */
+
+/*==================[end of file]============================================*/
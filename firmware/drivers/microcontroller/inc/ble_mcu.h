@@ -13,6 +13,17 @@
  * so it can be used to communicate with common Android apps, like "Bluetooth Electronics"
  * (https://play.google.com/store/apps/details?id=com.keuwl.arduinobluetooth)
  * 
+ * @note The largest ATT MTU and LE data length are negotiated on connection. Queued
+ * messages are packed into full MTU notifications and sending is paced by the 
+ * stack congestion events, so throughput is limited by the link, not by a poll.
+ * Message boundaries are not preserved (the characteristic behaves as a byte stream).
+ * 
+ * @note Outgoing data goes through a byte ring: producers reserve space and write in
+ * place (BleTxReserve() / BleTxCommit(), or BleWrite() to copy a buffer) and the BLE
+ * task sends contiguous regions of the ring directly. When the link falls behind, 
+ * the TX policy selects between blocking, dropping the oldest unsent bytes or 
+ * dropping the new message.
+ * 
  * @author Albano Peñalva
  *
  * @section changelog
@@ -20,6 +31,8 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 22/03/2024 | Document creation		                         						|
+ * | 19/10/2026 | MTU negotiation, notification packing, congestion pacing, counters	|
+ * | 19/10/2026 | Zero-copy TX ring with back-pressure policies							|
  * 
  **/
 
@@ -28,6 +41,7 @@
 #include <stdint.h>
 /*==================[macros]=================================================*/
 #define BLE_NO_INT	0		/*!< Flag used when no reading interruption is required */
+#define BLE_TX_RING_SIZE	4096	/*!< TX ring size in bytes (power of 2) */
 /*==================[typedef]================================================*/
 /**
  * @brief Prototype of callback function for reading received data 
@@ -53,6 +67,32 @@ typedef enum ble_status {
 	BLE_DISCONNECTED,		/*!< BLE device disconnected */
 	BLE_CONNECTED			/*!< BLE device connected */
 } ble_status_t;
+
+/**
+ * @brief Behaviour when the TX ring is full
+ */
+typedef enum {
+	BLE_TX_BLOCK = 0,		/*!< Wait until the BLE task frees space */
+	BLE_TX_DROP_OLDEST,		/*!< Discard the oldest unsent bytes */
+	BLE_TX_DROP_NEWEST,		/*!< Discard the new message */
+} ble_tx_policy_t;
+
+/**
+ * @brief BLE transmission counters
+ */
+typedef struct {
+	uint64_t bytes_sent;		/*!< Bytes sent in notifications */
+	uint32_t bytes_dropped;		/*!< Bytes discarded (not connected or stack error) */
+	uint32_t messages;			/*!< Messages sent (BleSend* calls) */
+	uint32_t notifications;		/*!< Notifications sent */
+	uint32_t congestion_waits;	/*!< Times sending waited for the link to drain */
+	uint32_t queue_depth;		/*!< Messages waiting to be sent */
+	uint32_t queue_max;			/*!< Maximun number of messages waiting since last reset */
+	uint32_t ring_used;			/*!< Bytes in the TX ring (waiting or being sent) */
+	uint32_t ring_max;			/*!< Maximun TX ring usage since last reset */
+	uint32_t throughput;		/*!< Average throughput since last reset (bytes/s) */
+	uint16_t mtu;				/*!< Negotiated ATT MTU */
+} ble_stats_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -72,6 +112,61 @@ void BleInit(ble_config_t * ble_device);
  */
 ble_status_t BleStatus(void);
 
+/**
+ * @brief Gets the negotiated ATT MTU (payload per notification is MTU - 3)
+ * 
+ * @return uint16_t ATT MTU
+ */
+uint16_t BleMtu(void);
+
+/**
+ * @brief Gets transmission counters
+ * 
+ * @param ble_stats Pointer to struct where counters are copied
+ */
+void BleStats(ble_stats_t *ble_stats);
+
+/**
+ * @brief Reset transmission counters
+ */
+void BleStatsReset(void);
+
+/**
+ * @brief Select the behaviour when the TX ring is full
+ * 
+ * @param policy New policy (BLE_TX_BLOCK by default)
+ */
+void BleSetTxPolicy(ble_tx_policy_t policy);
+
+/**
+ * @brief Reserve space in the TX ring to write in place
+ * 
+ * @note When it returns more than 0, BleTxCommit() must be called (from the same task)
+ * to release the ring to other producers. The reserved region is contiguous, so it 
+ * can be shorter than requested at the end of the ring: reserve again for the rest.
+ * 
+ * @param buffer Where the pointer to the reserved region is returned
+ * @param length Number of bytes needed
+ * @return uint16_t Number of contiguous bytes reserved (0 if not connected or dropped)
+ */
+uint16_t BleTxReserve(uint8_t **buffer, uint16_t length);
+
+/**
+ * @brief Publish bytes written in the region returned by BleTxReserve()
+ * 
+ * @param length Number of bytes written (up to the reserved length)
+ */
+void BleTxCommit(uint16_t length);
+
+/**
+ * @brief Copy a buffer of any length to the TX ring (if connected)
+ * 
+ * @param data Pointer to data
+ * @param length Number of bytes
+ * @return uint16_t Number of bytes accepted
+ */
+uint16_t BleWrite(const uint8_t *data, uint16_t length);
+
 /**
  * @brief Send a single byte trough BLE (if connected)
  * 
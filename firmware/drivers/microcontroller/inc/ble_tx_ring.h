@@ -0,0 +1,128 @@
+#ifndef BLE_TX_RING_H
+#define BLE_TX_RING_H
+
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup BLE_TX_Ring BLE_TX_Ring
+ ** @{ */
+
+/** \brief Byte ring of the BLE transmission (see "ble_mcu.h").
+ *
+ * Producers reserve a contiguous region at head, write in place and commit it. The
+ * sending task claims a contiguous region at tail, sends it straight from the ring
+ * and releases it. Bytes from free to head are in use: the claim in flight (from free,
+ * in_flight bytes long) and the unsent bytes (from tail to head). Drop-oldest only
+ * discards unsent bytes, never the claim in flight.
+ *
+ * @note Hardware independent. Not thread safe: callers must serialize access (the
+ * driver calls every function inside a critical section).
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 19/10/2026 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_mcu.h"
+/*==================[macros]=================================================*/
+
+/*==================[typedef]================================================*/
+/**
+ * @brief TX ring. Positions are free running byte counts (index = position & (size - 1)).
+ */
+typedef struct {
+	uint8_t *data;				/*!< Ring storage */
+	uint32_t size;				/*!< Storage size in bytes (power of 2) */
+	uint32_t head;				/*!< Next byte to write */
+	uint32_t tail;				/*!< Next byte to send */
+	uint32_t free;				/*!< Bytes before this one can be overwritten */
+	uint32_t in_flight;			/*!< Bytes claimed by the notification being sent, from free */
+} ble_tx_ring_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Initialize an empty ring
+ *
+ * @param ring TX ring
+ * @param data Storage
+ * @param size Storage size in bytes (power of 2)
+ */
+void BleTxRingInit(ble_tx_ring_t *ring, uint8_t *data, uint32_t size);
+
+/**
+ * @brief Reserve a region at head to write in place
+ *
+ * @note Room is made for the whole request (up to size bytes), but only the part up
+ * to the end of the storage is returned, so the region is contiguous: after its
+ * commit, the rest of the request fits at the start of the storage with no more drops.
+ * With BLE_TX_DROP_OLDEST the oldest unsent bytes are discarded to make room, up to
+ * the claim in flight. Otherwise (or if discarding is not enough) nothing changes.
+ *
+ * @param ring TX ring
+ * @param length Number of bytes needed
+ * @param policy TX policy
+ * @param buffer Where the pointer to the reserved region is returned
+ * @param dropped Where the number of bytes discarded is returned
+ * @return uint32_t Number of contiguous bytes reserved, 0 if there is no room
+ */
+uint32_t BleTxRingReserve(ble_tx_ring_t *ring, uint32_t length, ble_tx_policy_t policy,
+						  uint8_t **buffer, uint32_t *dropped);
+
+/**
+ * @brief Publish bytes written in the region returned by BleTxRingReserve()
+ *
+ * @param ring TX ring
+ * @param length Number of bytes written (up to the reserved length)
+ * @return uint32_t Bytes in use after the commit
+ */
+uint32_t BleTxRingCommit(ble_tx_ring_t *ring, uint32_t length);
+
+/**
+ * @brief Claim the oldest unsent bytes for sending (one claim at a time)
+ *
+ * @param ring TX ring
+ * @param max Maximum number of bytes
+ * @param buffer Where the pointer to the claimed region is returned
+ * @return uint32_t Number of contiguous bytes claimed (0: nothing to send)
+ */
+uint32_t BleTxRingClaim(ble_tx_ring_t *ring, uint32_t max, uint8_t **buffer);
+
+/**
+ * @brief Release the claim in flight once sent
+ *
+ * @param ring TX ring
+ */
+void BleTxRingRelease(ble_tx_ring_t *ring);
+
+/**
+ * @brief Discard every unsent byte (the claim in flight is kept until released)
+ *
+ * @param ring TX ring
+ * @return uint32_t Number of bytes discarded
+ */
+uint32_t BleTxRingDiscard(ble_tx_ring_t *ring);
+
+/**
+ * @brief Bytes in use (claim in flight and unsent bytes)
+ *
+ * @param ring TX ring
+ * @return uint32_t Bytes in use
+ */
+uint32_t BleTxRingUsed(const ble_tx_ring_t *ring);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* BLE_TX_RING_H */
+
+/*==================[end of file]============================================*/
@@ -12,7 +12,11 @@
  * This driver provide functions to generate delays FreeRTOS friendly, using one timer.
  * 
  * @note All delays will block the current RTOS task, with the exception of 
- * DelayUs with usec < 50.
+ * DelayUs with usec < 50 (busy wait on the CPU cycle counter).
+ * 
+ * @note A single free running timer is shared by every task: each delay only adds its
+ * deadline to a min-heap, and the timer alarm is programmed for the nearest one.
+ * Up to 16 tasks can wait at the same time (more fall back to vTaskDelay()).
  *
  * @author Albano Peñalva
  *
@@ -21,6 +25,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 20/10/2023 | Document creation		                         						|
+ * | 19/10/2026 | Persistent timer with per task deadlines		                        |
  * 
  **/
 
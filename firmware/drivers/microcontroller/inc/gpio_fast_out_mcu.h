@@ -16,6 +16,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 20/11/2023 | Document creation		                         						|
+ * | 19/10/2026 | Pin list copy fix, write with mask	                         		|
  * 
  **/
 
@@ -32,20 +33,31 @@
 /*==================[external functions declaration]=========================*/
 
 /**
- * @brief 
+ * @brief Configure a list of pins as a dedicated GPIO bundle.
  * 
- * @param pin_list 
- * @param pin_qty 
+ * @note Bit n of the values written corresponds to pin_list[n].
+ * @param pin_list Array of GPIOs in the bundle
+ * @param pin_qty Number of GPIOs in the bundle (up to 8)
  */
 void GPIOFastInit(gpio_t *pin_list, uint8_t pin_qty);
 
 /**
- * @brief 
+ * @brief Write all the pins of the bundle.
  * 
- * @param value 
+ * @param value Bit n: state of pin_list[n]
  */
 void GPIOFastWrite(uint16_t value);
 
+/**
+ * @brief Write only the pins of the bundle selected by mask, leaving the rest unchanged.
+ * 
+ * @note Placed in IRAM and written with CPU instructions, so it can be used
+ * for timing critical waveforms.
+ * @param mask Bit n: 1 to write pin_list[n]
+ * @param value Bit n: state of pin_list[n]
+ */
+void GPIOFastWriteMask(uint16_t mask, uint16_t value);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
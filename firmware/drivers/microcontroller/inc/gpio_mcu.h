@@ -19,6 +19,12 @@
  * @note GPIO_12 and GPIO_13 are not recommended for use, because using them will
  * overwrite the flash and debug functionalities via USB.
  * 
+ * @note GPIOWriteMask(), GPIOReadMask() and GPIOReadOutputMask() are inlined and access the 
+ * port registers directly. GPIOWriteMask() drives every pin to set high with one store, then 
+ * every pin to clear low with a second one: in between the pins to clear still hold their 
+ * old level. Loads that must see all the pins change at once need a latch or strobe pulsed 
+ * after the write. Pins must be configured with GPIOInit() first.
+ * 
  * @author Albano Peñalva
  *
  * @section changelog
@@ -26,13 +32,22 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/10/2023 | Document creation		                         						|
+ * | 19/10/2026 | Any edge interruption		                         						|
+ * | 19/10/2026 | GPIOWriteMask() and GPIOReadMask() port wide access		         		|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include <stdbool.h>
 #include <stdint.h>
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#endif
 /*==================[macros]=================================================*/
+/** @brief Bit of a GPIO in a port mask */
+#define GPIO_MASK(pin)		(1UL << (pin))
 
 /*==================[typedef]================================================*/
 /**
@@ -75,7 +90,21 @@ typedef enum gpio_list{
 	GPIO_23, 	/**< GPIO23 */
 } gpio_t;
 
+#if CONFIG_IDF_TARGET_LINUX
+/**
+ * @brief Port registers of the host stub backend
+ */
+typedef struct {
+	uint32_t out;		/*!< Output latch */
+	uint32_t in;		/*!< Input levels, driven by the host test */
+	uint32_t writes;	/*!< GPIOWriteMask() calls */
+	uint32_t reads;		/*!< GPIOReadMask() calls */
+} gpio_host_port_t;
+#endif
 /*==================[internal data declaration]==============================*/
+#if CONFIG_IDF_TARGET_LINUX
+extern gpio_host_port_t gpio_host_port;	/*!< Defined by the host backend */
+#endif
 
 /*==================[internal functions declaration]=========================*/
 /**
@@ -124,6 +153,55 @@ void GPIOToggle(gpio_t pin);
  */
 bool GPIORead(gpio_t pin);
 
+/**
+ * @brief Set and clear several outputs at once
+ * 
+ * @note Two stores: pins in set_mask go high first, then pins in clear_mask go low.
+ * Pins present in both masks end up low.
+ * @param set_mask pins to drive high (use GPIO_MASK())
+ * @param clear_mask pins to drive low (use GPIO_MASK())
+ */
+static inline void GPIOWriteMask(uint32_t set_mask, uint32_t clear_mask){
+#if CONFIG_IDF_TARGET_LINUX
+	gpio_host_port.out = (gpio_host_port.out | set_mask) & ~clear_mask;
+	gpio_host_port.writes++;
+#else
+	if(set_mask){
+		REG_WRITE(GPIO_OUT_W1TS_REG, set_mask);
+	}
+	if(clear_mask){
+		REG_WRITE(GPIO_OUT_W1TC_REG, clear_mask);
+	}
+#endif
+}
+
+/**
+ * @brief Reads the input level of every GPIO
+ * 
+ * @return uint32_t bit n is the level of GPIO_n
+ */
+static inline uint32_t GPIOReadMask(void){
+#if CONFIG_IDF_TARGET_LINUX
+	gpio_host_port.reads++;
+	return gpio_host_port.in;
+#else
+	return REG_READ(GPIO_IN_REG);
+#endif
+}
+
+/**
+ * @brief Reads the output latch of every GPIO
+ * 
+ * @return uint32_t bit n is the level driven on GPIO_n
+ */
+static inline uint32_t GPIOReadOutputMask(void){
+#if CONFIG_IDF_TARGET_LINUX
+	return gpio_host_port.out;
+#else
+	return REG_READ(GPIO_OUT_REG);
+#endif
+}
+
 /**
  * @brief Configure GPIO input interruption
  * 
@@ -134,6 +212,16 @@ bool GPIORead(gpio_t pin);
  */
 void GPIOActivInt(gpio_t pin, void *ptr_int_func, bool edge, void *args);
 
+/**
+ * @brief Configure GPIO input interruption on both edges
+ * 
+ * @note Use GPIORead() in the callback to know which edge occurred.
+ * @param pin GPIO number
+ * @param ptr_int_func Pointer to callback function
+ * @param args Pointer to callback function parameter
+ */
+void GPIOActivIntAnyEdge(gpio_t pin, void *ptr_int_func, void *args);
+
 /**
  * @brief Configure an input glitch filter to a GPIO
  * 
@@ -13,6 +13,19 @@
  * @note SDA: GPIO_6, SCL: GPIO_7.
  * 
  * @note ESP-EDU have 4 I2C connector in the board (J4, J5, J6 and J8), but all of them are routed to the same I2C port.
+ * 
+ * Register reads are issued as a single write + repeated start + read 
+ * transaction. Transactions are built on a statically allocated command link
+ * shared under a bus mutex. Batches of register reads/writes can be queued 
+ * with I2C_submitBatch() and are executed by a worker task, which notifies 
+ * the submitting task (and calls an optional callback) on completion.
+ * 
+ * A device can keep a shadow copy of its registers (I2C_shadowAttach()). Bit
+ * level read-modify-writes then take the current value from the shadow 
+ * instead of the bus. In deferred mode writes only update the shadow and 
+ * I2C_shadowFlush() writes the changed registers, one burst per contiguous 
+ * run. Registers the device changes by itself (status, data, self clearing 
+ * bits) must be declared with I2C_shadowSetVolatile().
  *
  * @author Juan Ignacio Cerrudo
  * 
@@ -21,6 +34,8 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 30/01/2024 | Document creation		                         |
+ * | 19/10/2026 | Repeated start reads, static link, batch queue |
+ * | 19/10/2026 | Shadow registers                               |
  *
  */
 
@@ -40,12 +55,50 @@
 #define I2C_MASTER_TX_BUF_DISABLE   0           /*!< I2C master doesn't need buffer */
 #define I2C_MASTER_RX_BUF_DISABLE   0           /*!< I2C master doesn't need buffer */
 #define I2C_MASTER_TIMEOUT_MS       1000
+#define I2C_BATCH_QUEUE_LEN         8           /*!< Batches that can be waiting for the worker task */
+#define I2C_SHADOW_DEVICES          2           /*!< Devices with shadow registers */
+#define I2C_SHADOW_REGS             128         /*!< Registers shadowed per device (multiple of 32) */
+
+/**
+ * @brief Batch operation type
+ */
+typedef enum {
+	I2C_OP_READ = 0,	/*!< Read length bytes starting at reg_addr */
+	I2C_OP_WRITE,		/*!< Write length bytes starting at reg_addr */
+} i2c_op_type_t;
+
+/**
+ * @brief One register access of a batch
+ */
+typedef struct {
+	i2c_op_type_t type;		/*!< Read or write */
+	uint8_t dev_addr;		/*!< I2C slave device address */
+	uint8_t reg_addr;		/*!< First register address */
+	uint8_t length;			/*!< Number of bytes */
+	uint8_t *data;			/*!< Data buffer */
+	int16_t result;			/*!< Filled on completion: bytes transferred, 0 on error */
+} i2c_op_t;
+
+/**
+ * @brief Batch of register accesses executed in order by the worker task
+ */
+typedef struct {
+	i2c_op_t *ops;			/*!< Operations */
+	uint8_t op_qty;			/*!< Number of operations */
+	void *func_p;			/*!< Pointer to function called from the worker task when done void f(i2c_batch_t *batch, void *param) (NULL: none) */
+	void *param_p;			/*!< Pointer to callback function parameters */
+	uint8_t errors;			/*!< Filled on completion: number of failed operations */
+	volatile bool done;		/*!< Set when every operation was executed */
+	void *owner;			/*!< Task notified on completion (set by I2C_submitBatch) */
+} i2c_batch_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
 
 /** @fn I2C_initialize( uint32_t clockRateHz )
  * @brief Initialize I2C0
+ * @note Transfers before it fail (return 0 / false)
+ * @return true if the driver was installed
  */
 bool I2C_initialize( uint32_t clockRateHz );
 
@@ -105,9 +158,9 @@ int8_t I2C_readWord(uint8_t devAddr, uint8_t regAddr, uint16_t *data, uint16_t t
  * @param length Number of bytes to read
  * @param data Buffer to store read data in
  * @param timeout Optional read timeout in milliseconds (0 to disable, leave off to use default class value in I2C_readTimeout)
- * @return I2C_TransferReturn_TypeDef
+ * @return Number of bytes read, 0 on error
  */
-int8_t I2C_readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout);
+int16_t I2C_readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout);
 
 /** @fn I2C_writeBit(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint8_t data);
  * @brief write a single bit in an 8-bit device register.
@@ -165,6 +218,61 @@ bool I2C_writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *d
  */
 void I2C_SelectRegister(uint8_t devAddr, uint8_t reg);
 
+/** @fn I2C_shadowAttach(uint8_t devAddr)
+ * @brief Keep a shadow copy of the registers of a device
+ * @param devAddr I2C slave device address
+ * @return true if there was a free shadow slot
+ */
+bool I2C_shadowAttach(uint8_t devAddr);
+
+/** @fn I2C_shadowSetVolatile(uint8_t devAddr, uint8_t regAddr, uint8_t length)
+ * @brief Declare registers changed by the device itself; they are never cached
+ * @param devAddr I2C slave device address
+ * @param regAddr First register
+ * @param length Number of registers
+ */
+void I2C_shadowSetVolatile(uint8_t devAddr, uint8_t regAddr, uint8_t length);
+
+/** @fn I2C_shadowInvalidate(uint8_t devAddr, uint8_t regAddr, uint8_t length)
+ * @brief Forget the shadow value of registers (e.g. after a device reset); pending writes are dropped
+ * @param devAddr I2C slave device address
+ * @param regAddr First register
+ * @param length Number of registers
+ */
+void I2C_shadowInvalidate(uint8_t devAddr, uint8_t regAddr, uint8_t length);
+
+/** @fn I2C_shadowDefer(uint8_t devAddr, bool defer)
+ * @brief Select deferred (local until flush) or write-through mode
+ * @param devAddr I2C slave device address
+ * @param defer true: deferred, false: write-through
+ */
+void I2C_shadowDefer(uint8_t devAddr, bool defer);
+
+/** @fn I2C_shadowFlush(uint8_t devAddr)
+ * @brief Write the changed registers, coalescing contiguous ones in one burst
+ * @param devAddr I2C slave device address
+ * @return Status of operation (true = success)
+ */
+bool I2C_shadowFlush(uint8_t devAddr);
+
+/** @fn I2C_submitBatch(i2c_batch_t *batch)
+ * @brief Queue a batch of register accesses, without blocking
+ * @note The batch and its buffers must remain valid until it is done
+ * @param batch Batch to execute
+ * @return true if the batch was queued
+ */
+bool I2C_submitBatch(i2c_batch_t *batch);
+
+/** @fn I2C_waitBatch(i2c_batch_t *batch, uint32_t timeout_ms)
+ * @brief Block the submitting task until the batch is done
+ * @param batch Batch submitted by the calling task
+ * @note After a timeout the batch is still pending: its notification is
+ * given when it is done and must be taken by the submitting task
+ * @param timeout_ms Maximun time to wait
+ * @return true if the batch is done
+ */
+bool I2C_waitBatch(i2c_batch_t *batch, uint32_t timeout_ms);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -14,6 +14,17 @@
  * @note It can setup up to 4 PWM outputs, with independet duty 
  * cycle and frequency configuration
  *
+ * @note The duty resolution is chosen from the frequency: the timer runs with as many bits
+ * as the 80 MHz source allows (up to 20 bits at 50 Hz, 10 bits at 78 kHz). Besides the
+ * percent API, the duty can be set in native ticks (0 to PWMGetMaxTicks()) or as a Q16
+ * fraction (PWM_Q16_ONE is 100 %).
+ *
+ * @note PWMGroupInit() drives several outputs from one timer (the one of the first output),
+ * so they share frequency and are phase aligned. PWMGroupSetDutyQ16() latches the new duty 
+ * of every output of the group on the same PWM period.
+ *
+ * @note PWMFadeQ16() ramps the duty in hardware, without CPU load.
+ *
  * @author Albano Peñalva
  * 
  * @section changelog
@@ -21,13 +32,17 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 23/01/2024 | Document creation		                         |
+ * | 19/10/2026 | Ticks/Q16 duty, auto resolution, groups, fades |
  *
  */
 
 /*==================[inclusions]=============================================*/
 #include <stdint.h>
+#include <stdbool.h>
 #include <gpio_mcu.h>
 /*==================[macros]=================================================*/
+#define PWM_Q16_ONE					65536UL										/*!< 100 % duty in Q16 */
+#define PWM_Q16_PERCENT(percent)	((uint32_t)(((uint32_t)(percent) * PWM_Q16_ONE) / 100))	/*!< Percent to Q16 */
 
 /*==================[typedef]================================================*/
 typedef enum pwm_out {
@@ -83,6 +98,74 @@ void PWMSetDutyCycle(pwm_out_t out, uint8_t duty_cycle);
  */
 uint8_t PWMSetFreq(pwm_out_t out, uint32_t freq);
 
+/**
+ * @brief Initialize several PWM outputs driven by a single timer
+ * 
+ * @note The timer of outs[0] is used, outputs start with duty cycle 0%. Pausing one
+ * output of a group with PWMOff() stops only that output, and PWMSetFreq() on any of 
+ * them changes the frequency of the whole group.
+ * 
+ * @param outs array of PWM outputs
+ * @param gpios array of GPIO pin numbers, one for each output
+ * @param qty number of outputs
+ * @param freq PWM wave frequency
+ * @return uint8_t 0 if ok
+ */
+uint8_t PWMGroupInit(const pwm_out_t *outs, const gpio_t *gpios, uint8_t qty, uint32_t freq);
+
+/**
+ * @brief Duty resolution of an PWM output
+ * 
+ * @param out PWM output 
+ * @return uint8_t bits of the timer the output is attached to
+ */
+uint8_t PWMGetResolution(pwm_out_t out);
+
+/**
+ * @brief Ticks of a full PWM period (100 % duty)
+ * 
+ * @param out PWM output 
+ * @return uint32_t 2^resolution
+ */
+uint32_t PWMGetMaxTicks(pwm_out_t out);
+
+/**
+ * @brief Change PWM duty cycle of an PWM output in timer ticks
+ * 
+ * @param out PWM output 
+ * @param ticks high time in ticks (0 to PWMGetMaxTicks())
+ */
+void PWMSetDutyTicks(pwm_out_t out, uint32_t ticks);
+
+/**
+ * @brief Change PWM duty cycle of an PWM output as a Q16 fraction
+ * 
+ * @note The duty is kept across PWMSetFreq() even if the resolution changes.
+ * @param out PWM output 
+ * @param duty_q16 duty cycle (0 to PWM_Q16_ONE)
+ */
+void PWMSetDutyQ16(pwm_out_t out, uint32_t duty_q16);
+
+/**
+ * @brief Change the duty cycle of several outputs of a group on the same PWM period
+ * 
+ * @param outs array of PWM outputs (initialized with PWMGroupInit())
+ * @param duty_q16 array of duty cycles (0 to PWM_Q16_ONE), one for each output
+ * @param qty number of outputs
+ */
+void PWMGroupSetDutyQ16(const pwm_out_t *outs, const uint32_t *duty_q16, uint8_t qty);
+
+/**
+ * @brief Ramp the duty cycle of an PWM output in hardware
+ * 
+ * @param out PWM output 
+ * @param duty_q16 final duty cycle (0 to PWM_Q16_ONE)
+ * @param time_ms ramp duration in ms
+ * @param wait true: return when the ramp ends - false: return immediately
+ * @return uint8_t 0 if ok
+ */
+uint8_t PWMFadeQ16(pwm_out_t out, uint32_t duty_q16, uint32_t time_ms, bool wait);
+
 /**
  * @brief PWM output de-inicialization
  * 
@@ -14,6 +14,12 @@
  * 
  * @note MISO: GPIO_22, MOSI: GPIO_21, SCLK: GPIO_20, CS1: GPIO_19, CS2: GPIO_18, CS3: GPIO_9
  * 
+ * @note SpiSubmit() queues a transaction and returns at once. Each device owns a pool of 
+ * SPI_QUEUE_SIZE preallocated transactions, so no more than that can be in flight per device.
+ * Completion callbacks run in a driver task, not in the ISR. Buffers passed to SpiSubmit()
+ * must stay valid until the callback runs (or SpiWaitAll() returns), and should come from 
+ * SpiDmaAlloc() to avoid a bounce copy.
+ * 
  * @author Albano Peñalva
  *
  * @section changelog
@@ -21,12 +27,14 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 09/02/2024 | Document creation		                         						|
+ * | 19/10/2026 | Asynchronous SpiSubmit() with transaction pool and SpiWaitAll()		|
  * 
  **/
 /*==================[inclusions]=============================================*/
 #include <stdbool.h>
 #include <stdint.h>
 /*==================[macros]=================================================*/
+#define SPI_QUEUE_SIZE		8		/*!< Transactions that can be queued per device */
 
 /*==================[typedef]================================================*/
 
@@ -108,6 +116,46 @@ void SpiWrite(spi_dev_t device, uint8_t * tx_buffer, uint32_t tx_buffer_size);
  */
 void SpiReadWrite(spi_dev_t device, uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size);
 
+/**
+ * @brief Queue a transaction on a SPI device without waiting for it to end
+ * 
+ * @note Blocks only while the device pool is exhausted. func_p is called from the SPI 
+ * driver task as void func_p(void *tag) once the transaction is done.
+ * 
+ * @param device SPI device
+ * @param tx_buffer pointer to data to write (NULL for read only)
+ * @param rx_buffer pointer to buffer where data read is stored (NULL for write only)
+ * @param buffer_size numbers of bytes to transfer
+ * @param func_p pointer to completion callback (can be NULL)
+ * @param tag user value passed to the callback
+ * @return true if the transaction was queued
+ */
+bool SpiSubmit(spi_dev_t device, uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size, void *func_p, void *tag);
+
+/**
+ * @brief Wait until every transaction submitted to a device has completed
+ * 
+ * @param device SPI device
+ * @param timeout_ms max time to wait in ms
+ * @return true if the device is idle, false on timeout
+ */
+bool SpiWaitAll(spi_dev_t device, uint32_t timeout_ms);
+
+/**
+ * @brief Allocate a DMA capable buffer for SPI transfers
+ * 
+ * @param size numbers of bytes (rounded up to a multiple of 4)
+ * @return void* pointer to buffer, NULL if there is no memory
+ */
+void *SpiDmaAlloc(uint32_t size);
+
+/**
+ * @brief Release a buffer allocated with SpiDmaAlloc()
+ * 
+ * @param buffer pointer to buffer
+ */
+void SpiDmaFree(void *buffer);
+
 /**
  * @brief De-Initialize SPI module with the corresponding configuration
  * 
@@ -9,6 +9,17 @@
  ** @{ */
 
 /** \brief Timer driver for the ESP-EDU Board.
+ * 
+ * Two kinds of timers are available:
+ * - TIMER_A, TIMER_B and TIMER_C: one hardware timer each, with 1us resolution.
+ * - Soft timers (soft_timer_t): any number of one-shot or periodic timers sharing a single
+ *   hardware timer (timer service), with TIMER_SERVICE_TICK_US resolution. The callback can
+ *   be called from the ISR, from the timer service task, or replaced by a task notification.
+ * 
+ * @note The timer service interrupt only comes when a soft timer expires (or every
+ * TIMER_WHEEL_SLOTS ticks while the next expiration is further away), not on each tick.
+ * Callbacks called from the ISR run out of the service lock, so they can start and stop
+ * soft timers.
  * 
  * @author Albano Peñalva
  *
@@ -17,12 +28,17 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 20/10/2023 | Document creation		                         						|
+ * | 19/10/2026 | Table driven hardware timers, soft timers service                    	|
+ * | 19/10/2026 | SoftTimerSetPeriod()                                                 	|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include <stdbool.h>
+#include "timer_wheel.h"
 /*==================[macros]=================================================*/
+#define TIMER_SERVICE_TICK_US	1000	/*!< Soft timers resolution (us) */
 
 /*==================[typedef]================================================*/
 /**
@@ -42,6 +58,48 @@ typedef struct {
 	void *func_p;			/*!< Pointer to callback function to call periodically */
 	void *param_p;			/*!< Pointer to callback function parameter */
 } timer_config_t;
+/**
+ * @brief Context where soft timers callbacks are called
+ */
+typedef enum timer_dispatch {
+	TIMER_DISPATCH_ISR,			/*!< From the timer service ISR (keep it short, IRAM) */
+	TIMER_DISPATCH_TASK,		/*!< From the timer service task */
+	TIMER_DISPATCH_NOTIFY,		/*!< No callback: give a notification to the task in param_p (NULL: task calling SoftTimerInit()) */
+} timer_dispatch_t;
+/**
+ * @brief Soft timer configuration struct
+ */
+typedef struct {
+	uint32_t period;			/*!< Period (in us, rounded up to TIMER_SERVICE_TICK_US) */
+	bool periodic;				/*!< true: periodic, false: one-shot */
+	timer_dispatch_t dispatch;	/*!< Context where callback is called */
+	void *func_p;				/*!< Pointer to callback function (not used with TIMER_DISPATCH_NOTIFY) */
+	void *param_p;				/*!< Pointer to callback function parameter (task handle with TIMER_DISPATCH_NOTIFY) */
+} soft_timer_config_t;
+/**
+ * @brief Soft timer statistics
+ */
+typedef struct {
+	uint32_t runs;				/*!< Times the timer expired since started */
+	uint32_t missed;			/*!< Expirations lost because the service task queue was full */
+	uint32_t max_jitter_us;		/*!< Max deviation of the interval between callbacks from the period */
+	uint64_t sum_jitter_us;		/*!< Sum of deviations (mean: sum_jitter_us / (runs - 1)) */
+} soft_timer_stats_t;
+/**
+ * @brief Soft timer (memory provided by the user, fields are private)
+ */
+typedef struct soft_timer {
+	tw_timer_t wheel;			/*!< Timer wheel entry */
+	uint32_t period_us;			/*!<  */
+	bool periodic;				/*!<  */
+	timer_dispatch_t dispatch;	/*!<  */
+	void (*func_p)(void *);		/*!<  */
+	void *param_p;				/*!<  */
+	int64_t last_run;			/*!< Time of last callback (us) */
+	soft_timer_stats_t stats;	/*!<  */
+	struct soft_timer *run_next;	/*!< Next TIMER_DISPATCH_ISR timer to run in the service ISR */
+	uint16_t run_due;			/*!< Expirations to run in the service ISR */
+} soft_timer_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -75,6 +133,77 @@ void TimerStop(timer_mcu_t timer);
  */
 void TimerReset(timer_mcu_t timer);
 
+/**
+ * @brief Timer service initialization (called by SoftTimerInit() if needed)
+ * 
+ */
+void TimerServiceInit(void);
+
+/**
+ * @brief Soft timer initialization
+ * 
+ * @note Timer is stopped after init
+ * 
+ * @param timer Pointer to soft timer (must remain valid while it is used)
+ * @param config Pointer to soft timer configuration
+ */
+void SoftTimerInit(soft_timer_t *timer, soft_timer_config_t *config);
+
+/**
+ * @brief Start (or restart) a soft timer: first expiration one period later
+ * 
+ * @param timer Pointer to soft timer
+ */
+void SoftTimerStart(soft_timer_t *timer);
+
+/**
+ * @brief Change the period of a soft timer
+ * 
+ * @note The new period is used from the next SoftTimerStart(), so a one-shot timer can be
+ * re-armed with a different delay from its own callback.
+ * 
+ * @param timer Pointer to soft timer
+ * @param period Period (in us, rounded up to TIMER_SERVICE_TICK_US)
+ */
+void SoftTimerSetPeriod(soft_timer_t *timer, uint32_t period);
+
+/**
+ * @brief Stop a soft timer
+ * 
+ * @param timer Pointer to soft timer
+ */
+void SoftTimerStop(soft_timer_t *timer);
+
+/**
+ * @brief Check if a soft timer is waiting to expire
+ * 
+ * @param timer Pointer to soft timer
+ * @return true if started and not expired (one-shot) or stopped
+ */
+bool SoftTimerIsActive(soft_timer_t *timer);
+
+/**
+ * @brief Read soft timer statistics
+ * 
+ * @param timer Pointer to soft timer
+ * @param stats Pointer to struct where statistics will be stored
+ */
+void SoftTimerStats(soft_timer_t *timer, soft_timer_stats_t *stats);
+
+/**
+ * @brief Clear soft timer statistics
+ * 
+ * @param timer Pointer to soft timer
+ */
+void SoftTimerStatsReset(soft_timer_t *timer);
+
+/**
+ * @brief Number of expirations lost because the service task queue was full
+ * 
+ * @return uint32_t Lost expirations
+ */
+uint32_t TimerServiceOverruns(void);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
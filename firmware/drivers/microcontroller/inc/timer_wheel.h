@@ -0,0 +1,140 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Timer_Wheel Timer_Wheel
+ ** @{ */
+
+/** \brief Hierarchical timer wheel: core of the timer service (see "timer_mcu.h").
+ * 
+ * Four levels of 64 slots each. Timers are kept in the slot of the tick (or group of
+ * ticks) when they expire, so insert and cancel are O(1) and advancing one tick only
+ * looks at one slot (plus cascading one slot of the upper levels every 64 ticks).
+ * 
+ * @note Hardware independent: time is given by the caller in ticks, so it can be
+ * driven by a timer interrupt or by a simulated clock on a host. Not thread safe:
+ * callers must serialize access.
+ * 
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 19/10/2026 | Document creation		                         						|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define TIMER_WHEEL_BITS		6								/*!< log2 of slots per level */
+#define TIMER_WHEEL_SLOTS		(1 << TIMER_WHEEL_BITS)			/*!< Slots per level */
+#define TIMER_WHEEL_LEVELS		4								/*!< Levels */
+#define TIMER_WHEEL_MAX_TICKS	((1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)	/*!< Longest timeout */
+/*==================[typedef]================================================*/
+/**
+ * @brief Timer wheel entry
+ */
+typedef struct tw_timer {
+	struct tw_timer *next;		/*!< Next entry in slot */
+	struct tw_timer *prev;		/*!< Previous entry in slot */
+	uint32_t expires;			/*!< Absolute expiration tick */
+	uint32_t period;			/*!< Reload period in ticks (0: one-shot) */
+	void *owner;				/*!< Free for the user of the wheel */
+} tw_timer_t;
+
+/**
+ * @brief Timer wheel
+ */
+typedef struct {
+	uint32_t now;											/*!< Next tick to be processed */
+	tw_timer_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];	/*!< List heads (circular) */
+} tw_wheel_t;
+
+/**
+ * @brief Prototype of the function called for each expired timer
+ * 
+ * @note The timer has already been removed (and re-added if periodic), so
+ * it can be added or canceled from this function.
+ * @param timer Expired timer
+ * @param param Pointer given to TimerWheelAdvance()
+ */
+typedef void (*tw_expire_t)(tw_timer_t *timer, void *param);
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Initialize an empty wheel
+ * 
+ * @param wheel Timer wheel
+ * @param now Current tick
+ */
+void TimerWheelInit(tw_wheel_t *wheel, uint32_t now);
+
+/**
+ * @brief Initialize a timer entry (not pending)
+ * 
+ * @param timer Timer entry
+ */
+void TimerWheelTimerInit(tw_timer_t *timer);
+
+/**
+ * @brief Add a timer, expiring delay ticks after the current tick
+ * 
+ * @note If the timer was pending it is moved. Delays longer than
+ * TIMER_WHEEL_MAX_TICKS are clamped.
+ * @param wheel Timer wheel
+ * @param timer Timer entry
+ * @param delay Ticks until expiration (0 expires on next advance)
+ * @param period Reload period in ticks (0: one-shot)
+ */
+void TimerWheelAdd(tw_wheel_t *wheel, tw_timer_t *timer, uint32_t delay, uint32_t period);
+
+/**
+ * @brief Remove a pending timer (nothing happens if not pending)
+ * 
+ * @param timer Timer entry
+ */
+void TimerWheelCancel(tw_timer_t *timer);
+
+/**
+ * @brief Check if a timer is waiting to expire
+ * 
+ * @param timer Timer entry
+ * @return true if pending
+ */
+bool TimerWheelPending(const tw_timer_t *timer);
+
+/**
+ * @brief Process every tick up to now, calling func for each expired timer
+ * 
+ * @param wheel Timer wheel
+ * @param now Current tick
+ * @param func Function called for each expired timer
+ * @param param Pointer passed to func
+ * @return uint32_t Number of timers expired
+ */
+uint32_t TimerWheelAdvance(tw_wheel_t *wheel, uint32_t now, tw_expire_t func, void *param);
+
+/**
+ * @brief Ticks until the first pending timer expires, to sleep until then
+ * 
+ * @note TimerWheelAdvance() up to wheel->now + delay is the first one expiring a
+ * timer. Looks at one slot list per level (up to TIMER_WHEEL_SLOTS heads each).
+ * @param wheel Timer wheel
+ * @param delay Ticks from wheel->now (the next tick to be processed)
+ * @return true if a timer is pending (delay is set)
+ */
+bool TimerWheelNextExpiry(const tw_wheel_t *wheel, uint32_t *delay);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
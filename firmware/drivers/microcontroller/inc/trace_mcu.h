@@ -0,0 +1,223 @@
+#ifndef TRACE_MCU_H
+#define TRACE_MCU_H
+
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Trace Trace
+ ** @{ */
+
+/** \brief Execution trace probes timestamped with the CPU cycle counter.
+ *
+ * TRACE_BEGIN() / TRACE_END() mark the start and end of a section of code and
+ * TRACE_COUNTER() samples a value. Each probe stores an 8 byte record (cycle count,
+ * id, type and value) in a RAM ring of the core it runs on: no locks, no calls, so
+ * probes can be used inside interrupts and cost a few tens of cycles. When the ring
+ * is full the oldest records are overwritten. Recording starts at boot.
+ *
+ * TraceDump() sends the rings in binary form through a UART port; the host tool
+ * tools/trace2json.py converts them to the Chrome trace format (chrome://tracing,
+ * ui.perfetto.dev):
+ * @code
+ * python tools/trace2json.py /dev/ttyUSB0 -o trace.json
+ * @endcode
+ *
+ * Probes are only compiled when TRACE_ENABLED is 1, for every component of the
+ * project (project CMakeLists.txt, before project()):
+ * @code
+ * add_compile_definitions(TRACE_ENABLED=1)
+ * @endcode
+ * Otherwise the macros expand to nothing (their arguments are not evaluated), no
+ * RAM is reserved and the functions of this driver do nothing.
+ *
+ * @note The cycle counter is 32 bits wide (26 s at 160 MHz): the host tool unwraps
+ * it, so two consecutive records of a core must be less than half that apart.
+ * On the virtual board (linux target) time is taken in microseconds.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 19/10/2026 | Document creation		                         						|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart_mcu.h"
+#include "sdkconfig.h"
+#if defined(CONFIG_IDF_TARGET_LINUX)
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#include "soc/soc_caps.h"
+#endif
+/*==================[macros]=================================================*/
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED		0		/*!< 1: compile the probes */
+#endif
+
+#ifndef TRACE_RING_RECORDS
+#define TRACE_RING_RECORDS	1024	/*!< Records per core (power of 2) */
+#endif
+
+#if defined(CONFIG_IDF_TARGET_LINUX)
+#define TRACE_CORES			1								/*!< Rings */
+#define TRACE_CYCLES_HZ		1000000UL						/*!< Time stamp resolution */
+#else
+#define TRACE_CORES			SOC_CPU_CORES_NUM				/*!< Rings */
+#define TRACE_CYCLES_HZ		(CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000UL)	/*!< Time stamp resolution */
+#endif
+
+#define TRACE_ID_MAX		64		/*!< Number of trace ids */
+
+#if TRACE_ENABLED
+/** @brief Mark the start of section id */
+#define TRACE_BEGIN(id)				TraceRecord((id), TRACE_EV_BEGIN, 0)
+/** @brief Mark the end of section id */
+#define TRACE_END(id)				TraceRecord((id), TRACE_EV_END, 0)
+/** @brief Sample value of counter id (saturated to int16_t) */
+#define TRACE_COUNTER(id, value)	TraceRecord((id), TRACE_EV_COUNTER, (value))
+#else
+#define TRACE_BEGIN(id)				do{}while(0)
+#define TRACE_END(id)				do{}while(0)
+#define TRACE_COUNTER(id, value)	do{}while(0)
+#endif
+/*==================[typedef]================================================*/
+/**
+ * @brief Trace ids used by the drivers. Application ids start at TRACE_ID_USER
+ * and are named with TraceSetName().
+ */
+typedef enum {
+	TRACE_ID_TIMER_ISR = 0,		/*!< TIMER_A/B/C user function */
+	TRACE_ID_TIMER_SERVICE,		/*!< Timer service tick */
+	TRACE_ID_SOFT_TIMER,		/*!< Soft timer user function */
+	TRACE_ID_FFT,				/*!< FFTMagnitude() */
+	TRACE_ID_IIR_LOW,			/*!< LowPassFilter() biquad cascade */
+	TRACE_ID_IIR_HIGH,			/*!< HiPassFilter() biquad cascade */
+	TRACE_ID_LCD_WRITE,			/*!< ILI9341 command/data transfer */
+	TRACE_ID_UART_SEND,			/*!< Copy into the UART TX ring */
+	TRACE_ID_UART_USED,			/*!< Counter: bytes in the UART TX ring */
+	TRACE_ID_BLE_WRITE,			/*!< Copy into the BLE TX ring */
+	TRACE_ID_BLE_NOTIFY,		/*!< One BLE notification */
+	TRACE_ID_BLE_USED,			/*!< Counter: bytes in the BLE TX ring */
+	TRACE_ID_USER = 32,			/*!< First application id */
+} trace_id_t;
+
+/**
+ * @brief Record types
+ */
+typedef enum {
+	TRACE_EV_BEGIN = 0,			/*!< Section start */
+	TRACE_EV_END,				/*!< Section end */
+	TRACE_EV_COUNTER,			/*!< Counter sample */
+} trace_event_t;
+
+/**
+ * @brief Trace record, as stored in the ring and sent by TraceDump()
+ */
+typedef struct {
+	uint32_t cycles;			/*!< CPU cycle counter */
+	uint8_t id;					/*!< trace_id_t or application id */
+	uint8_t type;				/*!< trace_event_t */
+	int16_t value;				/*!< Counter value */
+} trace_record_t;
+
+/**
+ * @brief Ring of one core. Only written by the probes of that core.
+ */
+typedef struct {
+	uint32_t head;								/*!< Records written since TraceClear() */
+	trace_record_t records[TRACE_RING_RECORDS];	/*!<  */
+} trace_ring_t;
+/*==================[external data declaration]==============================*/
+#if TRACE_ENABLED
+extern trace_ring_t trace_rings[TRACE_CORES];	/*!< Used by TraceRecord() */
+extern volatile bool trace_running;				/*!< Used by TraceRecord() */
+#endif
+/*==================[external functions declaration]=========================*/
+#if TRACE_ENABLED
+/**
+ * @brief Current time stamp, in 1 / TRACE_CYCLES_HZ units
+ */
+static inline __attribute__((always_inline)) uint32_t TraceCycles(void){
+#if defined(CONFIG_IDF_TARGET_LINUX)
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)(now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+#else
+	return esp_cpu_get_cycle_count();
+#endif
+}
+
+/**
+ * @brief Store a record in the ring of the calling core. Use the TRACE_ macros.
+ */
+static inline __attribute__((always_inline)) void TraceRecord(uint8_t id, uint8_t type, int32_t value){
+	trace_ring_t *ring;
+	trace_record_t *record;
+	uint32_t cycles;
+
+	if(!trace_running){
+		return;
+	}
+	cycles = TraceCycles();
+#if TRACE_CORES > 1
+	ring = &trace_rings[esp_cpu_get_core_id()];
+#else
+	ring = &trace_rings[0];
+#endif
+	/* an interrupt between claim and write takes the next slot, so no lock is needed */
+	record = &ring->records[__atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED) & (TRACE_RING_RECORDS - 1)];
+	record->cycles = cycles;
+	record->id = id;
+	record->type = type;
+	record->value = (value > INT16_MAX) ? INT16_MAX : ((value < INT16_MIN) ? INT16_MIN : value);
+}
+#endif
+
+/**
+ * @brief Resume recording (also done by TraceClear())
+ */
+void TraceStart(void);
+
+/**
+ * @brief Stop recording, rings keep their content
+ */
+void TraceStop(void);
+
+/**
+ * @brief Empty the rings and start recording
+ */
+void TraceClear(void);
+
+/**
+ * @brief Name an application id, shown by the host tool
+ *
+ * @param[in] id TRACE_ID_USER ... TRACE_ID_MAX - 1
+ * @param[in] name Constant string (the pointer is kept)
+ */
+void TraceSetName(uint8_t id, const char *name);
+
+/**
+ * @brief Send the rings through a UART port (already initialized), oldest records
+ * first. Recording is paused while sending and resumed afterwards.
+ *
+ * Format (little endian): "TRC1", u32 TRACE_CYCLES_HZ, u8 cores, u8 record size,
+ * u16 names; each name: u8 id, u8 length, chars; each core: u32 records,
+ * u32 overwritten, records; "TEND".
+ *
+ * @param[in] port UART port
+ */
+void TraceDump(uart_mcu_port_t port);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* TRACE_MCU_H */
+
+/*==================[end of file]============================================*/
@@ -9,6 +9,10 @@
  ** @{ */
 
 /** \brief UART driver for the ESP-EDU Board.
+ * 
+ * @note Transmission is buffered: send functions copy data into a software ring
+ * (one per port) and return, a driver task moves it to the UART in blocks. When
+ * the ring is full the port policy (serial_config_t.tx_policy) is applied.
  * 
  * @author Albano Peñalva
  *
@@ -17,11 +21,14 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 02/07/2024 | Document creation		                         						|
+ * | 19/10/2026 | Buffered TX ring, policies, counters and formatting	         		|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include <stdbool.h>
+#include <stdarg.h>
 /*==================[macros]=================================================*/
 #define UART_NO_INT	0		/*!< Flag used when no reading interruption is required */
 /*==================[typedef]================================================*/
@@ -32,6 +39,24 @@ typedef enum uart_ports{
 	UART_PC,				/*!< UART connected PC through USB port (indicated with UART) (also maped to TX: GPIO16, RX: GPIO17) */
 	UART_CONNECTOR,			/*!< UART connected to J2 connector (TX: GPIO18, RX: GPIO19) */
 } uart_mcu_port_t;
+/**
+ * @brief What to do when the TX ring has no room for a message
+ */
+typedef enum uart_tx_policies{
+	UART_TX_BLOCK = 0,		/*!< Wait until the whole message is queued (default) */
+	UART_TX_NON_BLOCK,		/*!< Queue as much as fits and return */
+	UART_TX_DROP,			/*!< Queue the whole message or nothing */
+} uart_tx_policy_t;
+/**
+ * @brief TX path counters
+ */
+typedef struct {
+	uint32_t bytes_queued;	/*!< Bytes accepted in the TX ring */
+	uint32_t bytes_sent;	/*!< Bytes moved to the UART driver */
+	uint32_t bytes_dropped;	/*!< Bytes discarded due to full ring */
+	uint32_t msgs_dropped;	/*!< Writes truncated or discarded due to full ring */
+	uint32_t max_used;		/*!< TX ring high water mark (bytes) */
+} uart_tx_stats_t;
 /**
  * @brief Serial port configuration struct
  */
@@ -40,6 +65,7 @@ typedef struct {
 	uint32_t baud_rate;		/*!< baudrate (bits per second) */
 	void *func_p;			/*!< Pointer to callback function to call when receiving data (= UART_NO_INT if not requiered)*/
 	void *param_p;			/*!< Pointer to callback function parameters */
+	uart_tx_policy_t tx_policy;	/*!< Behaviour when TX ring is full (UART_TX_BLOCK if not set) */
 } serial_config_t;
 /*==================[external data declaration]==============================*/
 
@@ -97,6 +123,112 @@ void UartSendString(uart_mcu_port_t port, const char *msg);
  */
 void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes);
 
+/**
+ * @brief Queue multiple bytes for transmission, following the port TX policy
+ * 
+ * @param port Port for sending data
+ * @param data Pointer to data to be transmitted
+ * @param nbytes Number of bytes to be sended
+ * @return uint16_t Number of bytes queued
+ */
+uint16_t UartWrite(uart_mcu_port_t port, const void *data, uint16_t nbytes);
+
+/**
+ * @brief Change the behaviour of a port when its TX ring is full
+ * 
+ * @param port Serial port
+ * @param policy New policy
+ */
+void UartSetTxPolicy(uart_mcu_port_t port, uart_tx_policy_t policy);
+
+/**
+ * @brief Read TX path counters
+ * 
+ * @param port Serial port
+ * @param stats Pointer to struct where counters will be stored
+ */
+void UartTxStats(uart_mcu_port_t port, uart_tx_stats_t *stats);
+
+/**
+ * @brief Clear TX path counters
+ * 
+ * @param port Serial port
+ */
+void UartTxStatsReset(uart_mcu_port_t port);
+
+/**
+ * @brief Wait until all queued data has been transmitted
+ * 
+ * @param port Serial port
+ * @param timeout_ms Max waiting time
+ * @return true if all data was transmitted before timeout
+ */
+bool UartTxFlush(uart_mcu_port_t port, uint32_t timeout_ms);
+
+/**
+ * @brief Format a formatted line and queue it with a single write
+ * 
+ * @note Supported conversions: %d %i %u %x %b %c %s %f %%. With the 'l' modifier the
+ * argument is read as long and narrowed to 32 bits. A NULL string prints "(null)".
+ * Floats use 2 decimals unless a precision is given (e.g. %.4f, up to 6).
+ * Lines are truncated to 127 characters.
+ * 
+ * @param port Port for sending data
+ * @param fmt Format string
+ * @return uint16_t Number of bytes queued
+ */
+uint16_t UartPrintf(uart_mcu_port_t port, const char *fmt, ...);
+
+/**
+ * @brief Same as UartPrintf(), but writing in a caller owned buffer
+ * 
+ * @param buf Output buffer (always '\0' terminated)
+ * @param size Size of buf
+ * @param fmt Format string
+ * @return uint16_t Number of characters written (without '\0')
+ */
+uint16_t UartSprintf(char *buf, uint16_t size, const char *fmt, ...);
+
+/**
+ * @brief Same as UartSprintf(), with a variable argument list
+ * 
+ * @param buf Output buffer (always '\0' terminated)
+ * @param size Size of buf
+ * @param fmt Format string
+ * @param args Arguments
+ * @return uint16_t Number of characters written (without '\0')
+ */
+uint16_t UartVsprintf(char *buf, uint16_t size, const char *fmt, va_list args);
+
+/**
+ * @brief Convert an unsigned number to a String in a caller owned buffer
+ * 
+ * @param buf Output buffer (at least 33 bytes for base 2, 11 for base 10)
+ * @param val Number to be converted
+ * @param base Base of the converted number (2 to 16)
+ * @return uint8_t Number of characters written (without '\0')
+ */
+uint8_t UartFmtUint(char *buf, uint32_t val, uint8_t base);
+
+/**
+ * @brief Convert a signed number to a decimal String in a caller owned buffer
+ * 
+ * @param buf Output buffer (at least 12 bytes)
+ * @param val Number to be converted
+ * @return uint8_t Number of characters written (without '\0')
+ */
+uint8_t UartFmtInt(char *buf, int32_t val);
+
+/**
+ * @brief Convert a float to a String with fixed decimals in a caller owned buffer
+ * 
+ * @param buf Output buffer (at least 19 bytes)
+ * @param val Number to be converted
+ * @param decimals Number of decimals (up to 6)
+ * @return uint8_t Number of characters written (without '\0')
+ */
+uint8_t UartFmtFloat(char *buf, float val, uint8_t decimals);
+
 /**
  * @brief Convert a number to a String (char array ended with '\0')
  * 
@@ -10,21 +10,76 @@
  */
 
 /*==================[inclusions]=============================================*/
+#include "sdkconfig.h"
 #include "analog_io_mcu.h"
+#include "analog_lut.h"
 #include "driver/gptimer.h"
 #include "driver/sdm.h"
 #include "esp_adc/adc_cali_scheme.h"
 #include "esp_adc/adc_oneshot.h"
 #include "esp_adc/adc_continuous.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include <string.h>
 /*==================[macros and definitions]=================================*/
 #define ADC_BITWIDTH 		SOC_ADC_DIGI_MAX_BITWIDTH	// 12 bit resolution
 #define ADC_ATTENUATION		ADC_ATTEN_DB_11				// 12dB attenuation (for 0-3,3V ADC range)
+#define ADC_CHANNELS		4							// CH0 to CH3
+#define ADC_CONV_FRAME_SIZE	(ANALOG_FRAME_CONVERSIONS * SOC_ADC_DIGI_RESULT_BYTES)	// DMA frame size (bytes)
+
+/* AnalogWaveIsr() runs from IRAM and calls the SDM and GPTimer drivers */
+#if !CONFIG_SDM_CTRL_FUNC_IN_IRAM || !CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM
+#error "analog_io_mcu needs CONFIG_SDM_CTRL_FUNC_IN_IRAM and CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM (menuconfig)"
+#endif
+#define ADC_POOL_SIZE		(ANALOG_FRAME_RING * ADC_CONV_FRAME_SIZE)				// driver pool size (bytes)
+#define ADC_TASK_STACK		2048
+#define ADC_TASK_PRIO		13							// above UART event tasks
+#define WAVE_TIMER_FREQ		10000000					// 10MHz waveform timer resolution
+#define WAVE_MAX_RATE		100000						// max SDM updates per second
+#define Q16_SHIFT			16
+#define DAC_OFFSET			128							// pulse density = value - 128
 /*==================[internal data declaration]==============================*/
 adc_cali_handle_t adc_calibration_single, adc_calibration_cont;
 adc_oneshot_unit_handle_t adc1_single; 
-adc_continuous_handle_t adc2_cont;
+adc_continuous_handle_t adc1_cont = NULL;
 sdm_channel_handle_t dac = NULL;
 bool adc1_single_used = false;
+static uint8_t cont_channels = 0;					/* bit n: CHn in the scan pattern */
+static uint32_t cont_sample_freq = 0;				/* conversions per second (all channels) */
+static analog_frame_func_t frame_func_p = NULL;		/* per frame callback */
+static void *frame_param_p = NULL;
+static TaskHandle_t adc_task_handle = NULL;
+static SemaphoreHandle_t frames_ready = NULL;		/* counts frames waiting in the ring */
+static analog_frame_t frame_ring[ANALOG_FRAME_RING];
+static volatile uint32_t frame_head = 0;			/* next frame to be filled (ADC task) */
+static volatile uint32_t frame_tail = 0;			/* next frame to be read (user) */
+static analog_frame_t *last_frame = NULL;			/* last complete frame, guarded by frame_mutex */
+static SemaphoreHandle_t frame_mutex = NULL;		/* held by the ADC task while it fills a frame */
+static uint32_t frame_seq = 0;
+static uint32_t frame_overruns = 0;
+static uint8_t conv_buffer[ADC_CONV_FRAME_SIZE];
+static analog_lut_t raw2mv_lut;						/* calibration curve expanded (ADC_BITWIDTH == ANALOG_LUT_BITS) */
+/**
+ * @brief Waveform generator state (shared with the timer ISR)
+ */
+typedef struct {
+	const uint8_t *buffer;				/*!< Buffer being played */
+	uint16_t length;					/*!< Length of buffer being played */
+	const uint8_t * volatile next;		/*!< Buffer queued (stream mode), published after next_length */
+	volatile uint16_t next_length;		/*!< Length of queued buffer */
+	analog_wave_mode_t mode;			/*!< One-shot, loop or stream */
+	uint32_t phase;						/*!< Position in buffer (samples, Q16.16) */
+	uint32_t step;						/*!< Phase increment per output update (Q16.16) */
+	volatile bool running;				/*!<  */
+	volatile uint32_t underruns;		/*!< Updates with no buffer queued (stream mode) */
+	void (*func_p)(void *param);		/*!< Called from ISR at the end of each buffer */
+	void *param_p;						/*!<  */
+} analog_wave_t;
+static analog_wave_t wave = {0};
+static gptimer_handle_t wave_timer = NULL;
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -39,7 +94,174 @@ adc_oneshot_chan_cfg_t adc_config_single = {
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static bool IRAM_ATTR AdcConvDone(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data){
+	BaseType_t task_woken = pdFALSE;
+	vTaskNotifyGiveFromISR(adc_task_handle, &task_woken);
+	return (task_woken == pdTRUE);
+}
+
+static bool AdcCaliRaw2mV(void *cal, int raw, int *mv){
+	return adc_cali_raw_to_voltage((adc_cali_handle_t)cal, raw, mv) == ESP_OK;
+}
+
+/**
+ * @brief Expand the curve fitting calibration in raw2mv_lut (see analog_lut.h).
+ * A linear table built before the calibration existed is replaced.
+ */
+static void AdcBuildLut(void){
+	AnalogLutBuild(&raw2mv_lut, AdcCaliRaw2mV, adc_calibration_single);
+}
+
+/**
+ * @brief Waveform timer ISR: one SDM update with linear interpolation
+ * between the two nearest buffer samples.
+ */
+static bool IRAM_ATTR AnalogWaveIsr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx){
+	uint32_t idx = wave.phase >> Q16_SHIFT;
+	int32_t frac = wave.phase & ((1 << Q16_SHIFT) - 1);
+	int32_t a, b;
+	const uint8_t *next = __atomic_load_n(&wave.next, __ATOMIC_ACQUIRE);
+
+	a = wave.buffer[idx];
+	if(idx + 1 < wave.length){
+		b = wave.buffer[idx + 1];
+	}else if(wave.mode == ANALOG_WAVE_LOOP){
+		b = wave.buffer[0];
+	}else if(wave.mode == ANALOG_WAVE_STREAM && next != NULL){
+		b = next[0];
+	}else{
+		b = a;
+	}
+	sdm_channel_set_pulse_density(dac, (a + (((b - a) * frac) >> Q16_SHIFT)) - DAC_OFFSET);
+
+	wave.phase += wave.step;
+	if((wave.phase >> Q16_SHIFT) >= wave.length){
+		switch(wave.mode){
+			case ANALOG_WAVE_LOOP:
+				wave.phase -= (uint32_t)wave.length << Q16_SHIFT;
+			break;
+			case ANALOG_WAVE_ONESHOT:
+				gptimer_stop(wave_timer);
+				wave.phase = (uint32_t)(wave.length - 1) << Q16_SHIFT;
+				wave.running = false;
+			break;
+			case ANALOG_WAVE_STREAM:
+				if(next != NULL){
+					wave.phase -= (uint32_t)wave.length << Q16_SHIFT;
+					wave.length = wave.next_length;
+					wave.buffer = next;
+					__atomic_store_n(&wave.next, NULL, __ATOMIC_RELEASE);
+				}else{
+					/* hold last sample until a new buffer is queued */
+					wave.phase = (uint32_t)(wave.length - 1) << Q16_SHIFT;
+					wave.underruns++;
+					return false;
+				}
+			break;
+		}
+		if(wave.func_p != NULL){
+			wave.func_p(wave.param_p);
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Split a DMA frame in one block of samples per channel.
+ */
+static void AdcDemux(analog_frame_t *frame, const uint8_t *raw, uint32_t len){
+	uint8_t qty = __builtin_popcount(cont_channels);
+	uint16_t per_channel = ANALOG_FRAME_CONVERSIONS / qty;
+	uint16_t offset = 0;
+	adc_digi_output_data_t *conv;
+
+	for(uint8_t ch = 0; ch < ADC_CHANNELS; ch++){
+		frame->length[ch] = 0;
+		if(cont_channels & (1 << ch)){
+			frame->samples[ch] = &frame->data[offset];
+			offset += per_channel;
+		}else{
+			frame->samples[ch] = NULL;
+		}
+	}
+	for(uint32_t i = 0; i < len; i += SOC_ADC_DIGI_RESULT_BYTES){
+		conv = (adc_digi_output_data_t *)&raw[i];
+		uint8_t ch = conv->type2.channel;
+		if(ch < ADC_CHANNELS && frame->samples[ch] != NULL && frame->length[ch] < per_channel){
+			frame->samples[ch][frame->length[ch]++] = conv->type2.data;
+		}
+	}
+}
 
+/**
+ * @brief Reads every DMA frame once it is complete: no CPU work per sample
+ * besides the demultiplexing.
+ */
+static void AdcContinuousTask(void *param){
+	uint32_t len;
+	analog_frame_t *frame;
+	while(1){
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		while(adc_continuous_read(adc1_cont, conv_buffer, ADC_CONV_FRAME_SIZE, &len, 0) == ESP_OK){
+			if(frame_func_p == NULL && (frame_head - frame_tail) >= ANALOG_FRAME_RING){
+				/* user still holds every frame: drop the new one */
+				frame_overruns++;
+				continue;
+			}
+			frame = &frame_ring[frame_head % ANALOG_FRAME_RING];
+			/* a slow AnalogInputReadContinuous() could be copying this frame */
+			xSemaphoreTake(frame_mutex, portMAX_DELAY);
+			AdcDemux(frame, conv_buffer, len);
+			frame->seq = frame_seq++;
+			frame->timestamp = esp_timer_get_time();
+			last_frame = frame;
+			xSemaphoreGive(frame_mutex);
+			if(frame_func_p != NULL){
+				frame_func_p(frame, frame_param_p);
+				frame_head++;
+				frame_tail = frame_head;
+			}else{
+				frame_head++;
+				xSemaphoreGive(frames_ready);
+			}
+		}
+	}
+}
+
+static void AdcContinuousSetup(void){
+	adc_digi_pattern_config_t pattern[ADC_CHANNELS] = {0};
+	uint8_t qty = 0;
+
+	adc_continuous_handle_cfg_t handle_config = {
+		.max_store_buf_size = ADC_POOL_SIZE,
+		.conv_frame_size = ADC_CONV_FRAME_SIZE,
+	};
+	ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_config, &adc1_cont));
+	for(uint8_t ch = 0; ch < ADC_CHANNELS; ch++){
+		if(cont_channels & (1 << ch)){
+			pattern[qty].atten = ADC_ATTENUATION;
+			pattern[qty].channel = ADC_CHANNEL_0 + ch;
+			pattern[qty].unit = ADC_UNIT_1;
+			pattern[qty].bit_width = ADC_BITWIDTH;
+			qty++;
+		}
+	}
+	adc_continuous_config_t adc_config = {
+		.pattern_num = qty,
+		.adc_pattern = pattern,
+		.sample_freq_hz = cont_sample_freq,
+		.conv_mode = ADC_CONV_SINGLE_UNIT_1,
+		.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+	};
+	ESP_ERROR_CHECK(adc_continuous_config(adc1_cont, &adc_config));
+	frames_ready = xSemaphoreCreateCounting(ANALOG_FRAME_RING, 0);
+	frame_mutex = xSemaphoreCreateMutex();
+	xTaskCreate(AdcContinuousTask, "adc_cont_task", ADC_TASK_STACK, NULL, ADC_TASK_PRIO, &adc_task_handle);
+	adc_continuous_evt_cbs_t callbacks = {
+		.on_conv_done = AdcConvDone,
+	};
+	ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc1_cont, &callbacks, NULL));
+}
 /*==================[external functions definition]==========================*/
 
 void AnalogInputInit(analog_input_config_t *config){
@@ -53,7 +275,10 @@ void AnalogInputInit(analog_input_config_t *config){
 				.atten = ADC_ATTENUATION,
 				.bitwidth = ADC_BITWIDTH,
 			};
-			adc_cali_create_scheme_curve_fitting(&cali_config_1, &adc_calibration_single);
+			if(adc_calibration_single == NULL){
+				adc_cali_create_scheme_curve_fitting(&cali_config_1, &adc_calibration_single);
+			}
+			AdcBuildLut();
         	if(!adc1_single_used){
 				adc_oneshot_new_unit(&init_config_single, &adc1_single);
 				adc1_single_used = true;
@@ -74,19 +299,29 @@ void AnalogInputInit(analog_input_config_t *config){
 			}
 		break;
 		case ADC_CONTINUOUS:
-			switch(config->input){
-				case CH0:
-
-				break;
-				case CH1:
-
-				break;
-				case CH2:
-
-				break;
-				case CH3:
-
-				break;
+			// same calibration curve, to be used with AnalogRaw2mV()
+			adc_cali_curve_fitting_config_t cali_config_2 = {
+				.unit_id = ADC_UNIT_1,
+				.atten = ADC_ATTENUATION,
+				.bitwidth = ADC_BITWIDTH,
+			};
+			if(adc_calibration_single == NULL){
+				adc_cali_create_scheme_curve_fitting(&cali_config_2, &adc_calibration_single);
+			}
+			AdcBuildLut();
+			// channels are added to the scan pattern, configured on first start
+			cont_channels |= (1 << config->input);
+			if(config->sample_frec != 0){
+				cont_sample_freq = config->sample_frec;
+			}
+			if(cont_sample_freq < SOC_ADC_SAMPLE_FREQ_THRES_LOW){
+				cont_sample_freq = SOC_ADC_SAMPLE_FREQ_THRES_LOW;
+			}else if(cont_sample_freq > SOC_ADC_SAMPLE_FREQ_THRES_HIGH){
+				cont_sample_freq = SOC_ADC_SAMPLE_FREQ_THRES_HIGH;
+			}
+			if(config->func_p != NULL){
+				frame_func_p = (analog_frame_func_t)config->func_p;
+				frame_param_p = config->param_p;
 			}
 		break;
 	}
@@ -120,21 +355,144 @@ void AnalogInputReadSingle(adc_ch_t channel, uint16_t *value){
 }
 
 void AnalogStartContinuous(adc_ch_t channel){
-
+	if(cont_channels == 0){
+		return;
+	}
+	if(adc1_cont == NULL){
+		AdcContinuousSetup();
+	}
+	adc_continuous_start(adc1_cont);
 }
 
 void AnalogStopContinuous(adc_ch_t channel){
+	if(adc1_cont != NULL){
+		adc_continuous_stop(adc1_cont);
+	}
+}
+
+uint16_t AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values){
+	uint16_t length = 0;
+
+	if(frame_mutex == NULL){
+		return 0;
+	}
+	/* the ADC task can't refill the frame while it is copied */
+	xSemaphoreTake(frame_mutex, portMAX_DELAY);
+	if(last_frame != NULL && last_frame->samples[channel] != NULL){
+		length = last_frame->length[channel];
+		memcpy(values, last_frame->samples[channel], length * sizeof(uint16_t));
+	}
+	xSemaphoreGive(frame_mutex);
+	return length;
+}
 
+const analog_frame_t * AnalogFrameWait(uint32_t timeout_ms){
+	if(frames_ready == NULL || xSemaphoreTake(frames_ready, pdMS_TO_TICKS(timeout_ms)) != pdTRUE){
+		return NULL;
+	}
+	return &frame_ring[frame_tail % ANALOG_FRAME_RING];
 }
 
-void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values){
+void AnalogFrameRelease(void){
+	if(frame_tail != frame_head){
+		frame_tail++;
+	}
+}
 
+uint32_t AnalogFrameOverruns(void){
+	return frame_overruns;
 }
 
 uint16_t AnalogRaw2mV(uint16_t value){
-	uint16_t volt;
-	adc_cali_raw_to_voltage(adc_calibration_single, value, (int*)&volt);
-	return volt;
+	AdcBuildLut();
+	return AnalogLutRaw2mV(&raw2mv_lut, value);
+}
+
+void AnalogRaw2mVBlock(const uint16_t *raw, uint16_t *mv, uint16_t len){
+	AdcBuildLut();
+	for(uint16_t i = 0; i < len; i++){
+		mv[i] = AnalogLutRaw2mV(&raw2mv_lut, raw[i]);
+	}
+}
+
+void AnalogRaw2VoltBlock(const uint16_t *raw, float *volts, uint16_t len){
+	AdcBuildLut();
+	for(uint16_t i = 0; i < len; i++){
+		volts[i] = AnalogLutRaw2mV(&raw2mv_lut, raw[i]) * 0.001f;
+	}
+}
+
+bool AnalogWaveStart(analog_wave_config_t *config){
+	uint32_t update_rate = config->update_rate;
+
+	if(dac == NULL || config->buffer == NULL || config->length == 0 || config->sample_rate == 0){
+		return false;
+	}
+	if(update_rate < config->sample_rate){
+		update_rate = config->sample_rate;
+	}
+	if(update_rate > WAVE_MAX_RATE){
+		update_rate = WAVE_MAX_RATE;
+	}
+	AnalogWaveStop();
+	wave.buffer = config->buffer;
+	wave.length = config->length;
+	wave.next = NULL;
+	wave.mode = config->mode;
+	wave.phase = 0;
+	wave.step = ((uint64_t)config->sample_rate << Q16_SHIFT) / update_rate;
+	wave.underruns = 0;
+	wave.func_p = config->func_p;
+	wave.param_p = config->param_p;
+
+	if(wave_timer == NULL){
+		gptimer_config_t timer_config = {
+			.clk_src = GPTIMER_CLK_SRC_DEFAULT,
+			.direction = GPTIMER_COUNT_UP,
+			.resolution_hz = WAVE_TIMER_FREQ,
+		};
+		ESP_ERROR_CHECK(gptimer_new_timer(&timer_config, &wave_timer));
+		gptimer_event_callbacks_t callbacks = {
+			.on_alarm = AnalogWaveIsr,
+		};
+		gptimer_register_event_callbacks(wave_timer, &callbacks, NULL);
+		gptimer_enable(wave_timer);
+	}
+	gptimer_alarm_config_t alarm_config = {
+		.alarm_count = WAVE_TIMER_FREQ / update_rate,
+		.reload_count = 0,
+		.flags.auto_reload_on_alarm = true,
+	};
+	gptimer_set_alarm_action(wave_timer, &alarm_config);
+	gptimer_set_raw_count(wave_timer, 0);
+	wave.running = true;
+	gptimer_start(wave_timer);
+	return true;
+}
+
+bool AnalogWaveQueue(const uint8_t *buffer, uint16_t length){
+	if(wave.next != NULL || buffer == NULL || length == 0){
+		return false;
+	}
+	wave.next_length = length;
+	/* the ISR sees the buffer only once its length is written */
+	__atomic_store_n(&wave.next, buffer, __ATOMIC_RELEASE);
+	return true;
+}
+
+void AnalogWaveStop(void){
+	if(wave_timer != NULL && wave.running){
+		gptimer_stop(wave_timer);
+	}
+	wave.running = false;
+}
+
+bool AnalogWaveRunning(void){
+	return wave.running;
+}
+
+uint32_t AnalogWaveUnderruns(void){
+	return wave.underruns;
 }
 
 void AnalogOutputWrite(uint8_t value){
@@ -0,0 +1,44 @@
+/**
+ * @file analog_lut.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "analog_lut.h"
+#include <stddef.h>
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+void AnalogLutBuild(analog_lut_t *lut, analog_lut_cal_t func, void *cal){
+	int mv;
+
+	if(lut->ready && (lut->cal == cal)){
+		return;
+	}
+	for(int raw = 0; raw < ANALOG_LUT_SIZE; raw++){
+		if((cal == NULL) || !func(cal, raw, &mv)){
+			mv = (raw * ANALOG_LUT_FULL_SCALE_MV) / (ANALOG_LUT_SIZE - 1);
+		}
+		lut->mv[raw] = (mv < 0) ? 0 : ((mv > UINT16_MAX) ? UINT16_MAX : mv);
+	}
+	lut->cal = cal;
+	lut->ready = true;
+}
+
+/*==================[end of file]============================================*/
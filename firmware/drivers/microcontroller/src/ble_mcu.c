@@ -11,6 +11,8 @@
 
 /*==================[inclusions]=============================================*/
 #include "ble_mcu.h"
+#include "ble_tx_ring.h"
+#include "trace_mcu.h"
 #include <stdint.h>
 #include <string.h>
 
@@ -27,15 +29,23 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_gatt_common_api.h"
+#include "esp_timer.h"
 /*==================[macros and definitions]=================================*/
 #define TAG "ble_mcu"
-#define MTU_MAX_BYTES		20	 /* GATT Maximum Transmission Unit */
-#define PAYLOAD_SIZE        128  /* Maximun number of bytes transmitted in one transaction */
+#define MTU_DEFAULT			23	 /* ATT MTU before negotiation */
+#define MTU_LOCAL			517	 /* Largest ATT MTU offered to the peer */
+#define ATT_HDR_BYTES		3	 /* Notification header (opcode + handle) */
+#define DATA_LEN_MAX		251	 /* LE data length extension, link layer payload */
+#define EVENTS_QUEUE_LEN	32	 /* Pending events and outgoing messages */
+#define CONGEST_TIMEOUT_MS	1000 /* Maximun time waiting for the link to drain */
+#define PAYLOAD_SIZE        128  /* Maximun number of bytes received in one write */
 #define SPP_PROFILE_NUM     1       
 #define SPP_PROFILE_APP_IDX 0
 #define ESP_SPP_APP_ID      0x56
 #define SPP_SVC_INST_ID     0
-#define SPP_DATA_MAX_LEN    (128) /* Maximun number of bytes transmitted in one transaction */
+#define SPP_DATA_MAX_LEN    (MTU_LOCAL - ATT_HDR_BYTES) /* Maximun number of bytes transmitted in one notification */
 /* List of attributes to be added to the service database */
 enum{
     SPP_IDX_SVC,
@@ -59,7 +69,7 @@ typedef enum {
     CMD_BLUETOOTH_AUTH,          /* device authentification */
     CMD_BLUETOOTH_DATA,          /* data reception */
     CMD_BLUETOOTH_DISCONNECT,    /* device disconnection */
-    CMD_SEND_DATA,               /* data transmission */
+    CMD_TX_KICK,                 /* data waiting in the TX ring */
 } comd_bt_ev_t;
 /* Struct used to handle Bluetooth events */
 typedef struct {
@@ -92,6 +102,20 @@ struct gatts_profile_inst {
 };
 QueueHandle_t xQueueEvents = NULL;  /* Queue for handling Bluettoth events */
 QueueHandle_t xQueueRead = NULL;    /* Queue for handling received data */
+static volatile uint16_t mtu = MTU_DEFAULT;     /* Negotiated ATT MTU */
+static volatile bool congested = false;         /* Link layer buffers full */
+static SemaphoreHandle_t uncongested = NULL;    /* Given when the congestion clears */
+static ble_stats_t stats;                       /* Throughput and queue counters */
+static int64_t stats_start;                     /* Time of the last counters reset */
+/* TX byte ring (see ble_tx_ring.h): producers (under tx_mutex) write in place, the
+ * events task sends one claim at a time. Positions are taken under tx_lock. */
+static uint8_t tx_data[BLE_TX_RING_SIZE];
+static ble_tx_ring_t tx_ring = {.data = tx_data, .size = BLE_TX_RING_SIZE};
+static ble_tx_policy_t tx_policy = BLE_TX_BLOCK;
+static portMUX_TYPE tx_lock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t tx_mutex = NULL;       /* One producer at a time */
+static SemaphoreHandle_t tx_space = NULL;       /* Given when ring space is released */
+static bool tx_kick = false;                    /* A CMD_TX_KICK is already queued */
 
 /*==================[internal functions declaration]=========================*/
 static void gatts_profile_event_handler(esp_gatts_cb_event_t event,
@@ -298,6 +322,7 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event,
 	switch (event) {
 		case ESP_GATTS_REG_EVT:
 			esp_ble_gap_set_device_name(device_name);
+			esp_ble_gatt_set_local_mtu(MTU_LOCAL);
 			//generate a resolvable random address
 			esp_ble_gap_config_local_privacy(true);
 			esp_ble_gap_config_adv_data_raw((uint8_t *)spp_adv_data, sizeof(spp_adv_data));
@@ -307,13 +332,16 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event,
 			break;
 		case ESP_GATTS_WRITE_EVT:
 			cmdBuf.command = CMD_BLUETOOTH_DATA;
-			memcpy(cmdBuf.payload, param->write.value, param->write.len);
-			cmdBuf.length = param->write.len;
+			/* with a large MTU the peer can write more than a payload */
+			cmdBuf.length = (param->write.len > PAYLOAD_SIZE) ? PAYLOAD_SIZE : param->write.len;
+			memcpy(cmdBuf.payload, param->write.value, cmdBuf.length);
 			xQueueSend(xQueueRead, &cmdBuf, 0);
 			break;
 		case ESP_GATTS_EXEC_WRITE_EVT:
 			break;
 		case ESP_GATTS_MTU_EVT:
+			mtu = param->mtu.mtu;
+			ESP_LOGI(TAG, "MTU %d", mtu);
 			break;
 		case ESP_GATTS_CONF_EVT:
 			break;
@@ -328,6 +356,16 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event,
 		case ESP_GATTS_CONNECT_EVT:
 			/* start security connect with peer device when receive the connect event sent by the master */
 			esp_ble_set_encryption(param->connect.remote_bda, ESP_BLE_SEC_ENCRYPT_MITM);
+			/* longest link layer packets and shortest connection interval for streaming */
+			esp_ble_gap_set_pkt_data_len(param->connect.remote_bda, DATA_LEN_MAX);
+			esp_ble_conn_update_params_t conn_params = {
+				.min_int = 0x06,		/* x 1.25ms */
+				.max_int = 0x0C,		/* x 1.25ms */
+				.latency = 0,
+				.timeout = 400,			/* x 10ms */
+			};
+			memcpy(conn_params.bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+			esp_ble_gap_update_conn_params(&conn_params);
 			cmdBuf.command = CMD_BLUETOOTH_CONNECT;
 			cmdBuf.spp_conn_id = p_data->connect.conn_id;
 			cmdBuf.spp_gatts_if = gatts_if;
@@ -336,6 +374,9 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event,
 		case ESP_GATTS_DISCONNECT_EVT:
 			cmdBuf.command = CMD_BLUETOOTH_DISCONNECT;
 			status = BLE_DISCONNECTED;
+			mtu = MTU_DEFAULT;
+			congested = false;
+			xSemaphoreGive(uncongested);
 			xQueueSend(xQueueEvents, &cmdBuf, portMAX_DELAY);
 			/* start advertising again when missing the connect */
 			esp_ble_gap_start_advertising(&spp_adv_params);
@@ -349,6 +390,10 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event,
 		case ESP_GATTS_LISTEN_EVT:
 			break;
 		case ESP_GATTS_CONGEST_EVT:
+			congested = param->congest.congested;
+			if(!congested){
+				xSemaphoreGive(uncongested);
+			}
 			break;
 		case ESP_GATTS_CREAT_ATTR_TAB_EVT: {
 			if (param->create.status == ESP_GATT_OK){
@@ -403,14 +448,61 @@ static void read_task(void* pvParameters) {
 	} 
 }
 
+/* Send one notification, pacing on the link congestion instead of a fixed delay */
+static void ble_notify(esp_gatt_if_t gatts_if, uint16_t conn_id, uint8_t *data, uint16_t length){
+	if(congested){
+		stats.congestion_waits++;
+		xSemaphoreTake(uncongested, 0);
+		if(congested){
+			xSemaphoreTake(uncongested, pdMS_TO_TICKS(CONGEST_TIMEOUT_MS));
+		}
+	}
+	TRACE_BEGIN(TRACE_ID_BLE_NOTIFY);
+	if(esp_ble_gatts_send_indicate(gatts_if, conn_id, spp_handle_table[SPP_IDX_SPP_DATA_NOTIFY_VAL], length, data, false) == ESP_OK){
+		stats.bytes_sent += length;
+		stats.notifications++;
+	} else{
+		stats.bytes_dropped += length;
+	}
+	TRACE_END(TRACE_ID_BLE_NOTIFY);
+}
+
+/* Drop everything waiting in the TX ring */
+static void ble_tx_discard(void){
+	taskENTER_CRITICAL(&tx_lock);
+	stats.bytes_dropped += BleTxRingDiscard(&tx_ring);
+	taskEXIT_CRITICAL(&tx_lock);
+	xSemaphoreGive(tx_space);
+}
+
+/* Send the TX ring content straight from the ring, one MTU (or contiguous region) per notification */
+static void ble_tx_drain(esp_gatt_if_t gatts_if, uint16_t conn_id){
+	uint8_t *data;
+	uint16_t length;
+
+	__atomic_store_n(&tx_kick, false, __ATOMIC_RELEASE);
+	while(status == BLE_CONNECTED){
+		taskENTER_CRITICAL(&tx_lock);
+		length = BleTxRingClaim(&tx_ring, mtu - ATT_HDR_BYTES, &data);
+		taskEXIT_CRITICAL(&tx_lock);
+		if(length == 0){
+			return;
+		}
+		ble_notify(gatts_if, conn_id, data, length);
+		taskENTER_CRITICAL(&tx_lock);
+		BleTxRingRelease(&tx_ring);
+		taskEXIT_CRITICAL(&tx_lock);
+		xSemaphoreGive(tx_space);
+	}
+	ble_tx_discard();
+}
+
 void bluetooth_events_task(void * arg) {
 	CMD_t cmdBuf;
 	uint16_t spp_conn_id = 0xffff;
 	esp_gatt_if_t spp_gatts_if = 0xff;
-	int data_sent, i;
 
 	while(1){
-		vTaskDelay(50 / portTICK_PERIOD_MS);
 		xQueueReceive(xQueueEvents, &cmdBuf, portMAX_DELAY);
         switch(cmdBuf.command){
             case CMD_BLUETOOTH_CONNECT:
@@ -424,22 +516,10 @@ void bluetooth_events_task(void * arg) {
             case CMD_BLUETOOTH_DISCONNECT:
                 ESP_LOGI(TAG, "Device disconnected");
 				status = BLE_DISCONNECTED;
+				ble_tx_discard();
             break;
-            case CMD_SEND_DATA:
-                if (status == BLE_CONNECTED) {
-					data_sent = 0;
-					i = 0;
-					while(data_sent < cmdBuf.length){
-						if((cmdBuf.length - data_sent) > MTU_MAX_BYTES){
-							esp_ble_gatts_send_indicate(spp_gatts_if, spp_conn_id, spp_handle_table[SPP_IDX_SPP_DATA_NOTIFY_VAL], MTU_MAX_BYTES, &cmdBuf.payload[i*MTU_MAX_BYTES], false);
-							data_sent += MTU_MAX_BYTES;
-							i++;
-						}else{
-							esp_ble_gatts_send_indicate(spp_gatts_if, spp_conn_id, spp_handle_table[SPP_IDX_SPP_DATA_NOTIFY_VAL], cmdBuf.length - data_sent, &cmdBuf.payload[i*MTU_MAX_BYTES], false);
-							data_sent += MTU_MAX_BYTES;
-						}
-					}
-                }
+            case CMD_TX_KICK:
+				ble_tx_drain(spp_gatts_if, spp_conn_id);
             break;
             case CMD_BLUETOOTH_DATA:
                 xQueueSend(xQueueRead, &cmdBuf, portMAX_DELAY);
@@ -517,7 +597,14 @@ esp_err_t ret;
 	esp_ble_gap_set_security_param(ESP_BLE_SM_SET_RSP_KEY, &rsp_key, sizeof(uint8_t));
 	
     /* Create Queue */
-	xQueueEvents = xQueueCreate(10, sizeof(CMD_t));
+	uncongested = xSemaphoreCreateBinary();
+	configASSERT(uncongested);
+	tx_mutex = xSemaphoreCreateMutex();
+	configASSERT(tx_mutex);
+	tx_space = xSemaphoreCreateBinary();
+	configASSERT(tx_space);
+	BleStatsReset();
+	xQueueEvents = xQueueCreate(EVENTS_QUEUE_LEN, sizeof(CMD_t));
 	configASSERT(xQueueEvents);
 	xQueueRead = xQueueCreate( 10, sizeof(CMD_t) );
 	configASSERT(xQueueRead);
@@ -531,36 +618,108 @@ ble_status_t BleStatus(void){
 	return status;
 }
 
-void BleSendByte(const char *data){
-	CMD_t cmdBuf;
-	if(status == BLE_CONNECTED){
-		cmdBuf.command = CMD_SEND_DATA;
-		cmdBuf.length = 1;
-		memcpy(cmdBuf.payload, data, cmdBuf.length);
-		xQueueSend(xQueueEvents, &cmdBuf, portMAX_DELAY);
+uint16_t BleMtu(void){
+	return mtu;
+}
+
+void BleStats(ble_stats_t *ble_stats){
+	int64_t elapsed = esp_timer_get_time() - stats_start;
+
+	*ble_stats = stats;
+	ble_stats->mtu = mtu;
+	ble_stats->queue_depth = (xQueueEvents != NULL) ? uxQueueMessagesWaiting(xQueueEvents) : 0;
+	ble_stats->ring_used = BleTxRingUsed(&tx_ring);
+	ble_stats->throughput = (elapsed > 0) ? (uint32_t)((stats.bytes_sent * 1000000ULL) / elapsed) : 0;
+}
+
+void BleStatsReset(void){
+	memset(&stats, 0, sizeof(stats));
+	stats_start = esp_timer_get_time();
+}
+
+void BleSetTxPolicy(ble_tx_policy_t policy){
+	tx_policy = policy;
+}
+
+uint16_t BleTxReserve(uint8_t **buffer, uint16_t length){
+	uint32_t reserved, dropped;
+
+	if((status != BLE_CONNECTED) || (length == 0)){
+		return 0;
+	}
+	xSemaphoreTake(tx_mutex, portMAX_DELAY);
+	while(1){
+		taskENTER_CRITICAL(&tx_lock);
+		reserved = BleTxRingReserve(&tx_ring, length, tx_policy, buffer, &dropped);
+		taskEXIT_CRITICAL(&tx_lock);
+		stats.bytes_dropped += dropped;
+		if(reserved){
+			return reserved;
+		}
+		if(tx_policy == BLE_TX_DROP_NEWEST){
+			stats.bytes_dropped += length;
+			xSemaphoreGive(tx_mutex);
+			return 0;
+		}
+		/* wait for the events task to release space */
+		if((xSemaphoreTake(tx_space, pdMS_TO_TICKS(CONGEST_TIMEOUT_MS)) != pdTRUE) && (status != BLE_CONNECTED)){
+			xSemaphoreGive(tx_mutex);
+			return 0;
+		}
 	}
 }
 
-void BleSendString(const char *msg){
+void BleTxCommit(uint16_t length){
 	CMD_t cmdBuf;
-	if(status == BLE_CONNECTED){
-		cmdBuf.command = CMD_SEND_DATA;
-		cmdBuf.length = 0;
-		while(msg[cmdBuf.length] != '\0'){
-			cmdBuf.length++;
+	uint32_t used;
+
+	taskENTER_CRITICAL(&tx_lock);
+	used = BleTxRingCommit(&tx_ring, length);
+	taskEXIT_CRITICAL(&tx_lock);
+	if(used > stats.ring_max){
+		stats.ring_max = used;
+	}
+	TRACE_COUNTER(TRACE_ID_BLE_USED, used);
+	xSemaphoreGive(tx_mutex);
+	/* one pending kick is enough: the events task drains everything committed */
+	if(!__atomic_exchange_n(&tx_kick, true, __ATOMIC_ACQ_REL)){
+		cmdBuf.command = CMD_TX_KICK;
+		if(xQueueSend(xQueueEvents, &cmdBuf, 0) != pdTRUE){
+			__atomic_store_n(&tx_kick, false, __ATOMIC_RELEASE);
 		}
-		memcpy(cmdBuf.payload, msg, cmdBuf.length);
-		xQueueSend(xQueueEvents, &cmdBuf, portMAX_DELAY);
 	}
 }
 
-void BleSendBuffer(const char *data, uint8_t nbytes){
-	CMD_t cmdBuf;
-	if(status == BLE_CONNECTED){
-		cmdBuf.command = CMD_SEND_DATA;
-		cmdBuf.length = nbytes;
-		memcpy(cmdBuf.payload, data, cmdBuf.length);
-		xQueueSend(xQueueEvents, &cmdBuf, portMAX_DELAY);
+uint16_t BleWrite(const uint8_t *data, uint16_t length){
+	uint8_t *buffer;
+	uint16_t written = 0, n;
+
+	TRACE_BEGIN(TRACE_ID_BLE_WRITE);
+	while(written < length){
+		n = BleTxReserve(&buffer, length - written);
+		if(n == 0){
+			break;
+		}
+		memcpy(buffer, &data[written], n);
+		BleTxCommit(n);
+		written += n;
+	}
+	if(written){
+		stats.messages++;
 	}
+	TRACE_END(TRACE_ID_BLE_WRITE);
+	return written;
+}
+
+void BleSendByte(const char *data){
+	BleWrite((const uint8_t *)data, 1);
+}
+
+void BleSendString(const char *msg){
+	BleWrite((const uint8_t *)msg, strlen(msg));
+}
+
+void BleSendBuffer(const char *data, uint8_t nbytes){
+	BleWrite((const uint8_t *)data, nbytes);
 }
 /*==================[end of file]============================================*/
\ No newline at end of file
@@ -0,0 +1,109 @@
+/**
+ * @file ble_tx_ring.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "ble_tx_ring.h"
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+void BleTxRingInit(ble_tx_ring_t *ring, uint8_t *data, uint32_t size){
+	ring->data = data;
+	ring->size = size;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->free = 0;
+	ring->in_flight = 0;
+}
+
+uint32_t BleTxRingReserve(ble_tx_ring_t *ring, uint32_t length, ble_tx_policy_t policy,
+						  uint8_t **buffer, uint32_t *dropped){
+	uint32_t free_bytes, drop, index;
+
+	*dropped = 0;
+	if(length > ring->size){
+		length = ring->size;
+	}
+	free_bytes = ring->size - (ring->head - ring->free);
+	if((free_bytes < length) && (policy == BLE_TX_DROP_OLDEST)){
+		/* unsent bytes only: the claim in flight ends at or before tail */
+		drop = length - free_bytes;
+		if(drop > ring->head - ring->tail){
+			drop = ring->head - ring->tail;
+		}
+		ring->tail += drop;
+		if(!ring->in_flight){
+			ring->free = ring->tail;
+		}
+		*dropped = drop;
+		free_bytes = ring->size - (ring->head - ring->free);
+	}
+	if(free_bytes < length){
+		return 0;
+	}
+	index = ring->head & (ring->size - 1);
+	if(length > ring->size - index){
+		length = ring->size - index;
+	}
+	*buffer = &ring->data[index];
+	return length;
+}
+
+uint32_t BleTxRingCommit(ble_tx_ring_t *ring, uint32_t length){
+	ring->head += length;
+	return ring->head - ring->free;
+}
+
+uint32_t BleTxRingClaim(ble_tx_ring_t *ring, uint32_t max, uint8_t **buffer){
+	uint32_t index = ring->tail & (ring->size - 1);
+	uint32_t length = ring->head - ring->tail;
+
+	if(length > max){
+		length = max;
+	}
+	if(length > ring->size - index){
+		length = ring->size - index;
+	}
+	*buffer = &ring->data[index];
+	ring->tail += length;
+	ring->in_flight = length;
+	return length;
+}
+
+void BleTxRingRelease(ble_tx_ring_t *ring){
+	ring->in_flight = 0;
+	ring->free = ring->tail;
+}
+
+uint32_t BleTxRingDiscard(ble_tx_ring_t *ring){
+	uint32_t dropped = ring->head - ring->tail;
+
+	ring->tail = ring->head;
+	if(!ring->in_flight){
+		ring->free = ring->tail;
+	}
+	return dropped;
+}
+
+uint32_t BleTxRingUsed(const ble_tx_ring_t *ring){
+	return ring->head - ring->free;
+}
+
+/*==================[end of file]============================================*/
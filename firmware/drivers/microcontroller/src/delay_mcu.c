@@ -15,99 +15,200 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_rom_sys.h"
+#include "esp_cpu.h"
+#include "esp_attr.h"
+#include "sdkconfig.h"
 /*==================[macros and definitions]=================================*/
 #define US_RESOLUTION_HZ	1000000	/*!< 1usec */
 #define MSEC				1000	/*!< 1msec = 1000usec */
 #define SEC					1000000	/*!< 1sec = 1000msec */
 #define MIN_US				50	    /*!< minimun delay in usec to use gptimer */
+#define CYCLES_PER_US		CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ	/*!< CPU cycles in 1usec */
+#define MAX_WAITERS			16		/*!< Tasks waiting on the timer at the same time */
+#define STATE_IDLE			0		/*!< Timer not created */
+#define STATE_CREATING		1		/*!< Timer being created by a task */
+#define STATE_READY			2		/*!< Timer running */
 /*==================[internal data declaration]==============================*/
-TaskHandle_t task_to_notify;
+/**
+ * @brief Task waiting for a deadline
+ */
+typedef struct {
+	uint64_t deadline;			/*!< Timer count when the delay ends */
+	TaskHandle_t task;			/*!< Task to notify */
+	volatile bool *done;		/*!< Set by the ISR when the deadline is reached */
+} delay_waiter_t;
+static gptimer_handle_t delay_timer = NULL;
+static volatile uint32_t delay_state = STATE_IDLE;
+static delay_waiter_t waiters[MAX_WAITERS];		/*!< Min-heap by deadline */
+static uint8_t waiters_qty = 0;
+static portMUX_TYPE delay_lock = portMUX_INITIALIZER_UNLOCKED;
 /*==================[internal functions declaration]=========================*/
-static bool IRAM_ATTR delay_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
-	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-	gptimer_stop(timer);
-	vTaskNotifyGiveFromISR(task_to_notify, &xHigherPriorityTaskWoken);
-	return (xHigherPriorityTaskWoken == pdTRUE);
-}
+
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static void IRAM_ATTR HeapSwap(uint8_t a, uint8_t b){
+	delay_waiter_t tmp = waiters[a];
+	waiters[a] = waiters[b];
+	waiters[b] = tmp;
+}
+
+static void IRAM_ATTR HeapPush(delay_waiter_t *waiter){
+	uint8_t i = waiters_qty++;
+	waiters[i] = *waiter;
+	while(i > 0 && waiters[(i - 1) / 2].deadline > waiters[i].deadline){
+		HeapSwap(i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+static void IRAM_ATTR HeapPop(void){
+	uint8_t i = 0, child;
+	waiters[0] = waiters[--waiters_qty];
+	while((child = 2 * i + 1) < waiters_qty){
+		if(child + 1 < waiters_qty && waiters[child + 1].deadline < waiters[child].deadline){
+			child++;
+		}
+		if(waiters[i].deadline <= waiters[child].deadline){
+			break;
+		}
+		HeapSwap(i, child);
+		i = child;
+	}
+}
+
+/**
+ * @brief Wake every task whose deadline has passed and program the alarm for
+ * the next one. Called with delay_lock taken.
+ */
+static bool IRAM_ATTR DelayService(bool from_isr){
+	BaseType_t task_woken = pdFALSE;
+	uint64_t now;
+
+	while(waiters_qty){
+		gptimer_get_raw_count(delay_timer, &now);
+		if(waiters[0].deadline > now){
+			gptimer_alarm_config_t alarm_config = {
+				.alarm_count = waiters[0].deadline,
+			};
+			gptimer_set_alarm_action(delay_timer, &alarm_config);
+			/* deadline could have passed while setting the alarm */
+			gptimer_get_raw_count(delay_timer, &now);
+			if(waiters[0].deadline > now){
+				break;
+			}
+		}
+		*waiters[0].done = true;
+		if(from_isr){
+			vTaskNotifyGiveFromISR(waiters[0].task, &task_woken);
+		}else if(waiters[0].task != xTaskGetCurrentTaskHandle()){
+			xTaskNotifyGive(waiters[0].task);
+		}
+		HeapPop();
+	}
+	return (task_woken == pdTRUE);
+}
 
+static bool IRAM_ATTR delay_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	bool task_woken;
+	portENTER_CRITICAL_ISR(&delay_lock);
+	task_woken = DelayService(true);
+	portEXIT_CRITICAL_ISR(&delay_lock);
+	return task_woken;
+}
+
+/**
+ * @brief Create the free running timer once, the first time a delay is requested.
+ */
+static void DelayInit(void){
+	uint32_t expected = STATE_IDLE;
+	if(__atomic_compare_exchange_n(&delay_state, &expected, STATE_CREATING, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+		gptimer_config_t delay_timer_config = {
+			.clk_src = GPTIMER_CLK_SRC_DEFAULT,
+			.direction = GPTIMER_COUNT_UP,
+			.resolution_hz = US_RESOLUTION_HZ,
+		};
+		ESP_ERROR_CHECK(gptimer_new_timer(&delay_timer_config, &delay_timer));
+		gptimer_event_callbacks_t delay_alarm = {
+			.on_alarm = delay_isr,
+		};
+		gptimer_register_event_callbacks(delay_timer, &delay_alarm, NULL);
+		gptimer_enable(delay_timer);
+		gptimer_start(delay_timer);
+		__atomic_store_n(&delay_state, STATE_READY, __ATOMIC_RELEASE);
+	}
+	while(__atomic_load_n(&delay_state, __ATOMIC_ACQUIRE) != STATE_READY){
+		vTaskDelay(1);
+	}
+}
+
+static void DelayBusy(uint32_t usec){
+	uint32_t start = esp_cpu_get_cycle_count();
+	uint32_t cycles = usec * CYCLES_PER_US;
+	while((esp_cpu_get_cycle_count() - start) < cycles);
+}
+
+/**
+ * @brief Block the calling task until the timer reaches now + usec.
+ */
+static void DelayBlock(uint64_t usec){
+	volatile bool done = false;
+	bool self_expired;
+	uint32_t taken = 0, foreign = 0;
+	uint64_t now;
+	delay_waiter_t waiter;
+
+	if(delay_state != STATE_READY){
+		DelayInit();
+	}
+	portENTER_CRITICAL(&delay_lock);
+	if(waiters_qty >= MAX_WAITERS){
+		portEXIT_CRITICAL(&delay_lock);
+		/* too many tasks waiting: fall back to the RTOS tick (rounded up) */
+		vTaskDelay((usec / MSEC + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS + 1);
+		return;
+	}
+	gptimer_get_raw_count(delay_timer, &now);
+	waiter.deadline = now + usec;
+	waiter.task = xTaskGetCurrentTaskHandle();
+	waiter.done = &done;
+	HeapPush(&waiter);
+	DelayService(false);
+	self_expired = done;
+	portEXIT_CRITICAL(&delay_lock);
+
+	if(!self_expired){
+		/* a take returns every pending notification, others' ones included */
+		while(!done){
+			taken += ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
+		/* the expiry gives exactly one notification, under delay_lock: once the lock
+		 * is free it has been given, take it if it came after the last take */
+		portENTER_CRITICAL(&delay_lock);
+		portEXIT_CRITICAL(&delay_lock);
+		taken += ulTaskNotifyTake(pdTRUE, 0);
+		foreign = taken - 1;
+	}
+	/* notifications from somebody else: give them back */
+	while(foreign--){
+		xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+	}
+}
 /*==================[external functions definition]==========================*/
 void DelaySec(uint16_t sec){
-	task_to_notify = xTaskGetCurrentTaskHandle();
-	gptimer_handle_t delay_timer = NULL;
-    gptimer_config_t delay_timer_config = {
-        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
-        .direction = GPTIMER_COUNT_UP,
-        .resolution_hz = US_RESOLUTION_HZ,
-    };
-    gptimer_new_timer(&delay_timer_config, &delay_timer);
-    gptimer_event_callbacks_t delay_alarm = {
-        .on_alarm = delay_isr,
-    };
-	gptimer_register_event_callbacks(delay_timer, &delay_alarm, NULL);
-	gptimer_enable(delay_timer);
-    gptimer_alarm_config_t alarm_config = {
-        .alarm_count = sec*SEC, 
-    };
-	gptimer_set_alarm_action(delay_timer, &alarm_config);
-	gptimer_start(delay_timer);
-	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-	gptimer_disable(delay_timer);
-	gptimer_del_timer(delay_timer);
+	DelayBlock((uint64_t)sec * SEC);
 }
 
 void DelayMs(uint16_t msec){
-	task_to_notify = xTaskGetCurrentTaskHandle();
-	gptimer_handle_t delay_timer = NULL;
-    gptimer_config_t delay_timer_config = {
-        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
-        .direction = GPTIMER_COUNT_UP,
-        .resolution_hz = US_RESOLUTION_HZ,
-    };
-    gptimer_new_timer(&delay_timer_config, &delay_timer);
-    gptimer_event_callbacks_t delay_alarm = {
-        .on_alarm = delay_isr,
-    };
-	gptimer_register_event_callbacks(delay_timer, &delay_alarm, NULL);
-	gptimer_enable(delay_timer);
-    gptimer_alarm_config_t alarm_config = {
-        .alarm_count = msec*MSEC, 
-    };
-	gptimer_set_alarm_action(delay_timer, &alarm_config);
-	gptimer_start(delay_timer);
-	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-	gptimer_disable(delay_timer);
-	gptimer_del_timer(delay_timer);
+	DelayBlock((uint64_t)msec * MSEC);
 }
 
 void DelayUs(uint16_t usec){
-    if(usec<=MIN_US){
-        esp_rom_delay_us(usec);
+    if(usec < MIN_US){
+        DelayBusy(usec);
     }else{
-        task_to_notify = xTaskGetCurrentTaskHandle();
-        gptimer_handle_t delay_timer = NULL;
-        gptimer_config_t delay_timer_config = {
-            .clk_src = GPTIMER_CLK_SRC_DEFAULT,
-            .direction = GPTIMER_COUNT_UP,
-            .resolution_hz = US_RESOLUTION_HZ,
-        };
-        gptimer_new_timer(&delay_timer_config, &delay_timer);
-        gptimer_event_callbacks_t delay_alarm = {
-            .on_alarm = delay_isr,
-        };
-        gptimer_register_event_callbacks(delay_timer, &delay_alarm, NULL);
-        gptimer_enable(delay_timer);
-        gptimer_alarm_config_t alarm_config = {
-            .alarm_count = usec, 
-        };
-        gptimer_set_alarm_action(delay_timer, &alarm_config);
-        gptimer_start(delay_timer);
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-        gptimer_disable(delay_timer);
-        gptimer_del_timer(delay_timer);
+        DelayBlock(usec);
     }
 }
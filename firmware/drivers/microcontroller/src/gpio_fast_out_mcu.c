@@ -13,14 +13,17 @@
 #include "gpio_fast_out_mcu.h"
 #include "gpio_mcu.h"
 #include <stdint.h>
-#include <string.h>
 #include "driver/gpio.h"
 #include "driver/dedic_gpio.h"
+#include "hal/dedic_gpio_cpu_ll.h"
+#include "esp_attr.h"
 /*==================[macros and definitions]=================================*/
 
 /*==================[internal data declaration]==============================*/
 dedic_gpio_bundle_handle_t bundleA = NULL;
 int bundleA_gpios[16];
+uint32_t bundleA_offset = 0;    /* first dedicated channel of bundleA */
+uint16_t bundleA_mask = 0;      /* one bit per pin in bundleA */
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -32,7 +35,9 @@ int bundleA_gpios[16];
 /*==================[external functions definition]==========================*/
 
 void GPIOFastInit(gpio_t *pin_list, uint8_t pin_qty){
-    memcpy(bundleA_gpios, pin_list, pin_qty);
+    for (int i = 0; i < pin_qty; i++) {
+        bundleA_gpios[i] = pin_list[i];
+    }
     gpio_config_t io_conf = {
         .mode = GPIO_MODE_OUTPUT,
     };
@@ -49,10 +54,17 @@ void GPIOFastInit(gpio_t *pin_list, uint8_t pin_qty){
         },
     };
     ESP_ERROR_CHECK(dedic_gpio_new_bundle(&bundleA_config, &bundleA));
+    ESP_ERROR_CHECK(dedic_gpio_get_out_offset(bundleA, &bundleA_offset));
+    bundleA_mask = (1 << pin_qty) - 1;
 }
 
 void GPIOFastWrite(uint16_t value){
-    dedic_gpio_bundle_write(bundleA, 0xFF, value);
+    dedic_gpio_bundle_write(bundleA, bundleA_mask, value);
+}
+
+void IRAM_ATTR GPIOFastWriteMask(uint16_t mask, uint16_t value){
+    /* CPU instruction level write, no checks: safe to be called in critical sections */
+    dedic_gpio_cpu_ll_write_mask((mask & bundleA_mask) << bundleA_offset, value << bundleA_offset);
 }
 
 /*==================[end of file]============================================*/
\ No newline at end of file
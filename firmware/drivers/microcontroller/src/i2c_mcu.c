@@ -14,18 +14,192 @@
 #include <esp_err.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <string.h>
 //#include "sdkconfig.h"
 
 #include "i2c_mcu.h"
 /*==================[macros and definitions]=================================*/
 #define I2C_NUM I2C_NUM_0
 
-#undef ESP_ERROR_CHECK
-#define ESP_ERROR_CHECK(x)   do { esp_err_t rc = (x); if (rc != ESP_OK) { ESP_LOGE("err", "esp_err_t = %d", rc); /*assert(0 && #x);*/} } while(0);
+/** Add a command to the link, unless a previous one failed (the error is kept in ret) */
+#define I2C_LINK_ADD(ret, x)	do { if((ret) == ESP_OK){ (ret) = (x); } } while(0)
+
+#define I2C_LINK_SIZE		I2C_LINK_RECOMMENDED_SIZE(8)	/*!< Enough for a repeated start read */
+#define I2C_TASK_STACK		2048
+#define I2C_TASK_PRIO		10
+
+#define SHADOW_WORDS		(I2C_SHADOW_REGS / 32)
+#define SHADOW_GET(map, reg)	(((map)[(reg) >> 5] >> ((reg) & 31)) & 1)
+#define SHADOW_SET(map, reg)	((map)[(reg) >> 5] |= (1UL << ((reg) & 31)))
+#define SHADOW_CLR(map, reg)	((map)[(reg) >> 5] &= ~(1UL << ((reg) & 31)))
+
+/**
+ * @brief Shadow copy of the registers of one device
+ */
+typedef struct {
+	bool used;								/*!< Slot in use */
+	bool deferred;							/*!< Writes are local until I2C_shadowFlush() */
+	uint8_t dev_addr;						/*!< I2C slave device address */
+	uint8_t value[I2C_SHADOW_REGS];			/*!< Register values */
+	uint32_t valid[SHADOW_WORDS];			/*!< Value known */
+	uint32_t dirty[SHADOW_WORDS];			/*!< Value not yet written to the device */
+	uint32_t volatile_regs[SHADOW_WORDS];	/*!< Changed by the device, never cached */
+} i2c_shadow_t;
 
 /*==================[internal data definition]===============================*/
+static uint8_t cmd_link_buf[I2C_LINK_SIZE];	/*!< Command link storage, guarded by bus_mutex */
+static SemaphoreHandle_t bus_mutex = NULL;
+static QueueHandle_t batch_queue = NULL;
+static i2c_shadow_t shadows[I2C_SHADOW_DEVICES];
+static portMUX_TYPE shadow_lock = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE batch_lock = portMUX_INITIALIZER_UNLOCKED;
 
 /*==================[internal functions declaration]=========================*/
+static i2c_cmd_handle_t I2C_linkTake(esp_err_t *ret);
+static esp_err_t I2C_linkRun(i2c_cmd_handle_t cmd, esp_err_t ret, uint16_t timeout);
+static void I2C_batchTask(void *param);
+static int16_t I2C_busRead(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout);
+static bool I2C_busWrite(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data);
+static i2c_shadow_t *I2C_shadowFind(uint8_t devAddr);
+static bool I2C_shadowCacheable(i2c_shadow_t *shadow, uint8_t regAddr, uint8_t length);
+static void I2C_shadowUpdate(i2c_shadow_t *shadow, uint8_t regAddr, uint8_t length, uint8_t *data, bool written);
+static int8_t I2C_readCached(uint8_t devAddr, uint8_t regAddr, uint8_t *data, uint16_t timeout);
+
+/*==================[internal functions definition]==========================*/
+/** Take the bus and build an empty command link on the static buffer
+ * @param ret ESP_OK, or the error (then the returned link is NULL)
+ */
+static i2c_cmd_handle_t I2C_linkTake(esp_err_t *ret){
+	i2c_cmd_handle_t cmd;
+
+	if(bus_mutex == NULL){
+		/* I2C_initialize() not called yet */
+		*ret = ESP_ERR_INVALID_STATE;
+		return NULL;
+	}
+	xSemaphoreTake(bus_mutex, portMAX_DELAY);
+	cmd = i2c_cmd_link_create_static(cmd_link_buf, sizeof(cmd_link_buf));
+	if(cmd == NULL){
+		xSemaphoreGive(bus_mutex);
+		*ret = ESP_ERR_NO_MEM;
+		return NULL;
+	}
+	*ret = ESP_OK;
+	return cmd;
+}
+
+/** Execute the command link (unless building it failed), release it and the bus
+ * @param ret Result of building the link
+ * @param timeout Timeout in milliseconds (0: I2C_MASTER_TIMEOUT_MS)
+ */
+static esp_err_t I2C_linkRun(i2c_cmd_handle_t cmd, esp_err_t ret, uint16_t timeout){
+	if(cmd != NULL){
+		if(ret == ESP_OK){
+			ret = i2c_master_cmd_begin(I2C_NUM, cmd, pdMS_TO_TICKS(timeout ? timeout : I2C_MASTER_TIMEOUT_MS));
+		}
+		i2c_cmd_link_delete_static(cmd);
+		xSemaphoreGive(bus_mutex);
+	}
+	if(ret != ESP_OK){
+		ESP_LOGE("i2c", "esp_err_t = %d", ret);
+	}
+	return ret;
+}
+
+static i2c_shadow_t *I2C_shadowFind(uint8_t devAddr){
+	for(uint8_t i = 0; i < I2C_SHADOW_DEVICES; i++){
+		if(shadows[i].used && shadows[i].dev_addr == devAddr){
+			return &shadows[i];
+		}
+	}
+	return NULL;
+}
+
+static bool I2C_shadowCacheable(i2c_shadow_t *shadow, uint8_t regAddr, uint8_t length){
+	if((uint16_t)regAddr + length > I2C_SHADOW_REGS){
+		return false;
+	}
+	for(uint8_t i = 0; i < length; i++){
+		if(SHADOW_GET(shadow->volatile_regs, regAddr + i)){
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Bring the shadow in line with data just read from / written to the device.
+ * On reads, registers with a pending (dirty) value are reported with that value.
+ */
+static void I2C_shadowUpdate(i2c_shadow_t *shadow, uint8_t regAddr, uint8_t length, uint8_t *data, bool written){
+	uint16_t reg;
+
+	taskENTER_CRITICAL(&shadow_lock);
+	for(uint8_t i = 0; i < length; i++){
+		reg = regAddr + i;
+		if((reg >= I2C_SHADOW_REGS) || SHADOW_GET(shadow->volatile_regs, reg)){
+			continue;
+		}
+		if(!written && SHADOW_GET(shadow->dirty, reg)){
+			data[i] = shadow->value[reg];
+		} else{
+			SHADOW_CLR(shadow->dirty, reg);
+			shadow->value[reg] = data[i];
+			SHADOW_SET(shadow->valid, reg);
+		}
+	}
+	taskEXIT_CRITICAL(&shadow_lock);
+}
+
+/** Read one register for a read-modify-write, from the shadow when possible
+ */
+static int8_t I2C_readCached(uint8_t devAddr, uint8_t regAddr, uint8_t *data, uint16_t timeout){
+	i2c_shadow_t *shadow = I2C_shadowFind(devAddr);
+	bool hit = false;
+
+	if((shadow != NULL) && I2C_shadowCacheable(shadow, regAddr, 1)){
+		taskENTER_CRITICAL(&shadow_lock);
+		if(SHADOW_GET(shadow->valid, regAddr)){
+			*data = shadow->value[regAddr];
+			hit = true;
+		}
+		taskEXIT_CRITICAL(&shadow_lock);
+	}
+	if(hit){
+		return 1;
+	}
+	return I2C_readBytes(devAddr, regAddr, 1, data, timeout);
+}
+
+static void I2C_batchTask(void *param){
+	i2c_batch_t *batch;
+	i2c_op_t *op;
+
+	while(true){
+		xQueueReceive(batch_queue, &batch, portMAX_DELAY);
+		batch->errors = 0;
+		for(uint8_t i = 0; i < batch->op_qty; i++){
+			op = &batch->ops[i];
+			if(op->type == I2C_OP_READ){
+				op->result = I2C_readBytes(op->dev_addr, op->reg_addr, op->length, op->data, 0);
+			} else{
+				op->result = I2C_writeBytes(op->dev_addr, op->reg_addr, op->length, op->data) ? op->length : 0;
+			}
+			if(op->result == 0){
+				batch->errors++;
+			}
+		}
+		if(batch->func_p != NULL){
+			((void (*)(i2c_batch_t *, void *))batch->func_p)(batch, batch->param_p);
+		}
+		/* done and the notification together, see I2C_waitBatch() */
+		taskENTER_CRITICAL(&batch_lock);
+		batch->done = true;
+		xTaskNotifyGive((TaskHandle_t)batch->owner);
+		taskEXIT_CRITICAL(&batch_lock);
+	}
+}
 
 /*==================[external functions definition]==========================*/
 
@@ -44,10 +218,17 @@ bool I2C_initialize( uint32_t clockRateHz )
         .master.clk_speed = clockRateHz,
     };
 
-    i2c_param_config(i2c_master_port, &conf);
+    if(i2c_param_config(i2c_master_port, &conf) != ESP_OK){
+        return false;
+    }
 
-    return i2c_driver_install(i2c_master_port, conf.mode, I2C_MASTER_RX_BUF_DISABLE, I2C_MASTER_TX_BUF_DISABLE, 0);
-	return true;
+    if(bus_mutex == NULL){
+        bus_mutex = xSemaphoreCreateMutex();
+        batch_queue = xQueueCreate(I2C_BATCH_QUEUE_LEN, sizeof(i2c_batch_t *));
+        xTaskCreate(I2C_batchTask, "i2c_batch", I2C_TASK_STACK, NULL, I2C_TASK_PRIO, NULL);
+    }
+
+    return (i2c_driver_install(i2c_master_port, conf.mode, I2C_MASTER_RX_BUF_DISABLE, I2C_MASTER_TX_BUF_DISABLE, 0) == ESP_OK);
 };
 
 
@@ -74,7 +255,7 @@ int8_t I2C_readBit(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint8_t *da
 
 
 	uint8_t b;
-    uint8_t count = I2C_readByte(devAddr, regAddr, &b, timeout);
+    uint8_t count = I2C_readCached(devAddr, regAddr, &b, timeout);
     *data = b & (1 << bitNum);
     return count;
 }
@@ -95,7 +276,7 @@ int8_t I2C_readBits(uint8_t devAddr, uint8_t regAddr, uint8_t bitStart, uint8_t
     //    010   masked
     //   -> 010 shifted
     uint8_t count, b;
-    if ((count = I2C_readByte(devAddr, regAddr, &b, timeout)) != 0) {
+    if ((count = I2C_readCached(devAddr, regAddr, &b, timeout)) != 0) {
         uint8_t mask = ((1 << length) - 1) << (bitStart - length + 1);
         b &= mask;
         b >>= (bitStart - length + 1);
@@ -121,45 +302,55 @@ int8_t I2C_readByte(uint8_t devAddr, uint8_t regAddr, uint8_t *data, uint16_t ti
  * @param length Number of bytes to read
  * @param data Buffer to store read data in
  * @param timeout Optional read timeout in milliseconds (0 to disable, leave off to use default class value in I2C_readTimeout)
- * @return I2C_TransferReturn_TypeDef http://downloads.energymicro.com/documentation/doxygen/group__I2C.html
+ * @return Number of bytes read, 0 on error
  */
-int8_t I2C_readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout) {
-	i2c_cmd_handle_t cmd;
-	I2C_SelectRegister(devAddr, regAddr);
-
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_READ, 1));
-
-	if(length>1)
-	ESP_ERROR_CHECK(i2c_master_read(cmd, data, length-1, I2C_MASTER_ACK));
-
-	ESP_ERROR_CHECK(i2c_master_read_byte(cmd, data+length-1, I2C_MASTER_NACK));
-
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	ESP_ERROR_CHECK(i2c_master_cmd_begin(I2C_NUM, cmd, 1000/portTICK_PERIOD_MS));
-	i2c_cmd_link_delete(cmd);
-
+int16_t I2C_readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout) {
+	i2c_shadow_t *shadow = I2C_shadowFind(devAddr);
+
+	if(I2C_busRead(devAddr, regAddr, length, data, timeout) == 0){
+		return 0;
+	}
+	if(shadow != NULL){
+		I2C_shadowUpdate(shadow, regAddr, length, data, false);
+	}
 	return length;
 }
 
+/** Read from the bus, bypassing the shadow registers
+ */
+static int16_t I2C_busRead(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout) {
+	i2c_cmd_handle_t cmd;
+	esp_err_t ret;
+
+	/* register select and read in one transaction: write, repeated start, read */
+	cmd = I2C_linkTake(&ret);
+	I2C_LINK_ADD(ret, i2c_master_start(cmd));
+	I2C_LINK_ADD(ret, i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_WRITE, 1));
+	I2C_LINK_ADD(ret, i2c_master_write_byte(cmd, regAddr, 1));
+	I2C_LINK_ADD(ret, i2c_master_start(cmd));
+	I2C_LINK_ADD(ret, i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_READ, 1));
+	I2C_LINK_ADD(ret, i2c_master_read(cmd, data, length, I2C_MASTER_LAST_NACK));
+	I2C_LINK_ADD(ret, i2c_master_stop(cmd));
+
+	return (I2C_linkRun(cmd, ret, timeout) == ESP_OK) ? length : 0;
+}
+
 bool I2C_writeWord(uint8_t devAddr, uint8_t regAddr, uint16_t data){
 
 	uint8_t data1[] = {(uint8_t)(data>>8), (uint8_t)(data & 0xff)};
-	I2C_writeBytes(devAddr, regAddr, 2, data1);
-	return true;
+	return I2C_writeBytes(devAddr, regAddr, 2, data1);
 }
 
 void I2C_SelectRegister(uint8_t devAddr, uint8_t reg){
 	i2c_cmd_handle_t cmd;
-
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_WRITE, 1));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, reg, 1));
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	ESP_ERROR_CHECK(i2c_master_cmd_begin(I2C_NUM, cmd, 1000/portTICK_PERIOD_MS));
-	i2c_cmd_link_delete(cmd);
+	esp_err_t ret;
+
+	cmd = I2C_linkTake(&ret);
+	I2C_LINK_ADD(ret, i2c_master_start(cmd));
+	I2C_LINK_ADD(ret, i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_WRITE, 1));
+	I2C_LINK_ADD(ret, i2c_master_write_byte(cmd, reg, 1));
+	I2C_LINK_ADD(ret, i2c_master_stop(cmd));
+	I2C_linkRun(cmd, ret, 0);
 }
 
 /** write a single bit in an 8-bit device register.
@@ -171,7 +362,9 @@ void I2C_SelectRegister(uint8_t devAddr, uint8_t reg){
  */
 bool I2C_writeBit(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint8_t data) {
     uint8_t b;
-    I2C_readByte(devAddr, regAddr, &b, 0);
+    if (I2C_readCached(devAddr, regAddr, &b, 0) == 0) {
+        return false;
+    }
     b = (data != 0) ? (b | (1 << bitNum)) : (b & ~(1 << bitNum));
     return I2C_writeByte(devAddr, regAddr, b);
 }
@@ -193,7 +386,7 @@ bool I2C_writeBits(uint8_t devAddr, uint8_t regAddr, uint8_t bitStart, uint8_t l
     // 10100011 original & ~mask
     // 10101011 masked | value
     uint8_t b = 0;
-    if (I2C_readByte(devAddr, regAddr, &b, 0) != 0) {
+    if (I2C_readCached(devAddr, regAddr, &b, 0) != 0) {
         uint8_t mask = ((1 << length) - 1) << (bitStart - length + 1);
         data <<= (bitStart - length + 1); // shift data into correct position
         data &= mask; // zero all non-important bits in data
@@ -212,18 +405,7 @@ bool I2C_writeBits(uint8_t devAddr, uint8_t regAddr, uint8_t bitStart, uint8_t l
  * @return Status of operation (true = success)
  */
 bool I2C_writeByte(uint8_t devAddr, uint8_t regAddr, uint8_t data) {
-	i2c_cmd_handle_t cmd;
-
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_WRITE, 1));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, regAddr, 1));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, data, 1));
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	ESP_ERROR_CHECK(i2c_master_cmd_begin(I2C_NUM, cmd, 1000/portTICK_PERIOD_MS));
-	i2c_cmd_link_delete(cmd);
-
-	return true;
+	return I2C_writeBytes(devAddr, regAddr, 1, &data);
 }
 
 /** Write single byte to an 8-bit device register.
@@ -234,18 +416,43 @@ bool I2C_writeByte(uint8_t devAddr, uint8_t regAddr, uint8_t data) {
  * @return Status of operation (true = success)
  */
 bool I2C_writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data){
+	i2c_shadow_t *shadow = I2C_shadowFind(devAddr);
+
+	if(shadow != NULL){
+		if(shadow->deferred && I2C_shadowCacheable(shadow, regAddr, length)){
+			/* local update, written by I2C_shadowFlush() */
+			taskENTER_CRITICAL(&shadow_lock);
+			for(uint8_t i = 0; i < length; i++){
+				shadow->value[regAddr + i] = data[i];
+				SHADOW_SET(shadow->valid, regAddr + i);
+				SHADOW_SET(shadow->dirty, regAddr + i);
+			}
+			taskEXIT_CRITICAL(&shadow_lock);
+			return true;
+		}
+		if(!I2C_busWrite(devAddr, regAddr, length, data)){
+			return false;
+		}
+		I2C_shadowUpdate(shadow, regAddr, length, data, true);
+		return true;
+	}
+	return I2C_busWrite(devAddr, regAddr, length, data);
+}
+
+/** Write to the bus, bypassing the shadow registers
+ */
+static bool I2C_busWrite(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data){
 	i2c_cmd_handle_t cmd;
+	esp_err_t ret;
 
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_WRITE, 1));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, regAddr, 1));
-	ESP_ERROR_CHECK(i2c_master_write(cmd, data, length-1, 0));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, data[length-1], 1));
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	i2c_master_cmd_begin(I2C_NUM, cmd, 1000/portTICK_PERIOD_MS);
-	i2c_cmd_link_delete(cmd);
-	return true;
+	cmd = I2C_linkTake(&ret);
+	I2C_LINK_ADD(ret, i2c_master_start(cmd));
+	I2C_LINK_ADD(ret, i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_WRITE, 1));
+	I2C_LINK_ADD(ret, i2c_master_write_byte(cmd, regAddr, 1));
+	I2C_LINK_ADD(ret, i2c_master_write(cmd, data, length, 1));
+	I2C_LINK_ADD(ret, i2c_master_stop(cmd));
+
+	return (I2C_linkRun(cmd, ret, 0) == ESP_OK);
 }
 
 
@@ -264,4 +471,134 @@ int8_t I2C_readWord(uint8_t devAddr, uint8_t regAddr, uint16_t *data, uint16_t t
 	return 0;
 }
 
+bool I2C_shadowAttach(uint8_t devAddr){
+	if(I2C_shadowFind(devAddr) != NULL){
+		return true;
+	}
+	for(uint8_t i = 0; i < I2C_SHADOW_DEVICES; i++){
+		if(!shadows[i].used){
+			memset(&shadows[i], 0, sizeof(i2c_shadow_t));
+			shadows[i].dev_addr = devAddr;
+			shadows[i].used = true;
+			return true;
+		}
+	}
+	return false;
+}
+
+void I2C_shadowSetVolatile(uint8_t devAddr, uint8_t regAddr, uint8_t length){
+	i2c_shadow_t *shadow = I2C_shadowFind(devAddr);
+
+	if(shadow == NULL){
+		return;
+	}
+	taskENTER_CRITICAL(&shadow_lock);
+	for(uint16_t reg = regAddr; (reg < regAddr + length) && (reg < I2C_SHADOW_REGS); reg++){
+		SHADOW_SET(shadow->volatile_regs, reg);
+		SHADOW_CLR(shadow->valid, reg);
+		SHADOW_CLR(shadow->dirty, reg);
+	}
+	taskEXIT_CRITICAL(&shadow_lock);
+}
+
+void I2C_shadowInvalidate(uint8_t devAddr, uint8_t regAddr, uint8_t length){
+	i2c_shadow_t *shadow = I2C_shadowFind(devAddr);
+
+	if(shadow == NULL){
+		return;
+	}
+	taskENTER_CRITICAL(&shadow_lock);
+	for(uint16_t reg = regAddr; (reg < regAddr + length) && (reg < I2C_SHADOW_REGS); reg++){
+		SHADOW_CLR(shadow->valid, reg);
+		SHADOW_CLR(shadow->dirty, reg);
+	}
+	taskEXIT_CRITICAL(&shadow_lock);
+}
+
+void I2C_shadowDefer(uint8_t devAddr, bool defer){
+	i2c_shadow_t *shadow = I2C_shadowFind(devAddr);
+
+	if(shadow != NULL){
+		shadow->deferred = defer;
+	}
+}
+
+bool I2C_shadowFlush(uint8_t devAddr){
+	i2c_shadow_t *shadow = I2C_shadowFind(devAddr);
+	uint8_t run[I2C_SHADOW_REGS];
+	uint16_t reg = 0, start, length;
+	bool ok = true;
+
+	if(shadow == NULL){
+		return true;
+	}
+	while(reg < I2C_SHADOW_REGS){
+		/* next run of contiguous dirty registers, written in one burst */
+		taskENTER_CRITICAL(&shadow_lock);
+		while((reg < I2C_SHADOW_REGS) && !SHADOW_GET(shadow->dirty, reg)){
+			reg++;
+		}
+		start = reg;
+		while((reg < I2C_SHADOW_REGS) && SHADOW_GET(shadow->dirty, reg)){
+			run[reg - start] = shadow->value[reg];
+			SHADOW_CLR(shadow->dirty, reg);
+			reg++;
+		}
+		taskEXIT_CRITICAL(&shadow_lock);
+		length = reg - start;
+		if(length && !I2C_busWrite(devAddr, start, length, run)){
+			/* keep them pending unless rewritten meanwhile */
+			taskENTER_CRITICAL(&shadow_lock);
+			for(uint16_t i = start; i < reg; i++){
+				SHADOW_SET(shadow->dirty, i);
+			}
+			taskEXIT_CRITICAL(&shadow_lock);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+bool I2C_submitBatch(i2c_batch_t *batch){
+	if(batch_queue == NULL){
+		return false;
+	}
+	batch->done = false;
+	batch->owner = xTaskGetCurrentTaskHandle();
+	return (xQueueSend(batch_queue, &batch, 0) == pdTRUE);
+}
+
+bool I2C_waitBatch(i2c_batch_t *batch, uint32_t timeout_ms){
+	uint32_t taken = 0, foreign;
+	TickType_t start = xTaskGetTickCount();
+	TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+	TickType_t elapsed;
+	bool done;
+
+	/* a take returns every pending notification, others' ones included */
+	while(!batch->done){
+		elapsed = xTaskGetTickCount() - start;
+		if(elapsed >= ticks){
+			break;
+		}
+		taken += ulTaskNotifyTake(pdTRUE, ticks - elapsed);
+	}
+	/* the worker sets done and notifies under batch_lock: once the lock is free
+	 * with done set, the notification has been given, take it if it came after
+	 * the last take */
+	taskENTER_CRITICAL(&batch_lock);
+	done = batch->done;
+	taskEXIT_CRITICAL(&batch_lock);
+	foreign = taken;
+	if(done){
+		taken += ulTaskNotifyTake(pdTRUE, 0);
+		foreign = taken - 1;
+	}
+	/* notifications from somebody else: give them back */
+	while(foreign--){
+		xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+	}
+	return batch->done;
+}
+
 /*==================[end of file]============================================*/
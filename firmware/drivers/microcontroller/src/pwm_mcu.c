@@ -12,9 +12,31 @@
 /*==================[inclusions]=============================================*/
 #include "pwm_mcu.h"
 #include "driver/ledc.h"
+#include "soc/soc_caps.h"
+#include "freertos/FreeRTOS.h"
 /*==================[macros and definitions]=================================*/
-#define DC_MAX  1023
-#define DC_100  100
+#define PWM_QTY         4
+#define PWM_SRC_CLK_HZ  80000000UL                  /*!< LEDC_AUTO_CLK selects the 80 MHz PLL divided clock */
+#define PWM_MIN_BITS    1
+#define PWM_MAX_BITS    SOC_LEDC_TIMER_BIT_WIDTH
+
+/**
+ * @brief State of a LEDC timer
+ */
+typedef struct {
+    uint32_t freq;      /*!< Frequency in Hz */
+    uint8_t bits;       /*!< Duty resolution */
+    uint8_t users;      /*!< Outputs attached */
+} pwm_timer_t;
+
+/**
+ * @brief State of a PWM output (LEDC channel)
+ */
+typedef struct {
+    ledc_timer_t timer; /*!< Timer the output is attached to */
+    uint32_t duty_q16;  /*!< Last duty, used to rescale on resolution changes */
+    bool init;          /*!< Output initialized */
+} pwm_channel_t;
 /*==================[internal data declaration]==============================*/
 static ledc_timer_config_t pwm_timer_cfg = {
     .speed_mode       = LEDC_LOW_SPEED_MODE,
@@ -27,150 +49,217 @@ static ledc_channel_config_t ledc_channel_cfg = {
     .duty           = 0,       /*!< Starts in 0% */
     .hpoint         = 0
 };
+static pwm_timer_t pwm_timers[PWM_QTY];
+static pwm_channel_t pwm_channels[PWM_QTY];
+static bool fade_installed = false;
+static portMUX_TYPE pwm_mux = portMUX_INITIALIZER_UNLOCKED;
 /*==================[internal functions declaration]=========================*/
-
+static uint8_t PWMBestResolution(uint32_t freq);
+static uint8_t PWMTimerConfig(ledc_timer_t timer, uint32_t freq);
+static uint8_t PWMAttach(pwm_out_t out, gpio_t gpio, ledc_timer_t timer);
+static uint32_t PWMQ16ToTicks(pwm_out_t out, uint32_t duty_q16);
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/**
+ * @brief Largest duty resolution the source clock allows at a given frequency
+ */
+static uint8_t PWMBestResolution(uint32_t freq){
+    uint8_t bits = PWM_MIN_BITS;
+    if(freq == 0){
+        return PWM_MAX_BITS;
+    }
+    while((bits < PWM_MAX_BITS) && (((uint64_t)freq << (bits + 1)) <= PWM_SRC_CLK_HZ)){
+        bits++;
+    }
+    return bits;
+}
+
+static uint8_t PWMTimerConfig(ledc_timer_t timer, uint32_t freq){
+    pwm_timer_cfg.freq_hz = freq;
+    pwm_timer_cfg.timer_num = timer;
+    pwm_timer_cfg.duty_resolution = PWMBestResolution(freq);
+    if(ledc_timer_config(&pwm_timer_cfg) != ESP_OK){
+        return 1;
+    }
+    pwm_timers[timer].freq = freq;
+    pwm_timers[timer].bits = pwm_timer_cfg.duty_resolution;
+    return 0;
+}
 
+static uint8_t PWMAttach(pwm_out_t out, gpio_t gpio, ledc_timer_t timer){
+    if(pwm_channels[out].init){
+        pwm_timers[pwm_channels[out].timer].users--;
+    }
+    ledc_channel_cfg.channel = out;
+    ledc_channel_cfg.timer_sel = timer;
+    ledc_channel_cfg.gpio_num = gpio;
+    if(ledc_channel_config(&ledc_channel_cfg) != ESP_OK){
+        pwm_channels[out].init = false;
+        return 1;
+    }
+    pwm_channels[out].timer = timer;
+    pwm_channels[out].duty_q16 = 0;
+    pwm_channels[out].init = true;
+    pwm_timers[timer].users++;
+    return 0;
+}
+
+static uint32_t PWMQ16ToTicks(pwm_out_t out, uint32_t duty_q16){
+    if(duty_q16 > PWM_Q16_ONE){
+        duty_q16 = PWM_Q16_ONE;
+    }
+    return (uint32_t)(((uint64_t)duty_q16 << pwm_timers[pwm_channels[out].timer].bits) >> 16);
+}
 /*==================[external functions definition]==========================*/
 uint8_t PWMInit(pwm_out_t out, gpio_t gpio, uint16_t freq){
-    switch(out){
-        case PWM_0:
-            pwm_timer_cfg.freq_hz = freq;
-            pwm_timer_cfg.timer_num = LEDC_TIMER_0;
-            ledc_timer_config(&pwm_timer_cfg);
-            ledc_channel_cfg.channel = LEDC_CHANNEL_0;
-            ledc_channel_cfg.timer_sel = LEDC_TIMER_0;
-            ledc_channel_cfg.gpio_num = gpio;
-            ledc_channel_config(&ledc_channel_cfg);
-            break;
-        case PWM_1:
-            pwm_timer_cfg.freq_hz = freq;
-            pwm_timer_cfg.timer_num = LEDC_TIMER_1;
-            ledc_timer_config(&pwm_timer_cfg);
-            ledc_channel_cfg.channel = LEDC_CHANNEL_1;
-            ledc_channel_cfg.timer_sel = LEDC_TIMER_1;
-            ledc_channel_cfg.gpio_num = gpio;
-            ledc_channel_config(&ledc_channel_cfg);
-            break;
-        case PWM_2:
-            pwm_timer_cfg.freq_hz = freq;
-            pwm_timer_cfg.timer_num = LEDC_TIMER_2;
-            ledc_timer_config(&pwm_timer_cfg);
-            ledc_channel_cfg.channel = LEDC_CHANNEL_2;
-            ledc_channel_cfg.timer_sel = LEDC_TIMER_2;
-            ledc_channel_cfg.gpio_num = gpio;
-            ledc_channel_config(&ledc_channel_cfg);
-            break;
-        case PWM_3:
-            pwm_timer_cfg.freq_hz = freq;
-            pwm_timer_cfg.timer_num = LEDC_TIMER_3;
-            ledc_timer_config(&pwm_timer_cfg);
-            ledc_channel_cfg.channel = LEDC_CHANNEL_3;
-            ledc_channel_cfg.timer_sel = LEDC_TIMER_3;
-            ledc_channel_cfg.gpio_num = gpio;
-            ledc_channel_config(&ledc_channel_cfg);
-            break;
+    if(out >= PWM_QTY){
+        return 1;
     }
-    return 0;
+    if(PWMTimerConfig(out, freq)){
+        return 1;
+    }
+    return PWMAttach(out, gpio, out);
+}
+
+uint8_t PWMGroupInit(const pwm_out_t *outs, const gpio_t *gpios, uint8_t qty, uint32_t freq){
+    uint8_t ret = 0;
+    if((qty == 0) || (outs[0] >= PWM_QTY)){
+        return 1;
+    }
+    ledc_timer_t timer = outs[0];
+    if(PWMTimerConfig(timer, freq)){
+        return 1;
+    }
+    for(uint8_t i = 0; i < qty; i++){
+        if(outs[i] >= PWM_QTY){
+            return 1;
+        }
+        ret |= PWMAttach(outs[i], gpios[i], timer);
+    }
+    return ret;
 }
 
 void PWMOn(pwm_out_t out){
-    switch(out){
-        case PWM_0:
-            ledc_timer_resume(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0);
-            break;
-        case PWM_1:
-            ledc_timer_resume(LEDC_LOW_SPEED_MODE, LEDC_TIMER_1);
-            break;
-        case PWM_2:
-            ledc_timer_resume(LEDC_LOW_SPEED_MODE, LEDC_TIMER_2);
-            break;
-        case PWM_3:
-            ledc_timer_resume(LEDC_LOW_SPEED_MODE, LEDC_TIMER_3);
-            break;
+    ledc_timer_t timer = pwm_channels[out].timer;
+    if(pwm_timers[timer].users > 1){
+        /* Shared timer: re-enable only this output */
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, out, PWMQ16ToTicks(out, pwm_channels[out].duty_q16));
+        ledc_update_duty(LEDC_LOW_SPEED_MODE, out);
+    } else {
+        ledc_timer_resume(LEDC_LOW_SPEED_MODE, timer);
     }
 }
 
 void PWMOff(pwm_out_t out){
-    switch(out){
-        case PWM_0:
-            ledc_timer_pause(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0);
-            break;
-        case PWM_1:
-            ledc_timer_pause(LEDC_LOW_SPEED_MODE, LEDC_TIMER_1);
-            break;
-        case PWM_2:
-            ledc_timer_pause(LEDC_LOW_SPEED_MODE, LEDC_TIMER_2);
-            break;
-        case PWM_3:
-            ledc_timer_pause(LEDC_LOW_SPEED_MODE, LEDC_TIMER_3);
-            break;
+    ledc_timer_t timer = pwm_channels[out].timer;
+    if(pwm_timers[timer].users > 1){
+        /* Shared timer: pausing it would stop the rest of the group */
+        ledc_stop(LEDC_LOW_SPEED_MODE, out, 0);
+    } else {
+        ledc_timer_pause(LEDC_LOW_SPEED_MODE, timer);
     }
 }
 
 void PWMSetDutyCycle(pwm_out_t out, uint8_t duty_cycle){
-    if(duty_cycle > DC_100){
-        duty_cycle = DC_100;
-    }
-    uint32_t dc = ((uint32_t)duty_cycle * DC_MAX) / DC_100;
-    switch(out){
-        case PWM_0:
-            ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0, dc);
-            ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0);
-            break;
-        case PWM_1:
-            ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_TIMER_1, dc);
-            ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_TIMER_1);
-            break;
-        case PWM_2:
-            ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_TIMER_2, dc);
-            ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_TIMER_2);
-            break;
-        case PWM_3:
-            ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_TIMER_3, dc);
-            ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_TIMER_3);
-            break;
+    if(duty_cycle > 100){
+        duty_cycle = 100;
+    }
+    PWMSetDutyQ16(out, PWM_Q16_PERCENT(duty_cycle));
+}
+
+uint8_t PWMGetResolution(pwm_out_t out){
+    return pwm_timers[pwm_channels[out].timer].bits;
+}
+
+uint32_t PWMGetMaxTicks(pwm_out_t out){
+    return 1UL << pwm_timers[pwm_channels[out].timer].bits;
+}
+
+void PWMSetDutyTicks(pwm_out_t out, uint32_t ticks){
+    uint8_t bits = pwm_timers[pwm_channels[out].timer].bits;
+    if(ticks > (1UL << bits)){
+        ticks = 1UL << bits;
+    }
+    pwm_channels[out].duty_q16 = (uint32_t)(((uint64_t)ticks << 16) >> bits);
+    ledc_set_duty(LEDC_LOW_SPEED_MODE, out, ticks);
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, out);
+}
+
+void PWMSetDutyQ16(pwm_out_t out, uint32_t duty_q16){
+    if(duty_q16 > PWM_Q16_ONE){
+        duty_q16 = PWM_Q16_ONE;
     }
+    pwm_channels[out].duty_q16 = duty_q16;
+    ledc_set_duty(LEDC_LOW_SPEED_MODE, out, PWMQ16ToTicks(out, duty_q16));
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, out);
+}
+
+void PWMGroupSetDutyQ16(const pwm_out_t *outs, const uint32_t *duty_q16, uint8_t qty){
+    /* ledc_set_duty() may block on the fade lock, so only the latch goes in the critical section */
+    for(uint8_t i = 0; i < qty; i++){
+        pwm_channels[outs[i]].duty_q16 = (duty_q16[i] > PWM_Q16_ONE) ? PWM_Q16_ONE : duty_q16[i];
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, outs[i], PWMQ16ToTicks(outs[i], duty_q16[i]));
+    }
+    /* New duties take effect on the next timer overflow, back to back they share it */
+    taskENTER_CRITICAL(&pwm_mux);
+    for(uint8_t i = 0; i < qty; i++){
+        ledc_update_duty(LEDC_LOW_SPEED_MODE, outs[i]);
+    }
+    taskEXIT_CRITICAL(&pwm_mux);
+}
+
+uint8_t PWMFadeQ16(pwm_out_t out, uint32_t duty_q16, uint32_t time_ms, bool wait){
+    if(!fade_installed){
+        if(ledc_fade_func_install(0) != ESP_OK){
+            return 1;
+        }
+        fade_installed = true;
+    }
+    if(duty_q16 > PWM_Q16_ONE){
+        duty_q16 = PWM_Q16_ONE;
+    }
+    pwm_channels[out].duty_q16 = duty_q16;
+    if(ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, out, PWMQ16ToTicks(out, duty_q16), time_ms) != ESP_OK){
+        return 1;
+    }
+    return (ledc_fade_start(LEDC_LOW_SPEED_MODE, out, wait ? LEDC_FADE_WAIT_DONE : LEDC_FADE_NO_WAIT) == ESP_OK) ? 0 : 1;
 }
 
 uint8_t PWMSetFreq(pwm_out_t out, uint32_t freq){
-    switch(out){
-        case PWM_0:
-            ledc_set_freq(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0, freq);
-            break;
-        case PWM_1:
-            ledc_set_freq(LEDC_LOW_SPEED_MODE, LEDC_TIMER_1, freq);
-            break;
-        case PWM_2:
-            ledc_set_freq(LEDC_LOW_SPEED_MODE, LEDC_TIMER_2, freq);
-            break;
-        case PWM_3:
-            ledc_set_freq(LEDC_LOW_SPEED_MODE, LEDC_TIMER_3, freq);
-            break;
+    ledc_timer_t timer = pwm_channels[out].timer;
+    if(PWMBestResolution(freq) == pwm_timers[timer].bits){
+        if(ledc_set_freq(LEDC_LOW_SPEED_MODE, timer, freq) != ESP_OK){
+            return 1;
+        }
+        pwm_timers[timer].freq = freq;
+        return 0;
+    }
+    /* Resolution changes: reconfigure the timer and rescale every output attached to it */
+    if(PWMTimerConfig(timer, freq)){
+        return 1;
+    }
+    for(uint8_t i = 0; i < PWM_QTY; i++){
+        if(pwm_channels[i].init && (pwm_channels[i].timer == timer)){
+            ledc_set_duty(LEDC_LOW_SPEED_MODE, i, PWMQ16ToTicks(i, pwm_channels[i].duty_q16));
+            ledc_update_duty(LEDC_LOW_SPEED_MODE, i);
+        }
     }
     return 0;
 }
 
 uint8_t PWMDeinit(pwm_out_t out){
-    switch(out){
-        case PWM_0:
-            ledc_stop(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, 0);
-            break;
-        case PWM_1:
-            ledc_stop(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, 0);
-            break;
-        case PWM_2:
-            ledc_stop(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, 0);
-            break;
-        case PWM_3:
-            ledc_stop(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_3, 0);
-            break;
+    if(out >= PWM_QTY){
+        return 1;
+    }
+    ledc_stop(LEDC_LOW_SPEED_MODE, out, 0);
+    if(pwm_channels[out].init){
+        pwm_timers[pwm_channels[out].timer].users--;
+        pwm_channels[out].init = false;
     }
     return 0;
 }
 
-/*==================[end of file]============================================*/
\ No newline at end of file
+/*==================[end of file]============================================*/
@@ -13,7 +13,13 @@
 #include "spi_mcu.h"
 #include <stdint.h>
 #include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
 #include "driver/spi_master.h"
+#include "esp_heap_caps.h"
 #include "gpio_mcu.h"
 /*==================[macros and definitions]=================================*/
 #define PIN_NUM_MISO	GPIO_22	/*!<  */
@@ -22,8 +28,35 @@
 #define PIN_NUM_CS1		GPIO_19	/*!<  */
 #define PIN_NUM_CS2		GPIO_18	/*!<  */
 #define PIN_NUM_CS3		GPIO_9	/*!<  */
+#define SPI_DEVICES		3		/*!< SPI_1, SPI_2 and SPI_3 */
+#define DONE_TASK_STACK	2048	/*!<  */
+#define DONE_TASK_PRIO	10		/*!<  */
+
+/**
+ * @brief Preallocated transaction of a device pool
+ */
+typedef struct {
+	spi_transaction_t trans;	/*!< Transaction handed to the driver, trans.user points back here */
+	uint8_t device;				/*!< Owner device */
+	bool used;					/*!< Slot in flight */
+	void (*func_p)(void*);		/*!< Completion callback */
+	void *tag;					/*!< Completion callback parameter */
+} spi_slot_t;
+
+/**
+ * @brief State of one chip select
+ */
+typedef struct {
+	spi_device_handle_t handle;			/*!< Driver handle, NULL until SpiInit() */
+	gpio_t cs_pin;						/*!< Chip select pin */
+	transfer_mode_t transfer_mode;		/*!< Transfer mode */
+	void (*isr_p)(void*);				/*!< Legacy end of transaction callback (SPI_INTERRUPT) */
+	void *user_data;					/*!< Legacy callback parameter */
+	spi_slot_t pool[SPI_QUEUE_SIZE];	/*!< Transaction pool */
+	SemaphoreHandle_t free_slots;		/*!< Counts free pool slots */
+	uint8_t pending;					/*!< Submitted and not yet completed */
+} spi_device_t;
 /*==================[internal data declaration]==============================*/
-spi_device_handle_t spi_1, spi_2, spi_3;
 const spi_bus_config_t bus_cfg = {
     .miso_io_num = PIN_NUM_MISO,
     .mosi_io_num = PIN_NUM_MOSI,
@@ -32,197 +65,233 @@ const spi_bus_config_t bus_cfg = {
     .quadhd_io_num = -1,
     .max_transfer_sz = 4092
 };
-transfer_mode_t transfer_mode_1, transfer_mode_2, transfer_mode_3;
-void (*spi_1_isr_p)(void*);	/*!<  */
-void (*spi_2_isr_p)(void*);	/*!<  */
-void (*spi_3_isr_p)(void*);	/*!<  */
-void *spi_1_user_data;	    /*!<  */
-void *spi_2_user_data;	    /*!<  */
-void *spi_3_user_data;	    /*!<  */
+static spi_device_t spi_devs[SPI_DEVICES] = {
+	[SPI_1] = {.cs_pin = PIN_NUM_CS1},
+	[SPI_2] = {.cs_pin = PIN_NUM_CS2},
+	[SPI_3] = {.cs_pin = PIN_NUM_CS3},
+};
+static QueueHandle_t done_queue = NULL;			/*!< Devices with a finished transaction, fed by the ISR */
+static EventGroupHandle_t idle_group = NULL;	/*!< Bit n set while device n has nothing pending */
+static portMUX_TYPE spi_mux = portMUX_INITIALIZER_UNLOCKED;
 /*==================[internal functions declaration]=========================*/
-static void IRAM_ATTR spi_1_isr(spi_transaction_t *t){
-	spi_1_isr_p(spi_1_user_data);
-}
-static void IRAM_ATTR spi_2_isr(spi_transaction_t *t){
-	spi_2_isr_p(spi_2_user_data);
-}
-static void IRAM_ATTR spi_3_isr(spi_transaction_t *t){
-	spi_3_isr_p(spi_3_user_data);
-}
+static void IRAM_ATTR SpiPostCb(spi_transaction_t *t);
+static void SpiDoneTask(void *param);
+static void SpiTransfer(spi_dev_t device, uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size);
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/**
+ * @brief Called by the driver at the end of every transaction of every device. 
+ * Synchronous polling transactions carry no slot and are ignored.
+ */
+static void IRAM_ATTR SpiPostCb(spi_transaction_t *t){
+	spi_slot_t *slot = t->user;
+	BaseType_t woken = pdFALSE;
+	if(slot == NULL){
+		return;
+	}
+	spi_device_t *dev = &spi_devs[slot->device];
+	if((dev->transfer_mode == SPI_INTERRUPT) && (dev->isr_p != NULL)){
+		dev->isr_p(dev->user_data);
+	}
+	xQueueSendFromISR(done_queue, &slot->device, &woken);
+	if(woken){
+		portYIELD_FROM_ISR();
+	}
+}
 
+/**
+ * @brief Collects finished transactions, releases their slots and runs the 
+ * completion callbacks outside the ISR.
+ */
+static void SpiDoneTask(void *param){
+	uint8_t device;
+	spi_transaction_t *t;
+	while(1){
+		xQueueReceive(done_queue, &device, portMAX_DELAY);
+		spi_device_t *dev = &spi_devs[device];
+		/* post_cb runs before the driver posts the result, so this may wait briefly */
+		if(spi_device_get_trans_result(dev->handle, &t, portMAX_DELAY) != ESP_OK){
+			continue;
+		}
+		spi_slot_t *slot = t->user;
+		void (*func_p)(void*) = slot->func_p;
+		void *tag = slot->tag;
+		/* Release the slot before the callback so it can submit again */
+		taskENTER_CRITICAL(&spi_mux);
+		slot->used = false;
+		taskEXIT_CRITICAL(&spi_mux);
+		xSemaphoreGive(dev->free_slots);
+		if(func_p != NULL){
+			func_p(tag);
+		}
+		/* Only count it done once the callback returned, SpiWaitAll() relies on it */
+		taskENTER_CRITICAL(&spi_mux);
+		bool idle = (--dev->pending == 0);
+		taskEXIT_CRITICAL(&spi_mux);
+		if(idle){
+			xEventGroupSetBits(idle_group, 1 << device);
+		}
+	}
+}
+
+static void SpiTransfer(spi_dev_t device, uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size){
+	spi_transaction_t t;
+	if((device >= SPI_DEVICES) || (spi_devs[device].handle == NULL)){
+		return;
+	}
+	switch(spi_devs[device].transfer_mode){
+		case SPI_POLLING:
+			/* The driver does not allow polling while queued transactions are in flight */
+			SpiWaitAll(device, portMAX_DELAY);
+			memset(&t, 0, sizeof(t));		// Zero out the transaction
+			t.length = buffer_size * 8;		// buffer_size is in bytes, transaction length is in bits.
+			t.rxlength = (rx_buffer != NULL) ? buffer_size * 8 : 0;
+			t.tx_buffer = tx_buffer;
+			t.rx_buffer = rx_buffer;
+			spi_device_polling_transmit(spi_devs[device].handle, &t);
+			break;
+		case SPI_INTERRUPT:
+			if(SpiSubmit(device, tx_buffer, rx_buffer, buffer_size, NULL, NULL)){
+				SpiWaitAll(device, portMAX_DELAY);
+			}
+			break;
+	}
+}
 /*==================[external functions definition]==========================*/
 uint8_t SpiInit(spi_mcu_config_t* spi){
     static bool spi_initialized = false;
+    if(spi->device >= SPI_DEVICES){
+        return 1;
+    }
     if(!spi_initialized){
 	    spi_bus_initialize(SPI2_HOST, &bus_cfg, SPI_DMA_CH_AUTO);
+        done_queue = xQueueCreate(SPI_DEVICES * SPI_QUEUE_SIZE, sizeof(uint8_t));
+        idle_group = xEventGroupCreate();
+        xEventGroupSetBits(idle_group, (1 << SPI_DEVICES) - 1);
+        xTaskCreate(SpiDoneTask, "spi_done", DONE_TASK_STACK, NULL, DONE_TASK_PRIO, NULL);
         spi_initialized = true;
+    }
+    spi_device_t *dev = &spi_devs[spi->device];
+    if(dev->handle != NULL){
+        return 1;
+    }
+    dev->transfer_mode = spi->transfer_mode;
+    dev->isr_p = spi->func_p;
+    dev->user_data = spi->param_p;
+    dev->pending = 0;
+    for(uint8_t i = 0; i < SPI_QUEUE_SIZE; i++){
+        memset(&dev->pool[i], 0, sizeof(spi_slot_t));
+        dev->pool[i].device = spi->device;
+        dev->pool[i].trans.user = &dev->pool[i];
+    }
+    if(dev->free_slots == NULL){
+        dev->free_slots = xSemaphoreCreateCounting(SPI_QUEUE_SIZE, SPI_QUEUE_SIZE);
     }
 	spi_device_interface_config_t dev_cfg = {
         .clock_speed_hz = spi->bitrate,     	
         .mode = spi->clk_mode,                  
-        .queue_size = 8,                        
+        .spics_io_num = dev->cs_pin,
+        .queue_size = SPI_QUEUE_SIZE,
+        .post_cb = SpiPostCb,
     };
-    switch(spi->device){
-        case SPI_1:
-            dev_cfg.spics_io_num = PIN_NUM_CS1;
-            transfer_mode_1 = spi->transfer_mode;
-            if(transfer_mode_1 == SPI_INTERRUPT){
-                dev_cfg.post_cb = spi_1_isr;
-            } 
-            spi_bus_add_device(SPI2_HOST, &dev_cfg, &spi_1);
-            spi_1_isr_p = spi->func_p;
-            spi_1_user_data = spi->param_p;
-            break;
-        case SPI_2:
-            dev_cfg.spics_io_num = PIN_NUM_CS2;
-            if(transfer_mode_2 == SPI_INTERRUPT){
-                dev_cfg.post_cb = spi_2_isr;
-            } 
-            transfer_mode_1 = spi->transfer_mode;
-            spi_bus_add_device(SPI2_HOST, &dev_cfg, &spi_2);
-            spi_2_isr_p = spi->func_p;
-            spi_2_user_data = spi->param_p;
-            break;
-        case SPI_3:
-            dev_cfg.spics_io_num = PIN_NUM_CS3;
-            if(transfer_mode_3 == SPI_INTERRUPT){
-                dev_cfg.post_cb = spi_3_isr;
-            } 
-            transfer_mode_1 = spi->transfer_mode;
-            spi_bus_add_device(SPI2_HOST, &dev_cfg, &spi_3);
-            spi_3_isr_p = spi->func_p;
-            spi_3_user_data = spi->param_p;
-            break;
+    if(spi_bus_add_device(SPI2_HOST, &dev_cfg, &dev->handle) != ESP_OK){
+        dev->handle = NULL;
+        return 1;
     }
     return 0;
 }
 
-void SpiRead(spi_dev_t device, uint8_t * rx_buffer, uint32_t rx_buffer_size){
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       // Zero out the transaction
-    t.length = rx_buffer_size * 8;  // tx_buffer_size is in bytes, transaction length is in bits.
-    t.rxlength = rx_buffer_size * 8;
-    t.rx_buffer = rx_buffer;        // Data
-    switch(device){
-        case SPI_1:
-            switch(transfer_mode_1){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_1, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_1, &t); 
-                    break;
-            }
-            break;
-        case SPI_2:
-            switch(transfer_mode_2){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_2, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_2, &t); 
-                    break;
-            }
-            break;
-        case SPI_3:
-            switch(transfer_mode_3){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_3, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_3, &t); 
-                    break;
-            }
+bool SpiSubmit(spi_dev_t device, uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size, void *func_p, void *tag){
+    spi_slot_t *slot = NULL;
+    if((device >= SPI_DEVICES) || (spi_devs[device].handle == NULL) || (buffer_size == 0)){
+        return false;
+    }
+    spi_device_t *dev = &spi_devs[device];
+    xSemaphoreTake(dev->free_slots, portMAX_DELAY);
+    taskENTER_CRITICAL(&spi_mux);
+    for(uint8_t i = 0; i < SPI_QUEUE_SIZE; i++){
+        if(!dev->pool[i].used){
+            slot = &dev->pool[i];
+            slot->used = true;
             break;
+        }
     }
+    dev->pending++;
+    taskEXIT_CRITICAL(&spi_mux);
+    xEventGroupClearBits(idle_group, 1 << device);
+    slot->func_p = func_p;
+    slot->tag = tag;
+    slot->trans.length = buffer_size * 8;	// buffer_size is in bytes, transaction length is in bits.
+    slot->trans.rxlength = (rx_buffer != NULL) ? buffer_size * 8 : 0;
+    slot->trans.tx_buffer = tx_buffer;
+    slot->trans.rx_buffer = rx_buffer;
+    if(spi_device_queue_trans(dev->handle, &slot->trans, portMAX_DELAY) != ESP_OK){
+        taskENTER_CRITICAL(&spi_mux);
+        slot->used = false;
+        bool idle = (--dev->pending == 0);
+        taskEXIT_CRITICAL(&spi_mux);
+        xSemaphoreGive(dev->free_slots);
+        if(idle){
+            xEventGroupSetBits(idle_group, 1 << device);
+        }
+        return false;
+    }
+    return true;
 }
 
-void SpiWrite(spi_dev_t device, uint8_t * tx_buffer, uint32_t tx_buffer_size){
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       // Zero out the transaction
-    t.length = tx_buffer_size * 8;  // tx_buffer_size is in bytes, transaction length is in bits.
-    t.tx_buffer = tx_buffer;        // Data
-    switch(device){
-        case SPI_1:
-            switch(transfer_mode_1){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_1, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_1, &t); 
-                    break;
-            }
-            break;
-        case SPI_2:
-            switch(transfer_mode_2){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_2, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_2, &t); 
-                    break;
-            }
-            break;
-        case SPI_3:
-            switch(transfer_mode_3){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_3, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_3, &t); 
-                    break;
-            }
-            break;
+bool SpiWaitAll(spi_dev_t device, uint32_t timeout_ms){
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if((device >= SPI_DEVICES) || (idle_group == NULL)){
+        return true;
+    }
+    while(1){
+        taskENTER_CRITICAL(&spi_mux);
+        bool idle = (spi_devs[device].pending == 0);
+        taskEXIT_CRITICAL(&spi_mux);
+        if(idle){
+            return true;
+        }
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if((timeout != portMAX_DELAY) && (elapsed >= timeout)){
+            return false;
+        }
+        /* The bit can be stale when a submit races the last completion, so re-check pending */
+        xEventGroupWaitBits(idle_group, 1 << device, pdFALSE, pdTRUE, 
+            (timeout == portMAX_DELAY) ? portMAX_DELAY : timeout - elapsed);
     }
 }
 
+void *SpiDmaAlloc(uint32_t size){
+    return heap_caps_malloc((size + 3) & ~3UL, MALLOC_CAP_DMA);
+}
+
+void SpiDmaFree(void *buffer){
+    heap_caps_free(buffer);
+}
+
+void SpiRead(spi_dev_t device, uint8_t * rx_buffer, uint32_t rx_buffer_size){
+    SpiTransfer(device, NULL, rx_buffer, rx_buffer_size);
+}
+
+void SpiWrite(spi_dev_t device, uint8_t * tx_buffer, uint32_t tx_buffer_size){
+    SpiTransfer(device, tx_buffer, NULL, tx_buffer_size);
+}
+
 void SpiReadWrite(spi_dev_t device, uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size){
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       // Zero out the transaction
-    t.length = buffer_size * 8;     // tx_buffer_size is in bytes, transaction length is in bits.
-    t.rxlength = buffer_size * 8;
-    t.tx_buffer = tx_buffer;        // Data
-    t.rx_buffer = rx_buffer;        
-    switch(device){
-        case SPI_1:
-            switch(transfer_mode_1){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_1, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_1, &t); 
-                    break;
-            }
-            break;
-        case SPI_2:
-            switch(transfer_mode_2){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_2, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_2, &t); 
-                    break;
-            }
-            break;
-        case SPI_3:
-            switch(transfer_mode_3){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_3, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_3, &t); 
-                    break;
-            }
-            break;
-    }
+    SpiTransfer(device, tx_buffer, rx_buffer, buffer_size);
 }
 
 uint8_t SpiDeInit(spi_dev_t device){
+    if((device >= SPI_DEVICES) || (spi_devs[device].handle == NULL)){
+        return 1;
+    }
+    SpiWaitAll(device, portMAX_DELAY);
+    spi_bus_remove_device(spi_devs[device].handle);
+    spi_devs[device].handle = NULL;
     return 0;
 }
 
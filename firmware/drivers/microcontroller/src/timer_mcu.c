@@ -11,142 +11,313 @@
 
 /*==================[inclusions]=============================================*/
 #include "timer_mcu.h"
+#include "timer_wheel.h"
+#include "trace_mcu.h"
 #include "driver/gptimer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 /*==================[macros and definitions]=================================*/
 #define US_RESOLUTION_HZ	1000000	/*!< 1usec */
 #define RESET_COUNT_VALUE	0		/*!< Reset timer count to 0 */
+#define HW_TIMERS			3		/*!< TIMER_A, TIMER_B, TIMER_C */
+#define SERVICE_QUEUE_SIZE	32		/*!< Expired timers waiting for the service task */
+#define SERVICE_TASK_STACK	3072	/*!<  */
+#define SERVICE_TASK_PRIO	(configMAX_PRIORITIES - 2)	/*!< Deferred callbacks run above application tasks */
+#define SERVICE_MAX_SLEEP	TIMER_WHEEL_SLOTS	/*!< Max ticks between service interrupts (bounds the ticks one processes) */
+#define ALARM_MARGIN_US		10		/*!< Alarms closer than this to the count are moved ahead */
 /*==================[internal data declaration]==============================*/
-gptimer_handle_t timer_a = NULL;		/*!<  */
-gptimer_handle_t timer_b = NULL;		/*!<  */
-gptimer_handle_t timer_c = NULL;		/*!<  */
+/**
+ * @brief Hardware timer (TIMER_A, TIMER_B, TIMER_C) state
+ */
+typedef struct {
+	gptimer_handle_t handle;	/*!<  */
+	void (*isr_p)(void*);		/*!<  */
+	void *user_data;			/*!<  */
+} hw_timer_t;
+/**
+ * @brief Soft timers expired in one service interrupt
+ */
+typedef struct {
+	BaseType_t task_woken;		/*!<  */
+	soft_timer_t *run;			/*!< TIMER_DISPATCH_ISR timers to run once service_lock is released */
+	soft_timer_t **run_tail;	/*!< Where the next one is linked (expiration order) */
+} service_dispatch_t;
+static hw_timer_t hw_timers[HW_TIMERS];	/*!<  */
 const gptimer_config_t timer_config = {
 	.clk_src = GPTIMER_CLK_SRC_DEFAULT,	/*!<  */
 	.direction = GPTIMER_COUNT_UP,		/*!<  */
 	.resolution_hz = US_RESOLUTION_HZ,	/*!<  */
 };
-void (*timer_a_isr_p)(void*);	/*!<  */
-void (*timer_b_isr_p)(void*);	/*!<  */
-void (*timer_c_isr_p)(void*);	/*!<  */
-void *timer_a_user_data;	/*!<  */
-void *timer_b_user_data;	/*!<  */
-void *timer_c_user_data;	/*!<  */
+/* timer service */
+static gptimer_handle_t service_timer = NULL;		/*!< Free running count (us) of the timer wheel, alarm at the next expiration */
+static tw_wheel_t service_wheel;					/*!<  */
+static QueueHandle_t service_queue = NULL;			/*!< Deferred dispatch */
+static uint32_t service_queue_overruns = 0;			/*!<  */
+static portMUX_TYPE service_lock = portMUX_INITIALIZER_UNLOCKED;
 /*==================[internal functions declaration]=========================*/
-static bool IRAM_ATTR timer_a_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
-	timer_a_isr_p(timer_a_user_data);
-	return true;
-}
-static bool IRAM_ATTR timer_b_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
-	timer_b_isr_p(timer_b_user_data);
-	return true;
-}
-static bool IRAM_ATTR timer_c_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
-	timer_c_isr_p(timer_c_user_data);
-	return true;
-}
+
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static bool IRAM_ATTR hw_timer_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	hw_timer_t *hw = (hw_timer_t *)user_data;
+	TRACE_BEGIN(TRACE_ID_TIMER_ISR);
+	hw->isr_p(hw->user_data);
+	TRACE_END(TRACE_ID_TIMER_ISR);
+	return true;
+}
 
-/*==================[external functions definition]==========================*/
-void TimerInit(timer_config_t *timer_ini){
-	switch(timer_ini->timer){
-	 	case TIMER_A:
-			timer_a_isr_p = timer_ini->func_p;
-			timer_a_user_data = timer_ini->param_p;
-	 		gptimer_new_timer(&timer_config, &timer_a);
-			gptimer_alarm_config_t alarm_config_a = {
-				.alarm_count = timer_ini->period, 
-				.reload_count = RESET_COUNT_VALUE,
-				.flags.auto_reload_on_alarm = true,
-			};
-			gptimer_set_alarm_action(timer_a, &alarm_config_a);
-			gptimer_event_callbacks_t alarm_a = {
-				.on_alarm = timer_a_isr,
-			};
-			gptimer_register_event_callbacks(timer_a, &alarm_a, NULL);
-			gptimer_enable(timer_a);
-	 	break;
-
-	 	case TIMER_B:
-			timer_b_isr_p = timer_ini->func_p;
-			timer_b_user_data = timer_ini->param_p;
-	 		gptimer_new_timer(&timer_config, &timer_b);
-			gptimer_alarm_config_t alarm_config_b = {
-				.alarm_count = timer_ini->period, 
-				.reload_count = RESET_COUNT_VALUE,
-				.flags.auto_reload_on_alarm = true,
-			};
-			gptimer_set_alarm_action(timer_b, &alarm_config_b);
-			gptimer_event_callbacks_t alarm_b = {
-				.on_alarm = timer_b_isr,
-			};
-			gptimer_register_event_callbacks(timer_b, &alarm_b, NULL);
-			gptimer_enable(timer_b);
-	 	break;
-
-	 	case TIMER_C:
-			timer_c_isr_p = timer_ini->func_p;
-			timer_c_user_data = timer_ini->param_p;
-	 		gptimer_new_timer(&timer_config, &timer_c);
-			gptimer_alarm_config_t alarm_config_c = {
-				.alarm_count = timer_ini->period, 
-				.reload_count = RESET_COUNT_VALUE,
-				.flags.auto_reload_on_alarm = true,
-			};
-			gptimer_set_alarm_action(timer_c, &alarm_config_c);
-			gptimer_event_callbacks_t alarm_c = {
-				.on_alarm = timer_c_isr,
-			};
-			gptimer_register_event_callbacks(timer_c, &alarm_c, NULL);
-			gptimer_enable(timer_c);
-	 	break;
+static uint32_t IRAM_ATTR ServiceTick(uint64_t count){
+	return (uint32_t)(count / TIMER_SERVICE_TICK_US);
+}
+
+/**
+ * @brief Set the alarm at the start of the tick when the next soft timer expires
+ * (no alarm if none is started). Called with service_lock taken.
+ * @param count Current count of the service timer
+ */
+static void IRAM_ATTR ServiceSchedule(uint64_t count){
+	uint32_t delay;
+	int64_t alarm;
+	gptimer_alarm_config_t alarm_config = {
+		.reload_count = RESET_COUNT_VALUE,
+		.flags.auto_reload_on_alarm = false,
+	};
+
+	if(!TimerWheelNextExpiry(&service_wheel, &delay)){
+		gptimer_set_alarm_action(service_timer, NULL);
+		return;
+	}
+	if(delay > SERVICE_MAX_SLEEP){
+		delay = SERVICE_MAX_SLEEP;
 	}
+	/* wheel ticks are the 32 low bits of count / TIMER_SERVICE_TICK_US */
+	alarm = ((int64_t)(count / TIMER_SERVICE_TICK_US) + (int32_t)(service_wheel.now + delay - ServiceTick(count))) * TIMER_SERVICE_TICK_US;
+	if(alarm < (int64_t)count + ALARM_MARGIN_US){
+		/* already due */
+		alarm = count + ALARM_MARGIN_US;
+	}
+	alarm_config.alarm_count = alarm;
+	gptimer_set_alarm_action(service_timer, &alarm_config);
 }
 
-void TimerStart(timer_mcu_t timer){
-	switch(timer){
-	 	case TIMER_A:
-	 		gptimer_start(timer_a);
+/**
+ * @brief Update the statistics of a soft timer expired at now (us).
+ * Called with service_lock taken.
+ */
+static void IRAM_ATTR SoftTimerAccount(soft_timer_t *timer, int64_t now){
+	uint32_t jitter;
+
+	if(timer->stats.runs && timer->wheel.period){
+		/* deviation of the interval between runs from the period */
+		int64_t interval = now - timer->last_run;
+		jitter = (interval > timer->period_us) ? (interval - timer->period_us) : (timer->period_us - interval);
+		if(jitter > timer->stats.max_jitter_us){
+			timer->stats.max_jitter_us = jitter;
+		}
+		timer->stats.sum_jitter_us += jitter;
+	}
+	timer->last_run = now;
+	timer->stats.runs++;
+}
+
+/**
+ * @brief Called by the timer wheel (in the service ISR, service_lock taken) for each
+ * expired soft timer
+ */
+static void IRAM_ATTR SoftTimerExpired(tw_timer_t *entry, void *param){
+	soft_timer_t *timer = (soft_timer_t *)entry->owner;
+	service_dispatch_t *dispatch = (service_dispatch_t *)param;
+
+	switch(timer->dispatch){
+		case TIMER_DISPATCH_ISR:
+			SoftTimerAccount(timer, esp_timer_get_time());
+			/* run after the lock is released, once per expiration */
+			if(timer->run_due++ == 0){
+				timer->run_next = NULL;
+				*dispatch->run_tail = timer;
+				dispatch->run_tail = &timer->run_next;
+			}
 		break;
-	 	case TIMER_B:
-	 		gptimer_start(timer_b);
+		case TIMER_DISPATCH_TASK:
+			if(xQueueSendFromISR(service_queue, &timer, &dispatch->task_woken) != pdTRUE){
+				service_queue_overruns++;
+				timer->stats.missed++;
+			}
 		break;
-	 	case TIMER_C:
-	 		gptimer_start(timer_c);
+		case TIMER_DISPATCH_NOTIFY:
+			timer->stats.runs++;
+			vTaskNotifyGiveFromISR((TaskHandle_t)timer->param_p, &dispatch->task_woken);
 		break;
 	}
 }
 
-void TimerStop(timer_mcu_t timer){
-	switch(timer){
-	 	case TIMER_A:
-	 		gptimer_stop(timer_a);
-	 	break;
-	 	case TIMER_B:
-	 		gptimer_stop(timer_b);
-	 	break;
-	 	case TIMER_C:
-	 		gptimer_stop(timer_c);
-	 	break;
+static bool IRAM_ATTR service_timer_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	service_dispatch_t dispatch = {.task_woken = pdFALSE, .run = NULL, .run_tail = &dispatch.run};
+	soft_timer_t *run;
+	uint64_t count;
+
+	TRACE_BEGIN(TRACE_ID_TIMER_SERVICE);
+	portENTER_CRITICAL_ISR(&service_lock);
+	gptimer_get_raw_count(service_timer, &count);
+	TimerWheelAdvance(&service_wheel, ServiceTick(count), SoftTimerExpired, &dispatch);
+	ServiceSchedule(count);
+	portEXIT_CRITICAL_ISR(&service_lock);
+	/* callbacks out of the lock: they can start and stop soft timers */
+	while(dispatch.run != NULL){
+		run = dispatch.run;
+		dispatch.run = run->run_next;
+		for(; run->run_due; run->run_due--){
+			TRACE_BEGIN(TRACE_ID_SOFT_TIMER);
+			run->func_p(run->param_p);
+			TRACE_END(TRACE_ID_SOFT_TIMER);
+		}
 	}
+	TRACE_END(TRACE_ID_TIMER_SERVICE);
+	return (dispatch.task_woken == pdTRUE);
+}
+
+static void service_task(void *param){
+	soft_timer_t *timer;
+	while(1){
+		if(xQueueReceive(service_queue, &timer, portMAX_DELAY) == pdTRUE){
+			portENTER_CRITICAL(&service_lock);
+			SoftTimerAccount(timer, esp_timer_get_time());
+			portEXIT_CRITICAL(&service_lock);
+			TRACE_BEGIN(TRACE_ID_SOFT_TIMER);
+			timer->func_p(timer->param_p);
+			TRACE_END(TRACE_ID_SOFT_TIMER);
+		}
+	}
+}
+
+static uint32_t SoftTimerTicks(uint32_t period_us){
+	uint32_t ticks = (period_us + TIMER_SERVICE_TICK_US - 1) / TIMER_SERVICE_TICK_US;
+	return (ticks == 0) ? 1 : ticks;
+}
+/*==================[external functions definition]==========================*/
+void TimerInit(timer_config_t *timer_ini){
+	hw_timer_t *hw = &hw_timers[timer_ini->timer];
+	hw->isr_p = timer_ini->func_p;
+	hw->user_data = timer_ini->param_p;
+	gptimer_new_timer(&timer_config, &hw->handle);
+	gptimer_alarm_config_t alarm_config = {
+		.alarm_count = timer_ini->period, 
+		.reload_count = RESET_COUNT_VALUE,
+		.flags.auto_reload_on_alarm = true,
+	};
+	gptimer_set_alarm_action(hw->handle, &alarm_config);
+	gptimer_event_callbacks_t alarm = {
+		.on_alarm = hw_timer_isr,
+	};
+	gptimer_register_event_callbacks(hw->handle, &alarm, hw);
+	gptimer_enable(hw->handle);
+}
+
+void TimerStart(timer_mcu_t timer){
+	gptimer_start(hw_timers[timer].handle);
+}
+
+void TimerStop(timer_mcu_t timer){
+	gptimer_stop(hw_timers[timer].handle);
 }
 
 void TimerReset(timer_mcu_t timer){
-	switch(timer){
-	 	case TIMER_A:
-			gptimer_set_raw_count(timer_a, RESET_COUNT_VALUE);
-	 	break;
-	 	case TIMER_B:
-			gptimer_set_raw_count(timer_b, RESET_COUNT_VALUE);
-	 	break;
-	 	case TIMER_C:
-			gptimer_set_raw_count(timer_c, RESET_COUNT_VALUE);
-	 	break;
+	gptimer_set_raw_count(hw_timers[timer].handle, RESET_COUNT_VALUE);
+}
+
+void TimerServiceInit(void){
+	if(service_timer != NULL){
+		return;
+	}
+	TimerWheelInit(&service_wheel, 0);
+	service_queue = xQueueCreate(SERVICE_QUEUE_SIZE, sizeof(soft_timer_t *));
+	xTaskCreate(service_task, "timer_service", SERVICE_TASK_STACK, NULL, SERVICE_TASK_PRIO, NULL);
+	gptimer_new_timer(&timer_config, &service_timer);
+	gptimer_event_callbacks_t alarm = {
+		.on_alarm = service_timer_isr,
+	};
+	gptimer_register_event_callbacks(service_timer, &alarm, NULL);
+	gptimer_enable(service_timer);
+	/* always counting, the alarm is only set while soft timers are started */
+	gptimer_start(service_timer);
+}
+
+void SoftTimerInit(soft_timer_t *timer, soft_timer_config_t *config){
+	TimerServiceInit();
+	TimerWheelTimerInit(&timer->wheel);
+	timer->wheel.owner = timer;
+	timer->period_us = config->period;
+	timer->periodic = config->periodic;
+	timer->dispatch = config->dispatch;
+	timer->func_p = config->func_p;
+	timer->param_p = config->param_p;
+	timer->run_next = NULL;
+	timer->run_due = 0;
+	if(timer->dispatch == TIMER_DISPATCH_NOTIFY && timer->param_p == NULL){
+		timer->param_p = xTaskGetCurrentTaskHandle();
+	}
+	SoftTimerStatsReset(timer);
+}
+
+void SoftTimerStart(soft_timer_t *timer){
+	uint32_t ticks = SoftTimerTicks(timer->period_us);
+	uint32_t tick, delay;
+	uint64_t count;
+
+	portENTER_CRITICAL(&service_lock);
+	gptimer_get_raw_count(service_timer, &count);
+	tick = ServiceTick(count);
+	if(!TimerWheelNextExpiry(&service_wheel, &delay)){
+		/* no interrupts while empty: bring the wheel to the current tick */
+		TimerWheelInit(&service_wheel, tick);
 	}
+	/* expires after 'ticks' full ticks from the next one */
+	TimerWheelAdd(&service_wheel, &timer->wheel, tick + 1 + ticks - service_wheel.now, timer->periodic ? ticks : 0);
+	timer->stats.runs = 0;
+	ServiceSchedule(count);
+	portEXIT_CRITICAL(&service_lock);
+}
+
+void SoftTimerSetPeriod(soft_timer_t *timer, uint32_t period){
+	portENTER_CRITICAL(&service_lock);
+	timer->period_us = period;
+	portEXIT_CRITICAL(&service_lock);
+}
+
+void SoftTimerStop(soft_timer_t *timer){
+	portENTER_CRITICAL(&service_lock);
+	/* the alarm is left as is: at worst one interrupt with nothing to expire */
+	TimerWheelCancel(&timer->wheel);
+	portEXIT_CRITICAL(&service_lock);
+}
+
+bool SoftTimerIsActive(soft_timer_t *timer){
+	return TimerWheelPending(&timer->wheel);
+}
+
+void SoftTimerStats(soft_timer_t *timer, soft_timer_stats_t *stats){
+	portENTER_CRITICAL(&service_lock);
+	*stats = timer->stats;
+	portEXIT_CRITICAL(&service_lock);
+}
+
+void SoftTimerStatsReset(soft_timer_t *timer){
+	portENTER_CRITICAL(&service_lock);
+	timer->stats.runs = 0;
+	timer->stats.missed = 0;
+	timer->stats.max_jitter_us = 0;
+	timer->stats.sum_jitter_us = 0;
+	portEXIT_CRITICAL(&service_lock);
+}
+
+uint32_t TimerServiceOverruns(void){
+	return service_queue_overruns;
 }
 
 /*==================[end of file]============================================*/
@@ -0,0 +1,193 @@
+/**
+ * @file timer_wheel.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-19
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "timer_wheel.h"
+#include <stddef.h>
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+/*==================[macros and definitions]=================================*/
+#define SLOT_MASK		(TIMER_WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(l)	((l) * TIMER_WHEEL_BITS)
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void IRAM_ATTR ListInsert(tw_timer_t *head, tw_timer_t *timer){
+	timer->next = head;
+	timer->prev = head->prev;
+	head->prev->next = timer;
+	head->prev = timer;
+}
+
+static void IRAM_ATTR ListRemove(tw_timer_t *timer){
+	timer->prev->next = timer->next;
+	timer->next->prev = timer->prev;
+	timer->next = NULL;
+	timer->prev = NULL;
+}
+
+/**
+ * @brief Put a timer in the slot of the level matching its distance to wheel->now
+ */
+static void IRAM_ATTR TimerWheelInsert(tw_wheel_t *wheel, tw_timer_t *timer){
+	uint32_t delta = timer->expires - wheel->now;
+	uint8_t level;
+
+	if((int32_t)delta < 0){
+		/* already expired: process on next tick */
+		timer->expires = wheel->now;
+		delta = 0;
+	}else if(delta > TIMER_WHEEL_MAX_TICKS){
+		timer->expires = wheel->now + TIMER_WHEEL_MAX_TICKS;
+		delta = TIMER_WHEEL_MAX_TICKS;
+	}
+	for(level = 0; level < TIMER_WHEEL_LEVELS - 1; level++){
+		if(delta < (1UL << LEVEL_SHIFT(level + 1))){
+			break;
+		}
+	}
+	ListInsert(&wheel->slots[level][(timer->expires >> LEVEL_SHIFT(level)) & SLOT_MASK], timer);
+}
+
+/**
+ * @brief Move the timers of one upper level slot to the levels below
+ */
+static void IRAM_ATTR TimerWheelCascade(tw_wheel_t *wheel, uint8_t level, uint8_t slot){
+	tw_timer_t *head = &wheel->slots[level][slot];
+	tw_timer_t *timer;
+	while(head->next != head){
+		timer = head->next;
+		ListRemove(timer);
+		TimerWheelInsert(wheel, timer);
+	}
+}
+/*==================[external functions definition]==========================*/
+void TimerWheelInit(tw_wheel_t *wheel, uint32_t now){
+	wheel->now = now;
+	for(uint8_t l = 0; l < TIMER_WHEEL_LEVELS; l++){
+		for(uint8_t s = 0; s < TIMER_WHEEL_SLOTS; s++){
+			wheel->slots[l][s].next = &wheel->slots[l][s];
+			wheel->slots[l][s].prev = &wheel->slots[l][s];
+		}
+	}
+}
+
+void TimerWheelTimerInit(tw_timer_t *timer){
+	timer->next = NULL;
+	timer->prev = NULL;
+	timer->expires = 0;
+	timer->period = 0;
+}
+
+void IRAM_ATTR TimerWheelAdd(tw_wheel_t *wheel, tw_timer_t *timer, uint32_t delay, uint32_t period){
+	TimerWheelCancel(timer);
+	timer->expires = wheel->now + delay;
+	timer->period = period;
+	TimerWheelInsert(wheel, timer);
+}
+
+void IRAM_ATTR TimerWheelCancel(tw_timer_t *timer){
+	if(timer->next != NULL){
+		ListRemove(timer);
+	}
+}
+
+bool IRAM_ATTR TimerWheelPending(const tw_timer_t *timer){
+	return (timer->next != NULL);
+}
+
+uint32_t IRAM_ATTR TimerWheelAdvance(tw_wheel_t *wheel, uint32_t now, tw_expire_t func, void *param){
+	uint32_t expired = 0;
+	uint8_t slot, level;
+	tw_timer_t *head, *timer;
+	tw_timer_t expiring;			/* timers of the tick being processed */
+
+	while((int32_t)(now - wheel->now) >= 0){
+		slot = wheel->now & SLOT_MASK;
+		/* every time a level wraps, bring down the next slot of the level above */
+		for(level = 1; level < TIMER_WHEEL_LEVELS; level++){
+			if(((wheel->now >> LEVEL_SHIFT(level - 1)) & SLOT_MASK) != 0){
+				break;
+			}
+			TimerWheelCascade(wheel, level, (wheel->now >> LEVEL_SHIFT(level)) & SLOT_MASK);
+		}
+		head = &wheel->slots[0][slot];
+		wheel->now++;
+		if(head->next == head){
+			continue;
+		}
+		/* detach the slot: reloads landing 64 ticks ahead go back to this same slot */
+		expiring.next = head->next;
+		expiring.prev = head->prev;
+		expiring.next->prev = &expiring;
+		expiring.prev->next = &expiring;
+		head->next = head;
+		head->prev = head;
+		while(expiring.next != &expiring){
+			timer = expiring.next;
+			ListRemove(timer);
+			if(timer->period){
+				/* reload from the ideal expiration tick: no drift */
+				timer->expires += timer->period;
+				TimerWheelInsert(wheel, timer);
+			}
+			expired++;
+			func(timer, param);
+		}
+	}
+	return expired;
+}
+
+bool IRAM_ATTR TimerWheelNextExpiry(const tw_wheel_t *wheel, uint32_t *delay){
+	const tw_timer_t *head, *timer;
+	uint32_t delta, first = 0;
+	uint8_t level, start;
+	bool found = false;
+
+	for(level = 0; level < TIMER_WHEEL_LEVELS; level++){
+		/* upper level slots are cascaded when the level below wraps: past that point
+		 * the current slot only holds timers one turn ahead, so it goes last */
+		start = (wheel->now >> LEVEL_SHIFT(level)) & SLOT_MASK;
+		if((level > 0) && (wheel->now & ((1UL << LEVEL_SHIFT(level)) - 1))){
+			start++;
+		}
+		/* the first non empty slot holds the earliest timers of the level */
+		for(uint8_t i = 0; i < TIMER_WHEEL_SLOTS; i++){
+			head = &wheel->slots[level][(start + i) & SLOT_MASK];
+			if(head->next == head){
+				continue;
+			}
+			for(timer = head->next; timer != head; timer = timer->next){
+				delta = timer->expires - wheel->now;
+				if(!found || (delta < first)){
+					first = delta;
+					found = true;
+				}
+			}
+			break;
+		}
+	}
+	if(found){
+		*delay = first;
+	}
+	return found;
+}
+
+/*==================[end of file]============================================*/
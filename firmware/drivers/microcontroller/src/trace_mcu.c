@@ -0,0 +1,148 @@
+/**
+ * @file trace_mcu.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Trace rings and their dump through a UART port (see trace_mcu.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "trace_mcu.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+/*==================[macros and definitions]=================================*/
+#define DUMP_CHUNK		128		/*!< Bytes per UartWrite(), fits in the TX ring with any policy */
+#define NAME_MAX_LEN	255		/*!< Names longer than this are truncated */
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+#if TRACE_ENABLED
+/* Names of the driver ids, applications add theirs with TraceSetName() */
+static const char *trace_names[TRACE_ID_MAX] = {
+	[TRACE_ID_TIMER_ISR] = "timer_isr",
+	[TRACE_ID_TIMER_SERVICE] = "timer_service",
+	[TRACE_ID_SOFT_TIMER] = "soft_timer",
+	[TRACE_ID_FFT] = "fft",
+	[TRACE_ID_IIR_LOW] = "iir_low_pass",
+	[TRACE_ID_IIR_HIGH] = "iir_high_pass",
+	[TRACE_ID_LCD_WRITE] = "lcd_write",
+	[TRACE_ID_UART_SEND] = "uart_send",
+	[TRACE_ID_UART_USED] = "uart_tx_used",
+	[TRACE_ID_BLE_WRITE] = "ble_write",
+	[TRACE_ID_BLE_NOTIFY] = "ble_notify",
+	[TRACE_ID_BLE_USED] = "ble_tx_used",
+};
+#endif
+/*==================[external data definition]===============================*/
+#if TRACE_ENABLED
+trace_ring_t trace_rings[TRACE_CORES];
+volatile bool trace_running = true;
+#endif
+/*==================[internal functions definition]==========================*/
+#if TRACE_ENABLED
+/**
+ * @brief Send a block in pieces, waiting for room in the TX ring when needed
+ */
+static void TraceSend(uart_mcu_port_t port, const void *data, uint32_t nbytes){
+	const uint8_t *bytes = (const uint8_t *)data;
+	uint16_t n;
+
+	while(nbytes){
+		n = UartWrite(port, bytes, (nbytes > DUMP_CHUNK) ? DUMP_CHUNK : nbytes);
+		if(n == 0){
+			vTaskDelay(1);
+			continue;
+		}
+		bytes += n;
+		nbytes -= n;
+	}
+}
+
+static void TraceSendU32(uart_mcu_port_t port, uint32_t value){
+	uint8_t bytes[4] = {value, value >> 8, value >> 16, value >> 24};
+	TraceSend(port, bytes, sizeof(bytes));
+}
+#endif
+/*==================[external functions definition]==========================*/
+void TraceStart(void){
+#if TRACE_ENABLED
+	trace_running = true;
+#endif
+}
+
+void TraceStop(void){
+#if TRACE_ENABLED
+	trace_running = false;
+#endif
+}
+
+void TraceClear(void){
+#if TRACE_ENABLED
+	trace_running = false;
+	for(uint8_t core = 0; core < TRACE_CORES; core++){
+		__atomic_store_n(&trace_rings[core].head, 0, __ATOMIC_RELAXED);
+	}
+	trace_running = true;
+#endif
+}
+
+void TraceSetName(uint8_t id, const char *name){
+#if TRACE_ENABLED
+	if(id < TRACE_ID_MAX){
+		trace_names[id] = name;
+	}
+#endif
+}
+
+void TraceDump(uart_mcu_port_t port){
+#if TRACE_ENABLED
+	bool running = trace_running;
+	uint8_t header[8] = {0};
+	uint16_t names = 0;
+	uint32_t head, count, first, part, n;
+	uint8_t len;
+
+	trace_running = false;
+	for(uint8_t id = 0; id < TRACE_ID_MAX; id++){
+		names += (trace_names[id] != NULL);
+	}
+	TraceSend(port, "TRC1", 4);
+	TraceSendU32(port, TRACE_CYCLES_HZ);
+	header[0] = TRACE_CORES;
+	header[1] = sizeof(trace_record_t);
+	header[2] = names;
+	header[3] = names >> 8;
+	TraceSend(port, header, 4);
+	for(uint8_t id = 0; id < TRACE_ID_MAX; id++){
+		if(trace_names[id] != NULL){
+			n = strlen(trace_names[id]);
+			len = (n > NAME_MAX_LEN) ? NAME_MAX_LEN : n;
+			header[0] = id;
+			header[1] = len;
+			TraceSend(port, header, 2);
+			TraceSend(port, trace_names[id], len);
+		}
+	}
+	for(uint8_t core = 0; core < TRACE_CORES; core++){
+		head = __atomic_load_n(&trace_rings[core].head, __ATOMIC_RELAXED);
+		count = (head > TRACE_RING_RECORDS) ? TRACE_RING_RECORDS : head;
+		TraceSendU32(port, count);
+		TraceSendU32(port, head - count);
+		/* oldest record first: up to the end of the ring, then from the start */
+		first = (head - count) & (TRACE_RING_RECORDS - 1);
+		part = (count > TRACE_RING_RECORDS - first) ? (TRACE_RING_RECORDS - first) : count;
+		TraceSend(port, &trace_rings[core].records[first], part * sizeof(trace_record_t));
+		TraceSend(port, trace_rings[core].records, (count - part) * sizeof(trace_record_t));
+	}
+	TraceSend(port, "TEND", 4);
+	trace_running = running;
+#endif
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,190 @@
+/**
+ * @file uart_fmt.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Number and string formatting of the UART driver (hardware independent,
+ * shared by the target and host builds)
+ * @version 0.1
+ * @date 2026-10-19
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "uart_mcu.h"
+#include <stdarg.h>
+#include <math.h>
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define FLOAT_MAX_DECIMALS  6               /*!<  */
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+uint8_t UartFmtUint(char *buf, uint32_t val, uint8_t base){
+    char tmp[32];
+    uint8_t len = 0, i = 0;
+    do{
+        tmp[len++] = "0123456789abcdef"[val % base];
+        val /= base;
+    }while(val);
+    while(len){
+        buf[i++] = tmp[--len];
+    }
+    buf[i] = 0;
+    return i;
+}
+
+uint8_t UartFmtInt(char *buf, int32_t val){
+    if(val < 0){
+        buf[0] = '-';
+        return UartFmtUint(&buf[1], -(uint32_t)val, 10) + 1;
+    }
+    return UartFmtUint(buf, val, 10);
+}
+
+uint8_t UartFmtFloat(char *buf, float val, uint8_t decimals){
+    static const uint32_t pow10[FLOAT_MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    uint64_t scaled;
+    uint32_t frac;
+    uint8_t len = 0;
+
+    if(isnan(val)){
+        strcpy(buf, "nan");
+        return 3;
+    }
+    if(val < 0){
+        buf[len++] = '-';
+        val = -val;
+    }
+    if(isinf(val) || val >= 4294967295.0f){
+        strcpy(&buf[len], "inf");
+        return len + 3;
+    }
+    if(decimals > FLOAT_MAX_DECIMALS){
+        decimals = FLOAT_MAX_DECIMALS;
+    }
+    /* round once in fixed point, so 9.999 with 2 decimals gives 10.00 */
+    scaled = (uint64_t)((double)val * pow10[decimals] + 0.5);
+    len += UartFmtUint(&buf[len], scaled / pow10[decimals], 10);
+    if(decimals){
+        buf[len++] = '.';
+        frac = scaled % pow10[decimals];
+        for(int8_t i = decimals - 1; i >= 0; i--){
+            buf[len + i] = '0' + frac % 10;
+            frac /= 10;
+        }
+        len += decimals;
+        buf[len] = 0;
+    }
+    return len;
+}
+
+uint16_t UartVsprintf(char *buf, uint16_t size, const char *fmt, va_list args){
+    char num[36];
+    const char *str;
+    uint16_t len = 0, n;
+    uint8_t decimals;
+    bool is_long;
+
+    if(size == 0){
+        return 0;
+    }
+    while(*fmt && len < size - 1){
+        if(*fmt != '%'){
+            buf[len++] = *fmt++;
+            continue;
+        }
+        fmt++;
+        decimals = 2;
+        if(*fmt == '.'){
+            fmt++;
+            decimals = 0;
+            while(*fmt >= '0' && *fmt <= '9'){
+                decimals = decimals * 10 + (*fmt++ - '0');
+            }
+        }
+        /* long is 64 bits on the host build: read it with its own width */
+        is_long = (*fmt == 'l');
+        if(is_long){
+            fmt++;
+        }
+        str = num;
+        switch(*fmt){
+            case 'd':
+            case 'i':
+                n = UartFmtInt(num, is_long ? (int32_t)va_arg(args, long) : va_arg(args, int32_t));
+            break;
+            case 'u':
+                n = UartFmtUint(num, is_long ? (uint32_t)va_arg(args, unsigned long) : va_arg(args, uint32_t), 10);
+            break;
+            case 'x':
+                n = UartFmtUint(num, is_long ? (uint32_t)va_arg(args, unsigned long) : va_arg(args, uint32_t), 16);
+            break;
+            case 'b':
+                n = UartFmtUint(num, is_long ? (uint32_t)va_arg(args, unsigned long) : va_arg(args, uint32_t), 2);
+            break;
+            case 'f':
+                n = UartFmtFloat(num, (float)va_arg(args, double), decimals);
+            break;
+            case 'c':
+                num[0] = (char)va_arg(args, int);
+                n = 1;
+            break;
+            case 's':
+                str = va_arg(args, const char *);
+                if(str == NULL){
+                    str = "(null)";
+                }
+                n = strlen(str);
+            break;
+            case '%':
+                num[0] = '%';
+                n = 1;
+            break;
+            default:
+                /* unsupported conversion: stop formatting */
+                buf[len] = 0;
+                return len;
+        }
+        fmt++;
+        if(n > size - 1 - len){
+            n = size - 1 - len;
+        }
+        memcpy(&buf[len], str, n);
+        len += n;
+    }
+    buf[len] = 0;
+    return len;
+}
+
+uint16_t UartSprintf(char *buf, uint16_t size, const char *fmt, ...){
+    va_list args;
+    uint16_t len;
+    va_start(args, fmt);
+    len = UartVsprintf(buf, size, fmt, args);
+    va_end(args);
+    return len;
+}
+
+uint8_t* UartItoa(uint32_t val, uint8_t base){
+	static uint8_t buf[32] = {0};
+	uint32_t i = 30;
+    if(val == 0){
+        return (uint8_t*)"0";
+    }else{
+        for(; val && i ; --i, val /= base){
+            buf[i] = "0123456789abcdef"[val % base];
+        }
+        return &buf[i+1];
+    }
+}
+
+/*==================[end of file]============================================*/
@@ -12,10 +12,15 @@
 /*==================[inclusions]=============================================*/
 #include "uart_mcu.h"
 #include "gpio_mcu.h"
+#include "trace_mcu.h"
 #include "driver/uart.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
+#include <stdarg.h>
+#include <string.h>
 /*==================[macros and definitions]=================================*/
 #define UART_CONN_TX        GPIO_18         /*!<  */
 #define UART_CONN_RX        GPIO_19         /*!<  */
@@ -23,6 +28,12 @@
 #define RX_BUFFER_SIZE      256             /*!<  */
 #define EVENT_QUEUE_SIZE    16              /*!<  */
 #define READ_TIMEOUT        100             /*!<  */
+#define UART_PORTS          2               /*!< UART_PC and UART_CONNECTOR */
+#define TX_RING_SIZE        2048            /*!< Software TX ring, must be a power of 2 */
+#define TX_RING_MASK        (TX_RING_SIZE - 1)
+#define TX_TASK_STACK       2048            /*!<  */
+#define TX_TASK_PRIO        11              /*!< Just below the event tasks */
+#define PRINTF_BUFFER_SIZE  128             /*!< Max length of a UartPrintf() line */
 /*==================[internal data declaration]==============================*/
 void (*uart_pc_isr_p)(void*);	            /*!<  */
 void (*uart_conn_isr_p)(void*);	            /*!<  */
@@ -30,6 +41,24 @@ void *uart_pc_user_data;	                /*!<  */
 void *uart_conn_user_data;	                /*!<  */
 static QueueHandle_t uart_pc_queue;         /*!<  */
 static QueueHandle_t uart_conn_queue;       /*!<  */
+/**
+ * @brief Software TX path of each port.
+ * 
+ * Lock-free single producer / single consumer ring: writers are serialized
+ * by write_mutex and only move head, the drain task only moves tail.
+ */
+typedef struct {
+    uint8_t buffer[TX_RING_SIZE];           /*!< Ring storage */
+    volatile uint32_t head;                 /*!< Free running write index (producer) */
+    volatile uint32_t tail;                 /*!< Free running read index (drain task) */
+    uart_port_t uart_num;                   /*!< ESP-IDF UART number */
+    uart_tx_policy_t policy;                /*!< Behaviour when the ring is full */
+    uart_tx_stats_t stats;                  /*!< Counters */
+    TaskHandle_t task;                      /*!< Drain task */
+    SemaphoreHandle_t write_mutex;          /*!< Serializes writers */
+    SemaphoreHandle_t space;                /*!< Given by the drain task when space is released */
+} uart_tx_t;
+static uart_tx_t uart_tx[UART_PORTS];       /*!<  */
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -37,6 +66,122 @@ static QueueHandle_t uart_conn_queue;       /*!<  */
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static inline uint32_t UartTxLoad(volatile uint32_t *index){
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void UartTxStore(volatile uint32_t *index, uint32_t value){
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Moves data from the software ring to the driver TX buffer, in as few
+ * uart_write_bytes() calls as possible (at most 2 per wake up, due to wrap around).
+ */
+static void uart_tx_task(void *pvParameters){
+    uart_tx_t *tx = (uart_tx_t *)pvParameters;
+    uint32_t head, tail, idx, chunk;
+    int sent;
+    /* when a reception callback is used the driver is installed by the event task */
+    while(!uart_is_driver_installed(tx->uart_num)){
+        vTaskDelay(1);
+    }
+    while(1){
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        tail = tx->tail;
+        while((head = UartTxLoad(&tx->head)) != tail){
+            idx = tail & TX_RING_MASK;
+            chunk = head - tail;
+            if(chunk > TX_RING_SIZE - idx){
+                chunk = TX_RING_SIZE - idx;
+            }
+            sent = uart_write_bytes(tx->uart_num, &tx->buffer[idx], chunk);
+            if(sent > 0){
+                tail += sent;
+                UartTxStore(&tx->tail, tail);
+                tx->stats.bytes_sent += sent;
+            }
+            xSemaphoreGive(tx->space);
+        }
+    }
+}
+
+/**
+ * @brief Copy data into the TX ring of a port, following the port policy.
+ * 
+ * @return uint16_t Number of bytes queued
+ */
+static uint16_t UartTxPush(uart_mcu_port_t port, const uint8_t *data, uint16_t nbytes){
+    uart_tx_t *tx = &uart_tx[port];
+    uint32_t head, free, idx, n, first;
+    uint16_t done = 0;
+
+    if(tx->task == NULL || nbytes == 0){
+        return 0;
+    }
+    TRACE_BEGIN(TRACE_ID_UART_SEND);
+    xSemaphoreTake(tx->write_mutex, portMAX_DELAY);
+    head = tx->head;
+    free = TX_RING_SIZE - (head - UartTxLoad(&tx->tail));
+    if(tx->policy == UART_TX_DROP && free < nbytes){
+        /* all or nothing: never send a truncated message */
+        tx->stats.bytes_dropped += nbytes;
+        tx->stats.msgs_dropped++;
+        xSemaphoreGive(tx->write_mutex);
+        TRACE_END(TRACE_ID_UART_SEND);
+        return 0;
+    }
+    while(done < nbytes){
+        free = TX_RING_SIZE - (head - UartTxLoad(&tx->tail));
+        if(free == 0){
+            if(tx->policy != UART_TX_BLOCK){
+                break;
+            }
+            xTaskNotifyGive(tx->task);
+            xSemaphoreTake(tx->space, 1);
+            continue;
+        }
+        n = nbytes - done;
+        if(n > free){
+            n = free;
+        }
+        idx = head & TX_RING_MASK;
+        first = (n > TX_RING_SIZE - idx) ? (TX_RING_SIZE - idx) : n;
+        memcpy(&tx->buffer[idx], &data[done], first);
+        memcpy(tx->buffer, &data[done + first], n - first);
+        head += n;
+        UartTxStore(&tx->head, head);
+        done += n;
+        if(done < nbytes){
+            /* message longer than the free space: start draining now */
+            xTaskNotifyGive(tx->task);
+        }
+    }
+    tx->stats.bytes_queued += done;
+    if(done < nbytes){
+        tx->stats.bytes_dropped += nbytes - done;
+        tx->stats.msgs_dropped++;
+    }
+    if(head - UartTxLoad(&tx->tail) > tx->stats.max_used){
+        tx->stats.max_used = head - UartTxLoad(&tx->tail);
+    }
+    TRACE_COUNTER(TRACE_ID_UART_USED, head - UartTxLoad(&tx->tail));
+    xSemaphoreGive(tx->write_mutex);
+    xTaskNotifyGive(tx->task);
+    TRACE_END(TRACE_ID_UART_SEND);
+    return done;
+}
+
+static void UartTxInit(uart_mcu_port_t port, uart_port_t uart_num, uart_tx_policy_t policy){
+    uart_tx_t *tx = &uart_tx[port];
+    tx->uart_num = uart_num;
+    tx->policy = policy;
+    if(tx->task == NULL){
+        tx->write_mutex = xSemaphoreCreateMutex();
+        tx->space = xSemaphoreCreateBinary();
+        xTaskCreate(uart_tx_task, (port == UART_PC) ? "uart_pc_tx_task" : "uart_conn_tx_task", TX_TASK_STACK, tx, TX_TASK_PRIO, &tx->task);
+    }
+}
 static void uart_pc_event_task(void *pvParameters){
     uart_event_t event;
     uart_driver_install(UART_NUM_0, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 16, &uart_pc_queue, 0);
@@ -124,6 +269,7 @@ void UartInit(serial_config_t *port_config){
             }else{
                 uart_driver_install(UART_NUM_0, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 0, NULL, 0);
             }
+            UartTxInit(UART_PC, UART_NUM_0, port_config->tx_policy);
             break;
         case UART_CONNECTOR:
             uart_param_config(UART_NUM_1, &uart_config);
@@ -135,6 +281,7 @@ void UartInit(serial_config_t *port_config){
             }else{
                 uart_driver_install(UART_NUM_1, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 0, NULL, 0);
             }
+            UartTxInit(UART_CONNECTOR, UART_NUM_1, port_config->tx_policy);
             break;
     }
 }
@@ -178,58 +325,57 @@ uint8_t UartReadBuffer(uart_mcu_port_t port, uint8_t* data, uint16_t nbytes){
 }
 
 void UartSendByte(uart_mcu_port_t port, const char *data){
-    uart_port_t uart_num = UART_NUM_0;
-    switch(port){
-        case UART_PC:
-                uart_num = UART_NUM_0;
-            break;
-        case UART_CONNECTOR:
-                uart_num = UART_NUM_1;
-            break;
-    }
-    uart_tx_chars(uart_num, data, 1);
+    UartTxPush(port, (const uint8_t *)data, 1);
 }
 
 void UartSendString(uart_mcu_port_t port, const char *msg){
-    uart_port_t uart_num = UART_NUM_0;
-    switch(port){
-        case UART_PC:
-                uart_num = UART_NUM_0;
-            break;
-        case UART_CONNECTOR:
-                uart_num = UART_NUM_1;
-            break;
-    }
-	while(*msg != 0){
-        uart_tx_chars(uart_num, msg, 1);
-		msg++;
-	}
+    UartTxPush(port, (const uint8_t *)msg, strlen(msg));
 }
 
 void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes){
-    uart_port_t uart_num = UART_NUM_0;
-    switch(port){
-        case UART_PC:
-                uart_num = UART_NUM_0;
-            break;
-        case UART_CONNECTOR:
-                uart_num = UART_NUM_1;
-            break;
-    }
-    uart_tx_chars(uart_num, data, nbytes);
+    UartTxPush(port, (const uint8_t *)data, nbytes);
+}
+
+uint16_t UartWrite(uart_mcu_port_t port, const void *data, uint16_t nbytes){
+    return UartTxPush(port, (const uint8_t *)data, nbytes);
 }
 
-uint8_t* UartItoa(uint32_t val, uint8_t base){
-	static uint8_t buf[32] = {0};
-	uint32_t i = 30;
-    if(val == 0){
-        return (uint8_t*)"0";
-    }else{
-        for(; val && i ; --i, val /= base){
-            buf[i] = "0123456789abcdef"[val % base];
+void UartSetTxPolicy(uart_mcu_port_t port, uart_tx_policy_t policy){
+    uart_tx[port].policy = policy;
+}
+
+void UartTxStats(uart_mcu_port_t port, uart_tx_stats_t *stats){
+    *stats = uart_tx[port].stats;
+}
+
+void UartTxStatsReset(uart_mcu_port_t port){
+    uart_tx_t *tx = &uart_tx[port];
+    xSemaphoreTake(tx->write_mutex, portMAX_DELAY);
+    memset(&tx->stats, 0, sizeof(uart_tx_stats_t));
+    xSemaphoreGive(tx->write_mutex);
+}
+
+bool UartTxFlush(uart_mcu_port_t port, uint32_t timeout_ms){
+    uart_tx_t *tx = &uart_tx[port];
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    while(UartTxLoad(&tx->tail) != UartTxLoad(&tx->head)){
+        if((xTaskGetTickCount() - start) >= timeout){
+            return false;
         }
-        return &buf[i+1];
+        xSemaphoreTake(tx->space, 1);
     }
+    return (uart_wait_tx_done(tx->uart_num, timeout - (xTaskGetTickCount() - start)) == ESP_OK);
+}
+
+uint16_t UartPrintf(uart_mcu_port_t port, const char *fmt, ...){
+    char line[PRINTF_BUFFER_SIZE];
+    va_list args;
+    uint16_t len;
+    va_start(args, fmt);
+    len = UartVsprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    return UartTxPush(port, (const uint8_t *)line, len);
 }
 
 /*==================[end of file]============================================*/
\ No newline at end of file
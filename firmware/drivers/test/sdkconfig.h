@@ -0,0 +1,16 @@
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+/** \brief Configuration seen by the drivers headers in the host unit tests.
+ *
+ * The tests run on the host, so headers take their virtual board (linux target)
+ * branch and do not include SoC registers.
+ *
+ * @author Albano Peñalva
+ **/
+
+/*==================[macros]=================================================*/
+#define CONFIG_IDF_TARGET_LINUX		1
+
+#endif /* SDKCONFIG_H */
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,116 @@
+/**
+ * @file test_analog_lut.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of the ADC raw to mV table (analog_lut.h) against a reference curve
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test_common.h"
+#include "analog_lut.h"
+#include <math.h>
+/*==================[macros and definitions]=================================*/
+#define RAW_MAX		(ANALOG_LUT_SIZE - 1)
+/*==================[internal data declaration]==============================*/
+/**
+ * @brief Calibration handle of the tests
+ */
+typedef struct {
+	int valid_max;			/*!< Raw values above this one fail */
+	uint32_t calls;			/*!< Conversions requested */
+} cal_t;
+/*==================[internal data definition]===============================*/
+static analog_lut_t lut;
+/*==================[internal functions definition]==========================*/
+/* Curve of a 12 bit ADC with 12 dB attenuation: gain, offset and a non linear term */
+static double RefCurve(int raw){
+	return -8.0 + raw * (3230.0 / RAW_MAX) + 25.0 * sin(raw * (M_PI / RAW_MAX));
+}
+
+static int RefMv(int raw){
+	long mv = lround(RefCurve(raw));
+	return (mv < 0) ? 0 : mv;
+}
+
+static int LinearMv(int raw){
+	return (raw * ANALOG_LUT_FULL_SCALE_MV) / RAW_MAX;
+}
+
+static bool CalRaw2mV(void *cal, int raw, int *mv){
+	cal_t *handle = (cal_t *)cal;
+
+	handle->calls++;
+	if(raw > handle->valid_max){
+		return false;
+	}
+	*mv = lround(RefCurve(raw));
+	return true;
+}
+
+static void TestLinearFallback(void){
+	lut.ready = false;
+	AnalogLutBuild(&lut, CalRaw2mV, NULL);
+	TEST_CHECK(lut.ready);
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, 0), 0);
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, RAW_MAX), ANALOG_LUT_FULL_SCALE_MV);
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, 2048), 1650);
+}
+
+static void TestReferenceCurve(void){
+	cal_t cal = {.valid_max = RAW_MAX};
+	int failures = test_failures;
+
+	lut.ready = false;
+	AnalogLutBuild(&lut, CalRaw2mV, &cal);
+	TEST_CHECK_EQ(cal.calls, ANALOG_LUT_SIZE);
+	for(int raw = 0; raw <= RAW_MAX; raw++){
+		TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, raw), RefMv(raw));
+		if(test_failures != failures){
+			printf("  raw %d\n", raw);
+			return;
+		}
+	}
+	/* negative voltages are clamped, higher bits ignored */
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, 0), 0);
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, ANALOG_LUT_SIZE + 100), RefMv(100));
+}
+
+static void TestCalibrationLater(void){
+	cal_t cal = {.valid_max = RAW_MAX};
+
+	/* a conversion before the ADC init builds the linear table... */
+	lut.ready = false;
+	AnalogLutBuild(&lut, CalRaw2mV, NULL);
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, 1000), LinearMv(1000));
+	/* ...replaced once calibration is available */
+	AnalogLutBuild(&lut, CalRaw2mV, &cal);
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, 1000), RefMv(1000));
+	TEST_CHECK_EQ(cal.calls, ANALOG_LUT_SIZE);
+	/* and built only once with it */
+	AnalogLutBuild(&lut, CalRaw2mV, &cal);
+	TEST_CHECK_EQ(cal.calls, ANALOG_LUT_SIZE);
+}
+
+static void TestPartialCalibration(void){
+	cal_t cal = {.valid_max = 4000};
+
+	lut.ready = false;
+	AnalogLutBuild(&lut, CalRaw2mV, &cal);
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, 4000), RefMv(4000));
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, 4001), LinearMv(4001));
+	TEST_CHECK_EQ(AnalogLutRaw2mV(&lut, RAW_MAX), ANALOG_LUT_FULL_SCALE_MV);
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	TEST_RUN(TestLinearFallback);
+	TEST_RUN(TestReferenceCurve);
+	TEST_RUN(TestCalibrationLater);
+	TEST_RUN(TestPartialCalibration);
+	TEST_END();
+}
+
+/*==================[end of file]============================================*/
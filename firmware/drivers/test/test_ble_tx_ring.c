@@ -0,0 +1,237 @@
+/**
+ * @file test_ble_tx_ring.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of the BLE TX ring (ble_tx_ring.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test_common.h"
+#include "ble_tx_ring.h"
+#include <stdlib.h>
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define RING_SIZE	64
+#define MTU_DATA	20
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal data definition]===============================*/
+static uint8_t data[RING_SIZE];
+static ble_tx_ring_t ring;
+/*==================[internal functions definition]==========================*/
+/* Byte written at a stream position: differs between laps of the ring */
+static uint8_t Pattern(uint32_t position){
+	return (uint8_t)(position ^ (position >> 6) ^ (position >> 12));
+}
+
+static void RingInit(void){
+	memset(data, 0, sizeof(data));
+	BleTxRingInit(&ring, data, RING_SIZE);
+}
+
+/* Reserve, fill with the pattern and commit; returns the bytes written */
+static uint32_t Write(uint32_t length, ble_tx_policy_t policy, uint32_t *dropped){
+	uint8_t *buffer;
+	uint32_t n = BleTxRingReserve(&ring, length, policy, &buffer, dropped);
+
+	TEST_CHECK(n <= length);
+	for(uint32_t i = 0; i < n; i++){
+		buffer[i] = Pattern(ring.head + i);
+	}
+	BleTxRingCommit(&ring, n);
+	return n;
+}
+
+/* Claim and check the content; returns the bytes claimed */
+static uint32_t Claim(uint32_t max, uint8_t **buffer){
+	uint32_t start = ring.tail;
+	uint32_t n = BleTxRingClaim(&ring, max, buffer);
+
+	for(uint32_t i = 0; i < n; i++){
+		TEST_CHECK_EQ((*buffer)[i], Pattern(start + i));
+	}
+	return n;
+}
+
+static void TestBlock(void){
+	uint8_t *buffer;
+	uint32_t dropped;
+
+	RingInit();
+	TEST_CHECK_EQ(Write(RING_SIZE, BLE_TX_BLOCK, &dropped), RING_SIZE);
+	/* full: nothing reserved, nothing dropped */
+	TEST_CHECK_EQ(BleTxRingReserve(&ring, 1, BLE_TX_BLOCK, &buffer, &dropped), 0);
+	TEST_CHECK_EQ(dropped, 0);
+	TEST_CHECK_EQ(Claim(MTU_DATA, &buffer), MTU_DATA);
+	/* claimed bytes are still in use until released */
+	TEST_CHECK_EQ(BleTxRingReserve(&ring, 1, BLE_TX_BLOCK, &buffer, &dropped), 0);
+	TEST_CHECK_EQ(BleTxRingUsed(&ring), RING_SIZE);
+	BleTxRingRelease(&ring);
+	TEST_CHECK_EQ(BleTxRingUsed(&ring), RING_SIZE - MTU_DATA);
+	TEST_CHECK_EQ(Write(MTU_DATA + 1, BLE_TX_BLOCK, &dropped), 0);
+	TEST_CHECK_EQ(Write(MTU_DATA, BLE_TX_BLOCK, &dropped), MTU_DATA);
+	TEST_CHECK_EQ(ring.head, RING_SIZE + MTU_DATA);
+}
+
+static void TestDropNewest(void){
+	uint8_t *buffer;
+	uint32_t dropped;
+
+	RingInit();
+	TEST_CHECK_EQ(Write(RING_SIZE - 10, BLE_TX_DROP_NEWEST, &dropped), RING_SIZE - 10);
+	/* the new message does not fit: unsent bytes are kept */
+	TEST_CHECK_EQ(BleTxRingReserve(&ring, 11, BLE_TX_DROP_NEWEST, &buffer, &dropped), 0);
+	TEST_CHECK_EQ(dropped, 0);
+	TEST_CHECK_EQ(ring.tail, 0);
+	TEST_CHECK_EQ(Write(10, BLE_TX_DROP_NEWEST, &dropped), 10);
+	TEST_CHECK_EQ(Claim(RING_SIZE, &buffer), RING_SIZE);
+}
+
+static void TestDropOldest(void){
+	uint8_t *buffer;
+	uint32_t dropped;
+
+	RingInit();
+	TEST_CHECK_EQ(Write(RING_SIZE, BLE_TX_DROP_OLDEST, &dropped), RING_SIZE);
+	TEST_CHECK_EQ(Write(8, BLE_TX_DROP_OLDEST, &dropped), 8);
+	TEST_CHECK_EQ(dropped, 8);
+	TEST_CHECK_EQ(ring.tail, 8);
+	/* claim in flight: [8, 28) */
+	TEST_CHECK_EQ(Claim(MTU_DATA, &buffer), MTU_DATA);
+	TEST_CHECK_EQ(ring.free, 8);
+	/* only unsent bytes can be dropped: 44 of them, 45 are needed */
+	TEST_CHECK_EQ(BleTxRingReserve(&ring, RING_SIZE - MTU_DATA + 1, BLE_TX_DROP_OLDEST, &buffer, &dropped), 0);
+	TEST_CHECK_EQ(dropped, RING_SIZE - MTU_DATA);
+	TEST_CHECK_EQ(ring.tail, ring.head);
+	TEST_CHECK_EQ(ring.free, 8);
+	/* the claim in flight was not overwritten */
+	for(uint32_t i = 0; i < MTU_DATA; i++){
+		TEST_CHECK_EQ(data[8 + i], Pattern(8 + i));
+	}
+	BleTxRingRelease(&ring);
+	TEST_CHECK_EQ(BleTxRingUsed(&ring), 0);
+	TEST_CHECK_EQ(Write(RING_SIZE, BLE_TX_DROP_OLDEST, &dropped), RING_SIZE - 8);
+	TEST_CHECK_EQ(dropped, 0);
+}
+
+static void TestWrapAround(void){
+	uint8_t *buffer;
+	uint32_t dropped;
+
+	RingInit();
+	Write(RING_SIZE - 4, BLE_TX_BLOCK, &dropped);
+	/* the region stops at the end of the storage */
+	TEST_CHECK_EQ(BleTxRingReserve(&ring, 10, BLE_TX_BLOCK, &buffer, &dropped), 0);
+	TEST_CHECK_EQ(Claim(RING_SIZE, &buffer), RING_SIZE - 4);
+	BleTxRingRelease(&ring);
+	TEST_CHECK_EQ(BleTxRingReserve(&ring, 10, BLE_TX_BLOCK, &buffer, &dropped), 4);
+	TEST_CHECK(buffer == &data[RING_SIZE - 4]);
+	TEST_CHECK_EQ(Write(10, BLE_TX_BLOCK, &dropped), 4);
+	TEST_CHECK_EQ(BleTxRingReserve(&ring, 6, BLE_TX_BLOCK, &buffer, &dropped), 6);
+	TEST_CHECK(buffer == &data[0]);
+	/* claims stop at the end of the storage too */
+	Write(6, BLE_TX_BLOCK, &dropped);
+	TEST_CHECK_EQ(Claim(RING_SIZE, &buffer), 4);
+	BleTxRingRelease(&ring);
+	TEST_CHECK_EQ(Claim(RING_SIZE, &buffer), 6);
+	TEST_CHECK(buffer == &data[0]);
+}
+
+static void TestDropOldestWrapAround(void){
+	uint8_t *buffer;
+	uint32_t dropped;
+
+	RingInit();
+	Write(RING_SIZE - 4, BLE_TX_DROP_OLDEST, &dropped);
+	Write(4, BLE_TX_DROP_OLDEST, &dropped);
+	Claim(RING_SIZE - 4, &buffer);
+	BleTxRingRelease(&ring);
+	Write(RING_SIZE - 4, BLE_TX_DROP_OLDEST, &dropped);
+	/* full, head 4 bytes before the end: room for all 10 bytes is made at once */
+	TEST_CHECK_EQ(ring.head & (RING_SIZE - 1), RING_SIZE - 4);
+	TEST_CHECK_EQ(Write(10, BLE_TX_DROP_OLDEST, &dropped), 4);
+	TEST_CHECK_EQ(dropped, 10);
+	TEST_CHECK_EQ(Write(6, BLE_TX_DROP_OLDEST, &dropped), 6);
+	TEST_CHECK_EQ(dropped, 0);
+	TEST_CHECK_EQ(BleTxRingUsed(&ring), RING_SIZE);
+}
+
+static void TestDiscard(void){
+	uint8_t *buffer;
+	uint32_t dropped;
+
+	RingInit();
+	Write(40, BLE_TX_BLOCK, &dropped);
+	Claim(MTU_DATA, &buffer);
+	TEST_CHECK_EQ(BleTxRingDiscard(&ring), 40 - MTU_DATA);
+	TEST_CHECK_EQ(ring.tail, ring.head);
+	/* space comes back with the claim in flight */
+	TEST_CHECK_EQ(BleTxRingUsed(&ring), 40);
+	BleTxRingRelease(&ring);
+	TEST_CHECK_EQ(BleTxRingUsed(&ring), 0);
+}
+
+/* Random producer / sender steps, every byte committed is sent or dropped once */
+static void TestFuzz(void){
+	static const ble_tx_policy_t policies[] = {BLE_TX_BLOCK, BLE_TX_DROP_OLDEST, BLE_TX_DROP_NEWEST};
+	int failures = test_failures;
+	uint8_t *buffer;
+	uint32_t dropped, n, committed = 0, sent = 0, total_dropped = 0;
+	uint32_t claim_start = 0, claim_length = 0;
+
+	RingInit();
+	srand(42);
+	for(uint32_t step = 0; step < 200000; step++){
+		switch(rand() % 3){
+			case 0:
+				n = Write(1 + rand() % RING_SIZE, policies[rand() % 3], &dropped);
+				committed += n;
+				total_dropped += dropped;
+			break;
+			case 1:
+				if(!ring.in_flight){
+					claim_start = ring.tail;
+					claim_length = Claim(1 + rand() % MTU_DATA, &buffer);
+				}
+			break;
+			default:
+				if(ring.in_flight){
+					/* sent straight from the ring: nothing overwrote it */
+					for(uint32_t i = 0; i < claim_length; i++){
+						TEST_CHECK_EQ(data[(claim_start + i) & (RING_SIZE - 1)], Pattern(claim_start + i));
+					}
+					sent += claim_length;
+					BleTxRingRelease(&ring);
+				}
+				if(rand() % 50 == 0){
+					total_dropped += BleTxRingDiscard(&ring);
+				}
+			break;
+		}
+		TEST_CHECK(BleTxRingUsed(&ring) <= RING_SIZE);
+		TEST_CHECK_EQ(committed, sent + ring.in_flight + total_dropped + (ring.head - ring.tail));
+		if(test_failures != failures){
+			printf("  step %u\n", step);
+			return;
+		}
+	}
+	TEST_CHECK(total_dropped > 0);
+	TEST_CHECK(ring.head > 10 * RING_SIZE);
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	TEST_RUN(TestBlock);
+	TEST_RUN(TestDropNewest);
+	TEST_RUN(TestDropOldest);
+	TEST_RUN(TestWrapAround);
+	TEST_RUN(TestDropOldestWrapAround);
+	TEST_RUN(TestDiscard);
+	TEST_RUN(TestFuzz);
+	TEST_END();
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,190 @@
+/**
+ * @file test_buzzer_rtttl.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of BuzzerRtttlCompile() (buzzer.h) over the melodies of buzzer_melodies.h
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test_common.h"
+#include "buzzer.h"
+#include "buzzer_melodies.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define NOTES_MAX	512
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal data definition]===============================*/
+static const char *corpus[] = {
+	"Nokia:d=4,o=5,b=225:8e6,8d6,f#,g#,8c#6,8b,d,e,8b,8a,c#,e,2a",
+	"Indiana:d=4,o=5,b=250:e,8p,8f,8g,8p,1c6,8p.,d,8p,8e,1f,p.,g,8p,8a,8b,8p,1f6",
+	NULL,		/* followed by buzzer_melodies.h */
+};
+static buzzer_note_t out[NOTES_MAX];
+static buzzer_note_t ref[NOTES_MAX];
+/*==================[internal functions definition]==========================*/
+/* Equal temperament, A4 = 440 Hz; semitone 1 is C */
+static double RefFreq(int octave, int semitone){
+	return 440.0 * pow(2.0, (octave - 4) + (semitone - 10) / 12.0);
+}
+
+/**
+ * @brief Reference compiler, written from the RTTTL specification (plus the
+ * documented driver limits: octaves 4..7, b# to the next octave, dot after the
+ * octave, durations saturated to UINT16_MAX). Returns the number of notes.
+ */
+static int RefCompile(const char *melody, buzzer_note_t *notes){
+	static const int semitones['h' - 'a' + 1] = {
+		['c' - 'a'] = 1, ['d' - 'a'] = 3, ['e' - 'a'] = 5, ['f' - 'a'] = 6,
+		['g' - 'a'] = 8, ['a' - 'a'] = 10, ['b' - 'a'] = 12, ['h' - 'a'] = 12,
+	};
+	int def_dur = 4, def_oct = 6, bpm = 63, qty = 0;
+	const char *p = strchr(melody, ':') + 1;
+	char *end;
+
+	while(*p != ':'){
+		char key = *p;
+		long value = strtol(p + 2, &end, 10);
+		if(key == 'd') def_dur = value;
+		if(key == 'o' && value >= 4 && value <= 7) def_oct = value;
+		if(key == 'b') bpm = value;
+		p = (*end == ',') ? end + 1 : end;
+	}
+	p++;
+	while(*p){
+		double whole = (60000 / bpm) * 4;
+		long dur = strtol(p, &end, 10);
+		long ms;
+		int semitone, octave = def_oct, dots = 0;
+
+		p = end;
+		ms = (long)whole / (dur ? dur : def_dur);
+		semitone = (*p == 'p') ? 0 : semitones[*p - 'a'];
+		p++;
+		if(*p == '#'){
+			semitone++;
+			p++;
+		}
+		while(*p == '.' || (*p >= '0' && *p <= '9')){
+			if(*p == '.'){
+				dots++;
+			}else{
+				octave = *p - '0';
+			}
+			p++;
+		}
+		while(dots--){
+			ms += ms / 2;
+		}
+		octave = (octave < 4) ? 4 : ((octave > 7) ? 7 : octave);
+		if(semitone > 12){
+			semitone -= 12;
+			octave = (octave < 7) ? octave + 1 : octave;
+		}
+		notes[qty].freq = semitone ? lround(RefFreq(octave, semitone)) : 0;
+		notes[qty].duration = (ms > UINT16_MAX) ? UINT16_MAX : ms;
+		qty++;
+		if(*p == ','){
+			p++;
+		}
+	}
+	return qty;
+}
+
+static void CheckMelody(const char *melody){
+	int failures = test_failures;
+	int16_t qty = BuzzerRtttlCompile(melody, out, NOTES_MAX);
+	int ref_qty = RefCompile(melody, ref);
+
+	TEST_CHECK_EQ(qty, ref_qty);
+	for(int i = 0; (i < qty) && (i < ref_qty); i++){
+		/* the driver table is rounded to whole Hz, as the reference */
+		TEST_CHECK(abs((int)out[i].freq - (int)ref[i].freq) <= 1);
+		TEST_CHECK_EQ(out[i].duration, ref[i].duration);
+		if(test_failures != failures){
+			printf("  %.*s... note %d\n", 20, melody, i);
+			return;
+		}
+	}
+}
+
+static void TestCorpus(void){
+	const char *melodies[] = {
+		songSimpsons, songIndiana, songTakeOnMe, songEntertainer, songMuppets, songXfiles,
+		songLooney, song20thCenFox, songBond, songMASH, songStarWars, songGoodBad, songTopGun,
+		songTeam, songFlinstones, songJeopardy, songGadget, songSmurfs, songMahnaMahna,
+		songLeisureSuit, songMissionImp,
+	};
+	for(int i = 0; corpus[i] != NULL; i++){
+		CheckMelody(corpus[i]);
+	}
+	for(unsigned i = 0; i < sizeof(melodies) / sizeof(melodies[0]); i++){
+		CheckMelody(melodies[i]);
+	}
+}
+
+static void TestKnownNotes(void){
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=4,o=5,b=120:a,8c#6,2p,16b#7,a3", out, NOTES_MAX), 5);
+	TEST_CHECK_EQ(out[0].freq, NOTE_A5);
+	TEST_CHECK_EQ(out[0].duration, 500);
+	TEST_CHECK_EQ(out[1].freq, NOTE_CS6);
+	TEST_CHECK_EQ(out[1].duration, 250);
+	TEST_CHECK_EQ(out[2].freq, 0);
+	TEST_CHECK_EQ(out[2].duration, 1000);
+	/* b# of the last octave stays there, octaves below 4 are raised */
+	TEST_CHECK_EQ(out[3].freq, NOTE_C7);
+	TEST_CHECK_EQ(out[4].freq, NOTE_A4);
+	/* dotted, before or after the octave */
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=4,o=5,b=120:a.,a5.", out, NOTES_MAX), 2);
+	TEST_CHECK_EQ(out[0].duration, 750);
+	TEST_CHECK_EQ(out[1].duration, 750);
+	/* defaults in any order, spaces and upper case */
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x: B = 60 , O = 4 , D = 8 : C , 2E", out, NOTES_MAX), 2);
+	TEST_CHECK_EQ(out[0].freq, NOTE_C4);
+	TEST_CHECK_EQ(out[0].duration, 500);
+	TEST_CHECK_EQ(out[1].freq, NOTE_E4);
+	/* saturated duration */
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=1,o=5,b=1:1a.", out, NOTES_MAX), 1);
+	TEST_CHECK_EQ(out[0].duration, UINT16_MAX);
+}
+
+static void TestDefaultDuration(void){
+	/* used to wrap the 8 bit default to 0 and divide by zero */
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=256,o=5,b=120:a", out, NOTES_MAX), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=0,o=5,b=120:a", out, NOTES_MAX), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=33,o=5,b=120:a", out, NOTES_MAX), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=32,o=5,b=120:a", out, NOTES_MAX), 1);
+	TEST_CHECK_EQ(out[0].duration, 62);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=1,o=5,b=120:a", out, NOTES_MAX), 1);
+	TEST_CHECK_EQ(out[0].duration, 2000);
+}
+
+static void TestMalformed(void){
+	TEST_CHECK_EQ(BuzzerRtttlCompile("", out, NOTES_MAX), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("no colon", out, NOTES_MAX), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=4,o=5,b=120", out, NOTES_MAX), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d4:a", out, NOTES_MAX), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:z=4:a", out, NOTES_MAX), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=4:a,x", out, NOTES_MAX), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x:d=4:a,", out, NOTES_MAX), 1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x::", out, NOTES_MAX), 0);
+	/* does not fit */
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x::a,b,c", out, 2), -1);
+	TEST_CHECK_EQ(BuzzerRtttlCompile("x::a,b,c", out, 3), 3);
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	TEST_RUN(TestCorpus);
+	TEST_RUN(TestKnownNotes);
+	TEST_RUN(TestDefaultDuration);
+	TEST_RUN(TestMalformed);
+	TEST_END();
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,41 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+/** \brief Minimal check macros for the host unit tests of the drivers.
+ *
+ * Each test is a function; TEST_RUN() calls it and TEST_END() returns the
+ * exit code of the executable (non zero if any check failed).
+ *
+ * @author Albano Peñalva
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+/*==================[macros]=================================================*/
+static int test_failures = 0;
+
+#define TEST_CHECK(cond)	do{ \
+	if(!(cond)){ \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		test_failures++; \
+	} \
+}while(0)
+
+#define TEST_CHECK_EQ(a, b)	do{ \
+	long long test_a = (long long)(a), test_b = (long long)(b); \
+	if(test_a != test_b){ \
+		printf("%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, test_a, test_b); \
+		test_failures++; \
+	} \
+}while(0)
+
+#define TEST_RUN(test)		do{ \
+	int test_before = test_failures; \
+	test(); \
+	printf("%-40s %s\n", #test, (test_failures == test_before) ? "ok" : "FAILED"); \
+}while(0)
+
+#define TEST_END()			return (test_failures != 0)
+
+#endif /* TEST_COMMON_H */
+
+/*==================[end of file]============================================*/
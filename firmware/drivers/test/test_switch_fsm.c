@@ -0,0 +1,195 @@
+/**
+ * @file test_switch_fsm.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of the switch state machine (switch_fsm.h) with synthetic edge traces
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test_common.h"
+#include "switch_fsm.h"
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define DEBOUNCE_MS		20
+#define DOUBLE_MS		250
+#define LONG_MS			800
+#define EVENTS_MAX		16
+#define TRACE_END		{UINT32_MAX, false}
+/*==================[internal data declaration]==============================*/
+/**
+ * @brief Raw edge of a trace
+ */
+typedef struct {
+	uint32_t time_ms;
+	bool pressed;
+} edge_t;
+
+/**
+ * @brief Event emitted by the state machine
+ */
+typedef struct {
+	switch_event_type_t type;
+	uint32_t time_ms;
+} event_t;
+/*==================[internal data definition]===============================*/
+static const switch_fsm_config_t config = {
+	.debounce_ms = DEBOUNCE_MS,
+	.double_click_ms = DOUBLE_MS,
+	.long_press_ms = LONG_MS,
+};
+static switch_fsm_t fsm;
+static event_t events[EVENTS_MAX];
+static uint32_t event_count;
+static uint32_t now;
+static uint32_t deadline_ms;
+/*==================[internal functions definition]==========================*/
+static void Record(switch_event_type_t type, uint32_t time_ms, void *param){
+	if(event_count < EVENTS_MAX){
+		events[event_count].type = type;
+		events[event_count].time_ms = time_ms;
+	}
+	event_count++;
+}
+
+/* Run the state machine up to time_ms as the switch service does: on each edge and on each deadline */
+static void RunUntil(uint32_t time_ms){
+	while((deadline_ms != SWITCH_FSM_NO_DEADLINE) && ((int32_t)(time_ms - (now + deadline_ms)) >= 0)){
+		now += deadline_ms;
+		deadline_ms = SwitchFsmUpdate(&fsm, now, Record, NULL);
+	}
+	now = time_ms;
+}
+
+/* Play a trace (times relative to start) and run 10 s more */
+static void Play(uint32_t start, bool pressed, const edge_t *trace){
+	SwitchFsmInit(&fsm, &config, pressed);
+	event_count = 0;
+	now = start;
+	deadline_ms = SWITCH_FSM_NO_DEADLINE;
+	for(; trace->time_ms != UINT32_MAX; trace++){
+		RunUntil(start + trace->time_ms);
+		SwitchFsmEdge(&fsm, trace->pressed, now);
+		deadline_ms = SwitchFsmUpdate(&fsm, now, Record, NULL);
+	}
+	RunUntil(now + 10000);
+}
+
+static void CheckEvents(uint32_t start, const event_t *expected, uint32_t count){
+	TEST_CHECK_EQ(event_count, count);
+	for(uint32_t i = 0; (i < count) && (i < event_count); i++){
+		TEST_CHECK_EQ(events[i].type, expected[i].type);
+		TEST_CHECK_EQ(events[i].time_ms - start, expected[i].time_ms);
+	}
+}
+
+static void TestClick(void){
+	static const edge_t trace[] = {
+		{100, true}, {102, false}, {104, true},		/* bouncing press */
+		{200, false}, {203, true}, {205, false},	/* bouncing release */
+		TRACE_END,
+	};
+	static const event_t expected[] = {
+		{SWITCH_EVENT_PRESS, 100}, {SWITCH_EVENT_RELEASE, 200}, {SWITCH_EVENT_CLICK, 200},
+	};
+	Play(0, false, trace);
+	CheckEvents(0, expected, 3);
+}
+
+static void TestClickDelayed(void){
+	static const edge_t trace[] = {{100, true}, {200, false}, TRACE_END};
+
+	/* the click waits for the double click window */
+	SwitchFsmInit(&fsm, &config, false);
+	event_count = 0;
+	SwitchFsmEdge(&fsm, trace[0].pressed, trace[0].time_ms);
+	SwitchFsmUpdate(&fsm, 100 + DEBOUNCE_MS, Record, NULL);
+	SwitchFsmEdge(&fsm, trace[1].pressed, trace[1].time_ms);
+	TEST_CHECK_EQ(SwitchFsmUpdate(&fsm, 200 + DEBOUNCE_MS, Record, NULL), DOUBLE_MS - DEBOUNCE_MS);
+	TEST_CHECK_EQ(event_count, 2);
+	TEST_CHECK_EQ(SwitchFsmUpdate(&fsm, 200 + DOUBLE_MS - 1, Record, NULL), 1);
+	TEST_CHECK_EQ(event_count, 2);
+	TEST_CHECK_EQ(SwitchFsmUpdate(&fsm, 200 + DOUBLE_MS, Record, NULL), SWITCH_FSM_NO_DEADLINE);
+	TEST_CHECK_EQ(event_count, 3);
+	TEST_CHECK_EQ(events[2].type, SWITCH_EVENT_CLICK);
+}
+
+static void TestDoubleClick(void){
+	static const edge_t trace[] = {
+		{100, true}, {200, false}, {300, true}, {301, false}, {302, true}, {400, false},
+		TRACE_END,
+	};
+	static const event_t expected[] = {
+		{SWITCH_EVENT_PRESS, 100}, {SWITCH_EVENT_RELEASE, 200},
+		{SWITCH_EVENT_PRESS, 300}, {SWITCH_EVENT_RELEASE, 400}, {SWITCH_EVENT_DOUBLE_CLICK, 400},
+	};
+	Play(0, false, trace);
+	CheckEvents(0, expected, 5);
+}
+
+static void TestLongPress(void){
+	static const edge_t trace[] = {{100, true}, {1500, false}, TRACE_END};
+	static const event_t expected[] = {
+		{SWITCH_EVENT_PRESS, 100}, {SWITCH_EVENT_LONG_PRESS, 100 + LONG_MS}, {SWITCH_EVENT_RELEASE, 1500},
+	};
+	Play(0, false, trace);
+	CheckEvents(0, expected, 3);
+}
+
+static void TestSecondPressLong(void){
+	static const edge_t trace[] = {{100, true}, {200, false}, {300, true}, {1500, false}, TRACE_END};
+	static const event_t expected[] = {
+		{SWITCH_EVENT_PRESS, 100}, {SWITCH_EVENT_RELEASE, 200}, {SWITCH_EVENT_PRESS, 300},
+		{SWITCH_EVENT_CLICK, 200}, {SWITCH_EVENT_LONG_PRESS, 300 + LONG_MS}, {SWITCH_EVENT_RELEASE, 1500},
+	};
+	Play(0, false, trace);
+	CheckEvents(0, expected, 6);
+}
+
+static void TestGlitch(void){
+	/* shorter than the debounce time, back to the same level */
+	static const edge_t released[] = {{100, true}, {105, false}, {2000, true}, {2001, false}, TRACE_END};
+	static const edge_t pressed[] = {{100, true}, {150, false}, {152, true}, {300, false}, TRACE_END};
+	static const event_t expected[] = {
+		{SWITCH_EVENT_PRESS, 100}, {SWITCH_EVENT_RELEASE, 300}, {SWITCH_EVENT_CLICK, 300},
+	};
+	Play(0, false, released);
+	TEST_CHECK_EQ(event_count, 0);
+	Play(0, false, pressed);
+	CheckEvents(0, expected, 3);
+}
+
+static void TestHeldAtStart(void){
+	/* a switch held at start up does not make a press, nor a click on release */
+	static const edge_t trace[] = {{100, false}, TRACE_END};
+	static const event_t expected[] = {{SWITCH_EVENT_RELEASE, 100}};
+	Play(0, true, trace);
+	CheckEvents(0, expected, 1);
+}
+
+static void TestTimeWrap(void){
+	static const edge_t trace[] = {{100, true}, {200, false}, {300, true}, {1500, false}, TRACE_END};
+	static const event_t expected[] = {
+		{SWITCH_EVENT_PRESS, 100}, {SWITCH_EVENT_RELEASE, 200}, {SWITCH_EVENT_PRESS, 300},
+		{SWITCH_EVENT_CLICK, 200}, {SWITCH_EVENT_LONG_PRESS, 300 + LONG_MS}, {SWITCH_EVENT_RELEASE, 1500},
+	};
+	Play(UINT32_MAX - 500, false, trace);
+	CheckEvents(UINT32_MAX - 500, expected, 6);
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	TEST_RUN(TestClick);
+	TEST_RUN(TestClickDelayed);
+	TEST_RUN(TestDoubleClick);
+	TEST_RUN(TestLongPress);
+	TEST_RUN(TestSecondPressLong);
+	TEST_RUN(TestGlitch);
+	TEST_RUN(TestHeldAtStart);
+	TEST_RUN(TestTimeWrap);
+	TEST_END();
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+"""Checks the C telemetry encoder against the Python decoder (firmware/tools/telemetry_decode.py).
+
+Runs "test_telemetry_packet --frames", feeds every frame to TelemetryDecoder and
+compares the decoded packet with the values the frame was built from.
+
+Usage:
+    python3 test_telemetry_decode.py <path to test_telemetry_packet>
+"""
+import os
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'tools'))
+from telemetry_decode import TelemetryDecoder   # noqa: E402
+
+
+def main():
+    output = subprocess.run([sys.argv[1], '--frames'], check=True, capture_output=True, text=True).stdout
+    decoder = TelemetryDecoder()
+    failures = 0
+    lines = output.splitlines()
+    for line in lines:
+        frame, packing, seq, timestamp, channels, values = line.split()
+        values = [int(v) for v in values.split(',')]
+        channels = int(channels)
+        expected = [values[i:i + channels] for i in range(0, len(values), channels)]
+        pkts = list(decoder.feed(bytes.fromhex(frame) + b'\x00'))
+        if len(pkts) != 1:
+            print('%s: not decoded' % frame)
+            failures += 1
+            continue
+        pkt = pkts[0]
+        got = (pkt.packing, pkt.seq, pkt.timestamp_us, pkt.channels, pkt.samples)
+        if got != (int(packing), int(seq), int(timestamp), channels, expected):
+            print('%s: decoded %s' % (frame, got))
+            failures += 1
+    if not lines or decoder.errors:
+        failures += 1
+    print('%d frames, %d failures' % (len(lines), failures))
+    return failures != 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,204 @@
+/**
+ * @file test_telemetry_packet.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of the telemetry packets, CRC16 and COBS (telemetry.h)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * With "--frames" the test vectors are printed as COBS frames instead, one per
+ * line, for test_telemetry_decode.py to check them against the Python decoder:
+ * <frame hex> <packing> <seq> <timestamp> <channels> <values>
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test_common.h"
+#include "telemetry.h"
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define ARRAY_LEN(a)	(sizeof(a) / sizeof((a)[0]))
+
+typedef struct {
+	const int16_t *values;
+	uint8_t channels;
+	uint16_t samples;
+	telemetry_packing_t packing;	/* requested packing */
+	uint16_t seq;
+	uint32_t timestamp;
+	const uint8_t *packet;			/* expected packet, CRC included */
+	uint16_t len;
+} vector_t;
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal data definition]===============================*/
+static const int16_t raw16_values[] = {1, -2, 0x1234, 0};
+static const uint8_t raw16_packet[] = {
+	0x10, 0x02, 0x02, 0x01, 0x44, 0x33, 0x22, 0x11, 0x02, 0x00,
+	0x01, 0x00, 0xFE, 0xFF, 0x34, 0x12, 0x00, 0x00,
+	0xAA, 0xA6,
+};
+
+/* odd number of values: the last one goes as 16 bits */
+static const int16_t bit12_values[] = {0x123, 0x456, 0xABC};
+static const uint8_t bit12_packet[] = {
+	0x11, 0x01, 0x03, 0x00, 0x10, 0x00, 0x00, 0x00, 0x03, 0x00,
+	0x23, 0x61, 0x45, 0xBC, 0x0A,
+	0xB9, 0x52,
+};
+
+static const int16_t delta8_values[] = {100, -100, 101, -102, 99, -95};
+static const uint8_t delta8_packet[] = {
+	0x12, 0x02, 0x04, 0x00, 0x20, 0x00, 0x00, 0x00, 0x03, 0x00,
+	0x64, 0x00, 0x9C, 0xFF, 0x01, 0xFE, 0xFE, 0x07,
+	0xF2, 0x19,
+};
+
+/* difference of 200 doesn't fit in int8: sent as RAW16 */
+static const int16_t fallback_values[] = {0, 200};
+static const uint8_t fallback_packet[] = {
+	0x10, 0x01, 0x05, 0x00, 0x30, 0x00, 0x00, 0x00, 0x02, 0x00,
+	0x00, 0x00, 0xC8, 0x00,
+	0x79, 0x9D,
+};
+
+static const vector_t vectors[] = {
+	{raw16_values, 2, 2, TELEMETRY_PACK_RAW16, 0x0102, 0x11223344, raw16_packet, sizeof(raw16_packet)},
+	{bit12_values, 1, 3, TELEMETRY_PACK_12BIT, 3, 0x10, bit12_packet, sizeof(bit12_packet)},
+	{delta8_values, 2, 3, TELEMETRY_PACK_DELTA8, 4, 0x20, delta8_packet, sizeof(delta8_packet)},
+	{fallback_values, 1, 2, TELEMETRY_PACK_DELTA8, 5, 0x30, fallback_packet, sizeof(fallback_packet)},
+};
+
+static uint8_t packet[TELEMETRY_MAX_PACKET];
+static uint8_t frame[TELEMETRY_MAX_FRAME];
+static uint8_t decoded[TELEMETRY_MAX_FRAME];
+/*==================[internal functions definition]==========================*/
+static uint16_t Build(const vector_t *v){
+	return TelemetryBuildPacket(v->values, v->channels, v->samples, v->packing, v->seq, v->timestamp, packet);
+}
+
+/* Encode, check there is no 0x00 in the frame and decode it back */
+static void CheckCobsRoundTrip(const uint8_t *data, uint16_t len){
+	int failures = test_failures;
+	uint16_t frame_len = TelemetryCobsEncode(data, len, frame);
+
+	TEST_CHECK(frame_len <= len + len / 254 + 1);
+	for(uint16_t i = 0; i < frame_len && failures == test_failures; i++){
+		TEST_CHECK(frame[i] != 0);
+	}
+	TEST_CHECK_EQ(TelemetryCobsDecode(frame, frame_len, decoded), len);
+	TEST_CHECK(memcmp(decoded, data, len) == 0);
+}
+
+static void TestPackets(void){
+	for(size_t i = 0; i < ARRAY_LEN(vectors); i++){
+		int failures = test_failures;
+		uint16_t len = Build(&vectors[i]);
+
+		TEST_CHECK_EQ(len, vectors[i].len);
+		for(uint16_t j = 0; j < len && failures == test_failures; j++){
+			TEST_CHECK_EQ(packet[j], vectors[i].packet[j]);
+		}
+		if(failures != test_failures){
+			printf("vector %zu\n", i);
+		}
+	}
+}
+
+static void TestCrc(void){
+	const uint8_t check[] = "123456789";
+	uint16_t len;
+
+	TEST_CHECK_EQ(TelemetryCrc16(check, 9), 0x29B1);
+	TEST_CHECK_EQ(TelemetryCrc16(check, 0), 0xFFFF);
+	/* the CRC of a packet covers the header and the payload, little endian */
+	len = Build(&vectors[0]);
+	TEST_CHECK_EQ(TelemetryCrc16(packet, len - TELEMETRY_CRC_SIZE), packet[len - 2] | (packet[len - 1] << 8));
+}
+
+static void TestCobs(void){
+	const uint8_t zero[] = {0x00};
+	const uint8_t zeros[] = {0x00, 0x00};
+	const uint8_t mixed[] = {0x11, 0x22, 0x00, 0x33};
+	const uint8_t invalid[] = {0x05, 0x11, 0x22};
+	uint8_t block[300];
+
+	TEST_CHECK_EQ(TelemetryCobsEncode(zero, sizeof(zero), frame), 2);
+	TEST_CHECK(frame[0] == 0x01 && frame[1] == 0x01);
+	TEST_CHECK_EQ(TelemetryCobsEncode(zeros, sizeof(zeros), frame), 3);
+	TEST_CHECK(frame[0] == 0x01 && frame[1] == 0x01 && frame[2] == 0x01);
+	TEST_CHECK_EQ(TelemetryCobsEncode(mixed, sizeof(mixed), frame), 5);
+	TEST_CHECK(memcmp(frame, "\x03\x11\x22\x02\x33", 5) == 0);
+	TEST_CHECK_EQ(TelemetryCobsDecode(invalid, sizeof(invalid), decoded), 0);
+
+	CheckCobsRoundTrip(zero, sizeof(zero));
+	CheckCobsRoundTrip(mixed, sizeof(mixed));
+	/* runs of 254 and more non zero bytes need an extra code byte */
+	for(size_t i = 0; i < sizeof(block); i++){
+		block[i] = (i % 255) + 1;
+	}
+	CheckCobsRoundTrip(block, 254);
+	TEST_CHECK_EQ(frame[0], 0xFF);
+	CheckCobsRoundTrip(block, 255);
+	CheckCobsRoundTrip(block, sizeof(block));
+}
+
+static void TestFrame(void){
+	const uint8_t expected[] = {
+		0x0A, 0x10, 0x02, 0x02, 0x01, 0x44, 0x33, 0x22, 0x11, 0x02,
+		0x02, 0x01, 0x05, 0xFE, 0xFF, 0x34, 0x12, 0x01, 0x03, 0xAA, 0xA6,
+	};
+	uint16_t len = Build(&vectors[0]);
+
+	TEST_CHECK_EQ(TelemetryCobsEncode(packet, len, frame), sizeof(expected));
+	TEST_CHECK(memcmp(frame, expected, sizeof(expected)) == 0);
+	for(size_t i = 0; i < ARRAY_LEN(vectors); i++){
+		CheckCobsRoundTrip(packet, Build(&vectors[i]));
+	}
+}
+
+static void TestMaxPacket(void){
+	static int16_t values[TELEMETRY_MAX_VALUES];
+	uint16_t len;
+
+	for(uint16_t i = 0; i < TELEMETRY_MAX_VALUES; i++){
+		values[i] = (int16_t)(i * 257);
+	}
+	len = TelemetryBuildPacket(values, TELEMETRY_MAX_CHANNELS, TELEMETRY_MAX_VALUES / TELEMETRY_MAX_CHANNELS,
+							   TELEMETRY_PACK_DELTA8, 0, 0, packet);
+	TEST_CHECK_EQ(len, TELEMETRY_MAX_PACKET);
+	TEST_CHECK_EQ(packet[0] & 0x0F, TELEMETRY_PACK_RAW16);
+	CheckCobsRoundTrip(packet, len);
+	TEST_CHECK(TelemetryCobsEncode(packet, len, frame) + 1 <= TELEMETRY_MAX_FRAME);
+}
+
+static void PrintFrames(void){
+	for(size_t i = 0; i < ARRAY_LEN(vectors); i++){
+		const vector_t *v = &vectors[i];
+		uint16_t len = TelemetryCobsEncode(packet, Build(v), frame);
+
+		for(uint16_t j = 0; j < len; j++){
+			printf("%02x", frame[j]);
+		}
+		printf(" %d %u %lu %u ", packet[0] & 0x0F, v->seq, (unsigned long)v->timestamp, v->channels);
+		for(uint16_t j = 0; j < v->channels * v->samples; j++){
+			printf("%s%d", j ? "," : "", v->values[j]);
+		}
+		printf("\n");
+	}
+}
+/*==================[external functions definition]==========================*/
+int main(int argc, char *argv[]){
+	if(argc > 1 && strcmp(argv[1], "--frames") == 0){
+		PrintFrames();
+		return 0;
+	}
+	TEST_RUN(TestPackets);
+	TEST_RUN(TestCrc);
+	TEST_RUN(TestCobs);
+	TEST_RUN(TestFrame);
+	TEST_RUN(TestMaxPacket);
+	TEST_END();
+}
+
+/*==================[end of file]============================================*/
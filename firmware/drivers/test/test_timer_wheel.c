@@ -0,0 +1,255 @@
+/**
+ * @file test_timer_wheel.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of the timer wheel (timer_wheel.h) against a reference model
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test_common.h"
+#include "timer_wheel.h"
+#include <stdlib.h>
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define TIMERS		64
+#define FIRES_MAX	16
+/*==================[internal data declaration]==============================*/
+/**
+ * @brief Expected state of a timer
+ */
+typedef struct {
+	bool pending;
+	uint32_t expires;
+	uint32_t period;
+} model_t;
+
+/**
+ * @brief State shared with the expiration callback
+ */
+typedef struct {
+	tw_wheel_t wheel;
+	tw_timer_t timers[TIMERS];
+	model_t model[TIMERS];
+	uint32_t fires[FIRES_MAX];		/* ticks of the simple tests */
+	uint32_t fired;
+	bool callback_actions;			/* fuzz: add/cancel from the callback */
+} fixture_t;
+/*==================[internal data definition]===============================*/
+static fixture_t fx;
+/*==================[internal functions definition]==========================*/
+static void FixtureInit(uint32_t now){
+	memset(&fx, 0, sizeof(fx));
+	TimerWheelInit(&fx.wheel, now);
+	for(uint32_t i = 0; i < TIMERS; i++){
+		TimerWheelTimerInit(&fx.timers[i]);
+		fx.timers[i].owner = &fx.model[i];
+	}
+}
+
+static void ModelAdd(uint32_t i, uint32_t delay, uint32_t period){
+	TimerWheelAdd(&fx.wheel, &fx.timers[i], delay, period);
+	fx.model[i].pending = true;
+	fx.model[i].expires = fx.wheel.now + delay;
+	fx.model[i].period = period;
+}
+
+static void ModelCancel(uint32_t i){
+	TimerWheelCancel(&fx.timers[i]);
+	fx.model[i].pending = false;
+}
+
+/* Next expiration of the model, checked against TimerWheelNextExpiry() */
+static void CheckNextExpiry(void){
+	uint32_t delay = 0, first = UINT32_MAX;
+	bool pending = false;
+
+	for(uint32_t i = 0; i < TIMERS; i++){
+		if(fx.model[i].pending && (fx.model[i].expires - fx.wheel.now < first)){
+			first = fx.model[i].expires - fx.wheel.now;
+			pending = true;
+		}
+	}
+	TEST_CHECK_EQ(TimerWheelNextExpiry(&fx.wheel, &delay), pending);
+	if(pending){
+		TEST_CHECK_EQ(delay, first);
+	}
+}
+
+/* Simple tests: record the tick of each expiration */
+static void RecordTick(tw_timer_t *timer, void *param){
+	if(fx.fired < FIRES_MAX){
+		fx.fires[fx.fired] = fx.wheel.now - 1;
+	}
+	fx.fired++;
+}
+
+/* Fuzz: check each expiration against the model */
+static void CheckExpired(tw_timer_t *timer, void *param){
+	model_t *model = (model_t *)timer->owner;
+	uint32_t i = model - fx.model;
+	uint32_t tick = fx.wheel.now - 1;
+
+	fx.fired++;
+	TEST_CHECK(model->pending);
+	TEST_CHECK_EQ(tick, model->expires);
+	if(model->period){
+		model->expires += model->period;
+	}else{
+		model->pending = false;
+	}
+	if(fx.callback_actions){
+		switch(rand() % 8){
+			case 0:
+				/* re-arm exactly one level 0 turn ahead */
+				ModelAdd(i, 63, 0);
+			break;
+			case 1:
+				ModelAdd(i, rand() % 300, rand() % 2 ? 0 : 1 + rand() % 200);
+			break;
+			case 2:
+				ModelCancel(rand() % TIMERS);
+			break;
+			default:
+			break;
+		}
+	}
+}
+
+static void TestPeriodicOneTurn(void){
+	FixtureInit(0);
+	TimerWheelAdd(&fx.wheel, &fx.timers[0], 10, 64);
+	TimerWheelAdvance(&fx.wheel, 200, RecordTick, NULL);
+	TEST_CHECK_EQ(fx.fired, 3);
+	TEST_CHECK_EQ(fx.fires[0], 10);
+	TEST_CHECK_EQ(fx.fires[1], 74);
+	TEST_CHECK_EQ(fx.fires[2], 138);
+}
+
+static void TestPeriodicShort(void){
+	FixtureInit(0);
+	TimerWheelAdd(&fx.wheel, &fx.timers[0], 0, 1);
+	TEST_CHECK_EQ(TimerWheelAdvance(&fx.wheel, 99, RecordTick, NULL), 100);
+	TEST_CHECK_EQ(fx.fires[0], 0);
+	TEST_CHECK_EQ(fx.fires[FIRES_MAX - 1], FIRES_MAX - 1);
+}
+
+static void TestLongDelayCascade(void){
+	FixtureInit(5);
+	TimerWheelAdd(&fx.wheel, &fx.timers[0], 300000, 0);
+	TimerWheelAdvance(&fx.wheel, 300004, RecordTick, NULL);
+	TEST_CHECK_EQ(fx.fired, 0);
+	TimerWheelAdvance(&fx.wheel, 300005, RecordTick, NULL);
+	TEST_CHECK_EQ(fx.fired, 1);
+	TEST_CHECK_EQ(fx.fires[0], 300005);
+	TEST_CHECK(!TimerWheelPending(&fx.timers[0]));
+}
+
+static void TestCancel(void){
+	FixtureInit(0);
+	TimerWheelAdd(&fx.wheel, &fx.timers[0], 20, 20);
+	TimerWheelAdvance(&fx.wheel, 30, RecordTick, NULL);
+	TimerWheelCancel(&fx.timers[0]);
+	TEST_CHECK(!TimerWheelPending(&fx.timers[0]));
+	TimerWheelAdvance(&fx.wheel, 1000, RecordTick, NULL);
+	TEST_CHECK_EQ(fx.fired, 1);
+}
+
+static void TestNextExpiry(void){
+	uint32_t delay = 0;
+
+	FixtureInit(1000);
+	TEST_CHECK(!TimerWheelNextExpiry(&fx.wheel, &delay));
+	/* level 2, then level 1 closer, then level 0 */
+	TimerWheelAdd(&fx.wheel, &fx.timers[0], 5000, 0);
+	TEST_CHECK(TimerWheelNextExpiry(&fx.wheel, &delay));
+	TEST_CHECK_EQ(delay, 5000);
+	TimerWheelAdd(&fx.wheel, &fx.timers[1], 100, 0);
+	TEST_CHECK(TimerWheelNextExpiry(&fx.wheel, &delay));
+	TEST_CHECK_EQ(delay, 100);
+	TimerWheelAdd(&fx.wheel, &fx.timers[2], 7, 0);
+	TEST_CHECK(TimerWheelNextExpiry(&fx.wheel, &delay));
+	TEST_CHECK_EQ(delay, 7);
+	/* sleeping until then expires it, not before */
+	TimerWheelAdvance(&fx.wheel, 1000 + 6, RecordTick, NULL);
+	TEST_CHECK_EQ(fx.fired, 0);
+	TEST_CHECK(TimerWheelNextExpiry(&fx.wheel, &delay));
+	TEST_CHECK_EQ(delay, 0);
+	TimerWheelAdvance(&fx.wheel, 1000 + 7, RecordTick, NULL);
+	TEST_CHECK_EQ(fx.fired, 1);
+	/* a level 1 timer one turn ahead in the slot already cascaded goes after the others */
+	TimerWheelAdd(&fx.wheel, &fx.timers[3], 4090, 0);
+	TEST_CHECK(TimerWheelNextExpiry(&fx.wheel, &delay));
+	TEST_CHECK_EQ(delay, 100 - 8);
+	TimerWheelCancel(&fx.timers[1]);
+	TimerWheelCancel(&fx.timers[0]);
+	TEST_CHECK(TimerWheelNextExpiry(&fx.wheel, &delay));
+	TEST_CHECK_EQ(delay, 4090);
+	TimerWheelCancel(&fx.timers[3]);
+	TEST_CHECK(!TimerWheelNextExpiry(&fx.wheel, &delay));
+}
+
+static void Fuzz(uint32_t start, bool callback_actions){
+	int failures = test_failures;
+	uint32_t target;
+
+	FixtureInit(start);
+	srand(start ^ callback_actions);
+	fx.callback_actions = callback_actions;
+	for(uint32_t step = 0; step < 20000; step++){
+		switch(rand() % 4){
+			case 0:
+				ModelAdd(rand() % TIMERS, rand() % 5000, (rand() % 3) ? 0 : 1 + rand() % 300);
+			break;
+			case 1:
+				ModelCancel(rand() % TIMERS);
+			break;
+			default:
+				target = fx.wheel.now + rand() % 200;
+				TimerWheelAdvance(&fx.wheel, target, CheckExpired, NULL);
+				TEST_CHECK_EQ(fx.wheel.now, target + 1);
+				CheckNextExpiry();
+				for(uint32_t i = 0; i < TIMERS; i++){
+					TEST_CHECK_EQ(TimerWheelPending(&fx.timers[i]), fx.model[i].pending);
+					if(fx.model[i].pending){
+						/* nothing missed */
+						TEST_CHECK((int32_t)(fx.model[i].expires - fx.wheel.now) >= 0);
+					}
+				}
+			break;
+		}
+		if(test_failures != failures){
+			return;
+		}
+	}
+	TEST_CHECK(fx.fired > 1000);
+}
+
+static void TestFuzz(void){
+	Fuzz(0, false);
+}
+
+static void TestFuzzCallbackActions(void){
+	Fuzz(1234, true);
+}
+
+static void TestFuzzTickWrap(void){
+	Fuzz(0xFFFF0000UL, true);
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	TEST_RUN(TestPeriodicOneTurn);
+	TEST_RUN(TestPeriodicShort);
+	TEST_RUN(TestLongDelayCascade);
+	TEST_RUN(TestCancel);
+	TEST_RUN(TestNextExpiry);
+	TEST_RUN(TestFuzz);
+	TEST_RUN(TestFuzzCallbackActions);
+	TEST_RUN(TestFuzzTickWrap);
+	TEST_END();
+}
+
+/*==================[end of file]============================================*/
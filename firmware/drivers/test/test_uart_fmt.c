@@ -0,0 +1,67 @@
+/**
+ * @file test_uart_fmt.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of the UART formatting (UartSprintf())
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test_common.h"
+#include "uart_mcu.h"
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define BUF_SIZE	64
+
+#define CHECK_FMT(expected, ...)	do{ \
+	uint16_t test_len = UartSprintf(buf, BUF_SIZE, __VA_ARGS__); \
+	TEST_CHECK(strcmp(buf, expected) == 0); \
+	TEST_CHECK_EQ(test_len, strlen(expected)); \
+}while(0)
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal data definition]===============================*/
+static char buf[BUF_SIZE];
+/*==================[internal functions definition]==========================*/
+static void TestIntegers(void){
+	CHECK_FMT("-12 34 ff 101", "%d %u %x %b", -12, 34u, 0xFFu, 5u);
+	CHECK_FMT("-2147483648 4294967295", "%d %u", (int32_t)INT32_MIN, (uint32_t)UINT32_MAX);
+}
+
+static void TestLong(void){
+	/* the next argument must still be read correctly after a long */
+	CHECK_FMT("-5 7 ab 11 x", "%ld %lu %lx %lb %c", -5L, 7UL, 0xABUL, 3UL, 'x');
+	CHECK_FMT("-2147483648 4294967295 1", "%ld %lu %d", (long)INT32_MIN, (unsigned long)UINT32_MAX, 1);
+}
+
+static void TestStrings(void){
+	CHECK_FMT("a=hello%", "%c=%s%%", 'a', "hello");
+	CHECK_FMT("(null) 1", "%s %d", (const char *)NULL, 1);
+}
+
+static void TestFloats(void){
+	CHECK_FMT("3.14 -0.5000 10.00", "%f %.4f %.2f", 3.14159, -0.5, 9.999);
+	CHECK_FMT("nan", "%f", 0.0 / 0.0);
+}
+
+static void TestTruncation(void){
+	char small[6];
+
+	TEST_CHECK_EQ(UartSprintf(small, sizeof(small), "%s", "truncated"), 5);
+	TEST_CHECK(strcmp(small, "trunc") == 0);
+	TEST_CHECK_EQ(UartSprintf(small, 0, "%d", 1), 0);
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	TEST_RUN(TestIntegers);
+	TEST_RUN(TestLong);
+	TEST_RUN(TestStrings);
+	TEST_RUN(TestFloats);
+	TEST_RUN(TestTruncation);
+	TEST_END();
+}
+
+/*==================[end of file]============================================*/
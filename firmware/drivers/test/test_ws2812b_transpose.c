@@ -0,0 +1,102 @@
+/**
+ * @file test_ws2812b_transpose.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of ws2812bParallelTranspose() (ws2812b_parallel.h) against a bit by bit reference
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "test_common.h"
+#include "ws2812b_parallel.h"
+#include <stdlib.h>
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define LEN_MAX		64
+#define LANES_ARG	(WS2812B_MAX_LANES + 2)		/* more than accepted, to check the clamp */
+#define GUARD		0xA5
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal data definition]===============================*/
+static uint8_t frames[LANES_ARG][LEN_MAX];
+static const uint8_t *lanes[LANES_ARG];
+static uint8_t slots[8 * LEN_MAX + 1];
+static uint8_t ref[8 * LEN_MAX];
+/*==================[internal functions definition]==========================*/
+/* Output byte 8 * k + b, bit n: bit (7 - b) of byte k of lane n */
+static void RefTranspose(uint8_t lane_qty, uint16_t len){
+	memset(ref, 0, sizeof(ref));
+	for(uint8_t n = 0; (n < lane_qty) && (n < WS2812B_MAX_LANES); n++){
+		for(uint16_t k = 0; k < len; k++){
+			for(uint8_t b = 0; b < 8; b++){
+				ref[8 * k + b] |= ((frames[n][k] >> (7 - b)) & 1) << n;
+			}
+		}
+	}
+}
+
+static void Check(uint8_t lane_qty, uint16_t len){
+	memset(slots, GUARD, sizeof(slots));
+	RefTranspose(lane_qty, len);
+	ws2812bParallelTranspose(lanes, lane_qty, len, slots);
+	TEST_CHECK(memcmp(slots, ref, 8 * len) == 0);
+	TEST_CHECK_EQ(slots[8 * len], GUARD);
+}
+
+static void TestSingleBits(void){
+	memset(frames, 0, sizeof(frames));
+	/* lane 0 MSB is the first slot, lane 7 LSB the last one */
+	frames[0][0] = 0x80;
+	frames[7][0] = 0x01;
+	frames[3][1] = 0x10;
+	ws2812bParallelTranspose(lanes, WS2812B_MAX_LANES, 2, slots);
+	TEST_CHECK_EQ(slots[0], 0x01);
+	TEST_CHECK_EQ(slots[7], 0x80);
+	TEST_CHECK_EQ(slots[8 + 3], 0x08);
+	for(uint8_t i = 1; i < 16; i++){
+		if(i != 7 && i != 11){
+			TEST_CHECK_EQ(slots[i], 0);
+		}
+	}
+	Check(WS2812B_MAX_LANES, 2);
+}
+
+static void TestAllOnes(void){
+	memset(frames, 0xFF, sizeof(frames));
+	for(uint8_t lane_qty = 0; lane_qty <= LANES_ARG; lane_qty++){
+		Check(lane_qty, LEN_MAX);
+	}
+}
+
+static void TestRandom(void){
+	int failures = test_failures;
+
+	srand(28);
+	for(uint32_t test = 0; test < 1000; test++){
+		for(uint8_t n = 0; n < LANES_ARG; n++){
+			for(uint16_t k = 0; k < LEN_MAX; k++){
+				frames[n][k] = rand();
+			}
+		}
+		Check(rand() % (LANES_ARG + 1), rand() % (LEN_MAX + 1));
+		if(test_failures != failures){
+			printf("  case %u\n", test);
+			return;
+		}
+	}
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	for(uint8_t n = 0; n < LANES_ARG; n++){
+		lanes[n] = frames[n];
+	}
+	TEST_RUN(TestSingleBits);
+	TEST_RUN(TestAllOnes);
+	TEST_RUN(TestRandom);
+	TEST_END();
+}
+
+/*==================[end of file]============================================*/
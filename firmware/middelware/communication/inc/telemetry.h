@@ -0,0 +1,177 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Middelware Middelware
+ ** @{ */
+/** \addtogroup Telemetry Binary telemetry
+ ** @{ */
+
+/** \brief Binary framed telemetry for multi-channel sample streaming.
+ * 
+ * Samples are grouped in packets, each one with a small header, the payload and
+ * a CRC16. Packets are COBS encoded and ended with a 0x00 delimiter, so the
+ * receiver can resynchronize at any time.
+ * 
+ * Packet (before COBS, little endian):
+ * 
+ * | Offset | Size | Field                                                     |
+ * |:------:|:----:|:----------------------------------------------------------|
+ * | 0      | 1    | Version (high nibble) and packing used (low nibble)       |
+ * | 1      | 1    | Number of channels                                        |
+ * | 2      | 2    | Sequence number                                           |
+ * | 4      | 4    | Timestamp of the first sample of the packet (us)          |
+ * | 8      | 2    | Samples per channel                                       |
+ * | 10     | N    | Payload: interleaved samples (ch0, ch1, ..., ch0, ...)    |
+ * | 10 + N | 2    | CRC16-CCITT (0x1021, init 0xFFFF) of the previous bytes   |
+ * 
+ * Packing:
+ * - TELEMETRY_PACK_RAW16: int16 per value.
+ * - TELEMETRY_PACK_12BIT: unsigned 12 bits values (e.g. ADC samples), 2 values in 3 bytes.
+ * - TELEMETRY_PACK_DELTA8: first sample of each channel as int16, then int8 differences
+ *   with the previous sample of the same channel. Packets with larger differences
+ *   are sent as TELEMETRY_PACK_RAW16.
+ * 
+ * @note A host side decoder is available at firmware/tools/telemetry_decode.py
+ * @note Packet building, CRC16 and COBS (telemetry_packet.c) don't access any
+ * hardware and are tested on the host (firmware/drivers/test).
+ * 
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 19/10/2026 | Document creation		                         						|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define TELEMETRY_VERSION           1       /*!< Protocol version */
+#define TELEMETRY_MAX_CHANNELS      8       /*!< Max channels per packet */
+#define TELEMETRY_MAX_VALUES        256     /*!< Max values (samples * channels) per packet */
+#define TELEMETRY_HEADER_SIZE       10      /*!< Packet header size */
+#define TELEMETRY_CRC_SIZE          2       /*!< Packet CRC size */
+#define TELEMETRY_MAX_PACKET        (TELEMETRY_HEADER_SIZE + 2 * TELEMETRY_MAX_VALUES + TELEMETRY_CRC_SIZE)
+#define TELEMETRY_MAX_FRAME         (TELEMETRY_MAX_PACKET + TELEMETRY_MAX_PACKET / 254 + 2)    /*!< COBS overhead and delimiter */
+/*==================[typedef]================================================*/
+/**
+ * @brief Link used to send packets
+ */
+typedef enum {
+	TELEMETRY_UART_PC,			/*!< UART_PC (must be initialized with UartInit()) */
+	TELEMETRY_UART_CONNECTOR,	/*!< UART_CONNECTOR (must be initialized with UartInit()) */
+	TELEMETRY_BLE,				/*!< BLE (must be initialized with BleInit()) */
+} telemetry_transport_t;
+
+/**
+ * @brief Samples packing in the payload
+ */
+typedef enum {
+	TELEMETRY_PACK_RAW16 = 0,	/*!< 2 bytes per value */
+	TELEMETRY_PACK_12BIT = 1,	/*!< 1.5 bytes per value (0 to 4095) */
+	TELEMETRY_PACK_DELTA8 = 2,	/*!< ~1 byte per value for slow signals */
+} telemetry_packing_t;
+
+/**
+ * @brief Telemetry configuration struct
+ */
+typedef struct {
+	telemetry_transport_t transport;	/*!< Link used to send packets */
+	telemetry_packing_t packing;		/*!< Samples packing */
+	uint8_t channels;					/*!< Values per sample (1 to TELEMETRY_MAX_CHANNELS) */
+	uint16_t samples_per_packet;		/*!< Samples grouped in each packet (channels * samples <= TELEMETRY_MAX_VALUES) */
+	uint32_t sample_period_us;			/*!< Time between samples (us), used to timestamp each packet of a block */
+} telemetry_config_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Initialize the telemetry module
+ * 
+ * @param config Pointer to configuration struct
+ * @return true     Telemetry initialized
+ * @return false    Invalid configuration
+ */
+bool TelemetryInit(telemetry_config_t *config);
+
+/**
+ * @brief Add one sample (one value per channel). The packet is sent once
+ * samples_per_packet samples have been added.
+ * 
+ * @param values Array of config.channels values
+ */
+void TelemetryAddSample(const int16_t *values);
+
+/**
+ * @brief Send a block of interleaved samples, split in as many packets as needed.
+ * 
+ * Each packet is stamped with timestamp + (samples sent before it) * config.sample_period_us.
+ * 
+ * @param values Array of samples * config.channels values
+ * @param samples Number of samples in the block
+ * @param timestamp Sampling time of the first sample of the block (us, esp_timer)
+ */
+void TelemetrySendBlock(const int16_t *values, uint16_t samples, uint32_t timestamp);
+
+/**
+ * @brief Send the samples added so far, even if the packet is not complete.
+ * 
+ */
+void TelemetryFlush(void);
+
+/**
+ * @brief Build a packet (header, payload and CRC) without COBS encoding.
+ * 
+ * @note Pure function, it doesn't access any hardware.
+ * @param values Interleaved values
+ * @param channels Number of channels
+ * @param samples Samples per channel
+ * @param packing Requested packing
+ * @param seq Sequence number
+ * @param timestamp Timestamp of the first sample (us)
+ * @param packet Output buffer (at least TELEMETRY_MAX_PACKET bytes)
+ * @return uint16_t Packet length
+ */
+uint16_t TelemetryBuildPacket(const int16_t *values, uint8_t channels, uint16_t samples, telemetry_packing_t packing,
+							  uint16_t seq, uint32_t timestamp, uint8_t *packet);
+
+/**
+ * @brief CRC16-CCITT (polynomial 0x1021, initial value 0xFFFF)
+ * 
+ * @param data Data array
+ * @param len Data length
+ * @return uint16_t CRC
+ */
+uint16_t TelemetryCrc16(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief COBS encoding
+ * 
+ * @note The output doesn't include the 0x00 delimiter.
+ * @param in Data to be encoded
+ * @param len Data length
+ * @param out Encoded data (at least len + len / 254 + 1 bytes)
+ * @return uint16_t Encoded length
+ */
+uint16_t TelemetryCobsEncode(const uint8_t *in, uint16_t len, uint8_t *out);
+
+/**
+ * @brief COBS decoding
+ * 
+ * @param in Encoded data (without the 0x00 delimiter)
+ * @param len Encoded length
+ * @param out Decoded data (at least len bytes)
+ * @return uint16_t Decoded length (0 if the frame is invalid)
+ */
+uint16_t TelemetryCobsDecode(const uint8_t *in, uint16_t len, uint8_t *out);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* TELEMETRY_H_ */
+
+/*==================[end of file]============================================*/
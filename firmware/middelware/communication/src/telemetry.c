@@ -0,0 +1,105 @@
+/**
+ * @file telemetry.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-19
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include <string.h>
+#include "telemetry.h"
+#include "uart_mcu.h"
+#include "ble_mcu.h"
+#include "esp_timer.h"
+/*==================[macros and definitions]=================================*/
+#define TELEMETRY_BLE_CHUNK     128     /*!< Max bytes per BleSendBuffer() call */
+/*==================[internal data declaration]==============================*/
+static telemetry_config_t telemetry_config;
+static int16_t samples_buffer[TELEMETRY_MAX_VALUES];
+static uint16_t samples_count = 0;
+static uint32_t first_timestamp = 0;
+static uint16_t packet_seq = 0;
+static uint8_t packet[TELEMETRY_MAX_PACKET];
+static uint8_t frame[TELEMETRY_MAX_FRAME];
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void TelemetryWrite(const uint8_t *data, uint16_t len){
+    uint16_t chunk;
+    switch(telemetry_config.transport){
+        case TELEMETRY_UART_PC:
+            UartWrite(UART_PC, data, len);
+        break;
+        case TELEMETRY_UART_CONNECTOR:
+            UartWrite(UART_CONNECTOR, data, len);
+        break;
+        case TELEMETRY_BLE:
+            while(len){
+                chunk = (len > TELEMETRY_BLE_CHUNK) ? TELEMETRY_BLE_CHUNK : len;
+                BleSendBuffer((const char *)data, chunk);
+                data += chunk;
+                len -= chunk;
+            }
+        break;
+    }
+}
+
+static void TelemetrySendPacket(const int16_t *values, uint16_t samples, uint32_t timestamp){
+    uint16_t len;
+    len = TelemetryBuildPacket(values, telemetry_config.channels, samples, telemetry_config.packing,
+                               packet_seq++, timestamp, packet);
+    len = TelemetryCobsEncode(packet, len, frame);
+    frame[len++] = 0x00;
+    TelemetryWrite(frame, len);
+}
+/*==================[external functions definition]==========================*/
+bool TelemetryInit(telemetry_config_t *config){
+    if(config->channels == 0 || config->channels > TELEMETRY_MAX_CHANNELS || config->samples_per_packet == 0 ||
+       (uint32_t)config->channels * config->samples_per_packet > TELEMETRY_MAX_VALUES){
+        return false;
+    }
+    telemetry_config = *config;
+    samples_count = 0;
+    packet_seq = 0;
+    return true;
+}
+
+void TelemetryAddSample(const int16_t *values){
+    if(samples_count == 0){
+        first_timestamp = (uint32_t)esp_timer_get_time();
+    }
+    memcpy(&samples_buffer[samples_count * telemetry_config.channels], values, telemetry_config.channels * sizeof(int16_t));
+    samples_count++;
+    if(samples_count >= telemetry_config.samples_per_packet){
+        TelemetryFlush();
+    }
+}
+
+void TelemetrySendBlock(const int16_t *values, uint16_t samples, uint32_t timestamp){
+    uint16_t n;
+    TelemetryFlush();
+    while(samples){
+        n = (samples > telemetry_config.samples_per_packet) ? telemetry_config.samples_per_packet : samples;
+        TelemetrySendPacket(values, n, timestamp);
+        values += n * telemetry_config.channels;
+        timestamp += n * telemetry_config.sample_period_us;
+        samples -= n;
+    }
+}
+
+void TelemetryFlush(void){
+    if(samples_count){
+        TelemetrySendPacket(samples_buffer, samples_count, first_timestamp);
+        samples_count = 0;
+    }
+}
+
+/*==================[end of file]============================================*/
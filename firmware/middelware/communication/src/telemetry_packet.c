@@ -0,0 +1,187 @@
+/**
+ * @file telemetry_packet.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Telemetry packet building, CRC16 and COBS (hardware independent)
+ * @version 0.1
+ * @date 2026-10-19
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "telemetry.h"
+/*==================[macros and definitions]=================================*/
+#define COBS_MAX_BLOCK          0xFF
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+static const uint16_t crc16_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static inline void PutU16(uint8_t *buf, uint16_t val){
+    buf[0] = val & 0xFF;
+    buf[1] = val >> 8;
+}
+
+static uint16_t PackRaw16(const int16_t *values, uint16_t count, uint8_t *payload){
+    for (uint16_t i = 0; i < count; i++){
+        PutU16(&payload[2 * i], values[i]);
+    }
+    return 2 * count;
+}
+
+static uint16_t Pack12Bit(const int16_t *values, uint16_t count, uint8_t *payload){
+    uint16_t len = 0, a, b;
+    for (uint16_t i = 0; i + 1 < count; i += 2){
+        a = values[i] & 0x0FFF;
+        b = values[i + 1] & 0x0FFF;
+        payload[len++] = a & 0xFF;
+        payload[len++] = (a >> 8) | ((b & 0x0F) << 4);
+        payload[len++] = b >> 4;
+    }
+    if(count & 1){
+        PutU16(&payload[len], values[count - 1] & 0x0FFF);
+        len += 2;
+    }
+    return len;
+}
+
+/**
+ * @return uint16_t payload length, 0 if a difference doesn't fit in int8
+ */
+static uint16_t PackDelta8(const int16_t *values, uint8_t channels, uint16_t count, uint8_t *payload){
+    uint16_t len = 0;
+    int32_t delta;
+    for (uint8_t ch = 0; ch < channels && ch < count; ch++){
+        PutU16(&payload[len], values[ch]);
+        len += 2;
+    }
+    for (uint16_t i = channels; i < count; i++){
+        delta = (int32_t)values[i] - values[i - channels];
+        if(delta < INT8_MIN || delta > INT8_MAX){
+            return 0;
+        }
+        payload[len++] = (uint8_t)(int8_t)delta;
+    }
+    return len;
+}
+
+/*==================[external functions definition]==========================*/
+uint16_t TelemetryBuildPacket(const int16_t *values, uint8_t channels, uint16_t samples, telemetry_packing_t packing,
+                              uint16_t seq, uint32_t timestamp, uint8_t *packet){
+    uint16_t count = channels * samples;
+    uint16_t len = 0;
+    uint8_t *payload = &packet[TELEMETRY_HEADER_SIZE];
+
+    switch(packing){
+        case TELEMETRY_PACK_12BIT:
+            len = Pack12Bit(values, count, payload);
+        break;
+        case TELEMETRY_PACK_DELTA8:
+            len = PackDelta8(values, channels, count, payload);
+        break;
+        default:
+        break;
+    }
+    if(len == 0){
+        /* raw packing requested, or deltas out of range */
+        packing = TELEMETRY_PACK_RAW16;
+        len = PackRaw16(values, count, payload);
+    }
+    packet[0] = (TELEMETRY_VERSION << 4) | packing;
+    packet[1] = channels;
+    PutU16(&packet[2], seq);
+    PutU16(&packet[4], timestamp & 0xFFFF);
+    PutU16(&packet[6], timestamp >> 16);
+    PutU16(&packet[8], samples);
+    len += TELEMETRY_HEADER_SIZE;
+    PutU16(&packet[len], TelemetryCrc16(packet, len));
+    return len + TELEMETRY_CRC_SIZE;
+}
+
+uint16_t TelemetryCrc16(const uint8_t *data, uint16_t len){
+    uint16_t crc = 0xFFFF;
+    while(len--){
+        crc = (crc << 8) ^ crc16_table[(crc >> 8) ^ *data++];
+    }
+    return crc;
+}
+
+uint16_t TelemetryCobsEncode(const uint8_t *in, uint16_t len, uint8_t *out){
+    uint16_t code_idx = 0, out_idx = 1;
+    uint8_t code = 1;
+    for (uint16_t i = 0; i < len; i++){
+        if(in[i] == 0){
+            out[code_idx] = code;
+            code_idx = out_idx++;
+            code = 1;
+        }else{
+            out[out_idx++] = in[i];
+            code++;
+            if(code == COBS_MAX_BLOCK){
+                out[code_idx] = code;
+                code_idx = out_idx++;
+                code = 1;
+            }
+        }
+    }
+    out[code_idx] = code;
+    return out_idx;
+}
+
+uint16_t TelemetryCobsDecode(const uint8_t *in, uint16_t len, uint8_t *out){
+    uint16_t in_idx = 0, out_idx = 0;
+    uint8_t code;
+    while(in_idx < len){
+        code = in[in_idx++];
+        if(code == 0 || in_idx + code - 1 > len){
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++){
+            out[out_idx++] = in[in_idx++];
+        }
+        if(code != COBS_MAX_BLOCK && in_idx < len){
+            out[out_idx++] = 0;
+        }
+    }
+    return out_idx;
+}
+
+/*==================[end of file]============================================*/
@@ -14,6 +14,7 @@
 #include <math.h>
 #include "fft.h"
 #include "esp_dsp.h"
+#include "trace_mcu.h"
 #include "esp_log.h"
 /*==================[macros and definitions]=================================*/
 #define TAG "FFT Module"
@@ -38,6 +39,7 @@ bool FFTInit(void){
 }
 
 void FFTMagnitude(float * signal, float * fft, uint16_t signal_lenght){
+    TRACE_BEGIN(TRACE_ID_FFT);
     // Generate Hann window
     dsps_wind_hann_f32(wind, signal_lenght);
     // Clear fft array
@@ -57,6 +59,7 @@ void FFTMagnitude(float * signal, float * fft, uint16_t signal_lenght){
     fft_complex[0] = fft_complex[0] / 2;
     // Copy result in fft array
     memcpy(fft, fft_complex, (signal_lenght / 2) * sizeof(float));
+    TRACE_END(TRACE_ID_FFT);
 }
 
 void FFTFrequency(float sample_freq, uint16_t signal_lenght, float * f){
@@ -12,6 +12,7 @@
 /*==================[inclusions]=============================================*/
 #include "iir_filter.h"
 #include "esp_dsp.h"
+#include "trace_mcu.h"
 /*==================[macros and definitions]=================================*/
 #define N_SOS       5
 #define N_DELAY     2
@@ -108,6 +109,7 @@ void HiPassInit(float sample_frec, float cut_frec, filter_order_t order){
 }
 
 void LowPassFilter(float * input_signal, float * output_signal, int16_t signal_lenght){
+    TRACE_BEGIN(TRACE_ID_IIR_LOW);
     switch(lp_order){
         case ORDER_2:
             dsps_biquad_f32(input_signal, output_signal, signal_lenght, lp2_sos_coeff, lp2_delay);
@@ -128,9 +130,11 @@ void LowPassFilter(float * input_signal, float * output_signal, int16_t signal_l
             dsps_biquad_f32(output_signal, output_signal, signal_lenght, lp8_sos_coeff, lp8_delay);
         break;
     }
+    TRACE_END(TRACE_ID_IIR_LOW);
 }
 
 void HiPassFilter(float * input_signal, float * output_signal, int16_t signal_lenght){
+    TRACE_BEGIN(TRACE_ID_IIR_HIGH);
     switch(hp_order){
         case ORDER_2:
             dsps_biquad_f32(input_signal, output_signal, signal_lenght, hp2_sos_coeff, hp2_delay);
@@ -151,6 +155,7 @@ void HiPassFilter(float * input_signal, float * output_signal, int16_t signal_le
             dsps_biquad_f32(output_signal, output_signal, signal_lenght, hp8_sos_coeff, hp8_delay);
         break;
     }
+    TRACE_END(TRACE_ID_IIR_HIGH);
 }
 
 /*==================[end of file]============================================*/
\ No newline at end of file
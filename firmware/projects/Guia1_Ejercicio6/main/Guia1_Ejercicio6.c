@@ -59,14 +59,17 @@ int8_t convertToBcdArray(uint32_t data, uint8_t digits, uint8_t * bcd_number){
  * @param gpi almacena el estado de cada pin segun los bits del bcd ingresado
 */
 void cambiaEstado(int dig_bcd, gpioConf_t *gpi){
+	uint32_t set = 0, clear = 0;
 	for(int i=0; i<4; i++){
 		if(dig_bcd & (1<<i)){
-		GPIOOn(gpi[i].pin);
+		set |= GPIO_MASK(gpi[i].pin);
 		}
 		else{
-		GPIOOff(gpi[i].pin);
+		clear |= GPIO_MASK(gpi[i].pin);
 		}
 	}
+	/* se actualizan los 4 pines con dos escrituras al puerto: primero los unos, luego los ceros */
+	GPIOWriteMask(set, clear);
 };
 
 /**
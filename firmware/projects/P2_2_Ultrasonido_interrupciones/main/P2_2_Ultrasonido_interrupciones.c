@@ -150,11 +150,23 @@ void LeerTecla(switch_t tecla){
 	}
 }
 
+/** @brief Llamada por el servicio de teclas: al apretar un switch enciende/apaga las mediciones (SWITCH_1) o pausa el display (SWITCH_2)
+ * @param evento evento de la tecla
+ * @param param no usado
+ * @return void
+*/
+void EventoTecla(switch_event_t *evento, void *param){
+	if(evento->type == SWITCH_EVENT_PRESS){
+		LeerTecla(evento->sw);
+	}
+}
+
 /*==================[external functions definition]==========================*/
 void app_main(void){
 	LedsInit();
 	SwitchesInit();
 	LcdItsE0803Init();
+	LcdItsE0803StartRefresh(100);	/* el display se actualiza en segundo plano, las tareas solo cargan el valor */
 	HcSr04Init(GPIO_3, GPIO_2);
 
 	timer_config_t timer_distancia = {
@@ -166,10 +178,14 @@ void app_main(void){
 
 	TimerInit(&timer_distancia);
 
-	SwitchActivInt(SWITCH_1, &LeerTeclaOnOff, NULL);
-	SwitchActivInt(SWITCH_2, &LeerTeclaHold, NULL);
-	//SwitchActivInt(SWITCH_1, &LeerTecla, SWITCH_1); Sirve para hacer una sola funcion, el de abajo igual 
-	//SwitchActivInt(SWITCH_2, &LeerTecla, SWITCH_2);
+	switch_service_config_t teclas = {
+		.debounce_ms = SWITCH_DEBOUNCE_MS,
+		.double_click_ms = 0,
+		.long_press_ms = 0,
+		.func_p = EventoTecla,
+		.param_p = NULL
+	};
+	SwitchServiceInit(&teclas);
 
 	xTaskCreate(&LeerDistancia, "LeerDistancia", 2048, NULL, 5, &leer_distancia_handle);
 	xTaskCreate(&MostrarDistancia, "MostrarDistancia", 2048, NULL, 5, &mostrar_distancia_handle);
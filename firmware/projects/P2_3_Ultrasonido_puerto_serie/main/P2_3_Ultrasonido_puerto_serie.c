@@ -157,6 +157,25 @@ void controlXTeclado(void *param){
 	}
 }
 
+/** @brief Llamada por el servicio de teclas: SWITCH_1 hace lo mismo que la tecla 'O' y SWITCH_2 lo mismo que la tecla 'H'
+ * @param evento evento de la tecla
+ * @param param no usado
+ * @return void
+*/
+void EventoTecla(switch_event_t *evento, void *param){
+	if(evento->type != SWITCH_EVENT_PRESS){
+		return;
+	}
+	switch(evento->sw){
+		case SWITCH_1:
+			LeerTeclaOnOff();
+		break;
+		case SWITCH_2:
+			LeerTeclaHold();
+		break;
+	}
+}
+
 /*==================[external functions definition]==========================*/
 void app_main(void){
 	LedsInit();
@@ -185,9 +204,14 @@ void app_main(void){
 	xTaskCreate(&LeerDistancia, "LeerDistancia", 2048, NULL, 5, &leer_distancia_handle);
 	xTaskCreate(&MostrarDistancia, "MostrarDistancia", 2048, NULL, 5, &mostrar_distancia_handle);
 		
-	//interrupciones	
-	SwitchActivInt(SWITCH_1, &LeerTeclaOnOff, NULL);
-	SwitchActivInt(SWITCH_2, &LeerTeclaHold, NULL);
+	switch_service_config_t teclas = {
+		.debounce_ms = SWITCH_DEBOUNCE_MS,
+		.double_click_ms = 0,
+		.long_press_ms = 0,
+		.func_p = EventoTecla,
+		.param_p = NULL
+	};
+	SwitchServiceInit(&teclas);
 
 	TimerStart(timer_distancia.timer);
 }
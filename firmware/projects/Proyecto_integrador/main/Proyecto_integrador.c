@@ -170,6 +170,16 @@ void read_data(uint8_t * data, uint8_t length){
     }
 }
 
+/**
+ * @brief Carga el ciclo de trabajo de ambos motores, que se actualiza en el mismo periodo del PWM
+ * @param izq ciclo de trabajo del motor izquierdo en %
+ * @param der ciclo de trabajo del motor derecho en %
+ */
+void MotoresSetDuty(uint8_t izq, uint8_t der){
+	uint32_t duty[2] = {PWM_Q16_PERCENT(izq), PWM_Q16_PERCENT(der)};
+	PWMGroupSetDutyQ16(pwm_control_motores, duty, 2);
+}
+
 /**
  * @brief Funcion que controla los motores DC y modifica su velocidad utilizando PWM 
  * MIB y MDB deben estar en HIGH para que el robot vaya hacia adelante.
@@ -182,26 +192,22 @@ void ControlMotores(){
 			PWMOn(pwm_control_motores[0]);
 			PWMOn(pwm_control_motores[1]);
 			
-			PWMSetDutyCycle(pwm_control_motores[0], 65);
-			PWMSetDutyCycle(pwm_control_motores[1], 65);
+			MotoresSetDuty(65, 65);
 			break;
 		case 'I':
 			PWMOn(pwm_control_motores[0]);
 			PWMOn(pwm_control_motores[1]);
 			
-			PWMSetDutyCycle(pwm_control_motores[0], 90); 
-			PWMSetDutyCycle(pwm_control_motores[1], 30); 
+			MotoresSetDuty(90, 30);
 			break;
 		case 'D':
 			PWMOn(pwm_control_motores[0]);
 			PWMOn(pwm_control_motores[1]);
 			
-			PWMSetDutyCycle(pwm_control_motores[0], 30); 
-			PWMSetDutyCycle(pwm_control_motores[1], 90); 	
+			MotoresSetDuty(30, 90);
 			break;
 		case 'F':
-			PWMSetDutyCycle(pwm_control_motores[0], 100); 
-			PWMSetDutyCycle(pwm_control_motores[1], 100); 	
+			MotoresSetDuty(100, 100);
 			break;
 
 		default:
@@ -310,8 +316,8 @@ void app_main(void){
 
 	pwm_control_motores[0]=PWM_0;
 	pwm_control_motores[1]=PWM_1;
-	PWMInit(pwm_control_motores[0], MIA, 50);
-	PWMInit(pwm_control_motores[1], MDA, 50);
+	gpio_t gpio_pwm_motores[2] = {MIA, MDA};
+	PWMGroupInit(pwm_control_motores, gpio_pwm_motores, 2, 50);
 
 	analog_input_config_t senal_analogica_bat = {			
 		.input= CH1,			
@@ -88,14 +88,14 @@ void FuncTimerB_Mostrar (void* param){
 	vTaskNotifyGiveFromISR(mostrar_estado_handle, pdFALSE);
 }
 
-/** @brief Interrupcion que cambia el estado de la variable inicio al apretar SWITCH 1
+/** @brief Cambia el estado de la variable inicio al apretar SWITCH 1
  * @return void
 */
 void LeerTeclaOn(void){
 	inicio=true;	
 }
 
-/** @brief Interrupcion que cambia el estado de la variable inicio al apretar SWITCH 2
+/** @brief Cambia el estado de la variable inicio al apretar SWITCH 2
  * @return void
 */
 void LeerTeclaOff(void){
@@ -181,6 +181,26 @@ static void MostrarEstado(void *pvParameter){
 				}
 			}
 		}
+	}
+}
+
+/** @brief Llamada por el servicio de teclas: SWITCH_1 inicia el control de riego y pH, SWITCH_2 lo detiene
+ * @param evento evento de la tecla
+ * @param param no usado
+ * @return void
+*/
+void EventoTecla(switch_event_t *evento, void *param){
+	if(evento->type != SWITCH_EVENT_PRESS){
+		return;
+	}
+	switch(evento->sw){
+		case SWITCH_1:
+			LeerTeclaOn();
+		break;
+		case SWITCH_2:
+			LeerTeclaOff();
+		break;
+	}
 }
 
 /*==================[external functions definition]==========================*/
@@ -228,8 +248,14 @@ void app_main(void){
 	xTaskCreate(&ControlpH, "Control_pH", 2048, NULL, 5, &control_ph_handle);
 	xTaskCreate(&MostrarEstado, "Mostrar_estado", 2048, NULL, 5, &mostrar_estado_handle);
 
-	SwitchActivInt(SWITCH_1, &LeerTeclaOn, NULL);
-	SwitchActivInt(SWITCH_2, &LeerTeclaOff, NULL);
+	switch_service_config_t teclas = {
+		.debounce_ms = SWITCH_DEBOUNCE_MS,
+		.double_click_ms = 0,
+		.long_press_ms = 0,
+		.func_p = EventoTecla,
+		.param_p = NULL
+	};
+	SwitchServiceInit(&teclas);
 
 	TimerStart(timer_medicion.timer);
 	TimerStart(timer_puertoserie.timer);
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Host side decoder for the binary telemetry protocol (middelware/communication/telemetry.h).
+
+Reads COBS framed packets from a serial port or a capture file and prints one line
+per sample (CSV), or can be imported to decode frames in scripts and tests:
+
+    from telemetry_decode import TelemetryDecoder
+    dec = TelemetryDecoder()
+    for pkt in dec.feed(data):
+        print(pkt.seq, pkt.samples)
+
+Usage:
+    python3 telemetry_decode.py /dev/ttyUSB0 --baud 115200
+    python3 telemetry_decode.py capture.bin
+"""
+import argparse
+import struct
+import sys
+from dataclasses import dataclass, field
+
+VERSION = 1
+HEADER = struct.Struct('<BBHIH')
+PACK_RAW16, PACK_12BIT, PACK_DELTA8 = 0, 1, 2
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC16-CCITT (polynomial 0x1021, initial value 0xFFFF)."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    """Decode a COBS frame (without the 0x00 delimiter). Raises ValueError if invalid."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError('invalid COBS frame')
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def _unpack_values(packing, payload, count, channels):
+    if packing == PACK_RAW16:
+        return list(struct.unpack('<%dh' % count, payload[:2 * count]))
+    if packing == PACK_12BIT:
+        values = []
+        i = 0
+        while len(values) + 1 < count:
+            b0, b1, b2 = payload[i:i + 3]
+            values.append(b0 | ((b1 & 0x0F) << 8))
+            values.append((b1 >> 4) | (b2 << 4))
+            i += 3
+        if count & 1:
+            values.append(struct.unpack_from('<H', payload, i)[0])
+        return values
+    if packing == PACK_DELTA8:
+        first = min(channels, count)
+        values = list(struct.unpack_from('<%dh' % first, payload, 0))
+        deltas = struct.unpack_from('<%db' % (count - first), payload, 2 * first)
+        for i, delta in enumerate(deltas, start=first):
+            values.append(values[i - channels] + delta)
+        return values
+    raise ValueError('unknown packing %d' % packing)
+
+
+@dataclass
+class Packet:
+    seq: int
+    timestamp_us: int
+    channels: int
+    packing: int
+    samples: list = field(default_factory=list)   # one list of channel values per sample
+
+
+def decode_packet(raw):
+    """Decode a packet (already COBS decoded). Raises ValueError on bad CRC or format."""
+    if len(raw) < HEADER.size + 2:
+        raise ValueError('packet too short')
+    if crc16(raw[:-2]) != struct.unpack_from('<H', raw, len(raw) - 2)[0]:
+        raise ValueError('bad CRC')
+    ver_pack, channels, seq, timestamp, samples = HEADER.unpack_from(raw)
+    if ver_pack >> 4 != VERSION:
+        raise ValueError('unsupported version %d' % (ver_pack >> 4))
+    values = _unpack_values(ver_pack & 0x0F, raw[HEADER.size:-2], channels * samples, channels)
+    rows = [values[i:i + channels] for i in range(0, len(values), channels)]
+    return Packet(seq, timestamp, channels, ver_pack & 0x0F, rows)
+
+
+class TelemetryDecoder:
+    """Stream decoder: splits on 0x00, decodes and tracks lost packets."""
+
+    def __init__(self):
+        self._buffer = bytearray()
+        self._next_seq = None
+        self.packets = 0
+        self.errors = 0
+        self.lost = 0
+
+    def feed(self, data):
+        """Feed received bytes, yield every valid Packet found."""
+        self._buffer += data
+        while True:
+            end = self._buffer.find(0)
+            if end < 0:
+                return
+            frame = bytes(self._buffer[:end])
+            del self._buffer[:end + 1]
+            if not frame:
+                continue
+            try:
+                pkt = decode_packet(cobs_decode(frame))
+            except ValueError:
+                self.errors += 1
+                continue
+            if self._next_seq is not None:
+                self.lost += (pkt.seq - self._next_seq) & 0xFFFF
+            self._next_seq = (pkt.seq + 1) & 0xFFFF
+            self.packets += 1
+            yield pkt
+
+
+def _open_source(path, baud):
+    if path == '-':
+        return sys.stdin.buffer
+    try:
+        return open(path, 'rb') if not path.startswith(('/dev/', 'COM')) else _open_serial(path, baud)
+    except OSError as err:
+        sys.exit(str(err))
+
+
+def _open_serial(path, baud):
+    import serial   # pyserial, only needed for live capture
+    return serial.Serial(path, baud, timeout=1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('source', help="serial port, capture file or '-' for stdin")
+    parser.add_argument('--baud', type=int, default=115200)
+    args = parser.parse_args()
+
+    src = _open_source(args.source, args.baud)
+    decoder = TelemetryDecoder()
+    try:
+        while True:
+            data = src.read(256)
+            if not data:
+                if not args.source.startswith(('/dev/', 'COM')):
+                    break
+                continue
+            for pkt in decoder.feed(data):
+                for i, row in enumerate(pkt.samples):
+                    print('%d,%d,%d,%s' % (pkt.seq, pkt.timestamp_us, i, ','.join(map(str, row))))
+    except KeyboardInterrupt:
+        pass
+    print('# packets: %d, CRC/format errors: %d, lost: %d' % (decoder.packets, decoder.errors, decoder.lost),
+          file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""Host side converter for the trace dump of the drivers (drivers/microcontroller/inc/trace_mcu.h).
+
+Finds the binary dump sent by TraceDump() in a serial port or a capture file (other
+output around it is skipped) and writes it in the Chrome trace format, to be opened
+in chrome://tracing or https://ui.perfetto.dev. A summary with the duration of every
+section is printed to stderr. Can also be imported:
+
+    from trace2json import parse_dump, to_chrome
+    dump, _ = parse_dump(data)
+    events = to_chrome(dump)
+
+Usage:
+    python3 trace2json.py /dev/ttyUSB0 --baud 115200 -o trace.json
+    python3 trace2json.py capture.bin -o trace.json
+"""
+import argparse
+import json
+import struct
+import sys
+from dataclasses import dataclass, field
+
+MAGIC = b'TRC1'
+TRAILER = b'TEND'
+HEADER = struct.Struct('<IBBH')
+CORE = struct.Struct('<II')
+RECORD = struct.Struct('<IBBh')
+EV_BEGIN, EV_END, EV_COUNTER = 0, 1, 2
+
+
+class Incomplete(Exception):
+    """The dump is cut: more data is needed."""
+
+
+@dataclass
+class Dump:
+    cycles_hz: int
+    names: dict = field(default_factory=dict)       # id -> name
+    cores: list = field(default_factory=list)       # one list of (cycles, id, type, value) per core
+    overwritten: list = field(default_factory=list)
+
+
+def _take(data, offset, size):
+    if offset + size > len(data):
+        raise Incomplete()
+    return data[offset:offset + size], offset + size
+
+
+def parse_dump(data, start=0):
+    """Parse the first dump found in data from start. Returns (Dump, end offset).
+
+    Raises Incomplete if the dump is not complete yet and ValueError if there is none
+    or it is malformed.
+    """
+    offset = data.find(MAGIC, start)
+    if offset < 0:
+        raise ValueError('no trace dump found')
+    raw, offset = _take(data, offset + len(MAGIC), HEADER.size)
+    cycles_hz, cores, record_size, names = HEADER.unpack(raw)
+    if record_size != RECORD.size or cycles_hz == 0:
+        raise ValueError('unsupported dump (record size %d)' % record_size)
+    dump = Dump(cycles_hz)
+    for _ in range(names):
+        raw, offset = _take(data, offset, 2)
+        raw_name, offset = _take(data, offset, raw[1])
+        dump.names[raw[0]] = raw_name.decode('ascii', 'replace')
+    for _ in range(cores):
+        raw, offset = _take(data, offset, CORE.size)
+        count, overwritten = CORE.unpack(raw)
+        raw, offset = _take(data, offset, count * RECORD.size)
+        dump.cores.append(list(RECORD.iter_unpack(raw)))
+        dump.overwritten.append(overwritten)
+    raw, offset = _take(data, offset, len(TRAILER))
+    if raw != TRAILER:
+        raise ValueError('bad trailer')
+    return dump, offset
+
+
+def _unwrap(records):
+    """32 bit cycle counter to a monotonic count, records of one core in ring order.
+
+    A step back is taken as a record interrupted between its time stamp and its slot.
+    """
+    out = []
+    total = None
+    for cycles, ident, kind, value in records:
+        if total is None:
+            total = cycles
+        else:
+            delta = (cycles - total) & 0xFFFFFFFF
+            total += delta - (1 << 32) if delta & 0x80000000 else delta
+        out.append((total, ident, kind, value))
+    return out
+
+
+@dataclass
+class Summary:
+    count: int = 0
+    total_us: float = 0.0
+    max_us: float = 0.0
+
+
+def to_chrome(dump, summary=None):
+    """Convert a Dump to a list of Chrome trace events (one thread per core).
+
+    Begin and end records are paired by id, so sections of different tasks that
+    overlap on a core are shown correctly. Ends whose begin was overwritten are
+    skipped; begins without end are left open.
+    """
+    names = dict(dump.names)
+    cores = [_unwrap(records) for records in dump.cores]
+    origin = min((records[0][0] for records in cores if records), default=0)
+    to_us = 1e6 / dump.cycles_hz
+    events = [{'name': 'process_name', 'ph': 'M', 'pid': 0, 'args': {'name': 'firmware'}}]
+    for core, records in enumerate(cores):
+        events.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': core, 'args': {'name': 'core %d' % core}})
+        open_sections = {}
+        for cycles, ident, kind, value in records:
+            name = names.get(ident, 'id_%d' % ident)
+            ts = (cycles - origin) * to_us
+            if kind == EV_BEGIN:
+                open_sections.setdefault(ident, []).append(ts)
+            elif kind == EV_END:
+                if not open_sections.get(ident):
+                    continue
+                begin = open_sections[ident].pop()
+                events.append({'name': name, 'ph': 'X', 'pid': 0, 'tid': core, 'ts': begin, 'dur': ts - begin})
+                if summary is not None:
+                    stats = summary.setdefault(name, Summary())
+                    stats.count += 1
+                    stats.total_us += ts - begin
+                    stats.max_us = max(stats.max_us, ts - begin)
+            elif kind == EV_COUNTER:
+                events.append({'name': name, 'ph': 'C', 'pid': 0, 'tid': core, 'ts': ts, 'args': {name: value}})
+        for ident, begins in open_sections.items():
+            for begin in begins:
+                events.append({'name': names.get(ident, 'id_%d' % ident), 'ph': 'B', 'pid': 0, 'tid': core,
+                               'ts': begin})
+    return events
+
+
+def _open_source(path, baud):
+    if path == '-':
+        return sys.stdin.buffer
+    try:
+        return open(path, 'rb') if not path.startswith(('/dev/', 'COM')) else _open_serial(path, baud)
+    except OSError as err:
+        sys.exit(str(err))
+
+
+def _open_serial(path, baud):
+    import serial   # pyserial, only needed for live capture
+    return serial.Serial(path, baud, timeout=1)
+
+
+def _read_dump(src, live):
+    """Read until a complete dump is received (or the file ends)."""
+    data = bytearray()
+    while True:
+        try:
+            return parse_dump(bytes(data))[0]
+        except Incomplete:
+            pass
+        except ValueError:
+            start = data.find(MAGIC)
+            if start >= 0:
+                # malformed dump (or text looking like the magic): look for the next one
+                del data[:start + 1]
+                continue
+            # keep the tail: the magic could be split between two reads
+            del data[:-(len(MAGIC) - 1)]
+        chunk = src.read(4096)
+        if not chunk and not live:
+            sys.exit('no complete trace dump found')
+        data += chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('source', help="serial port, capture file or '-' for stdin")
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('-o', '--output', help='JSON file (default: stdout)')
+    args = parser.parse_args()
+
+    try:
+        dump = _read_dump(_open_source(args.source, args.baud), args.source.startswith(('/dev/', 'COM')))
+    except KeyboardInterrupt:
+        sys.exit(1)
+    summary = {}
+    trace = {'traceEvents': to_chrome(dump, summary), 'displayTimeUnit': 'ns'}
+    if args.output:
+        with open(args.output, 'w') as out:
+            json.dump(trace, out)
+    else:
+        json.dump(trace, sys.stdout)
+    for core, records in enumerate(dump.cores):
+        print('# core %d: %d records, %d overwritten' % (core, len(records), dump.overwritten[core]), file=sys.stderr)
+    for name, stats in sorted(summary.items()):
+        print('# %-16s %6d  mean %9.2f us  max %9.2f us' % (name, stats.count, stats.total_us / stats.count,
+                                                             stats.max_us), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()